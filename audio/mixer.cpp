@@ -19,6 +19,8 @@
  *
  */
 
+#include <atomic>
+
 #include "gui/EventRecorder.h"
 
 #include "common/util.h"
@@ -37,6 +39,17 @@ namespace Audio {
 #pragma mark -
 
 
+/**
+ * Snapshot of a channel's playback position, see elapsedTime().
+ */
+struct ChannelTiming {
+	uint32 samplesConsumed;
+	uint32 mixerTimeStamp;
+	uint32 pauseStartTime;
+	uint32 pauseTime;
+	bool paused;
+};
+
 /**
  * Channel used by the default Mixer implementation.
  */
@@ -121,9 +134,10 @@ public:
 	void notifyGlobalVolChange() { updateChannelVolumes(); }
 
 	/**
-	 * Queries how long the channel has been playing.
+	 * Queries the state needed to compute how long the channel has been
+	 * playing.
 	 */
-	Timestamp getElapsedTime();
+	ChannelTiming getTiming() const;
 
 	/**
 	 * Replaces the channel's stream with a version that loops indefinitely.
@@ -176,24 +190,168 @@ private:
 #pragma mark --- Mixer ---
 #pragma mark -
 
+enum {
+	/** Handle value of a free channel slot, same as a default SoundHandle. */
+	kFreeHandle = 0xFFFFFFFF,
+	/** Handle value of a slot whose channel was stopped, but not deleted yet. */
+	kRetiredHandle = 0xFFFFFFFE,
+	/** Wait (in milliseconds) for the audio thread without buffer size */
+	kDefaultCommandDelay = 100
+};
+
+/**
+ * The part of a channel's state which may be queried from any thread.
+ *
+ * The slot handle is written by the thread reserving the slot (in
+ * playStream) and cleared by the thread deleting the channel; all other
+ * fields are written before the handle is published. The timing fields
+ * are updated by the audio thread and guarded by a sequence counter.
+ *
+ * A channel stopped by a command is moved to retired, for the stopping
+ * thread to delete it, and its handle set to kRetiredHandle until then.
+ */
+struct MixerImpl::ChannelState {
+	std::atomic<uint32> handle;
+	std::atomic<int> id;
+	std::atomic<int> type;
+	std::atomic<int> volume;
+	std::atomic<int> balance;
+
+	std::atomic<uint32> timingSeq;
+	std::atomic<uint32> samplesConsumed;
+	std::atomic<uint32> mixerTimeStamp;
+	std::atomic<uint32> pauseStartTime;
+	std::atomic<uint32> pauseTime;
+	std::atomic<bool> paused;
+
+	std::atomic<Channel *> retired;
+
+	ChannelState() : handle(kFreeHandle), id(-1), type(0), volume(0), balance(0), timingSeq(0),
+		samplesConsumed(0), mixerTimeStamp(0), pauseStartTime(0), pauseTime(0), paused(false), retired(nullptr) {}
+
+	bool matches(uint32 val) const {
+		return val != kFreeHandle && val != kRetiredHandle && handle.load(std::memory_order_acquire) == val;
+	}
+
+	bool isActive() const {
+		const uint32 val = handle.load(std::memory_order_acquire);
+		return val != kFreeHandle && val != kRetiredHandle;
+	}
+
+	void setTiming(const ChannelTiming &timing) {
+		timingSeq.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		samplesConsumed.store(timing.samplesConsumed, std::memory_order_relaxed);
+		mixerTimeStamp.store(timing.mixerTimeStamp, std::memory_order_relaxed);
+		pauseStartTime.store(timing.pauseStartTime, std::memory_order_relaxed);
+		pauseTime.store(timing.pauseTime, std::memory_order_relaxed);
+		paused.store(timing.paused, std::memory_order_relaxed);
+		timingSeq.fetch_add(1, std::memory_order_release);
+	}
+
+	ChannelTiming getTiming() const {
+		ChannelTiming timing;
+		uint32 seq;
+		do {
+			// An odd sequence number means an update is in progress
+			while ((seq = timingSeq.load(std::memory_order_acquire)) & 1)
+				;
+			timing.samplesConsumed = samplesConsumed.load(std::memory_order_relaxed);
+			timing.mixerTimeStamp = mixerTimeStamp.load(std::memory_order_relaxed);
+			timing.pauseStartTime = pauseStartTime.load(std::memory_order_relaxed);
+			timing.pauseTime = pauseTime.load(std::memory_order_relaxed);
+			timing.paused = paused.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+		} while (timingSeq.load(std::memory_order_relaxed) != seq);
+		return timing;
+	}
+};
+
+struct MixerImpl::CommandQueue {
+	Command commands[COMMAND_QUEUE_SIZE];
+	/** Index of the next command to apply, only advanced by the consumer. */
+	std::atomic<uint32> head;
+	/** Index of the next free entry, only advanced by the producer. */
+	std::atomic<uint32> tail;
+
+	CommandQueue() : head(0), tail(0) {}
+
+	bool push(const Command &cmd) {
+		const uint32 t = tail.load(std::memory_order_relaxed);
+		if (t - head.load(std::memory_order_acquire) == COMMAND_QUEUE_SIZE)
+			return false;
+		commands[t % COMMAND_QUEUE_SIZE] = cmd;
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool pop(Command &cmd) {
+		const uint32 h = head.load(std::memory_order_relaxed);
+		if (h == tail.load(std::memory_order_acquire))
+			return false;
+		cmd = commands[h % COMMAND_QUEUE_SIZE];
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+};
+
+/**
+ * Compute how long a channel has been playing from a timing snapshot.
+ */
+static Timestamp elapsedTime(uint rate, const ChannelTiming &timing) {
+	uint32 delta = 0;
+
+	Audio::Timestamp ts(0, rate);
+
+	if (timing.mixerTimeStamp == 0)
+		return ts;
+
+	if (timing.paused)
+		delta = timing.pauseStartTime - timing.mixerTimeStamp;
+	else
+		delta = g_system->getMillis(true) - timing.mixerTimeStamp - timing.pauseTime;
+
+	// Convert the number of samples into a time duration.
+
+	ts = ts.addFrames(timing.samplesConsumed);
+	ts = ts.addMsecs(delta);
+
+	// In theory it would seem like a good idea to limit the approximation
+	// so that it never exceeds the theoretical upper bound set by
+	// _samplesDecoded. Meanwhile, back in the real world, doing so makes
+	// the Broken Sword cutscenes noticeably jerkier. I guess the mixer
+	// isn't invoked at the regular intervals that I first imagined.
+
+	return ts;
+}
+
 MixerImpl::MixerImpl(uint sampleRate, uint outBufSize)
-	: _mutex(), _sampleRate(sampleRate), _outBufSize(outBufSize), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _sampleRate(sampleRate), _outBufSize(outBufSize), _mixerReady(false), _handleSeed(0), _channelsBusy(false), _appliedCommands(0), _soundTypeSettings() {
 
 	assert(sampleRate > 0);
 
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		_channels[i] = nullptr;
+
+	_channelStates = new ChannelState[NUM_CHANNELS];
+	_commandQueue = new CommandQueue();
 }
 
 MixerImpl::~MixerImpl() {
+	// Take over the channels which are still waiting to be inserted
+	while (!applyCommands())
+		g_system->delayMillis(1);
+	destroyRetiredChannels();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		delete _channels[i];
+
+	delete[] _channelStates;
+	delete _commandQueue;
 }
 
 void MixerImpl::setReady(bool ready) {
-	Common::StackLock lock(_mutex);
-
-	_mixerReady = ready;
+	_mixerReady.store(ready, std::memory_order_release);
 }
 
 uint MixerImpl::getOutputRate() const {
@@ -204,29 +362,255 @@ uint MixerImpl::getOutputBufSize() const {
 	return _outBufSize;
 }
 
-void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
-	int index = -1;
+uint32 MixerImpl::queueCommand(Command::Type type, uint32 handle, int id, int param, Channel *channel) {
+	Command cmd;
+	cmd.type = type;
+	cmd.handle = handle;
+	cmd.id = id;
+	cmd.param = param;
+	cmd.channel = channel;
+
+	for (;;) {
+		uint32 count;
+		{
+			Common::StackLock lock(_queueMutex);
+			if (_commandQueue->push(cmd))
+				return _commandQueue->tail.load(std::memory_order_relaxed);
+			count = _commandQueue->tail.load(std::memory_order_relaxed);
+		}
+
+		// The audio thread is not keeping up, wait for it to make room
+		waitForCommands(count);
+	}
+}
+
+void MixerImpl::waitForCommands(uint32 count) {
+	// Two buffers, as the audio thread may have just started mixing one
+	const uint32 maxDelay = _outBufSize ? 2 * 1000 * _outBufSize / _sampleRate + 10 : (uint32)kDefaultCommandDelay;
+	const uint32 start = g_system->getMillis();
+
+	while ((int32)(_appliedCommands.load(std::memory_order_acquire) - count) < 0) {
+		// Without a running audio thread, the commands are applied from
+		// here, while the audio thread is not mixing. The calling thread
+		// may hold mutex() already, keeping the audio thread from mixing.
+		if (!isReady() || g_system->getMillis() - start >= maxDelay) {
+			Common::StackLock lock(_mutex);
+			if (applyCommands())
+				break;
+		}
+		g_system->delayMillis(1);
+	}
+}
+
+bool MixerImpl::applyCommands() {
+	if (_channelsBusy.exchange(true, std::memory_order_acquire))
+		return false;
+	processCommands();
+	_channelsBusy.store(false, std::memory_order_release);
+	return true;
+}
+
+void MixerImpl::stopChannels(Command::Type type, uint32 handle, int id) {
+	// The streams may be freed once this returns, so they must not be
+	// mixed anymore
+	waitForCommands(queueCommand(type, handle, id, 0));
+	destroyRetiredChannels();
+}
+
+void MixerImpl::destroyRetiredChannels() {
+	Common::StackLock lock(_mutex);
+	Common::StackLock queueLock(_queueMutex);
+
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] == nullptr) {
-			index = i;
-			break;
+		Channel *chan = _channelStates[i].retired.exchange(nullptr, std::memory_order_acquire);
+		if (chan) {
+			delete chan;
+
+			// Only now may the slot be reserved again
+			_channelStates[i].handle.store(kFreeHandle, std::memory_order_release);
 		}
 	}
-	if (index == -1) {
-		warning("MixerImpl::out of mixer slots");
-		delete chan;
-		return;
+}
+
+void MixerImpl::processCommands() {
+	Command cmd;
+	while (_commandQueue->pop(cmd)) {
+		Channel *chan = nullptr;
+
+		switch (cmd.type) {
+		case Command::kCommandInsert:
+			assert(!_channels[cmd.handle % NUM_CHANNELS]);
+			_channels[cmd.handle % NUM_CHANNELS] = cmd.channel;
+			break;
+
+		case Command::kCommandSetVolume:
+			chan = findChannel(cmd.handle);
+			if (chan)
+				chan->setVolume(cmd.param);
+			break;
+
+		case Command::kCommandSetBalance:
+			chan = findChannel(cmd.handle);
+			if (chan)
+				chan->setBalance(cmd.param);
+			break;
+
+		case Command::kCommandPauseHandle:
+			chan = findChannel(cmd.handle);
+			if (chan) {
+				chan->pause(cmd.param != 0);
+				publishChannelTiming(cmd.handle % NUM_CHANNELS);
+			}
+			break;
+
+		case Command::kCommandPauseID:
+			for (int i = 0; i != NUM_CHANNELS; i++) {
+				if (_channels[i] != nullptr && _channels[i]->getId() == cmd.id) {
+					_channels[i]->pause(cmd.param != 0);
+					publishChannelTiming(i);
+					break;
+				}
+			}
+			break;
+
+		case Command::kCommandPauseAll:
+			for (int i = 0; i != NUM_CHANNELS; i++) {
+				if (_channels[i] != nullptr) {
+					_channels[i]->pause(cmd.param != 0);
+					publishChannelTiming(i);
+				}
+			}
+			break;
+
+		case Command::kCommandLoop:
+			chan = findChannel(cmd.handle);
+			if (chan)
+				chan->loop();
+			break;
+
+		case Command::kCommandNotifyGlobalVolume:
+			for (int i = 0; i != NUM_CHANNELS; ++i) {
+				if (_channels[i] && _channels[i]->getType() == cmd.param)
+					_channels[i]->notifyGlobalVolChange();
+			}
+			break;
+
+		case Command::kCommandStopHandle:
+			if (findChannel(cmd.handle))
+				retireChannel(cmd.handle % NUM_CHANNELS);
+			break;
+
+		case Command::kCommandStopID:
+			for (int i = 0; i != NUM_CHANNELS; i++) {
+				if (_channels[i] != nullptr && _channels[i]->getId() == cmd.id)
+					retireChannel(i);
+			}
+			break;
+
+		case Command::kCommandStopAll:
+			for (int i = 0; i != NUM_CHANNELS; i++) {
+				if (_channels[i] != nullptr && !_channels[i]->isPermanent())
+					retireChannel(i);
+			}
+			break;
+
+		default:
+			break;
+		}
 	}
 
-	_channels[index] = chan;
+	// Acknowledge the commands to the threads waiting for them
+	_appliedCommands.store(_commandQueue->head.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+Channel *MixerImpl::findChannel(uint32 handle) {
+	const int index = handle % NUM_CHANNELS;
+	if (!_channels[index] || _channels[index]->getHandle()._val != handle)
+		return nullptr;
+	return _channels[index];
+}
+
+Channel *MixerImpl::detachChannel(int index) {
+	Channel *chan = _channels[index];
+	_channels[index] = nullptr;
+	return chan;
+}
+
+void MixerImpl::retireChannel(int index) {
+	ChannelState &state = _channelStates[index];
+
+	// The handle first, so that the thread taking the channel frees the
+	// slot after it
+	state.handle.store(kRetiredHandle, std::memory_order_relaxed);
+	state.retired.store(detachChannel(index), std::memory_order_release);
+}
+
+void MixerImpl::destroyChannel(Channel *chan) {
+	const uint32 handle = chan->getHandle()._val;
+
+	delete chan;
+
+	// Only now may the slot be reserved again
+	uint32 expected = handle;
+	_channelStates[handle % NUM_CHANNELS].handle.compare_exchange_strong(expected, (uint32)kFreeHandle, std::memory_order_acq_rel);
+}
+
+void MixerImpl::publishChannelTiming(int index) {
+	_channelStates[index].setTiming(_channels[index]->getTiming());
+}
+
+void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
+	int index = -1;
+	uint32 chanHandle = kFreeHandle;
+
+	{
+		Common::StackLock lock(_queueMutex);
+
+		// Prevent duplicate sounds
+		const int id = chan->getId();
+		if (id != -1) {
+			for (int i = 0; i != NUM_CHANNELS; i++) {
+				if (_channelStates[i].isActive() && _channelStates[i].id.load(std::memory_order_relaxed) == id) {
+					delete chan;
+					return;
+				}
+			}
+		}
+
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channelStates[i].handle.load(std::memory_order_acquire) == kFreeHandle) {
+				index = i;
+				break;
+			}
+		}
+		if (index == -1) {
+			warning("MixerImpl::out of mixer slots");
+			delete chan;
+			return;
+		}
+
+		chanHandle = index + (_handleSeed * NUM_CHANNELS);
+		_handleSeed++;
+
+		SoundHandle soundHandle;
+		soundHandle._val = chanHandle;
+		chan->setHandle(soundHandle);
+
+		// Publish the new channel, so that queries see it right away
+		ChannelState &state = _channelStates[index];
+		ChannelTiming timing = { 0, 0, 0, 0, false };
+		state.setTiming(timing);
+		state.id.store(id, std::memory_order_relaxed);
+		state.type.store(chan->getType(), std::memory_order_relaxed);
+		state.volume.store(chan->getVolume(), std::memory_order_relaxed);
+		state.balance.store(chan->getBalance(), std::memory_order_relaxed);
+		state.handle.store(chanHandle, std::memory_order_release);
+	}
 
-	SoundHandle chanHandle;
-	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
+	queueCommand(Command::kCommandInsert, chanHandle, -1, 0, chan);
 
-	chan->setHandle(chanHandle);
-	_handleSeed++;
 	if (handle)
-		*handle = chanHandle;
+		handle->_val = chanHandle;
 }
 
 void MixerImpl::playStream(
@@ -237,8 +621,6 @@ void MixerImpl::playStream(
 			DisposeAfterUse::Flag autofreeStream,
 			bool permanent,
 			bool reverseStereo) {
-	Common::StackLock lock(_mutex);
-
 	if (stream == nullptr) {
 		warning("stream is 0");
 		return;
@@ -247,22 +629,6 @@ void MixerImpl::playStream(
 
 	assert(_mixerReady);
 
-	// Prevent duplicate sounds
-	if (id != -1) {
-		for (int i = 0; i != NUM_CHANNELS; i++)
-			if (_channels[i] != nullptr && _channels[i]->getId() == id) {
-				// Delete the stream if were asked to auto-dispose it.
-				// Note: This could cause trouble if the client code does not
-				// yet expect the stream to be gone. The primary example to
-				// keep in mind here is QueuingAudioStream.
-				// Thus, as a quick rule of thumb, you should never, ever,
-				// try to play QueuingAudioStreams with a sound id.
-				if (autofreeStream == DisposeAfterUse::YES)
-					delete stream;
-				return;
-			}
-	}
-
 #ifdef AUDIO_REVERSE_STEREO
 	reverseStereo = !reverseStereo;
 #endif
@@ -271,124 +637,135 @@ void MixerImpl::playStream(
 	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
+
+	// Note: insertChannel deletes the channel (and thus the stream, if we
+	// were asked to auto-dispose it) for duplicate sound ids. This could
+	// cause trouble if the client code does not yet expect the stream to be
+	// gone. The primary example to keep in mind here is QueuingAudioStream.
+	// Thus, as a quick rule of thumb, you should never, ever, try to play
+	// QueuingAudioStreams with a sound id.
 	insertChannel(handle, chan);
 }
 
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
-	Common::StackLock lock(_mutex);
-
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
 	assert(len % 4 == 0);
 	len >>= 2;
 
-	// Since the mixer callback has been called, the mixer must be ready...
-	_mixerReady = true;
-
 	//  zero the buf
 	memset(buf, 0, 2 * len * sizeof(int16));
 
+	// Since the mixer callback has been called, the mixer must be ready...
+	_mixerReady.store(true, std::memory_order_release);
+
+	// Apply the control operations queued since the last call. A thread
+	// which found the audio thread stalled may be applying them in its
+	// place, which only takes a moment.
+	while (!applyCommands())
+		;
+
 	// mix all channels
+	Channel *finished[NUM_CHANNELS];
+	int numFinished = 0;
 	int res = 0, tmp;
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i]) {
-			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = nullptr;
-			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
-
-				if (tmp > res)
-					res = tmp;
-			}
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (_channelStates[i].handle.load(std::memory_order_relaxed) == kFreeHandle)
+			continue;
+
+		// The players sharing mutex() expect it to be held while their
+		// streams are read. It is taken before the channels, in the same
+		// order as in waitForCommands().
+		Common::StackLock lock(_mutex);
+		while (_channelsBusy.exchange(true, std::memory_order_acquire))
+			;
+
+		if (!_channels[i]) {
+			// Not inserted yet
+		} else if (_channels[i]->isFinished()) {
+			finished[numFinished++] = detachChannel(i);
+		} else if (!_channels[i]->isPaused()) {
+			tmp = _channels[i]->mix(buf, len);
+			publishChannelTiming(i);
+
+			if (tmp > res)
+				res = tmp;
 		}
 
+		_channelsBusy.store(false, std::memory_order_release);
+	}
+
+	if (numFinished) {
+		Common::StackLock lock(_mutex);
+		for (int i = 0; i < numFinished; i++)
+			destroyChannel(finished[i]);
+	}
+
 	return res;
 }
 
 void MixerImpl::stopAll() {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != nullptr && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = nullptr;
-		}
-	}
+	stopChannels(Command::kCommandStopAll, kFreeHandle, -1);
 }
 
 void MixerImpl::stopID(int id) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != nullptr && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = nullptr;
-		}
-	}
+	stopChannels(Command::kCommandStopID, kFreeHandle, id);
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
 	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (!_channelStates[handle._val % NUM_CHANNELS].matches(handle._val))
 		return;
 
-	delete _channels[index];
-	_channels[index] = nullptr;
+	stopChannels(Command::kCommandStopHandle, handle._val, -1);
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
-	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
-	_soundTypeSettings[type].mute = mute;
+	assert(0 <= (int)type && (int)type < NUM_SOUND_TYPES);
+	_soundTypeSettings[type].mute.store(mute, std::memory_order_relaxed);
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	queueCommand(Command::kCommandNotifyGlobalVolume, kFreeHandle, -1, type);
 }
 
 bool MixerImpl::isSoundTypeMuted(SoundType type) const {
-	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
-	return _soundTypeSettings[type].mute;
+	assert(0 <= (int)type && (int)type < NUM_SOUND_TYPES);
+	return _soundTypeSettings[type].mute.load(std::memory_order_relaxed);
 }
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
-	Common::StackLock lock(_mutex);
-
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	ChannelState &state = _channelStates[handle._val % NUM_CHANNELS];
+	if (!state.matches(handle._val))
 		return;
 
-	_channels[index]->setVolume(volume);
+	state.volume.store(volume, std::memory_order_relaxed);
+	queueCommand(Command::kCommandSetVolume, handle._val, -1, volume);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const ChannelState &state = _channelStates[handle._val % NUM_CHANNELS];
+	if (!state.matches(handle._val))
 		return 0;
 
-	return _channels[index]->getVolume();
+	return state.volume.load(std::memory_order_relaxed);
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
-	Common::StackLock lock(_mutex);
-
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	ChannelState &state = _channelStates[handle._val % NUM_CHANNELS];
+	if (!state.matches(handle._val))
 		return;
 
-	_channels[index]->setBalance(balance);
+	state.balance.store(balance, std::memory_order_relaxed);
+	queueCommand(Command::kCommandSetBalance, handle._val, -1, balance);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const ChannelState &state = _channelStates[handle._val % NUM_CHANNELS];
+	if (!state.matches(handle._val))
 		return 0;
 
-	return _channels[index]->getBalance();
+	return state.balance.load(std::memory_order_relaxed);
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -396,97 +773,77 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 }
 
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	const ChannelState &state = _channelStates[handle._val % NUM_CHANNELS];
+	if (!state.matches(handle._val))
+		return Timestamp(0, _sampleRate);
+
+	const ChannelTiming timing = state.getTiming();
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	// The slot may have been reused while we were reading
+	if (!state.matches(handle._val))
 		return Timestamp(0, _sampleRate);
 
-	return _channels[index]->getElapsedTime();
+	return elapsedTime(_sampleRate, timing);
 }
 
 void MixerImpl::loopChannel(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (!_channelStates[handle._val % NUM_CHANNELS].matches(handle._val))
 		return;
 
-	_channels[index]->loop();
+	queueCommand(Command::kCommandLoop, handle._val, -1, 0);
 }
 
 void MixerImpl::pauseAll(bool paused) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != nullptr) {
-			_channels[i]->pause(paused);
-		}
-	}
+	queueCommand(Command::kCommandPauseAll, kFreeHandle, -1, paused);
 }
 
 void MixerImpl::pauseID(int id, bool paused) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != nullptr && _channels[i]->getId() == id) {
-			_channels[i]->pause(paused);
-			return;
-		}
-	}
+	queueCommand(Command::kCommandPauseID, kFreeHandle, id, paused);
 }
 
 void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
-	Common::StackLock lock(_mutex);
-
 	// Simply ignore (un)pause requests for sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (!_channelStates[handle._val % NUM_CHANNELS].matches(handle._val))
 		return;
 
-	_channels[index]->pause(paused);
+	queueCommand(Command::kCommandPauseHandle, handle._val, -1, paused);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
-	Common::StackLock lock(_mutex);
-
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getId() == id)
+		if (_channelStates[i].isActive() && _channelStates[i].id.load(std::memory_order_relaxed) == id)
 			return true;
 	return false;
 }
 
 int MixerImpl::getSoundID(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-	const int index = handle._val % NUM_CHANNELS;
-	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
-		return _channels[index]->getId();
+	const ChannelState &state = _channelStates[handle._val % NUM_CHANNELS];
+	if (state.matches(handle._val))
+		return state.id.load(std::memory_order_relaxed);
 	return 0;
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
-	const int index = handle._val % NUM_CHANNELS;
-	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
+	return _channelStates[handle._val % NUM_CHANNELS].matches(handle._val);
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
-	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getType() == type)
+		if (_channelStates[i].isActive() && _channelStates[i].type.load(std::memory_order_relaxed) == type)
 			return true;
 	return false;
 }
 
 void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
-	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
+	assert(0 <= (int)type && (int)type < NUM_SOUND_TYPES);
 
 	// Check range
 	volume = CLIP<int>(volume, 0, kMaxMixerVolume);
@@ -494,19 +851,16 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	// TODO: Maybe we should do logarithmic (not linear) volume
 	// scaling? See also Player_V2::setMasterVolume
 
-	Common::StackLock lock(_mutex);
-	_soundTypeSettings[type].volume = volume;
+	// Read by the audio thread when it applies the command
+	_soundTypeSettings[type].volume.store(volume, std::memory_order_relaxed);
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	queueCommand(Command::kCommandNotifyGlobalVolume, kFreeHandle, -1, type);
 }
 
 int MixerImpl::getVolumeForSoundType(SoundType type) const {
-	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
+	assert(0 <= (int)type && (int)type < NUM_SOUND_TYPES);
 
-	return _soundTypeSettings[type].volume;
+	return _soundTypeSettings[type].volume.load(std::memory_order_relaxed);
 }
 
 
@@ -594,32 +948,14 @@ void Channel::pause(bool paused) {
 	}
 }
 
-Timestamp Channel::getElapsedTime() {
-	const uint32 rate = _mixer->getOutputRate();
-	uint32 delta = 0;
-
-	Audio::Timestamp ts(0, rate);
-
-	if (_mixerTimeStamp == 0)
-		return ts;
-
-	if (isPaused())
-		delta = _pauseStartTime - _mixerTimeStamp;
-	else
-		delta = g_system->getMillis(true) - _mixerTimeStamp - _pauseTime;
-
-	// Convert the number of samples into a time duration.
-
-	ts = ts.addFrames(_samplesConsumed);
-	ts = ts.addMsecs(delta);
-
-	// In theory it would seem like a good idea to limit the approximation
-	// so that it never exceeds the theoretical upper bound set by
-	// _samplesDecoded. Meanwhile, back in the real world, doing so makes
-	// the Broken Sword cutscenes noticeably jerkier. I guess the mixer
-	// isn't invoked at the regular intervals that I first imagined.
-
-	return ts;
+ChannelTiming Channel::getTiming() const {
+	ChannelTiming timing;
+	timing.samplesConsumed = _samplesConsumed;
+	timing.mixerTimeStamp = _mixerTimeStamp;
+	timing.pauseStartTime = _pauseStartTime;
+	timing.pauseTime = _pauseTime;
+	timing.paused = isPaused();
+	return timing;
 }
 
 void Channel::loop() {
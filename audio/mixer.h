@@ -96,6 +96,10 @@ public:
 
 	/**
 	 * Return the mixer's internal mutex so that audio players can use it.
+	 *
+	 * The mixer does not hold it while mixing: players must take it in
+	 * their streams as well. Do not stop sounds while holding it, as
+	 * stopping waits for the stream being mixed.
 	 */
 	virtual Common::Mutex &mutex() = 0;
 
@@ -22,6 +22,8 @@
 #ifndef AUDIO_MIXER_INTERN_H
 #define AUDIO_MIXER_INTERN_H
 
+#include <atomic>
+
 #include "common/scummsys.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
@@ -58,25 +60,76 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 32
+		NUM_CHANNELS = 32,
+		NUM_SOUND_TYPES = 4,
+		COMMAND_QUEUE_SIZE = 256
+	};
+
+	/**
+	 * A control operation queued by the engine for the audio thread.
+	 */
+	struct Command {
+		enum Type {
+			kCommandInsert,
+			kCommandSetVolume,
+			kCommandSetBalance,
+			kCommandPauseHandle,
+			kCommandPauseID,
+			kCommandPauseAll,
+			kCommandLoop,
+			kCommandNotifyGlobalVolume,
+			kCommandStopHandle,
+			kCommandStopID,
+			kCommandStopAll
+		};
+
+		Type type;
+		uint32 handle;
+		int id;
+		int param;
+		Channel *channel;
 	};
 
+	/** Lock-free view of a channel slot, readable from any thread. */
+	struct ChannelState;
+	/** Single-producer/single-consumer ring of Commands. */
+	struct CommandQueue;
+
+	/**
+	 * Lent to the audio players through mutex(). The audio thread holds it
+	 * while it reads the stream of a channel and while it deletes finished
+	 * channels, which the players sharing it rely on.
+	 */
 	Common::Mutex _mutex;
+	/** Serializes the threads queuing commands; never taken by the audio thread. */
+	Common::Mutex _queueMutex;
 
 	const uint _sampleRate;
 	const uint _outBufSize;
-	bool _mixerReady;
+	std::atomic<bool> _mixerReady;
 	uint32 _handleSeed;
 
+	/**
+	 * Set by the thread applying commands or accessing the channels: the
+	 * audio thread, or a thread whose commands the audio thread did not
+	 * apply in time. Both only hold it for a moment, and the audio thread
+	 * takes _mutex first when mixing, as the other thread does.
+	 */
+	std::atomic<bool> _channelsBusy;
+	/** Number of commands applied so far, for the threads waiting for them. */
+	std::atomic<uint32> _appliedCommands;
+
 	struct SoundTypeSettings {
 		SoundTypeSettings() : mute(false), volume(kMaxMixerVolume) {}
 
-		bool mute;
-		int volume;
+		std::atomic<bool> mute;
+		std::atomic<int> volume;
 	};
 
-	SoundTypeSettings _soundTypeSettings[4];
+	SoundTypeSettings _soundTypeSettings[NUM_SOUND_TYPES];
 	Channel *_channels[NUM_CHANNELS];
+	ChannelState *_channelStates;
+	CommandQueue *_commandQueue;
 
 
 public:
@@ -84,7 +137,7 @@ public:
 	MixerImpl(uint sampleRate, uint outBufSize = 0);
 	~MixerImpl();
 
-	virtual bool isReady() const { Common::StackLock lock(_mutex); return _mixerReady; }
+	virtual bool isReady() const { return _mixerReady.load(std::memory_order_acquire); }
 
 	virtual Common::Mutex &mutex() { return _mutex; }
 
@@ -134,6 +187,58 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+private:
+	/**
+	 * Queue a command for the audio thread, waiting for room if the queue
+	 * is full.
+	 *
+	 * @return the number of commands queued so far, for waitForCommands()
+	 */
+	uint32 queueCommand(Command::Type type, uint32 handle, int id, int param, Channel *channel = nullptr);
+
+	/**
+	 * Wait until the first @p count commands have been applied. If the
+	 * audio thread is not running or does not get to them in time, they are
+	 * applied from the calling thread instead.
+	 */
+	void waitForCommands(uint32 count);
+
+	/**
+	 * Apply the pending commands from the calling thread, unless the audio
+	 * thread is mixing.
+	 *
+	 * @return whether the commands were applied
+	 */
+	bool applyCommands();
+
+	/** Queue a stop command, wait for it and delete the channels it stopped. */
+	void stopChannels(Command::Type type, uint32 handle, int id);
+
+	/** Delete the channels stopped by commands and free their slots. */
+	void destroyRetiredChannels();
+
+	/**
+	 * Apply all pending commands. The channels stopped are moved to their
+	 * slot state, for destroyRetiredChannels(). Must be called with
+	 * _channelsBusy set.
+	 */
+	void processCommands();
+
+	/** Return the channel with the given handle, or nullptr. Must be called with _channelsBusy set. */
+	Channel *findChannel(uint32 handle);
+
+	/** Take the channel out of the given slot. Must be called with _channelsBusy set. */
+	Channel *detachChannel(int index);
+
+	/** Take a stopped channel out of the given slot for destroyRetiredChannels(). Must be called with _channelsBusy set. */
+	void retireChannel(int index);
+
+	/** Delete a detached channel and free its slot for new channels. */
+	void destroyChannel(Channel *chan);
+
+	/** Publish the timing of the channel in the given slot. Must be called with _channelsBusy set. */
+	void publishChannelTiming(int index);
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
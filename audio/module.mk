@@ -20,6 +20,7 @@ MODULE_OBJS := \
 	musicplugin.o \
 	null.o \
 	rate.o \
+	rate_mix.o \
 	timestamp.o \
 	decoders/3do.o \
 	decoders/aac.o \
@@ -95,6 +96,20 @@ MODULE_OBJS += \
 	alsa_opl.o
 endif
 
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	rate_mix_sse2.o
+
+$(MODULE)/rate_mix_sse2.o: CXXFLAGS += -msse2
+endif
+
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	rate_mix_neon.o
+
+$(MODULE)/rate_mix_neon.o: CXXFLAGS += $(NEON_CXXFLAGS)
+endif
+
 ifdef ENABLE_OPL2LPT
 MODULE_OBJS += \
 	opl2lpt.o
@@ -27,9 +27,14 @@
  * improvements over the original code were made.
  */
 
+#include <atomic>
+
 #include "audio/audiostream.h"
 #include "audio/rate.h"
+#include "audio/rate_mix.h"
 #include "audio/mixer.h"
+#include "common/algorithm.h"
+#include "common/config-manager.h"
 #include "common/frac.h"
 #include "common/textconsole.h"
 #include "common/util.h"
@@ -56,6 +61,24 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+/**
+ * Mix a block of converted frames into the output buffer through the
+ * kernel matching the channel layout of the converter.
+ */
+template<bool stereo, bool reverseStereo>
+static inline void mixFrames(const MixProcs &procs, st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	if (!stereo) {
+		if (reverseStereo)
+			procs.mixMono(obuf, ibuf, frames, vol_r, vol_l);
+		else
+			procs.mixMono(obuf, ibuf, frames, vol_l, vol_r);
+	} else if (reverseStereo) {
+		procs.mixStereoReverse(obuf, ibuf, frames, vol_l, vol_r);
+	} else {
+		procs.mixStereo(obuf, ibuf, frames, vol_l, vol_r);
+	}
+}
+
 /**
  * Audio rate converter based on simple resampling. Used when no
  * interpolation is required.
@@ -69,6 +92,11 @@ protected:
 	const st_sample_t *inPtr;
 	int inLen;
 
+	/** converted samples waiting to be mixed into the output */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	const MixProcs &_mix;
+
 	/** position of how far output is ahead of input */
 	/** Holds what would have been opos-ipos */
 	long opos;
@@ -89,7 +117,7 @@ public:
  * Prepare processing.
  */
 template<bool stereo, bool reverseStereo>
-SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate, st_rate_t outrate) {
+SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate, st_rate_t outrate) : _mix(getMixProcs()) {
 	if ((inrate % outrate) != 0) {
 		error("Input rate must be a multiple of output rate to use rate effect");
 	}
@@ -117,38 +145,46 @@ int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
-	while (obuf < oend) {
-
-		// read enough input samples so that opos >= 0
-		do {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			opos--;
-			if (opos >= 0) {
-				inPtr += (stereo ? 2 : 1);
-			}
-		} while (opos >= 0);
-
-		st_sample_t out0, out1;
-		out0 = *inPtr++;
-		out1 = (stereo ? *inPtr++ : out0);
+	bool eos = false;
+	while (!eos && obuf < oend) {
+		const st_size_t frames = MIN<st_size_t>((oend - obuf) / 2, ARRAYSIZE(outBuf) / (stereo ? 2 : 1));
+		st_sample_t *optr = outBuf;
+		st_size_t produced = 0;
+
+		while (produced < frames) {
+			// read enough input samples so that opos >= 0
+			do {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						eos = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				opos--;
+				if (opos >= 0) {
+					inPtr += (stereo ? 2 : 1);
+				}
+			} while (opos >= 0);
+
+			if (eos)
+				break;
+
+			*optr++ = *inPtr++;
+			if (stereo)
+				*optr++ = *inPtr++;
 
-		// Increment output position
-		opos += opos_inc;
-
-		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+			// Increment output position
+			opos += opos_inc;
 
-		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+			produced++;
+		}
 
-		obuf += 2;
+		mixFrames<stereo, reverseStereo>(_mix, obuf, outBuf, produced, vol_l, vol_r);
+		obuf += produced * 2;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -182,6 +218,11 @@ protected:
 	/** current sample(s) in the input stream (left/right channel) */
 	st_sample_t icur0, icur1;
 
+	/** interpolated samples waiting to be mixed into the output */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	const MixProcs &_mix;
+
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) override;
@@ -195,7 +236,7 @@ public:
  * Prepare processing.
  */
 template<bool stereo, bool reverseStereo>
-LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate, st_rate_t outrate) {
+LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate, st_rate_t outrate) : _mix(getMixProcs()) {
 	if (inrate >= 131072 || outrate >= 131072) {
 		error("rate effect can only handle rates < 131072");
 	}
@@ -226,48 +267,296 @@ int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
-	while (obuf < oend) {
-
-		// read enough input samples so that opos < 0
-		while ((frac_t)FRAC_ONE_LOW <= opos) {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
+	bool eos = false;
+	while (!eos && obuf < oend) {
+		const st_size_t frames = MIN<st_size_t>((oend - obuf) / 2, ARRAYSIZE(outBuf) / (stereo ? 2 : 1));
+		st_sample_t *optr = outBuf;
+		st_size_t produced = 0;
+
+		while (produced < frames) {
+			// read enough input samples so that opos < 0
+			while ((frac_t)FRAC_ONE_LOW <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						eos = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				ilast0 = icur0;
+				icur0 = *inPtr++;
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = *inPtr++;
+				}
+				opos -= FRAC_ONE_LOW;
 			}
-			inLen -= (stereo ? 2 : 1);
-			ilast0 = icur0;
-			icur0 = *inPtr++;
-			if (stereo) {
-				ilast1 = icur1;
-				icur1 = *inPtr++;
+
+			if (eos)
+				break;
+
+			// Interpolate as long as the outpos trails behind, and as long
+			// as there is still space in the intermediate buffer.
+			while (opos < (frac_t)FRAC_ONE_LOW && produced < frames) {
+				*optr++ = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+				if (stereo)
+					*optr++ = (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+
+				// Increment output position
+				opos += opos_inc;
+
+				produced++;
 			}
-			opos -= FRAC_ONE_LOW;
 		}
 
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE_LOW && obuf < oend) {
-			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						  out0);
+		// Apply the volume and mix the whole block into the output buffer
+		mixFrames<stereo, reverseStereo>(_mix, obuf, outBuf, produced, vol_l, vol_r);
+		obuf += produced * 2;
+	}
+	return (obuf - ostart) / 2;
+}
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
 
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+#pragma mark -
 
-			obuf += 2;
 
-			// Increment output position
-			opos += opos_inc;
+enum {
+	/** Number of taps per coefficient row when upsampling. */
+	SINC_TAPS = 32,
+	/** Maximum number of taps, which limits downsampling to a factor of 2. */
+	SINC_MAX_TAPS = 64
+};
+
+/**
+ * Zeroth order modified Bessel function of the first kind, used for the
+ * Kaiser window.
+ */
+static double besselI0(double x) {
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32; k++) {
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+		if (term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+/**
+ * Fill a FIR table with a Kaiser windowed sinc low-pass filter.
+ *
+ * Row r holds the filter for an input position r / FIR_ROWS samples
+ * after tap taps / 2 - 1. Each row is normalized to unity DC gain.
+ */
+static void makeSincTable(int16 *table, uint taps, double cutoff) {
+	// Gives about 70 dB of stopband attenuation
+	const double beta = 7.0;
+	const double norm = besselI0(beta);
+	const int center = taps / 2 - 1;
+
+	for (uint row = 0; row < FIR_ROWS; row++) {
+		const double frac = (double)row / FIR_ROWS;
+		double coeffs[SINC_MAX_TAPS];
+		double sum = 0.0;
+
+		for (uint i = 0; i < taps; i++) {
+			const double d = (int)i - center - frac;
+			const double x = d / (taps / 2);
+			const double window = (x > -1.0 && x < 1.0) ? besselI0(beta * sqrt(1.0 - x * x)) / norm : 0.0;
+			const double t = M_PI * cutoff * d;
+			coeffs[i] = cutoff * (d == 0.0 ? 1.0 : sin(t) / t) * window;
+			sum += coeffs[i];
+		}
+
+		int16 *out = table + row * taps;
+		int total = 0;
+		for (uint i = 0; i < taps; i++) {
+			out[i] = (int16)floor(coeffs[i] / sum * (1 << FIR_COEFF_BITS) + 0.5);
+			total += out[i];
+		}
+
+		// Put the rounding error on the tap nearest to the input position
+		out[center + (frac >= 0.5 ? 1 : 0)] += (1 << FIR_COEFF_BITS) - total;
+	}
+}
+
+/**
+ * The table for upsampling only depends on the tap count, so it is shared
+ * by all converters and built once, when the first one is created. It is
+ * never freed, as converters are created and deleted on different threads.
+ */
+static int16 sincUpsampleTable[FIR_ROWS * SINC_TAPS];
+
+enum {
+	kSincTableEmpty,
+	kSincTableBuilding,
+	kSincTableReady
+};
+
+static std::atomic<int> sincUpsampleTableState(kSincTableEmpty);
+
+static const int16 *getSincUpsampleTable() {
+	int state = kSincTableEmpty;
+	if (sincUpsampleTableState.compare_exchange_strong(state, kSincTableBuilding, std::memory_order_acquire)) {
+		makeSincTable(sincUpsampleTable, SINC_TAPS, 0.88);
+		sincUpsampleTableState.store(kSincTableReady, std::memory_order_release);
+	} else {
+		// Another thread is building it, which takes a moment
+		while (sincUpsampleTableState.load(std::memory_order_acquire) != kSincTableReady)
+			;
+	}
+	return sincUpsampleTable;
+}
+
+/**
+ * High quality audio rate converter based on a polyphase, Kaiser windowed
+ * sinc filter.
+ *
+ * Limited to sampling frequency < 131072 Hz and to downsampling by at
+ * most a factor of SINC_MAX_TAPS / SINC_TAPS.
+ */
+template<bool stereo, bool reverseStereo>
+class SincRateConverter : public RateConverter {
+protected:
+	enum {
+		HISTORY_SIZE = INTERMEDIATE_BUFFER_SIZE + SINC_MAX_TAPS
+	};
+
+	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	/** deinterleaved input samples (left/right channel) still needed by the filter */
+	st_sample_t history0[HISTORY_SIZE];
+	st_sample_t history1[HISTORY_SIZE];
+	uint historyLen;
+
+	/** filtered samples waiting to be mixed into the output */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	FirState _fir;
+	int16 *_ownTable;
+
+	const MixProcs &_mix;
+
+	bool refill(AudioStream &input);
+
+public:
+	SincRateConverter(st_rate_t inrate, st_rate_t outrate);
+	~SincRateConverter();
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) override;
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) override {
+		return ST_SUCCESS;
+	}
+};
+
+/*
+ * Prepare processing.
+ */
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::SincRateConverter(st_rate_t inrate, st_rate_t outrate) : _ownTable(nullptr), _mix(getMixProcs()) {
+	if (inrate >= 131072 || outrate >= 131072) {
+		error("rate effect can only handle rates < 131072");
+	}
+
+	const st_rate_t gcd = Common::gcd(inrate, outrate);
+	const st_rate_t step = inrate / gcd;
+
+	_fir.phases = outrate / gcd;
+	_fir.stepInt = step / _fir.phases;
+	_fir.stepFrac = step % _fir.phases;
+	_fir.rowScale = ((uint64)FIR_ROWS << 32) / _fir.phases;
+	_fir.pos = 0;
+	_fir.phase = 0;
+
+	if (inrate <= outrate) {
+		_fir.taps = SINC_TAPS;
+		_fir.coeffs = getSincUpsampleTable();
+	} else {
+		// Widen the filter along with the lower cutoff
+		_fir.taps = MIN<uint>((SINC_TAPS * inrate / outrate + 7) & ~7, SINC_MAX_TAPS);
+		_ownTable = new int16[FIR_ROWS * _fir.taps];
+		makeSincTable(_ownTable, _fir.taps, 0.88 * outrate / inrate);
+		_fir.coeffs = _ownTable;
+	}
+
+	// Center the filter on the first input sample
+	historyLen = _fir.taps / 2 - 1;
+	memset(history0, 0, sizeof(history0));
+	memset(history1, 0, sizeof(history1));
+}
+
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::~SincRateConverter() {
+	delete[] _ownTable;
+}
+
+/*
+ * Discard the input samples the filter is done with and append new ones.
+ * Return false at the end of the input stream.
+ */
+template<bool stereo, bool reverseStereo>
+bool SincRateConverter<stereo, reverseStereo>::refill(AudioStream &input) {
+	historyLen -= _fir.pos;
+	memmove(history0, history0 + _fir.pos, historyLen * sizeof(st_sample_t));
+	if (stereo)
+		memmove(history1, history1 + _fir.pos, historyLen * sizeof(st_sample_t));
+	_fir.pos = 0;
+
+	const int len = input.readBuffer(inBuf, MIN<uint>(ARRAYSIZE(inBuf), (HISTORY_SIZE - historyLen) * (stereo ? 2 : 1)));
+	if (len <= 0)
+		return false;
+
+	const st_sample_t *inPtr = inBuf;
+	for (int i = 0; i < len; i += (stereo ? 2 : 1)) {
+		history0[historyLen] = *inPtr++;
+		if (stereo)
+			history1[historyLen] = *inPtr++;
+		historyLen++;
+	}
+	return true;
+}
+
+/*
+ * Processed signed long samples from ibuf to obuf.
+ * Return number of sample pairs processed.
+ */
+template<bool stereo, bool reverseStereo>
+int SincRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	st_sample_t *ostart, *oend;
+
+	ostart = obuf;
+	oend = obuf + osamp * 2;
+
+	const uint step = _fir.stepInt * _fir.phases + _fir.stepFrac;
+
+	while (obuf < oend) {
+		// Count the output samples whose filter window is complete
+		st_size_t frames = 0;
+		if (historyLen >= _fir.pos + _fir.taps) {
+			const uint avail = (historyLen - _fir.pos - _fir.taps + 1) * _fir.phases - _fir.phase;
+			frames = (avail + step - 1) / step;
 		}
+		frames = MIN<st_size_t>(frames, (oend - obuf) / 2);
+		frames = MIN<st_size_t>(frames, ARRAYSIZE(outBuf) / (stereo ? 2 : 1));
+
+		if (frames == 0) {
+			if (!refill(input))
+				break;
+			continue;
+		}
+
+		_mix.fir(outBuf, (stereo ? 2 : 1), history0, _fir, frames);
+		if (stereo)
+			_mix.fir(outBuf + 1, 2, history1, _fir, frames);
+
+		mixFrames<stereo, reverseStereo>(_mix, obuf, outBuf, frames, vol_l, vol_r);
+		obuf += frames * 2;
+
+		const uint phase = _fir.phase + frames * _fir.stepFrac;
+		_fir.pos += frames * _fir.stepInt + phase / _fir.phases;
+		_fir.phase = phase % _fir.phases;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -283,8 +572,9 @@ template<bool stereo, bool reverseStereo>
 class CopyRateConverter : public RateConverter {
 	st_sample_t *_buffer;
 	st_size_t _bufferSize;
+	const MixProcs &_mix;
 public:
-	CopyRateConverter() : _buffer(nullptr), _bufferSize(0) {}
+	CopyRateConverter() : _buffer(nullptr), _bufferSize(0), _mix(getMixProcs()) {}
 	~CopyRateConverter() {
 		free(_buffer);
 	}
@@ -292,11 +582,8 @@ public:
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) override {
 		assert(input.isStereo() == stereo);
 
-		st_sample_t *ptr;
 		st_size_t len;
 
-		st_sample_t *ostart = obuf;
-
 		if (stereo)
 			osamp *= 2;
 
@@ -314,21 +601,12 @@ public:
 		len = input.readBuffer(_buffer, osamp);
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
+		if ((int)len <= 0)
+			return 0;
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
-		}
-		return (obuf - ostart) / 2;
+		const st_size_t frames = len / (stereo ? 2 : 1);
+		mixFrames<stereo, reverseStereo>(_mix, obuf, _buffer, frames, vol_l, vol_r);
+		return frames;
 	}
 
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) override {
@@ -339,10 +617,23 @@ public:
 
 #pragma mark -
 
+/**
+ * Whether the windowed-sinc converter should be used for the given rates.
+ * It is selected with the "audio_resampler" config key.
+ */
+static bool useSincConverter(st_rate_t inrate, st_rate_t outrate) {
+	if (!ConfMan.hasKey("audio_resampler") || ConfMan.get("audio_resampler") != "sinc")
+		return false;
+
+	return inrate < 131072 && outrate < 131072 && inrate * SINC_TAPS <= outrate * SINC_MAX_TAPS;
+}
+
 template<bool stereo, bool reverseStereo>
 RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
 	if (inrate != outrate) {
-		if ((inrate % outrate) == 0 && (inrate < 65536)) {
+		if (useSincConverter(inrate, outrate)) {
+			return new SincRateConverter<stereo, reverseStereo>(inrate, outrate);
+		} else if ((inrate % outrate) == 0 && (inrate < 65536)) {
 			return new SimpleRateConverter<stereo, reverseStereo>(inrate, outrate);
 		} else {
 			return new LinearRateConverter<stereo, reverseStereo>(inrate, outrate);
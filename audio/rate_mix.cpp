@@ -0,0 +1,75 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audio/rate_mix.h"
+#include "common/system.h"
+
+namespace Audio {
+
+static void firScalar(st_sample_t *obuf, uint ostride, const st_sample_t *ibuf, const FirState &state, st_size_t frames) {
+	uint pos = state.pos;
+	uint phase = state.phase;
+
+	for (; frames > 0; frames--) {
+		const st_sample_t *in = ibuf + pos;
+		const int16 *coeffs = firRow(state, phase);
+
+		int32 acc = 0;
+		for (uint i = 0; i < state.taps; i++)
+			acc += in[i] * coeffs[i];
+
+		*obuf = firResult(acc);
+		obuf += ostride;
+
+		firAdvance(state, pos, phase);
+	}
+}
+
+static const MixProcs scalarMixProcs = {
+	mixScalar<false, false>,
+	mixScalar<true, false>,
+	mixScalar<true, true>,
+	firScalar
+};
+
+const MixProcs &getScalarMixProcs() {
+	return scalarMixProcs;
+}
+
+const MixProcs &getMixProcs() {
+	// The SIMD kernels only implement signed output
+#ifndef OUTPUT_UNSIGNED_AUDIO
+	if (g_system) {
+#ifdef SCUMMVM_NEON
+		if (g_system->hasFeature(OSystem::kFeatureCpuNEON))
+			return getNEONMixProcs();
+#endif
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2))
+			return getSSE2MixProcs();
+#endif
+	}
+#endif
+
+	return scalarMixProcs;
+}
+
+} // End of namespace Audio
@@ -0,0 +1,175 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_RATE_MIX_H
+#define AUDIO_RATE_MIX_H
+
+#include "audio/mixer.h"
+#include "audio/rate.h"
+#include "common/util.h"
+
+namespace Audio {
+
+/**
+ * @defgroup audio_rate_mix Sample mixing kernels
+ * @ingroup audio_rate
+ *
+ * @brief Kernels applying the channel volume and balance to converted
+ * samples and accumulating them into the mixer output buffer.
+ *
+ * All kernels write interleaved stereo output and compute, for every
+ * output sample, exactly what clampedAdd(out, (in * vol) / Mixer::kMaxMixerVolume)
+ * computes. Volumes must not exceed Mixer::kMaxMixerVolume.
+ *
+ * The polyphase FIR filter of the windowed-sinc converter is part of
+ * the same table, so that it uses the same instruction set.
+ * @{
+ */
+
+/**
+ * Mix a block of sample frames into an interleaved stereo buffer.
+ *
+ * @param obuf   Output buffer, holding 2 * frames samples.
+ * @param ibuf   Input buffer, holding frames (mono) or 2 * frames (stereo) samples.
+ * @param frames Number of frames to mix.
+ * @param vol_l  Volume applied to the left (or mono) input channel.
+ * @param vol_r  Volume applied to the right (or mono) input channel.
+ */
+typedef void (*MixProc)(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r);
+
+/**
+ * Plain C++ implementation of MixProc, also used by the SIMD kernels
+ * for the frames that do not fill a whole vector.
+ */
+template<bool stereo, bool reverseStereo>
+static inline void mixScalar(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	for (; frames > 0; frames--) {
+		st_sample_t out0, out1;
+		out0 = *ibuf++;
+		out1 = (stereo ? *ibuf++ : out0);
+
+		// output left channel
+		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+		// output right channel
+		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+
+		obuf += 2;
+	}
+}
+
+enum {
+	/** Number of fractional bits of the FIR coefficients. */
+	FIR_COEFF_BITS = 14,
+	/**
+	 * Number of coefficient rows (i.e. fractional input positions) in a
+	 * FIR table. 640 rows represent 11025, 22050 and 44100 to 48000 Hz
+	 * conversion without rounding the input position.
+	 */
+	FIR_ROWS = 640
+};
+
+/**
+ * State of the polyphase FIR filter used by the windowed-sinc rate
+ * converter. The input position of the next output sample is
+ * pos + phase / phases, relative to the first tap.
+ */
+struct FirState {
+	/** FIR_ROWS rows of taps coefficients each. */
+	const int16 *coeffs;
+	/** Number of taps per row, a multiple of 8. */
+	uint taps;
+	/** Denominator of the fractional input position. */
+	uint phases;
+	/** Input advance per output sample, as stepInt + stepFrac / phases. */
+	uint stepInt, stepFrac;
+	/** Maps a phase to its coefficient row, in 32.32 fixed point. */
+	uint64 rowScale;
+
+	uint pos;
+	uint phase;
+};
+
+static inline const int16 *firRow(const FirState &state, uint phase) {
+	return state.coeffs + (uint)((phase * state.rowScale) >> 32) * state.taps;
+}
+
+static inline void firAdvance(const FirState &state, uint &pos, uint &phase) {
+	pos += state.stepInt;
+	phase += state.stepFrac;
+	if (phase >= state.phases) {
+		phase -= state.phases;
+		pos++;
+	}
+}
+
+static inline st_sample_t firResult(int32 acc) {
+	acc = (acc + (1 << (FIR_COEFF_BITS - 1))) >> FIR_COEFF_BITS;
+	return (st_sample_t)CLIP<int32>(acc, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+}
+
+/**
+ * Run the FIR filter over one channel of deinterleaved input.
+ *
+ * The FirState is not modified, so the same state can be used for
+ * every channel; the caller advances it afterwards.
+ *
+ * @param obuf    Output buffer, advanced by ostride after each sample.
+ * @param ostride Distance between two output samples.
+ * @param ibuf    Input samples of one channel.
+ * @param state   Filter state.
+ * @param frames  Number of output samples to produce.
+ */
+typedef void (*FirProc)(st_sample_t *obuf, uint ostride, const st_sample_t *ibuf, const FirState &state, st_size_t frames);
+
+struct MixProcs {
+	/** Mono input, duplicated into both output channels. */
+	MixProc mixMono;
+	/** Stereo input. */
+	MixProc mixStereo;
+	/** Stereo input, with the left input going to the right output and vice versa. */
+	MixProc mixStereoReverse;
+	/** Polyphase FIR filter of the windowed-sinc converter. */
+	FirProc fir;
+};
+
+/**
+ * Return the plain C++ mixing kernels.
+ */
+const MixProcs &getScalarMixProcs();
+
+/**
+ * Return the fastest mixing kernels supported by the host CPU.
+ */
+const MixProcs &getMixProcs();
+
+#ifdef SCUMMVM_SSE2
+const MixProcs &getSSE2MixProcs();
+#endif
+
+#ifdef SCUMMVM_NEON
+const MixProcs &getNEONMixProcs();
+#endif
+
+/** @} */
+} // End of namespace Audio
+
+#endif
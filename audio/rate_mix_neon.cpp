@@ -0,0 +1,130 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <arm_neon.h>
+
+#include "audio/rate_mix.h"
+
+namespace Audio {
+
+/**
+ * Compute (in * vol) / Mixer::kMaxMixerVolume for four samples, rounding
+ * towards zero exactly like the integer division in mixScalar.
+ */
+static inline int16x4_t scaleSamples(int16x4_t in, int16x4_t vol) {
+	int32x4_t prod = vmull_s16(in, vol);
+
+	// Negative products need a bias so the arithmetic shift truncates
+	const uint32x4_t bias = vandq_u32(vreinterpretq_u32_s32(vshrq_n_s32(prod, 31)), vdupq_n_u32(Mixer::kMaxMixerVolume - 1));
+	prod = vaddq_s32(prod, vreinterpretq_s32_u32(bias));
+
+	// Mixer::kMaxMixerVolume is 256
+	return vmovn_s32(vshrq_n_s32(prod, 8));
+}
+
+static inline void mixVector(st_sample_t *obuf, int16x8_t in, int16x8_t vol) {
+	const int16x8_t scaled = vcombine_s16(scaleSamples(vget_low_s16(in), vget_low_s16(vol)),
+	                                      scaleSamples(vget_high_s16(in), vget_high_s16(vol)));
+	vst1q_s16(obuf, vqaddq_s16(vld1q_s16(obuf), scaled));
+}
+
+static inline int16x8_t makeVolume(st_volume_t vol0, st_volume_t vol1) {
+	const int16_t vol[8] = { (int16_t)vol0, (int16_t)vol1, (int16_t)vol0, (int16_t)vol1,
+	                         (int16_t)vol0, (int16_t)vol1, (int16_t)vol0, (int16_t)vol1 };
+	return vld1q_s16(vol);
+}
+
+static void mixMonoNEON(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	const int16x8_t vol = makeVolume(vol_l, vol_r);
+
+	for (; frames >= 8; frames -= 8) {
+		const int16x8_t in = vld1q_s16(ibuf);
+		const int16x8x2_t dup = vzipq_s16(in, in);
+		mixVector(obuf, dup.val[0], vol);
+		mixVector(obuf + 8, dup.val[1], vol);
+		ibuf += 8;
+		obuf += 16;
+	}
+
+	mixScalar<false, false>(obuf, ibuf, frames, vol_l, vol_r);
+}
+
+static void mixStereoNEON(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	const int16x8_t vol = makeVolume(vol_l, vol_r);
+
+	for (; frames >= 4; frames -= 4) {
+		mixVector(obuf, vld1q_s16(ibuf), vol);
+		ibuf += 8;
+		obuf += 8;
+	}
+
+	mixScalar<true, false>(obuf, ibuf, frames, vol_l, vol_r);
+}
+
+static void mixStereoReverseNEON(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	// After swapping, the right input channel comes first
+	const int16x8_t vol = makeVolume(vol_r, vol_l);
+
+	for (; frames >= 4; frames -= 4) {
+		mixVector(obuf, vrev32q_s16(vld1q_s16(ibuf)), vol);
+		ibuf += 8;
+		obuf += 8;
+	}
+
+	mixScalar<true, true>(obuf, ibuf, frames, vol_l, vol_r);
+}
+
+static void firNEON(st_sample_t *obuf, uint ostride, const st_sample_t *ibuf, const FirState &state, st_size_t frames) {
+	uint pos = state.pos;
+	uint phase = state.phase;
+
+	for (; frames > 0; frames--) {
+		const st_sample_t *in = ibuf + pos;
+		const int16 *coeffs = firRow(state, phase);
+
+		int32x4_t acc = vdupq_n_s32(0);
+		for (uint i = 0; i < state.taps; i += 8) {
+			const int16x8_t samples = vld1q_s16(in + i);
+			const int16x8_t taps = vld1q_s16(coeffs + i);
+			acc = vmlal_s16(acc, vget_low_s16(samples), vget_low_s16(taps));
+			acc = vmlal_s16(acc, vget_high_s16(samples), vget_high_s16(taps));
+		}
+		const int32x2_t sum = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+
+		*obuf = firResult(vget_lane_s32(vpadd_s32(sum, sum), 0));
+		obuf += ostride;
+
+		firAdvance(state, pos, phase);
+	}
+}
+
+static const MixProcs neonMixProcs = {
+	mixMonoNEON,
+	mixStereoNEON,
+	mixStereoReverseNEON,
+	firNEON
+};
+
+const MixProcs &getNEONMixProcs() {
+	return neonMixProcs;
+}
+
+} // End of namespace Audio
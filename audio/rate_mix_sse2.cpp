@@ -0,0 +1,131 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <emmintrin.h>
+
+#include "audio/rate_mix.h"
+
+namespace Audio {
+
+/**
+ * Compute (in * vol) / Mixer::kMaxMixerVolume for eight samples, rounding
+ * towards zero exactly like the integer division in mixScalar.
+ */
+static inline __m128i scaleSamples(__m128i in, __m128i vol) {
+	const __m128i bias = _mm_set1_epi32(Mixer::kMaxMixerVolume - 1);
+	const __m128i prodLo = _mm_mullo_epi16(in, vol);
+	const __m128i prodHi = _mm_mulhi_epi16(in, vol);
+
+	__m128i lo = _mm_unpacklo_epi16(prodLo, prodHi);
+	__m128i hi = _mm_unpackhi_epi16(prodLo, prodHi);
+
+	// Negative products need a bias so the arithmetic shift truncates
+	lo = _mm_add_epi32(lo, _mm_and_si128(_mm_srai_epi32(lo, 31), bias));
+	hi = _mm_add_epi32(hi, _mm_and_si128(_mm_srai_epi32(hi, 31), bias));
+
+	// Mixer::kMaxMixerVolume is 256
+	return _mm_packs_epi32(_mm_srai_epi32(lo, 8), _mm_srai_epi32(hi, 8));
+}
+
+static inline void mixVector(st_sample_t *obuf, __m128i in, __m128i vol) {
+	__m128i out = _mm_loadu_si128((const __m128i *)obuf);
+	out = _mm_adds_epi16(out, scaleSamples(in, vol));
+	_mm_storeu_si128((__m128i *)obuf, out);
+}
+
+static void mixMonoSSE2(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	const __m128i vol = _mm_setr_epi16(vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r);
+
+	for (; frames >= 8; frames -= 8) {
+		const __m128i in = _mm_loadu_si128((const __m128i *)ibuf);
+		mixVector(obuf, _mm_unpacklo_epi16(in, in), vol);
+		mixVector(obuf + 8, _mm_unpackhi_epi16(in, in), vol);
+		ibuf += 8;
+		obuf += 16;
+	}
+
+	mixScalar<false, false>(obuf, ibuf, frames, vol_l, vol_r);
+}
+
+static void mixStereoSSE2(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	const __m128i vol = _mm_setr_epi16(vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r);
+
+	for (; frames >= 4; frames -= 4) {
+		mixVector(obuf, _mm_loadu_si128((const __m128i *)ibuf), vol);
+		ibuf += 8;
+		obuf += 8;
+	}
+
+	mixScalar<true, false>(obuf, ibuf, frames, vol_l, vol_r);
+}
+
+static void mixStereoReverseSSE2(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	// After swapping, the right input channel comes first
+	const __m128i vol = _mm_setr_epi16(vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l);
+
+	for (; frames >= 4; frames -= 4) {
+		__m128i in = _mm_loadu_si128((const __m128i *)ibuf);
+		in = _mm_shufflelo_epi16(in, _MM_SHUFFLE(2, 3, 0, 1));
+		in = _mm_shufflehi_epi16(in, _MM_SHUFFLE(2, 3, 0, 1));
+		mixVector(obuf, in, vol);
+		ibuf += 8;
+		obuf += 8;
+	}
+
+	mixScalar<true, true>(obuf, ibuf, frames, vol_l, vol_r);
+}
+
+static void firSSE2(st_sample_t *obuf, uint ostride, const st_sample_t *ibuf, const FirState &state, st_size_t frames) {
+	uint pos = state.pos;
+	uint phase = state.phase;
+
+	for (; frames > 0; frames--) {
+		const st_sample_t *in = ibuf + pos;
+		const int16 *coeffs = firRow(state, phase);
+
+		__m128i acc = _mm_setzero_si128();
+		for (uint i = 0; i < state.taps; i += 8) {
+			const __m128i samples = _mm_loadu_si128((const __m128i *)(in + i));
+			const __m128i taps = _mm_loadu_si128((const __m128i *)(coeffs + i));
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(samples, taps));
+		}
+		acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+		acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+
+		*obuf = firResult(_mm_cvtsi128_si32(acc));
+		obuf += ostride;
+
+		firAdvance(state, pos, phase);
+	}
+}
+
+static const MixProcs sse2MixProcs = {
+	mixMonoSSE2,
+	mixStereoSSE2,
+	mixStereoReverseSSE2,
+	firSSE2
+};
+
+const MixProcs &getSSE2MixProcs() {
+	return sse2MixProcs;
+}
+
+} // End of namespace Audio
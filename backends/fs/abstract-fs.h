@@ -172,6 +172,21 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Retrieves the size and the time of the last modification of the file
+	 * referred by this node, without opening it.
+	 *
+	 * @note By default, this method returns false, i.e. the information is
+	 * not available.
+	 *
+	 * @param size              Size of the file in bytes.
+	 * @param modificationTime  Time of the last modification, in seconds since
+	 *                          an arbitrary, backend specific epoch.
+	 *
+	 * @return bool true if the information was retrieved, false otherwise.
+	 */
+	virtual bool getFileInfo(int64 &size, int64 &modificationTime) const { return false; }
+
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
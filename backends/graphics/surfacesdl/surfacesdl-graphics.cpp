@@ -39,6 +39,7 @@
 #include "graphics/fontman.h"
 #include "graphics/scaler.h"
 #include "graphics/scaler/aspect.h"
+#include "graphics/scaler/threadpool.h"
 #include "graphics/surface.h"
 #include "gui/debugger.h"
 #include "gui/EventRecorder.h"
@@ -62,6 +63,12 @@
 #define SDL_FULLSCREEN  0x40000000
 #endif
 
+enum {
+	kMaxScalerThreads = 16,
+	// Fewer rows are not worth waking up a thread for
+	kMinScalerBandHeight = 16
+};
+
 static OSystem::GraphicsMode s_supportedGraphicsModes[] = {
 	{"surfacesdl", _s("SDL Surface"), GFX_SURFACESDL},
 	{nullptr, nullptr, 0}
@@ -135,7 +142,7 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	_enableFocusRectDebugCode(false), _enableFocusRect(false), _focusRect(),
 #endif
 	_transactionMode(kTransactionNone),
-	_scalerPlugins(ScalerMan.getPlugins()), _scalerPlugin(nullptr), _scaler(nullptr),
+	_scalerPlugins(ScalerMan.getPlugins()), _scalerPlugin(nullptr), _scaler(nullptr), _scalerThreads(nullptr),
 	_needRestoreAfterOverlay(false) {
 
 	// allocate palette storage
@@ -159,6 +166,17 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	_scaler = nullptr;
 	_maxExtraPixels = ScalerMan.getMaxExtraPixels();
 
+	if (ConfMan.hasKey("scaler_threads")) {
+		const int numThreads = CLIP<int>(ConfMan.getInt("scaler_threads"), 0, kMaxScalerThreads);
+		if (numThreads > 0) {
+			_scalerThreads = new ScalerThreadPool(numThreads);
+			if (!_scalerThreads->getNumThreads()) {
+				delete _scalerThreads;
+				_scalerThreads = nullptr;
+			}
+		}
+	}
+
 	_videoMode.fullscreen = ConfMan.getBool("fullscreen");
 	_videoMode.filtering = ConfMan.getBool("filtering");
 #if SDL_VERSION_ATLEAST(2, 0, 0)
@@ -171,6 +189,7 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 
 SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
 	unloadGFXMode();
+	delete _scalerThreads;
 	delete _scaler;
 	if (_mouseOrigSurface) {
 		SDL_FreeSurface(_mouseOrigSurface);
@@ -1232,8 +1251,14 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 				if (_videoMode.aspectRatioCorrection && !_overlayVisible)
 					dst_y = real2Aspect(dst_y);
 
-				_scaler->scale((byte *)srcSurf->pixels + (r->x + _maxExtraPixels) * 2 + (r->y + _maxExtraPixels) * srcPitch, srcPitch,
-					(byte *)_hwScreen->pixels + dst_x * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h, r->x, r->y);
+				const byte *srcPtr = (byte *)srcSurf->pixels + (r->x + _maxExtraPixels) * 2 + (r->y + _maxExtraPixels) * srcPitch;
+				byte *dstPtr = (byte *)_hwScreen->pixels + dst_x * 2 + dst_y * dstPitch;
+
+				// The scalers using the old source keep state between the rows
+				if (_scalerThreads && !_useOldSrc)
+					_scalerThreads->scale(_scaler, srcPtr, srcPitch, dstPtr, dstPitch, r->w, dst_h, r->x, r->y, kMinScalerBandHeight);
+				else
+					_scaler->scale(srcPtr, srcPitch, dstPtr, dstPitch, r->w, dst_h, r->x, r->y);
 			}
 
 			r->x = dst_x;
@@ -34,6 +34,8 @@
 
 #include "backends/platform/sdl/sdl-sys.h"
 
+class ScalerThreadPool;
+
 #ifndef RELEASE_BUILD
 // Define this to allow for focus rectangle debugging
 #define USE_SDL_DEBUG_FOCUSRECT
@@ -327,6 +329,8 @@ protected:
 	const PluginList &_scalerPlugins;
 	ScalerPluginObject *_scalerPlugin;
 	Scaler *_scaler;
+	/** Threads sharing the scaling of large rectangles, if enabled. */
+	ScalerThreadPool *_scalerThreads;
 	uint _maxExtraPixels;
 	uint _extraPixels;
 
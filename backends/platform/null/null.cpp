@@ -49,14 +49,19 @@ typedef void (*sighandler_t)(int);
 #if defined(USE_NULL_DRIVER)
 #include "backends/modular-backend.h"
 #include "backends/mutex/null/null-mutex.h"
+#if defined(POSIX) && defined(NULL_DRIVER_USE_FOR_TEST)
+#include "backends/mutex/pthread/pthread-mutex.h"
+#include "backends/thread/pthread/pthread-thread.h"
+#endif
 #include "base/main.h"
 
+#include "backends/graphics/null/null-graphics.h"
+
 #ifndef NULL_DRIVER_USE_FOR_TEST
 #include "backends/saves/default/default-saves.h"
 #include "backends/timer/default/default-timer.h"
 #include "backends/events/default/default-events.h"
 #include "backends/mixer/null/null-mixer.h"
-#include "backends/graphics/null/null-graphics.h"
 #include "gui/debugger.h"
 #endif
 
@@ -82,9 +87,16 @@ public:
 
 	virtual void initBackend();
 
+	virtual bool hasFeature(Feature f);
+
 	virtual bool pollEvent(Common::Event &event);
 
 	virtual Common::MutexInternal *createMutex();
+#if defined(POSIX) && defined(NULL_DRIVER_USE_FOR_TEST)
+	virtual Common::ThreadInternal *createThread(void (*proc)(void *param), void *param);
+	virtual Common::SemaphoreInternal *createSemaphore(uint value);
+	virtual uint getCPUCount();
+#endif
 	virtual uint32 getMillis(bool skipRecord = false);
 	virtual void delayMillis(uint msecs);
 	virtual void getTimeAndDate(TimeDate &td, bool skipRecord = false) const;
@@ -117,6 +129,13 @@ OSystem_NULL::OSystem_NULL() {
 	#else
 		#error Unknown and unsupported FS backend
 	#endif
+
+#ifdef NULL_DRIVER_USE_FOR_TEST
+	// The tests use no other manager, but code like the video decoders
+	// asks for the screen format
+	_graphicsManager = new NullGraphicsManager();
+	_graphicsManager->initSize(320, 200);
+#endif
 }
 
 OSystem_NULL::~OSystem_NULL() {
@@ -157,6 +176,27 @@ void OSystem_NULL::initBackend() {
 	BaseBackend::initBackend();
 }
 
+bool OSystem_NULL::hasFeature(Feature f) {
+#if defined(SCUMMVM_SSE2) && defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	if (f == kFeatureCpuSSE2)
+		return __builtin_cpu_supports("sse2");
+#endif
+#if defined(SCUMMVM_AVX2) && defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	if (f == kFeatureCpuAVX2)
+		return __builtin_cpu_supports("avx2");
+#endif
+#if defined(SCUMMVM_NEON) && defined(__aarch64__)
+	if (f == kFeatureCpuNEON)
+		return true;
+#endif
+
+	// Before initBackend(), there are no managers yet
+	if (!_graphicsManager)
+		return false;
+
+	return ModularGraphicsBackend::hasFeature(f);
+}
+
 bool OSystem_NULL::pollEvent(Common::Event &event) {
 #ifndef NULL_DRIVER_USE_FOR_TEST
 	((DefaultTimerManager *)getTimerManager())->checkTimers();
@@ -185,9 +225,29 @@ bool OSystem_NULL::pollEvent(Common::Event &event) {
 }
 
 Common::MutexInternal *OSystem_NULL::createMutex() {
+#if defined(POSIX) && defined(NULL_DRIVER_USE_FOR_TEST)
+	return createPthreadMutexInternal();
+#else
 	return new NullMutexInternal();
+#endif
 }
 
+// The unit tests use threads to cover code which only runs in parallel
+// on other backends
+#if defined(POSIX) && defined(NULL_DRIVER_USE_FOR_TEST)
+Common::ThreadInternal *OSystem_NULL::createThread(void (*proc)(void *param), void *param) {
+	return createPthreadThreadInternal(proc, param);
+}
+
+Common::SemaphoreInternal *OSystem_NULL::createSemaphore(uint value) {
+	return createPthreadSemaphoreInternal(value);
+}
+
+uint OSystem_NULL::getCPUCount() {
+	return getPthreadCPUCount();
+}
+#endif
+
 uint32 OSystem_NULL::getMillis(bool skipRecord) {
 #ifdef POSIX
 	timeval curTime;
@@ -41,6 +41,9 @@
 #include "common/fs.h"
 #include "common/archive.h"
 #include "common/config-manager.h"
+#include "common/endian.h"
+#include "common/memstream.h"
+#include "common/ptr.h"
 #include "common/zlib.h"
 
 #include <errno.h>	// for removeSavefile()
@@ -49,6 +52,15 @@
 const char *DefaultSaveFileManager::TIMESTAMPS_FILENAME = "timestamps";
 #endif
 
+#define SAVE_INDEX_SUFFIX ".saveindex"
+
+enum {
+	kSaveIndexTag = MKTAG('S', 'V', 'I', 'X'),
+	kSaveIndexVersion = 1,
+	// Tag, version and table size
+	kSaveIndexHeaderSize = 12
+};
+
 DefaultSaveFileManager::DefaultSaveFileManager() {
 }
 
@@ -89,7 +101,7 @@ Common::StringArray DefaultSaveFileManager::listSavefiles(const Common::String &
 
 	Common::StringArray results;
 	for (SaveFileCache::const_iterator file = _saveFileCache.begin(), end = _saveFileCache.end(); file != end; ++file) {
-		if (!locked.contains(file->_key) && file->_key.matchString(pattern, true)) {
+		if (!locked.contains(file->_key) && file->_key.matchString(pattern, true) && !file->_key.hasSuffixIgnoreCase(SAVE_INDEX_SUFFIX)) {
 			results.push_back(file->_key);
 		}
 	}
@@ -147,6 +159,8 @@ Common::OutSaveFile *DefaultSaveFileManager::openForSaving(const Common::String
 		}
 	}
 
+	dropIndexEntries(filename);
+
 #if defined(USE_CLOUD) && defined(USE_LIBCURL)
 	// Update file's timestamp
 	Common::HashMap<Common::String, uint32> timestamps = loadTimestamps();
@@ -203,6 +217,7 @@ bool DefaultSaveFileManager::removeSavefile(const Common::String &filename) {
 		// Remove from cache, this invalidates the 'file' iterator.
 		_saveFileCache.erase(file);
 		file = _saveFileCache.end();
+		dropIndexEntries(filename);
 
 		Common::ErrorCode result = removeFile(fileNode.getPath());
 		if (result == Common::kNoError)
@@ -298,6 +313,226 @@ void DefaultSaveFileManager::assureCached(const Common::String &savePathName) {
 	// Only now store that we cached 'savePathName' to indicate we successfully
 	// cached the directory.
 	_cachedDirectory = savePathName;
+
+	// The directory is also cached again while the cloud syncs, which keeps
+	// the indexes: the entries of the synced files are not valid anymore.
+	if (_indexDirectory != savePathName) {
+		_indexes.clear();
+		_indexDirectory = savePathName;
+	}
+}
+
+DefaultSaveFileManager::SaveIndex &DefaultSaveFileManager::getIndex(const Common::String &index) {
+	SaveIndexMap::iterator loaded = _indexes.find(index);
+	if (loaded != _indexes.end())
+		return loaded->_value;
+
+	SaveIndex &saveIndex = _indexes[index];
+	saveIndex.dirty = false;
+
+	SaveFileCache::const_iterator file = _saveFileCache.find(index + SAVE_INDEX_SUFFIX);
+	if (file == _saveFileCache.end())
+		return saveIndex;
+
+	Common::ScopedPtr<Common::SeekableReadStream> in(file->_value.createReadStream());
+	if (!in)
+		return saveIndex;
+
+	const uint32 tag = in->readUint32BE();
+	const uint32 version = in->readUint32BE();
+	const uint32 tableSize = in->readUint32LE();
+	if (in->err() || in->eos() || tag != kSaveIndexTag || version != kSaveIndexVersion)
+		return saveIndex;
+
+	// The entries are read at once, the attachments are left in the file
+	Common::ScopedPtr<Common::SeekableReadStream> table(in->readStream(tableSize));
+	if (!table || table->size() != tableSize)
+		return saveIndex;
+
+	const uint32 count = table->readUint32LE();
+	for (uint32 i = 0; i < count; i++) {
+		const Common::String filename = table->readPascalString(false);
+
+		SaveIndexEntry entry;
+		entry.fileSize = table->readSint64LE();
+		entry.fileTime = table->readSint64LE();
+		entry.record.resize(table->readUint32LE());
+		if (!entry.record.empty())
+			table->read(&entry.record[0], entry.record.size());
+		entry.attachmentPos = table->readUint32LE();
+		entry.attachmentSize = table->readUint32LE();
+
+		if (table->err() || table->eos()) {
+			warning("DefaultSaveFileManager: Ignoring truncated save index '%s'", file->_key.c_str());
+			saveIndex.entries.clear();
+			break;
+		}
+		saveIndex.entries[filename] = entry;
+	}
+
+	return saveIndex;
+}
+
+void DefaultSaveFileManager::dropIndexEntries(const Common::String &filename) {
+	for (SaveIndexMap::iterator i = _indexes.begin(); i != _indexes.end(); ++i) {
+		SaveIndexEntryMap::iterator entry = i->_value.entries.find(filename);
+		if (entry != i->_value.entries.end()) {
+			i->_value.entries.erase(entry);
+			i->_value.dirty = true;
+		}
+	}
+}
+
+Common::SeekableReadStream *DefaultSaveFileManager::readIndexEntry(const Common::String &index, const Common::String &filename, bool attachment) {
+	// Assure the savefile name cache is up-to-date.
+	assureCached(getSavePath());
+	if (getError().getCode() != Common::kNoError)
+		return nullptr;
+
+	SaveFileCache::const_iterator file = _saveFileCache.find(filename);
+	if (file == _saveFileCache.end())
+		return nullptr;
+
+	SaveIndex &saveIndex = getIndex(index);
+	SaveIndexEntryMap::iterator entry = saveIndex.entries.find(filename);
+	if (entry == saveIndex.entries.end())
+		return nullptr;
+
+	// The file may have been changed by other means, e.g. by the cloud sync
+	int64 fileSize, fileTime;
+	if (!file->_value.getFileInfo(fileSize, fileTime) || fileSize != entry->_value.fileSize || fileTime != entry->_value.fileTime) {
+		saveIndex.entries.erase(entry);
+		saveIndex.dirty = true;
+		return nullptr;
+	}
+
+	const Common::Array<byte> *data = attachment ? &entry->_value.attachment : &entry->_value.record;
+	if (!attachment || entry->_value.attachmentPos < 0 || !entry->_value.attachmentSize) {
+		byte *copy = (byte *)malloc(data->size());
+		if (!data->empty())
+			memcpy(copy, &(*data)[0], data->size());
+		return new Common::MemoryReadStream(copy, data->size(), DisposeAfterUse::YES);
+	}
+
+	SaveFileCache::const_iterator indexFile = _saveFileCache.find(index + SAVE_INDEX_SUFFIX);
+	if (indexFile == _saveFileCache.end())
+		return nullptr;
+
+	Common::ScopedPtr<Common::SeekableReadStream> in(indexFile->_value.createReadStream());
+	if (!in || !in->seek(entry->_value.attachmentPos))
+		return nullptr;
+	return in->readStream(entry->_value.attachmentSize);
+}
+
+void DefaultSaveFileManager::writeIndexEntry(const Common::String &index, const Common::String &filename, const byte *record, uint32 recordSize, const byte *attachment, uint32 attachmentSize) {
+	// Assure the savefile name cache is up-to-date.
+	assureCached(getSavePath());
+	if (getError().getCode() != Common::kNoError)
+		return;
+
+	// The names are stored with a length byte
+	SaveFileCache::const_iterator file = _saveFileCache.find(filename);
+	int64 fileSize, fileTime;
+	if (filename.size() > 255 || file == _saveFileCache.end() || !file->_value.getFileInfo(fileSize, fileTime))
+		return;
+
+	SaveIndex &saveIndex = getIndex(index);
+	SaveIndexEntry &entry = saveIndex.entries[filename];
+	entry.fileSize = fileSize;
+	entry.fileTime = fileTime;
+	entry.record = Common::Array<byte>(record, recordSize);
+	entry.attachment = Common::Array<byte>(attachment, attachmentSize);
+	entry.attachmentPos = -1;
+	entry.attachmentSize = attachmentSize;
+	saveIndex.dirty = true;
+}
+
+void DefaultSaveFileManager::flushIndex(const Common::String &index) {
+	SaveIndexMap::iterator loaded = _indexes.find(index);
+	if (loaded == _indexes.end() || !loaded->_value.dirty)
+		return;
+
+	SaveIndex &saveIndex = loaded->_value;
+	const Common::String indexFilename = index + SAVE_INDEX_SUFFIX;
+
+	// The attachments still in the index file are read before it is
+	// written again. The entries whose attachment cannot be read are dropped.
+	SaveFileCache::const_iterator file = _saveFileCache.find(indexFilename);
+	Common::ScopedPtr<Common::SeekableReadStream> in(file != _saveFileCache.end() ? file->_value.createReadStream() : nullptr);
+	Common::StringArray unreadable;
+	uint32 tableSize = 4;
+	for (SaveIndexEntryMap::iterator i = saveIndex.entries.begin(); i != saveIndex.entries.end(); ++i) {
+		SaveIndexEntry &entry = i->_value;
+		if (entry.attachmentPos >= 0) {
+			entry.attachment.resize(entry.attachmentSize);
+			if (!in || !in->seek(entry.attachmentPos) ||
+			    (entry.attachmentSize && in->read(&entry.attachment[0], entry.attachmentSize) != entry.attachmentSize)) {
+				unreadable.push_back(i->_key);
+				continue;
+			}
+		}
+		tableSize += 1 + i->_key.size() + 8 + 8 + 4 + entry.record.size() + 4 + 4;
+	}
+	in.reset();
+	for (uint i = 0; i < unreadable.size(); i++)
+		saveIndex.entries.erase(unreadable[i]);
+
+	const Common::FSNode indexNode = Common::FSNode(getSavePath()).getChild(indexFilename);
+	Common::ScopedPtr<Common::SeekableWriteStream> out(indexNode.createWriteStream());
+	if (!out) {
+		warning("DefaultSaveFileManager: Cannot write save index '%s'", indexFilename.c_str());
+		return;
+	}
+
+	out->writeUint32BE(kSaveIndexTag);
+	out->writeUint32BE(kSaveIndexVersion);
+	out->writeUint32LE(tableSize);
+
+	out->writeUint32LE(saveIndex.entries.size());
+	uint32 attachmentPos = kSaveIndexHeaderSize + tableSize;
+	for (SaveIndexEntryMap::iterator i = saveIndex.entries.begin(); i != saveIndex.entries.end(); ++i) {
+		const SaveIndexEntry &entry = i->_value;
+		out->writeByte(i->_key.size());
+		out->writeString(i->_key);
+		out->writeSint64LE(entry.fileSize);
+		out->writeSint64LE(entry.fileTime);
+		out->writeUint32LE(entry.record.size());
+		if (!entry.record.empty())
+			out->write(&entry.record[0], entry.record.size());
+		out->writeUint32LE(attachmentPos);
+		out->writeUint32LE(entry.attachmentSize);
+		attachmentPos += entry.attachmentSize;
+	}
+
+	// Same order as the table, as the hash map was not changed since
+	for (SaveIndexEntryMap::iterator i = saveIndex.entries.begin(); i != saveIndex.entries.end(); ++i) {
+		if (!i->_value.attachment.empty())
+			out->write(&i->_value.attachment[0], i->_value.attachment.size());
+	}
+
+	if (!out->flush() || out->err()) {
+		warning("DefaultSaveFileManager: Failed to write save index '%s'", indexFilename.c_str());
+		out.reset();
+		removeFile(indexNode.getPath());
+		_saveFileCache.erase(indexFilename);
+		// The attachments were all read, so the entries stay valid
+		for (SaveIndexEntryMap::iterator i = saveIndex.entries.begin(); i != saveIndex.entries.end(); ++i)
+			i->_value.attachmentPos = -1;
+		return;
+	}
+	out->finalize();
+	out.reset();
+
+	// The attachments are read from the file again from now on
+	attachmentPos = kSaveIndexHeaderSize + tableSize;
+	for (SaveIndexEntryMap::iterator i = saveIndex.entries.begin(); i != saveIndex.entries.end(); ++i) {
+		i->_value.attachment.clear();
+		i->_value.attachmentPos = attachmentPos;
+		attachmentPos += i->_value.attachmentSize;
+	}
+
+	_saveFileCache[indexFilename] = Common::FSNode(indexNode.getPath());
+	saveIndex.dirty = false;
 }
 
 #if defined(USE_CLOUD) && defined(USE_LIBCURL)
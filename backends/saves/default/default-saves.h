@@ -23,6 +23,7 @@
 #define BACKEND_SAVES_DEFAULT_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
 #include "common/savefile.h"
 #include "common/str.h"
 #include "common/fs.h"
@@ -45,6 +46,10 @@ public:
 	bool removeSavefile(const Common::String &filename) override;
 	bool exists(const Common::String &filename) override;
 
+	Common::SeekableReadStream *readIndexEntry(const Common::String &index, const Common::String &filename, bool attachment = false) override;
+	void writeIndexEntry(const Common::String &index, const Common::String &filename, const byte *record, uint32 recordSize, const byte *attachment, uint32 attachmentSize) override;
+	void flushIndex(const Common::String &index) override;
+
 #ifdef USE_LIBCURL
 
 	static const uint32 INVALID_TIMESTAMP = UINT_MAX;
@@ -100,11 +105,54 @@ protected:
 	 */
 	Common::StringArray _lockedFiles;
 
+	struct SaveIndexEntry {
+		/** Size and modification time of the save file when the entry was written. */
+		int64 fileSize;
+		int64 fileTime;
+		Common::Array<byte> record;
+		/** The attachment, unless it is still only in the index file. */
+		Common::Array<byte> attachment;
+		/** Position of the attachment in the index file, or -1 if it is not written yet. */
+		int64 attachmentPos;
+		uint32 attachmentSize;
+	};
+
+	typedef Common::HashMap<Common::String, SaveIndexEntry, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> SaveIndexEntryMap;
+
+	struct SaveIndex {
+		SaveIndexEntryMap entries;
+		/** Whether the entries differ from the index file. */
+		bool dirty;
+	};
+
+	typedef Common::HashMap<Common::String, SaveIndex, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> SaveIndexMap;
+
+	/**
+	 * Get an index of the cached directory, loading it the first time.
+	 * Only the entries are loaded, the attachments are read when requested.
+	 */
+	SaveIndex &getIndex(const Common::String &index);
+
+	/**
+	 * Drop the index entries of a save file, which is saved again or removed.
+	 */
+	void dropIndexEntries(const Common::String &filename);
+
+	/**
+	 * Indexes loaded from the cached directory, by name.
+	 */
+	SaveIndexMap _indexes;
+
 private:
 	/**
 	 * The currently cached directory.
 	 */
 	Common::String _cachedDirectory;
+
+	/**
+	 * The directory _indexes were loaded from.
+	 */
+	Common::String _indexDirectory;
 };
 
 #endif
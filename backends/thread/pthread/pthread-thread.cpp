@@ -0,0 +1,145 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_unistd_h
+
+#include "common/scummsys.h"
+
+#if defined(POSIX)
+
+#include "backends/thread/pthread/pthread-thread.h"
+#include "common/textconsole.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+struct PthreadStartInfo {
+	Common::ThreadProc proc;
+	void *param;
+};
+
+static void *pthreadStart(void *arg) {
+	PthreadStartInfo info = *(PthreadStartInfo *)arg;
+	delete (PthreadStartInfo *)arg;
+
+	info.proc(info.param);
+	return nullptr;
+}
+
+/**
+ * pthreads thread implementation
+ */
+class PthreadThreadInternal final : public Common::ThreadInternal {
+public:
+	PthreadThreadInternal(pthread_t thread) : _thread(thread), _joined(false) {}
+	~PthreadThreadInternal() override { join(); }
+
+	void join() override;
+
+private:
+	pthread_t _thread;
+	bool _joined;
+};
+
+void PthreadThreadInternal::join() {
+	if (_joined)
+		return;
+
+	if (pthread_join(_thread, nullptr) != 0)
+		warning("pthread_join() failed");
+	_joined = true;
+}
+
+/**
+ * pthreads semaphore implementation, based on a condition variable as
+ * unnamed POSIX semaphores are not available everywhere
+ */
+class PthreadSemaphoreInternal final : public Common::SemaphoreInternal {
+public:
+	PthreadSemaphoreInternal(uint value);
+	~PthreadSemaphoreInternal() override;
+
+	void wait() override;
+	void post() override;
+
+private:
+	pthread_mutex_t _mutex;
+	pthread_cond_t _cond;
+	uint _value;
+};
+
+PthreadSemaphoreInternal::PthreadSemaphoreInternal(uint value) : _value(value) {
+	if (pthread_mutex_init(&_mutex, nullptr) != 0)
+		warning("pthread_mutex_init() failed");
+	if (pthread_cond_init(&_cond, nullptr) != 0)
+		warning("pthread_cond_init() failed");
+}
+
+PthreadSemaphoreInternal::~PthreadSemaphoreInternal() {
+	pthread_cond_destroy(&_cond);
+	pthread_mutex_destroy(&_mutex);
+}
+
+void PthreadSemaphoreInternal::wait() {
+	pthread_mutex_lock(&_mutex);
+	while (!_value)
+		pthread_cond_wait(&_cond, &_mutex);
+	_value--;
+	pthread_mutex_unlock(&_mutex);
+}
+
+void PthreadSemaphoreInternal::post() {
+	pthread_mutex_lock(&_mutex);
+	_value++;
+	pthread_cond_signal(&_cond);
+	pthread_mutex_unlock(&_mutex);
+}
+
+Common::ThreadInternal *createPthreadThreadInternal(Common::ThreadProc proc, void *param) {
+	PthreadStartInfo *info = new PthreadStartInfo;
+	info->proc = proc;
+	info->param = param;
+
+	pthread_t thread;
+	if (pthread_create(&thread, nullptr, pthreadStart, info) != 0) {
+		warning("pthread_create() failed");
+		delete info;
+		return nullptr;
+	}
+
+	return new PthreadThreadInternal(thread);
+}
+
+Common::SemaphoreInternal *createPthreadSemaphoreInternal(uint value) {
+	return new PthreadSemaphoreInternal(value);
+}
+
+uint getPthreadCPUCount() {
+#ifdef _SC_NPROCESSORS_ONLN
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	if (count > 0)
+		return (uint)count;
+#endif
+	return 1;
+}
+
+#endif
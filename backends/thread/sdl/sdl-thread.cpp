@@ -0,0 +1,115 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/thread/sdl/sdl-thread.h"
+#include "backends/platform/sdl/sdl-sys.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+struct SdlStartInfo {
+	Common::ThreadProc proc;
+	void *param;
+};
+
+static int SDLCALL sdlThreadStart(void *arg) {
+	SdlStartInfo info = *(SdlStartInfo *)arg;
+	delete (SdlStartInfo *)arg;
+
+	info.proc(info.param);
+	return 0;
+}
+
+/**
+ * SDL thread implementation
+ */
+class SdlThreadInternal final : public Common::ThreadInternal {
+public:
+	SdlThreadInternal(SDL_Thread *thread) : _thread(thread) {}
+	~SdlThreadInternal() override { join(); }
+
+	void join() override {
+		if (_thread) {
+			SDL_WaitThread(_thread, nullptr);
+			_thread = nullptr;
+		}
+	}
+
+private:
+	SDL_Thread *_thread;
+};
+
+/**
+ * SDL semaphore implementation
+ */
+class SdlSemaphoreInternal final : public Common::SemaphoreInternal {
+public:
+	SdlSemaphoreInternal(SDL_sem *semaphore) : _semaphore(semaphore) {}
+	~SdlSemaphoreInternal() override { SDL_DestroySemaphore(_semaphore); }
+
+	void wait() override { SDL_SemWait(_semaphore); }
+	void post() override { SDL_SemPost(_semaphore); }
+
+private:
+	SDL_sem *_semaphore;
+};
+
+Common::ThreadInternal *createSdlThreadInternal(Common::ThreadProc proc, void *param) {
+	SdlStartInfo *info = new SdlStartInfo;
+	info->proc = proc;
+	info->param = param;
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	SDL_Thread *thread = SDL_CreateThread(sdlThreadStart, "ScummVM worker", info);
+#else
+	SDL_Thread *thread = SDL_CreateThread(sdlThreadStart, info);
+#endif
+	if (!thread) {
+		warning("SDL_CreateThread() failed: %s", SDL_GetError());
+		delete info;
+		return nullptr;
+	}
+
+	return new SdlThreadInternal(thread);
+}
+
+Common::SemaphoreInternal *createSdlSemaphoreInternal(uint value) {
+	SDL_sem *semaphore = SDL_CreateSemaphore(value);
+	if (!semaphore) {
+		warning("SDL_CreateSemaphore() failed: %s", SDL_GetError());
+		return nullptr;
+	}
+
+	return new SdlSemaphoreInternal(semaphore);
+}
+
+uint getSdlCPUCount() {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	return MAX(SDL_GetCPUCount(), 1);
+#else
+	return 1;
+#endif
+}
+
+#endif
@@ -53,6 +53,7 @@
 #include "common/text-to-speech.h"
 #include "common/osd_message_queue.h"
 
+#include "gui/bitmapcache.h"
 #include "gui/gui-manager.h"
 #include "gui/error.h"
 
@@ -484,6 +485,7 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 		if (res.getCode() != Common::kNoError)
 			warning("%s", res.getDesc().c_str());
 
+		MD5Man.savePersistent(true);
 		PluginManager::instance().unloadDetectionPlugin();
 		PluginManager::instance().unloadAllPlugins();
 		PluginManager::destroy();
@@ -716,10 +718,13 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	Cloud::CloudManager::destroy();
 #endif
 #endif
+	MD5Man.savePersistent(true);
 	PluginManager::instance().unloadDetectionPlugin();
 	PluginManager::instance().unloadAllPlugins();
 	PluginManager::destroy();
 	GUI::GuiManager::destroy();
+	// Writes the order of use of the cached images
+	GUI::BitmapCache::destroy();
 	Common::ConfigManager::destroy();
 	Common::DebugManager::destroy();
 	Common::OSDMessageQueue::destroy();
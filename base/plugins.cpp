@@ -744,6 +744,8 @@ DetectionResults EngineManager::detectGames(const Common::FSList &fslist) {
 		}
 	}
 
+	MD5Man.savePersistent(false);
+
 	return DetectionResults(candidates);
 }
 
@@ -34,6 +34,7 @@ bool gDebugChannelsOnly = false;
 const DebugChannelDef gDebugChannels[] = {
 	{ kDebugLevelEventRec,   "eventrec",  "Event recorder debug level" },
 	{ kDebugGlobalDetection, "detection", "debug messages for advancedDetector" },
+	{ kDebugGlobalFonts,     "fonts",     "debug messages for the TTF glyph cache" },
 	DEBUG_CHANNEL_END
 };
 namespace Common {
@@ -161,6 +161,7 @@ extern bool gDebugChannelsOnly;
 
 /** Global constant for EventRecorder debug channel. */
 enum GlobalDebugLevels {
+	kDebugGlobalFonts = 1 << 28,
 	kDebugGlobalDetection = 1 << 29,
 	kDebugLevelEventRec = 1 << 30
 };
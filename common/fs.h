@@ -223,6 +223,20 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Retrieve the size and the time of the last modification of the file
+	 * referred by this node, without opening it. Not all backends support
+	 * this.
+	 *
+	 * @param size              Size of the file in bytes.
+	 * @param modificationTime  Time of the last modification. It is only
+	 *                          meant to be compared with other values
+	 *                          returned by this method.
+	 *
+	 * @return True if the information was retrieved, false otherwise.
+	 */
+	bool getFileInfo(int64 &size, int64 &modificationTime) const;
+
 	/**
 	 * Create a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -276,6 +276,42 @@ public:
 	 * @return true if the file exists. false otherwise.
 	 */
 	virtual bool exists(const String &name) = 0;
+
+	/**
+	 * Read an entry of a save file index.
+	 *
+	 * An index keeps data about save files, e.g. the metadata of all the saves
+	 * of a target, so that they can be listed without opening every file. An
+	 * entry is dropped when its save file is saved again or removed, and it is
+	 * not valid anymore once the save file was changed by other means.
+	 *
+	 * The default implementation does not keep indexes.
+	 *
+	 * @param index       Name of the index.
+	 * @param name        Name of the save file.
+	 * @param attachment  Whether to read the attachment of the entry instead of its record.
+	 *
+	 * @return The data, or nullptr if there is no valid entry for the save file.
+	 */
+	virtual SeekableReadStream *readIndexEntry(const String &index, const String &name, bool attachment = false) { return nullptr; }
+
+	/**
+	 * Write an entry of a save file index, replacing any previous entry of
+	 * the save file. The index is only written to disk by flushIndex().
+	 *
+	 * @param index           Name of the index.
+	 * @param name            Name of the save file, which must exist.
+	 * @param record          Data read whenever the index is loaded.
+	 * @param attachment      Larger data, e.g. a thumbnail, only read when requested.
+	 */
+	virtual void writeIndexEntry(const String &index, const String &name, const byte *record, uint32 recordSize, const byte *attachment, uint32 attachmentSize) {}
+
+	/**
+	 * Write an index to disk if it was changed.
+	 *
+	 * @param index  Name of the index.
+	 */
+	virtual void flushIndex(const String &index) {}
 };
 
 /** @} */
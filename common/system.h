@@ -49,6 +49,7 @@ class MutexInternal;
 struct Rect;
 class SaveFileManager;
 class SearchSet;
+class SemaphoreInternal;
 class String;
 #if defined(USE_TASKBAR)
 class TaskbarManager;
@@ -57,6 +58,7 @@ class TaskbarManager;
 class UpdateManager;
 #endif
 class TextToSpeechManager;
+class ThreadInternal;
 #if defined(USE_SYSDIALOGS)
 class DialogManager;
 #endif
@@ -497,7 +499,32 @@ public:
 		/**
 		* For platforms that should not have a Quit button.
 		*/
-		kFeatureNoQuit
+		kFeatureNoQuit,
+
+		/**
+		* The CPU supports the SSE2 instruction set (x86/x86_64).
+		*
+		* Code paths built with SCUMMVM_SSE2 may only be used when this
+		* feature is reported.
+		*/
+		kFeatureCpuSSE2,
+
+		/**
+		* The CPU and the operating system support the AVX2 instruction
+		* set (x86/x86_64).
+		*
+		* Code paths built with SCUMMVM_AVX2 may only be used when this
+		* feature is reported.
+		*/
+		kFeatureCpuAVX2,
+
+		/**
+		* The CPU supports the NEON instruction set (ARM/AArch64).
+		*
+		* NEON is optional before ARMv8, so code paths built with
+		* SCUMMVM_NEON may only be used when this feature is reported.
+		*/
+		kFeatureCpuNEON
 	};
 
 	/**
@@ -1451,6 +1478,42 @@ public:
 
 	/** @} */
 
+	/**
+	 * @defgroup common_system_thread Thread handling
+	 * @ingroup common_system
+	 * @{
+	 *
+	 * Backends may optionally allow running work on additional threads,
+	 * e.g. to hide I/O latency or to use multiple CPU cores. Callers must
+	 * always cope with these methods failing and do the work themselves.
+	 * Use Common::Thread and Common::Semaphore instead of calling these
+	 * methods directly.
+	 */
+
+	/**
+	 * Start a new thread running proc(param).
+	 *
+	 * @return The newly created thread, or nullptr if the backend does not
+	 *         support threads or an error occurred.
+	 */
+	virtual Common::ThreadInternal *createThread(void (*proc)(void *param), void *param) { return nullptr; }
+
+	/**
+	 * Create a new semaphore with the given initial value.
+	 *
+	 * @return The newly created semaphore, or nullptr if the backend does
+	 *         not support threads or an error occurred.
+	 */
+	virtual Common::SemaphoreInternal *createSemaphore(uint value) { return nullptr; }
+
+	/**
+	 * Return the number of CPU cores available, as a hint for the number
+	 * of threads worth starting for CPU bound work.
+	 */
+	virtual uint getCPUCount() { return 1; }
+
+	/** @} */
+
 
 
 	/** @defgroup common_system_sound Sound
@@ -0,0 +1,75 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/thread.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+namespace Common {
+
+Thread::Thread(ThreadProc proc, void *param) {
+	assert(g_system);
+	_thread = g_system->createThread(proc, param);
+}
+
+Thread::~Thread() {
+	join();
+}
+
+void Thread::join() {
+	if (_thread) {
+		_thread->join();
+		delete _thread;
+		_thread = nullptr;
+	}
+}
+
+
+#pragma mark -
+
+
+Semaphore::Semaphore(uint value) : _count(value) {
+	assert(g_system);
+	_semaphore = g_system->createSemaphore(value);
+}
+
+Semaphore::~Semaphore() {
+	delete _semaphore;
+}
+
+void Semaphore::wait() {
+	if (_semaphore) {
+		_semaphore->wait();
+	} else {
+		if (!_count)
+			error("Semaphore::wait() would block forever without threads");
+		_count--;
+	}
+}
+
+void Semaphore::post() {
+	if (_semaphore)
+		_semaphore->post();
+	else
+		_count++;
+}
+
+} // End of namespace Common
@@ -0,0 +1,118 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_THREAD_H
+#define COMMON_THREAD_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_thread Threads
+ * @ingroup common
+ *
+ * @brief API for running work on additional threads.
+ *
+ * Threads are optional: backends which do not implement
+ * OSystem::createThread() cannot start any, so every user of this API
+ * must be able to do its work on the calling thread instead.
+ *
+ * Most of the code base is not thread safe. Code running on a thread
+ * must only use objects it owns or which are protected by a Mutex. In
+ * particular, copies of reference counted objects such as String, FSNode
+ * or SharedPtr must not be shared between threads.
+ * @{
+ */
+
+/** Function run by a thread. */
+typedef void (*ThreadProc)(void *param);
+
+class ThreadInternal {
+public:
+	/** Wait for the thread to finish, if join() was not called before. */
+	virtual ~ThreadInternal() {}
+
+	/** Wait for the thread to finish. */
+	virtual void join() = 0;
+};
+
+class SemaphoreInternal {
+public:
+	virtual ~SemaphoreInternal() {}
+
+	virtual void wait() = 0;
+	virtual void post() = 0;
+};
+
+/**
+ * Wrapper class around the OSystem thread functions.
+ */
+class Thread : NonCopyable {
+	ThreadInternal *_thread;
+
+public:
+	/**
+	 * Start running proc(param) on a new thread. If the backend cannot
+	 * create threads, proc is not called and isRunning() returns false.
+	 */
+	Thread(ThreadProc proc, void *param);
+
+	/** Wait for the thread to finish. */
+	~Thread();
+
+	/**
+	 * Return whether the thread was started and join() was not
+	 * called yet.
+	 */
+	bool isRunning() const { return _thread != nullptr; }
+
+	/** Wait for the thread to finish. */
+	void join();
+};
+
+/**
+ * Wrapper class around the OSystem semaphore functions.
+ *
+ * Without backend support, this is a plain counter: waiting for it
+ * while it is zero is an error, as no other thread could increment it.
+ */
+class Semaphore : NonCopyable {
+	SemaphoreInternal *_semaphore;
+	uint _count;
+
+public:
+	explicit Semaphore(uint value = 0);
+	~Semaphore();
+
+	/** Wait until the value is positive, then decrement it. */
+	void wait();
+
+	/** Increment the value, waking up one waiting thread. */
+	void post();
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
@@ -105,6 +105,9 @@ typedef struct {
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/substream.h"
+#include "common/zlib.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -381,6 +384,7 @@ typedef Common::HashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_H
 */
 typedef struct {
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::SharedPtr<Common::SeekableReadStream> _sharedStream;	/* owns _stream, shared with the member streams */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -543,6 +547,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 	int err=UNZ_OK;
 
 	us->_stream = stream;
+	us->_sharedStream = Common::SharedPtr<Common::SeekableReadStream>(stream);
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos==0)
@@ -594,7 +599,6 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		err=UNZ_BADZIPFILE;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
 		delete us;
 		return nullptr;
 	}
@@ -643,7 +647,6 @@ int unzClose(unzFile file) {
 	if (s->pfile_in_zip_read != nullptr)
 		unzCloseCurrentFile(file);
 
-	delete s->_stream;
 	delete s;
 	return UNZ_OK;
 }
@@ -1033,6 +1036,32 @@ static int unzlocal_CheckCurrentFileCoherencyHeader(unz_s* s, uInt* piSizeVar,
 	return err;
 }
 
+/*
+  Get the position of the data of the current file in the zipfile stream,
+  after checking its local header.
+  If there is no error, the return value is UNZ_OK.
+*/
+static int unzlocal_GetCurrentFileDataOffset(unzFile file, uLong *poffset) {
+	uInt iSizeVar;
+	uLong offset_local_extrafield;
+	uInt  size_local_extrafield;
+	unz_s* s;
+
+	if (file==nullptr)
+		return UNZ_PARAMERROR;
+	s=(unz_s*)file;
+	if (!s->current_file_ok)
+		return UNZ_PARAMERROR;
+
+	if (unzlocal_CheckCurrentFileCoherencyHeader(s,&iSizeVar,
+				&offset_local_extrafield,&size_local_extrafield)!=UNZ_OK)
+		return UNZ_BADZIPFILE;
+
+	*poffset = s->byte_before_the_zipfile +
+		s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER + iSizeVar;
+	return UNZ_OK;
+}
+
 /*
   Open for reading data the current file in the zipfile.
   If there is no error and the file is opened, the return value is UNZ_OK.
@@ -1418,6 +1447,69 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 
 namespace Common {
 
+/**
+ * Reads from the archive file, keeping it open for as long as the stream
+ * exists.
+ */
+class ZipFileReadStream : public SeekableReadStream {
+	SharedPtr<SeekableReadStream> _parent;
+
+public:
+	ZipFileReadStream(const SharedPtr<SeekableReadStream> &parent) : _parent(parent) {}
+
+	bool eos() const override { return _parent->eos(); }
+	bool err() const override { return _parent->err(); }
+	void clearErr() override { _parent->clearErr(); }
+	uint32 read(void *dataPtr, uint32 dataSize) override { return _parent->read(dataPtr, dataSize); }
+
+	int64 pos() const override { return _parent->pos(); }
+	int64 size() const override { return _parent->size(); }
+	bool seek(int64 offset, int whence = SEEK_SET) override { return _parent->seek(offset, whence); }
+};
+
+/**
+ * Keeps the CRC-32 of the data of a member read so far, as
+ * unzReadCurrentFile() does, and reports a mismatch through err() once the
+ * member has been read to its end. Seeking forwards skips the check.
+ */
+class ZipCheckedReadStream : public SeekableReadStream {
+	ScopedPtr<SeekableReadStream> _parent;
+	const int64 _size;
+	const uLong _expectedCrc;
+	uLong _crc;
+	int64 _crcPos;
+	bool _crcError;
+
+public:
+	ZipCheckedReadStream(SeekableReadStream *parent, uint32 size, uLong crc)
+		: _parent(parent), _size(size), _expectedCrc(crc), _crc(0), _crcPos(0), _crcError(false) {}
+
+	bool eos() const override { return _parent->eos(); }
+	bool err() const override { return _crcError || _parent->err(); }
+	void clearErr() override { _crcError = false; _parent->clearErr(); }
+
+	uint32 read(void *dataPtr, uint32 dataSize) override {
+		const int64 start = _parent->pos();
+		const uint32 len = _parent->read(dataPtr, dataSize);
+#ifdef USE_ZLIB
+		// Only verify the data when zlib is linked in, because otherwise
+		// crc32() is not defined. Data read again after seeking backwards
+		// has been checked already.
+		if (start <= _crcPos && start + len > _crcPos) {
+			const uint32 skip = _crcPos - start;
+			_crc = crc32(_crc, (const Bytef *)dataPtr + skip, len - skip);
+			_crcPos = start + len;
+			if (_crcPos == _size && _crc != _expectedCrc)
+				_crcError = true;
+		}
+#endif
+		return len;
+	}
+
+	int64 pos() const override { return _parent->pos(); }
+	int64 size() const override { return _size; }
+	bool seek(int64 offset, int whence = SEEK_SET) override { return _parent->seek(offset, whence); }
+};
 
 class ZipArchive : public Archive {
 	unzFile _zipFile;
@@ -1492,31 +1584,37 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const Path &path) cons
 		return nullptr;
 
 	unz_file_info fileInfo;
-	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
-		return nullptr;
-
 	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK)
 		return nullptr;
 
-	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
-	assert(buffer);
-
-	if (unzReadCurrentFile(_zipFile, buffer, fileInfo.uncompressed_size) != (int)fileInfo.uncompressed_size) {
-		free(buffer);
+	uLong offset;
+	if (unzlocal_GetCurrentFileDataOffset(_zipFile, &offset) != UNZ_OK)
 		return nullptr;
-	}
 
-	if (unzCloseCurrentFile(_zipFile) != UNZ_OK) {
-		free(buffer);
+	// Members are read straight from the archive file. Each of them gets
+	// its own reference to it, so they stay valid after the archive is
+	// closed, and re-seeks it before reading, so several members can be
+	// used at the same time.
+	const unz_s *const archive = (const unz_s *)_zipFile;
+	SeekableReadStream *file = new ZipFileReadStream(archive->_sharedStream);
+
+	SeekableReadStream *member;
+	switch (fileInfo.compression_method) {
+	case 0:
+		member = new SafeSeekableSubReadStream(file, offset, offset + fileInfo.uncompressed_size, DisposeAfterUse::YES);
+		break;
+	case Z_DEFLATED:
+		member = wrapDeflateReadStream(new SafeSeekableSubReadStream(file, offset, offset + fileInfo.compressed_size, DisposeAfterUse::YES),
+		                               fileInfo.uncompressed_size);
+		break;
+	default:
+		delete file;
 		return nullptr;
 	}
 
-	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
-
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
+	if (!member)
+		return nullptr;
+	return new ZipCheckedReadStream(member, fileInfo.uncompressed_size, fileInfo.crc);
 }
 
 Archive *makeZipArchive(const String &name) {
@@ -23,6 +23,7 @@
 #define FORBIDDEN_SYMBOL_ALLOW_ALL
 
 #include "common/zlib.h"
+#include "common/array.h"
 #include "common/ptr.h"
 #include "common/util.h"
 #include "common/stream.h"
@@ -217,19 +218,24 @@ bool inflateZlibHeaderless(Common::WriteStream *dst, Common::SeekableReadStream
 	return (status == Z_OK);
 }
 
-#ifndef RELEASE_BUILD
-static bool _shownBackwardSeekingWarning = false;
-#endif
-
 /**
  * A simple wrapper class which can be used to wrap around an arbitrary
  * other SeekableReadStream and will then provide on-the-fly decompression support.
- * Assumes the compressed data to be in gzip format.
+ * Assumes the compressed data to be in gzip or zlib format, or to be raw
+ * deflate data.
+ *
+ * Every CHECKPOINT_SPAN bytes of output, a copy of the inflate state is
+ * kept the first time decompression gets there. Seeking then only has to
+ * decompress from the closest checkpoint before the target, instead of
+ * from the start of the data.
  */
 class GZipReadStream : public SeekableReadStream {
 protected:
 	enum {
-		BUFSIZE = 16384		// 1 << MAX_WBITS
+		BUFSIZE = 16384,		// 1 << MAX_WBITS
+		// Each checkpoint holds the whole inflate window (about 40 KB with
+		// the state), so they are kept far apart
+		CHECKPOINT_SPAN = 1 << 20
 	};
 
 	byte	_buf[BUFSIZE];
@@ -241,36 +247,80 @@ protected:
 	uint32 _origSize;
 	bool _eos;
 
+	/**
+	 * Copies of the inflate state, taken at multiples of CHECKPOINT_SPAN
+	 * (starting with CHECKPOINT_SPAN itself).
+	 */
+	Array<z_stream *> _checkpoints;
+
+	void addCheckpoint() {
+		z_stream *checkpoint = new z_stream();
+		if (inflateCopy(checkpoint, &_stream) != Z_OK) {
+			delete checkpoint;
+			return;
+		}
+		_checkpoints.push_back(checkpoint);
+	}
+
+	/**
+	 * Continue decompression from the given checkpoint, or from the start
+	 * of the data if checkpoint is -1.
+	 */
+	bool restart(int checkpoint) {
+		if (checkpoint < 0) {
+			_zlibErr = inflateReset(&_stream);
+		} else {
+			inflateEnd(&_stream);
+			_zlibErr = inflateCopy(&_stream, _checkpoints[checkpoint]);
+		}
+
+		// total_in includes the input bits zlib already holds
+		_pos = _stream.total_out;
+		_wrapped->seek(_stream.total_in, SEEK_SET);
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+		return _zlibErr == Z_OK;
+	}
+
 public:
 
-	GZipReadStream(SeekableReadStream *w, uint32 knownSize = 0) : _wrapped(w), _stream() {
+	GZipReadStream(SeekableReadStream *w, uint32 knownSize = 0, bool raw = false) : _wrapped(w), _stream() {
 		assert(w != nullptr);
 
-		// Verify file header is correct
-		w->seek(0, SEEK_SET);
-		uint16 header = w->readUint16BE();
-		assert(header == 0x1F8B ||
-		       ((header & 0x0F00) == 0x0800 && header % 31 == 0));
-
-		if (header == 0x1F8B) {
-			// Retrieve the original file size
-			w->seek(-4, SEEK_END);
-			_origSize = w->readUint32LE();
-		} else {
-			// Original size not available in zlib format
-			// use an otherwise known size if supplied.
+		if (raw) {
 			_origSize = knownSize;
+		} else {
+			// Verify file header is correct
+			w->seek(0, SEEK_SET);
+			uint16 header = w->readUint16BE();
+			assert(header == 0x1F8B ||
+			       ((header & 0x0F00) == 0x0800 && header % 31 == 0));
+
+			if (header == 0x1F8B) {
+				// Retrieve the original file size
+				w->seek(-4, SEEK_END);
+				_origSize = w->readUint32LE();
+			} else {
+				// Original size not available in zlib format
+				// use an otherwise known size if supplied.
+				_origSize = knownSize;
+			}
 		}
 		_pos = 0;
 		w->seek(0, SEEK_SET);
 		_eos = false;
 
-		// Adding 32 to windowBits indicates to zlib that it is supposed to
-		// automatically detect whether gzip or zlib headers are used for
-		// the compressed file. This feature was added in zlib 1.2.0.4,
-		// released 10 August 2003.
-		// Note: This is *crucial* for savegame compatibility, do *not* remove!
-		_zlibErr = inflateInit2(&_stream, MAX_WBITS + 32);
+		if (raw) {
+			// Negative MAX_WBITS tells zlib there's no zlib header
+			_zlibErr = inflateInit2(&_stream, -MAX_WBITS);
+		} else {
+			// Adding 32 to windowBits indicates to zlib that it is supposed to
+			// automatically detect whether gzip or zlib headers are used for
+			// the compressed file. This feature was added in zlib 1.2.0.4,
+			// released 10 August 2003.
+			// Note: This is *crucial* for savegame compatibility, do *not* remove!
+			_zlibErr = inflateInit2(&_stream, MAX_WBITS + 32);
+		}
 		if (_zlibErr != Z_OK)
 			return;
 
@@ -280,6 +330,10 @@ public:
 	}
 
 	~GZipReadStream() {
+		for (uint i = 0; i < _checkpoints.size(); ++i) {
+			inflateEnd(_checkpoints[i]);
+			delete _checkpoints[i];
+		}
 		inflateEnd(&_stream);
 	}
 
@@ -290,26 +344,41 @@ public:
 	}
 
 	uint32 read(void *dataPtr, uint32 dataSize) override {
-		_stream.next_out = (byte *)dataPtr;
-		_stream.avail_out = dataSize;
-
-		// Keep going while we get no error
-		while (_zlibErr == Z_OK && _stream.avail_out) {
-			if (_stream.avail_in == 0 && !_wrapped->eos()) {
-				// If we are out of input data: Read more data, if available.
-				_stream.next_in = _buf;
-				_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
+		byte *out = (byte *)dataPtr;
+		uint32 done = 0;
+
+		while (_zlibErr == Z_OK && done < dataSize) {
+			// Stop at the next checkpoint if it was not taken yet
+			const uint32 nextCheckpoint = (_checkpoints.size() + 1) * CHECKPOINT_SPAN;
+			uint32 chunk = dataSize - done;
+			if (_pos < nextCheckpoint)
+				chunk = MIN(chunk, nextCheckpoint - _pos);
+
+			_stream.next_out = out + done;
+			_stream.avail_out = chunk;
+
+			// Keep going while we get no error
+			while (_zlibErr == Z_OK && _stream.avail_out) {
+				if (_stream.avail_in == 0 && !_wrapped->eos()) {
+					// If we are out of input data: Read more data, if available.
+					_stream.next_in = _buf;
+					_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
+				}
+				_zlibErr = inflate(&_stream, Z_NO_FLUSH);
 			}
-			_zlibErr = inflate(&_stream, Z_NO_FLUSH);
-		}
 
-		// Update the position counter
-		_pos += dataSize - _stream.avail_out;
+			// Update the position counter
+			done += chunk - _stream.avail_out;
+			_pos += chunk - _stream.avail_out;
 
-		if (_zlibErr == Z_STREAM_END && _stream.avail_out > 0)
+			if (_pos == nextCheckpoint && _zlibErr == Z_OK)
+				addCheckpoint();
+		}
+
+		if (_zlibErr == Z_STREAM_END && done < dataSize)
 			_eos = true;
 
-		return dataSize - _stream.avail_out;
+		return done;
 	}
 
 	bool eos() const override {
@@ -322,7 +391,7 @@ public:
 		return _origSize;
 	}
 	bool seek(int64 offset, int whence = SEEK_SET) override {
-		int32 newPos = 0;
+		int64 newPos = 0;
 		switch (whence) {
 		default:
 			// fallthrough intended
@@ -333,49 +402,35 @@ public:
 			newPos = _pos + offset;
 			break;
 		case SEEK_END:
-			// NOTE: This can be an expensive operation (see below).
+			// NOTE: This can be an expensive operation, unless the end of
+			// the data was already decompressed once.
 			newPos = size() + offset;
 			break;
 		}
 
-		assert(newPos >= 0);
-
-		if ((uint32)newPos < _pos) {
-			// To search backward, we have to restart the whole decompression
-			// from the start of the file. A rather wasteful operation, best
-			// to avoid it. :/
-
-#ifndef RELEASE_BUILD
-			if (!_shownBackwardSeekingWarning) {
-				// We only throw this warning once per stream, to avoid
-				// getting the console swarmed with warnings when consecutive
-				// seeks are made.
-				debug(1, "Backward seeking in GZipReadStream detected");
-				_shownBackwardSeekingWarning = true;
-			}
-#endif
+		if (newPos < 0 || newPos > 0xFFFFFFFF)
+			return false;
 
-			_pos = 0;
-			_wrapped->seek(0, SEEK_SET);
-			_zlibErr = inflateReset(&_stream);
-			if (_zlibErr != Z_OK)
-				return false; // FIXME: STREAM REWRITE
-			_stream.next_in = _buf;
-			_stream.avail_in = 0;
+		// Continue from the closest checkpoint before the new position,
+		// unless decompressing from the current position is shorter
+		const int checkpoint = MIN<int64>(newPos / CHECKPOINT_SPAN, _checkpoints.size()) - 1;
+		const uint32 checkpointPos = (checkpoint + 1) * CHECKPOINT_SPAN;
+		if ((uint32)newPos < _pos || checkpointPos > _pos) {
+			if (!restart(checkpoint))
+				return false;
 		}
 
-		offset = newPos - _pos;
-
-		// Skip the given amount of data (very inefficient if one tries to skip
-		// huge amounts of data, but usually client code will only skip a few
-		// bytes, so this should be fine.
+		// Skip the remaining data. This is at most CHECKPOINT_SPAN bytes,
+		// unless the new position was never decompressed before.
 		byte tmpBuf[1024];
-		while (!err() && offset > 0) {
-			offset -= read(tmpBuf, MIN((int64)sizeof(tmpBuf), offset));
+		while (!err() && _pos < newPos) {
+			if (read(tmpBuf, MIN<int64>(sizeof(tmpBuf), newPos - _pos)) == 0)
+				break;
 		}
 
+		// Seeking past the end fails, leaving the stream at its end
 		_eos = false;
-		return true; // FIXME: STREAM REWRITE
+		return _pos == newPos;
 	}
 };
 
@@ -514,6 +569,18 @@ SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, ui
 	return toBeWrapped;
 }
 
+SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, uint32 size) {
+	if (!toBeWrapped)
+		return nullptr;
+
+#if defined(USE_ZLIB)
+	return new GZipReadStream(toBeWrapped, size, true);
+#else
+	delete toBeWrapped;
+	return nullptr;
+#endif
+}
+
 WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped) {
 #if defined(USE_ZLIB)
 	if (toBeWrapped)
@@ -133,6 +133,11 @@ bool inflateZlibHeaderless(Common::WriteStream *dst, Common::SeekableReadStream
  * here. knownSize will be ignored if the GZip-stream DOES include a length.
  * The created stream also becomes responsible for freeing the passed stream.
  *
+ * The wrapped stream keeps a copy of the decompressor state every megabyte
+ * of decompressed data, so a seek only has to decompress the data from the
+ * closest of them, instead of from the start of the stream. Seeking past
+ * the end of the data fails, and leaves the stream at its end.
+ *
  * It is safe to call this with a NULL parameter (in this case, NULL is
  * returned).
  *
@@ -141,6 +146,27 @@ bool inflateZlibHeaderless(Common::WriteStream *dst, Common::SeekableReadStream
  */
 SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize = 0);
 
+/**
+ * Take an arbitrary SeekableReadStream holding raw deflate data, without
+ * a zlib or gzip header, and wrap it in a custom stream which provides
+ * on-the-fly decompression. This is the format of compressed members of
+ * ZIP archives.
+ *
+ * Data is only decompressed when it is read. Seeking behaves as for
+ * wrapCompressedReadStream().
+ *
+ * The created stream becomes responsible for freeing the passed stream.
+ * If there is no ZLIB support, NULL is returned and the passed stream is
+ * destroyed.
+ *
+ * It is safe to call this with a NULL parameter (in this case, NULL is
+ * returned).
+ *
+ * @param toBeWrapped	the stream holding the compressed data
+ * @param size			the size of the decompressed data
+ */
+SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, uint32 size);
+
 /**
  * Take an arbitrary WriteStream and wrap it in a custom stream which provides
  * transparent on-the-fly compression. The compressed data is written in the
@@ -248,6 +248,27 @@ bool AdvancedMetaEngineDetection::cleanupPirated(ADDetectedGames &matched) const
 	return false;
 }
 
+void AdvancedMetaEngineDetection::getMD5FileNames(MD5FileMap &fileNames) const {
+	for (const byte *descPtr = _gameDescriptors; ((const ADGameDescription *)descPtr)->gameId != nullptr; descPtr += _descItemSize) {
+		const ADGameDescription *g = (const ADGameDescription *)descPtr;
+
+		// These are hashed another way than MD5Man.prefetch() does
+		if (g->flags & (ADGF_TAILMD5 | ADGF_MACRESFORK))
+			continue;
+
+		for (const ADGameFileDescription *fileDesc = g->filesDescriptions; fileDesc->fileName; fileDesc++) {
+			if (!fileDesc->md5)
+				continue;
+
+			// Files in subdirectories are hashed when their directory is listed
+			const char *name = strrchr(fileDesc->fileName, '/');
+			name = name ? name + 1 : fileDesc->fileName;
+			if (!fileNames.contains(name))
+				fileNames.setVal(name, _md5Bytes);
+		}
+	}
+}
+
 DetectedGames AdvancedMetaEngineDetection::detectGames(const Common::FSList &fslist) {
 	FileMap allFiles;
 
@@ -506,8 +527,246 @@ static char flagsToMD5Prefix(uint32 flags) {
 	return 'f';
 }
 
+#define MD5_CACHE_FILENAME "detection-md5.cache"
+#define MD5_CACHE_HEADER "ScummVM detection MD5 cache 2"
+
+enum {
+	kMD5CacheSaveInterval = 10000,
+	// About 3 MB on disk
+	kMD5CacheMaxEntries = 20000
+};
+
+/**
+ * The cache is kept next to the configuration file rather than with the
+ * saved games, which may be synchronized with a cloud storage.
+ */
+static Common::FSNode getMD5CacheFile() {
+	Common::String configFile = ConfMan.getCustomConfigFileName();
+	if (configFile.empty())
+		configFile = g_system->getDefaultConfigFileName();
+
+	return Common::FSNode(configFile).getParent().getChild(MD5_CACHE_FILENAME);
+}
+
+void MD5CacheManager::loadPersistent() {
+	_persistentLoaded = true;
+
+	Common::FSNode cacheFile = getMD5CacheFile();
+	if (!cacheFile.exists())
+		return;
+
+	Common::ScopedPtr<Common::SeekableReadStream> in(cacheFile.createReadStream());
+	if (!in || in->readLine() != MD5_CACHE_HEADER)
+		return;
+
+	// The generation of the run which saved the cache
+	_persistentGeneration = in->readLine().asUint64() + 1;
+
+	// Each line holds the key, stamp, size, MD5 and last use, separated by tabs
+	while (!in->eos() && !in->err()) {
+		Common::String line = in->readLine();
+
+		size_t fields[4];
+		fields[0] = line.find('\t');
+		for (int i = 1; i < ARRAYSIZE(fields); i++)
+			fields[i] = fields[i - 1] == Common::String::npos ? fields[i - 1] : line.find('\t', fields[i - 1] + 1);
+		if (fields[3] == Common::String::npos)
+			continue;
+
+		PersistentEntry entry;
+		entry.stamp = Common::String(line.c_str() + fields[0] + 1, fields[1] - fields[0] - 1);
+		entry.size = Common::String(line.c_str() + fields[1] + 1, fields[2] - fields[1] - 1).asUint64();
+		entry.md5 = Common::String(line.c_str() + fields[2] + 1, fields[3] - fields[2] - 1);
+		entry.lastUse = Common::String(line.c_str() + fields[3] + 1).asUint64();
+		_persistent[Common::String(line.c_str(), fields[0])] = entry;
+	}
+}
+
+bool MD5CacheManager::getPersistent(const Common::String &key, const Common::String &stamp, FileProperties &fileProps) {
+	if (!_persistentLoaded)
+		loadPersistent();
+
+	PersistentMap::iterator i = _persistent.find(key);
+	if (i == _persistent.end() || i->_value.stamp != stamp)
+		return false;
+
+	if (i->_value.lastUse != _persistentGeneration) {
+		i->_value.lastUse = _persistentGeneration;
+		_persistentDirty = true;
+	}
+
+	fileProps.size = i->_value.size;
+	fileProps.md5 = i->_value.md5;
+	return true;
+}
+
+void MD5CacheManager::setPersistent(const Common::String &key, const Common::String &stamp, const FileProperties &fileProps) {
+	if (!_persistentLoaded)
+		loadPersistent();
+
+	// Tabs and line breaks would break the file format
+	if (strpbrk(key.c_str(), "\t\r\n") || strpbrk(stamp.c_str(), "\t\r\n"))
+		return;
+
+	PersistentEntry &entry = _persistent[key];
+	entry.stamp = stamp;
+	entry.size = fileProps.size;
+	entry.md5 = fileProps.md5;
+	entry.lastUse = _persistentGeneration;
+	_persistentDirty = true;
+}
+
+void MD5CacheManager::prunePersistent() {
+	if (_persistent.size() <= kMD5CacheMaxEntries)
+		return;
+
+	Common::Array<uint32> uses;
+	uses.reserve(_persistent.size());
+	for (PersistentMap::const_iterator i = _persistent.begin(); i != _persistent.end(); ++i)
+		uses.push_back(i->_value.lastUse);
+	Common::sort(uses.begin(), uses.end());
+
+	// Drop the entries used before the oldest generation kept, then as many
+	// of that generation as needed. Entries used by this run are kept.
+	const uint32 oldestKept = uses[uses.size() - kMD5CacheMaxEntries];
+	uint toDrop = _persistent.size() - kMD5CacheMaxEntries;
+	for (int pass = 0; pass < 2; pass++) {
+		for (PersistentMap::iterator i = _persistent.begin(); i != _persistent.end() && toDrop; ++i) {
+			const uint32 lastUse = i->_value.lastUse;
+			if (lastUse < oldestKept || (pass == 1 && lastUse == oldestKept && lastUse != _persistentGeneration)) {
+				_persistent.erase(i);
+				toDrop--;
+			}
+		}
+	}
+}
+
+void MD5CacheManager::savePersistent(bool force) {
+	if (!_persistentDirty)
+		return;
+
+	const uint32 now = g_system->getMillis();
+	if (!force && _persistentSaveTime && now - _persistentSaveTime < kMD5CacheSaveInterval)
+		return;
+
+	prunePersistent();
+
+	Common::ScopedPtr<Common::WriteStream> out(getMD5CacheFile().createWriteStream());
+	if (!out)
+		return;
+
+	out->writeString(MD5_CACHE_HEADER "\n");
+	out->writeString(Common::String::format("%u\n", _persistentGeneration));
+	for (PersistentMap::const_iterator i = _persistent.begin(); i != _persistent.end(); ++i) {
+		out->writeString(Common::String::format("%s\t%s\t%lld\t%s\t%u\n", i->_key.c_str(), i->_value.stamp.c_str(),
+		                                        (long long)i->_value.size, i->_value.md5.c_str(), i->_value.lastUse));
+	}
+	out->finalize();
+
+	if (!out->err()) {
+		_persistentDirty = false;
+		_persistentSaveTime = MAX<uint32>(now, 1);
+	}
+}
+
+void MD5CacheManager::prefetch(const Common::FSNode &node, uint md5Bytes) {
+	Common::ScopedPtr<Common::SeekableReadStream> stream(node.createReadStream());
+	if (!stream)
+		return;
+
+	const int64 size = stream->size();
+	const Common::String md5 = Common::computeStreamMD5AsString(*stream, md5Bytes);
+	const Common::String key = Common::String::format("%u:%s", md5Bytes, node.getPath().c_str());
+
+	// Strings share their buffer when copied, without any locking, so the
+	// map must only hold buffers no other thread references
+	Common::StackLock lock(_prefetchMutex);
+	FileProperties &fileProps = _prefetched[Common::String(key.c_str())];
+	fileProps.size = size;
+	fileProps.md5 = Common::String(md5.c_str());
+}
+
+bool MD5CacheManager::getPrefetched(const Common::FSNode &node, uint md5Bytes, FileProperties &fileProps) {
+	const Common::String key = Common::String::format("%u:%s", md5Bytes, node.getPath().c_str());
+
+	Common::StackLock lock(_prefetchMutex);
+	PrefetchMap::const_iterator i = _prefetched.find(key);
+	if (i == _prefetched.end())
+		return false;
+
+	fileProps.size = i->_value.size;
+	fileProps.md5 = Common::String(i->_value.md5.c_str());
+	return true;
+}
+
+void MD5CacheManager::clearPrefetched() {
+	Common::StackLock lock(_prefetchMutex);
+	_prefetched.clear(true);
+}
+
 static bool getFilePropertiesIntern(uint md5Bytes, const AdvancedMetaEngine::FileMap &allFiles, const ADGameDescription &game, const Common::String fname, FileProperties &fileProps);
 
+/**
+ * Compute the key and stamp of a file for the persistent MD5 cache. The
+ * stamp covers all files its properties might be computed from.
+ *
+ * @return false if the file cannot be cached, e.g. because the backend
+ *         cannot tell the modification time of the files.
+ */
+static bool getPersistentMD5Key(uint md5Bytes, const AdvancedMetaEngine::FileMap &allFiles, const ADGameDescription &game, const Common::String &fname, Common::String &key, Common::String &stamp) {
+	Common::StringArray names;
+	if (game.flags & ADGF_MACRESFORK) {
+		// Sync with MacResManager::open()
+		const size_t slash = fname.findLastOf('/');
+		const size_t baseStart = slash == Common::String::npos ? 0 : slash + 1;
+
+		names.push_back(fname + ".rsrc");
+		names.push_back(Common::String(fname.c_str(), baseStart) + "._" + (fname.c_str() + baseStart));
+		names.push_back(fname + ".bin");
+	}
+	names.push_back(fname);
+
+	Common::String path;
+	for (uint i = 0; i < names.size(); i++) {
+		if (!allFiles.contains(names[i]))
+			continue;
+
+		const Common::FSNode &node = allFiles[names[i]];
+		int64 size, modificationTime;
+		if (!node.getFileInfo(size, modificationTime))
+			return false;
+
+		if (path.empty())
+			path = node.getPath();
+		stamp += Common::String::format("%s:%lld:%lld;", names[i].c_str(), (long long)size, (long long)modificationTime);
+	}
+
+	if (path.empty())
+		return false;
+
+	key = Common::String::format("%c:%u:%s", flagsToMD5Prefix(game.flags), md5Bytes, path.c_str());
+	return true;
+}
+
+/**
+ * Same as getFilePropertiesIntern(), but using the persistent MD5 cache.
+ */
+static bool getFilePropertiesPersistent(uint md5Bytes, const AdvancedMetaEngine::FileMap &allFiles, const ADGameDescription &game, const Common::String fname, FileProperties &fileProps) {
+	Common::String key, stamp;
+	const bool cacheable = getPersistentMD5Key(md5Bytes, allFiles, game, fname, key, stamp);
+
+	if (cacheable && MD5Man.getPersistent(key, stamp, fileProps))
+		return true;
+
+	if (!getFilePropertiesIntern(md5Bytes, allFiles, game, fname, fileProps))
+		return false;
+
+	if (cacheable)
+		MD5Man.setPersistent(key, stamp, fileProps);
+
+	return true;
+}
+
 bool AdvancedMetaEngineDetection::getFileProperties(const FileMap &allFiles, const ADGameDescription &game, const Common::String fname, FileProperties &fileProps) const {
 	Common::String hashname = Common::String::format("%c:%s:%d", flagsToMD5Prefix(game.flags), fname.c_str(), _md5Bytes);
 
@@ -517,7 +776,7 @@ bool AdvancedMetaEngineDetection::getFileProperties(const FileMap &allFiles, con
 		return true;
 	}
 
-	bool res = getFilePropertiesIntern(_md5Bytes, allFiles, game, fname, fileProps);
+	bool res = getFilePropertiesPersistent(_md5Bytes, allFiles, game, fname, fileProps);
 
 	if (res) {
 		MD5Man.setMD5(hashname, fileProps.md5);
@@ -528,7 +787,7 @@ bool AdvancedMetaEngineDetection::getFileProperties(const FileMap &allFiles, con
 }
 
 bool AdvancedMetaEngine::getFilePropertiesExtern(uint md5Bytes, const FileMap &allFiles, const ADGameDescription &game, const Common::String fname, FileProperties &fileProps) const {
-	return getFilePropertiesIntern(md5Bytes, allFiles, game, fname, fileProps);
+	return getFilePropertiesPersistent(md5Bytes, allFiles, game, fname, fileProps);
 }
 
 static bool getFilePropertiesIntern(uint md5Bytes, const AdvancedMetaEngine::FileMap &allFiles, const ADGameDescription &game, const Common::String fname, FileProperties &fileProps) {
@@ -550,6 +809,9 @@ static bool getFilePropertiesIntern(uint md5Bytes, const AdvancedMetaEngine::Fil
 	if (!allFiles.contains(fname))
 		return false;
 
+	if (!(game.flags & ADGF_TAILMD5) && MD5Man.getPrefetched(allFiles[fname], md5Bytes, fileProps))
+		return true;
+
 	Common::File testFile;
 
 	if (!testFile.open(allFiles[fname]))
@@ -26,12 +26,14 @@
 #include "engines/engine.h"
 
 #include "common/hash-str.h"
+#include "common/mutex.h"
 
 #include "common/gui_options.h" // FIXME: Temporary hack?
 
 namespace Common {
 class Error;
 class FSList;
+class FSNode;
 }
 /**
  * @defgroup engines_advdetector Advanced Detector
@@ -359,6 +361,8 @@ public:
 	 */
 	DetectedGames detectGames(const Common::FSList &fslist) override;
 
+	void getMD5FileNames(MD5FileMap &fileNames) const override;
+
 	/**
 	 * A generic createInstance.
 	 *
@@ -550,15 +554,60 @@ public:
 		return (md5HashMap.contains(fname) && sizeHashMap.contains(fname));
 	}
 
-	MD5CacheManager() {
+	MD5CacheManager() : _persistentLoaded(false), _persistentDirty(false), _persistentSaveTime(0), _persistentGeneration(0) {
 		clear();
 	}
 
+	/**
+	 * Clear the cache of the current detection run. The persistent cache
+	 * is kept.
+	 */
 	void clear() {
 		md5HashMap.clear(true);
 		sizeHashMap.clear(true);
 	}
 
+	/**
+	 * Look up file properties in the persistent cache, which is stored next
+	 * to the configuration file between runs.
+	 *
+	 * @param key    Identifies the file and how its MD5 is computed.
+	 * @param stamp  Describes the state (e.g. size and modification time)
+	 *               of the files the properties are computed from. Entries
+	 *               stored with a different stamp are outdated.
+	 */
+	bool getPersistent(const Common::String &key, const Common::String &stamp, FileProperties &fileProps);
+
+	/** Store file properties in the persistent cache. */
+	void setPersistent(const Common::String &key, const Common::String &stamp, const FileProperties &fileProps);
+
+	/**
+	 * Write the persistent cache to disk if it changed. Unless force is set,
+	 * this is skipped if it was written less than a few seconds ago, so that
+	 * mass detection does not rewrite it for every directory.
+	 *
+	 * When the cache holds too many entries, those used the least recently
+	 * are dropped, e.g. those of files which were deleted or changed.
+	 */
+	void savePersistent(bool force);
+
+	/**
+	 * Compute the properties of a file ahead of detection, the way
+	 * AdvancedMetaEngineDetection does for games without special flags.
+	 * Detection runs use the result until clearPrefetched() is called.
+	 *
+	 * Unlike the other methods, this may be called from any thread.
+	 */
+	void prefetch(const Common::FSNode &node, uint md5Bytes);
+
+	/**
+	 * Look up the properties of a file computed by prefetch().
+	 */
+	bool getPrefetched(const Common::FSNode &node, uint md5Bytes, FileProperties &fileProps);
+
+	/** Drop the properties computed by prefetch(). */
+	void clearPrefetched();
+
 private:
 	friend class Common::Singleton<MD5CacheManager>;
 
@@ -566,6 +615,31 @@ private:
 	typedef Common::HashMap<Common::String, int64, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> SizeHashMap;
 	FileHashMap md5HashMap;
 	SizeHashMap sizeHashMap;
+
+	struct PersistentEntry {
+		Common::String stamp;
+		Common::String md5;
+		int64 size;
+		/** Value of _persistentGeneration when the entry was last used. */
+		uint32 lastUse;
+	};
+
+	/** Persistent cache entries. The keys hold file paths, which are case sensitive. */
+	typedef Common::HashMap<Common::String, PersistentEntry> PersistentMap;
+	PersistentMap _persistent;
+	bool _persistentLoaded;
+	bool _persistentDirty;
+	uint32 _persistentSaveTime;
+	/** Incremented every time the cache is loaded, i.e. once per run. */
+	uint32 _persistentGeneration;
+
+	void loadPersistent();
+	void prunePersistent();
+
+	/** Properties computed by prefetch(), keyed by MD5 size and path. */
+	typedef Common::HashMap<Common::String, FileProperties> PrefetchMap;
+	PrefetchMap _prefetched;
+	Common::Mutex _prefetchMutex;
 };
 
 /** Convenience shortcut for accessing the MD5CacheManager. */
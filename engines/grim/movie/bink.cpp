@@ -41,7 +41,11 @@ MoviePlayer *CreateBinkPlayer(bool demo) {
 }
 
 BinkPlayer::BinkPlayer(bool demo) : MoviePlayer(), _demo(demo) {
-	_videoDecoder = new Video::BinkDecoder();
+	Video::BinkDecoder *binkDecoder = new Video::BinkDecoder();
+	// EMI's cutscenes are full screen, keep a couple of frames ready
+	binkDecoder->setDecodeAhead(2);
+	binkDecoder->setParallelDecode(true);
+	_videoDecoder = binkDecoder;
 	_videoDecoder->setDefaultHighColorFormat(Graphics::PixelFormat(4, 8, 8, 8, 0, 8, 16, 24, 0));
 	_subtitleIndex = _subtitles.begin();
 }
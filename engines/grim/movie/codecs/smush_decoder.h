@@ -61,6 +61,8 @@ protected:
 	void init();
 	void close() override;
 	const Graphics::Surface *decodeNextFrame() override;
+	// The frames are read by handleFrame() in decodeNextFrame()
+	bool canPrefetch() const override { return false; }
 	class SmushVideoTrack : public FixedRateVideoTrack {
 	public:
 		SmushVideoTrack(int width, int height, int fps, int numFrames, bool is16Bit);
@@ -25,6 +25,7 @@
 #include "backends/keymapper/keymap.h"
 #include "backends/keymapper/standard-actions.h"
 
+#include "common/memstream.h"
 #include "common/savefile.h"
 #include "common/system.h"
 #include "common/translation.h"
@@ -302,6 +303,61 @@ WARN_UNUSED_RESULT bool MetaEngine::readSavegameHeader(Common::InSaveFile *in, E
 }
 
 
+//////////////////////////////////////////////
+// Save index
+//////////////////////////////////////////////
+
+// The metadata of the saves in the extended format are kept in an index of
+// their target, so that they can be listed without opening every save file.
+// The record holds the header values, the attachment the thumbnail.
+
+enum {
+	kSaveIndexRecordVersion = 2
+};
+
+static void writeSaveIndexEntry(const char *target, const Common::String &filename, const ExtendedSavegameHeader &header) {
+	Common::MemoryWriteStreamDynamic record(DisposeAfterUse::YES);
+	record.writeByte(kSaveIndexRecordVersion);
+	record.writeUint32LE(header.date);
+	record.writeUint16LE(header.time);
+	record.writeUint32LE(header.playtime);
+	record.writeUint32LE(header.description.size());
+	record.writeString(header.description);
+
+	Common::MemoryWriteStreamDynamic thumbnail(DisposeAfterUse::YES);
+	if (header.thumbnail)
+		Graphics::saveThumbnail(thumbnail, *header.thumbnail);
+
+	g_system->getSavefileManager()->writeIndexEntry(target, filename, record.getData(), record.size(), thumbnail.getData(), thumbnail.size());
+}
+
+static bool readSaveIndexEntry(const char *target, const Common::String &filename, ExtendedSavegameHeader &header, bool skipThumbnail) {
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	Common::ScopedPtr<Common::SeekableReadStream> record(saveFileMan->readIndexEntry(target, filename));
+	if (!record || record->readByte() != kSaveIndexRecordVersion)
+		return false;
+
+	header.date = record->readUint32LE();
+	header.time = record->readUint16LE();
+	header.playtime = record->readUint32LE();
+	const uint32 descriptionSize = record->readUint32LE();
+	if (record->err() || record->eos() || descriptionSize > record->size() - record->pos())
+		return false;
+
+	header.description = record->readString(0, descriptionSize);
+	if (record->err() || record->eos())
+		return false;
+
+	if (skipThumbnail)
+		return true;
+
+	// Saves without a thumbnail have an empty attachment
+	Common::ScopedPtr<Common::SeekableReadStream> thumbnail(saveFileMan->readIndexEntry(target, filename, true));
+	if (!thumbnail)
+		return false;
+	return thumbnail->size() == 0 || Graphics::loadThumbnail(*thumbnail, header.thumbnail);
+}
+
 //////////////////////////////////////////////
 // MetaEngine default implementations
 //////////////////////////////////////////////
@@ -340,6 +396,16 @@ SaveStateList MetaEngine::listSaves(const char *target) const {
 		int slotNum = atoi(slotStr);
 
 		if (slotNum >= 0 && slotNum <= getMaximumSaveSlot()) {
+			// The list does not need the thumbnails, the dialogs query
+			// the saves whose thumbnail they show.
+			ExtendedSavegameHeader header;
+			if (readSaveIndexEntry(target, getSavegameFile(slotNum, target), header, true)) {
+				SaveStateDescriptor desc(this, slotNum, Common::U32String());
+				parseSavegameHeader(&header, &desc);
+				saveList.push_back(desc);
+				continue;
+			}
+
 			SaveStateDescriptor desc = querySaveMetaInfos(target, slotNum);
 			if (desc.getSaveSlot() != -1) {
 				saveList.push_back(desc);
@@ -347,6 +413,9 @@ SaveStateList MetaEngine::listSaves(const char *target) const {
 		}
 	}
 
+	// Write the entries of the saves queried above
+	saveFileMan->flushIndex(target);
+
 	// Sort saves based on slot number.
 	Common::sort(saveList.begin(), saveList.end(), SaveStateDescriptorSlotComparator());
 	return saveList;
@@ -405,21 +474,32 @@ SaveStateDescriptor MetaEngine::querySaveMetaInfos(const char *target, int slot)
 	if (!hasFeature(kSavesUseExtendedFormat))
 		return SaveStateDescriptor();
 
-	Common::ScopedPtr<Common::InSaveFile> f(g_system->getSavefileManager()->openForLoading(
-		getSavegameFile(slot, target)));
-
-	if (f) {
-		ExtendedSavegameHeader header;
-		if (!readSavegameHeader(f.get(), &header, false)) {
+	const Common::String filename = getSavegameFile(slot, target);
+	ExtendedSavegameHeader header;
+	if (!readSaveIndexEntry(target, filename, header, false)) {
+		Common::ScopedPtr<Common::InSaveFile> f(g_system->getSavefileManager()->openForLoading(filename));
+		if (!f || !readSavegameHeader(f.get(), &header, false))
 			return SaveStateDescriptor();
-		}
 
-		// Create the return descriptor
-		SaveStateDescriptor desc(this, slot, Common::U32String());
-		parseSavegameHeader(&header, &desc);
-		desc.setThumbnail(header.thumbnail);
-		return desc;
+		// The index is written to disk when the saves are listed next
+		writeSaveIndexEntry(target, filename, header);
 	}
 
-	return SaveStateDescriptor();
+	// Create the return descriptor
+	SaveStateDescriptor desc(this, slot, Common::U32String());
+	parseSavegameHeader(&header, &desc);
+	desc.setThumbnail(header.thumbnail);
+	return desc;
+}
+
+Common::SeekableReadStream *MetaEngine::openIndexedThumbnail(const char *target, int slot) const {
+	if (!hasFeature(kSavesUseExtendedFormat))
+		return nullptr;
+
+	Common::SeekableReadStream *thumbnail = g_system->getSavefileManager()->readIndexEntry(target, getSavegameFile(slot, target), true);
+	if (thumbnail && thumbnail->size() == 0) {
+		delete thumbnail;
+		return nullptr;
+	}
+	return thumbnail;
 }
@@ -26,6 +26,7 @@
 #include "common/scummsys.h"
 #include "common/error.h"
 #include "common/array.h"
+#include "common/hash-str.h"
 
 #include "engines/game.h"
 #include "engines/savestate.h"
@@ -136,6 +137,9 @@ struct ExtendedSavegameHeader {
  */
 class MetaEngineDetection : public PluginObject {
 public:
+	/** Names of files with the number of bytes to hash of them, regardless of case. */
+	typedef Common::HashMap<Common::String, uint, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> MD5FileMap;
+
 	virtual ~MetaEngineDetection() {}
 
 	/** Get the engine ID. */
@@ -157,6 +161,16 @@ public:
 	 */
 	virtual DetectedGames detectGames(const Common::FSList &fslist) = 0;
 
+	/**
+	 * Add the names of the files whose MD5 detectGames() computes to
+	 * @p fileNames, with the number of bytes it hashes of them, so that
+	 * they can be hashed ahead of detection. Names already in the map are
+	 * kept.
+	 *
+	 * The default implementation adds nothing.
+	 */
+	virtual void getMD5FileNames(MD5FileMap &fileNames) const {}
+
 	/**
 	 * Return a list of extra GUI options for the specified target.
 	 *
@@ -353,6 +367,18 @@ public:
 	 */
 	virtual SaveStateDescriptor querySaveMetaInfos(const char *target, int slot) const;
 
+	/**
+	 * Open the thumbnail of a save state in the extended format, as kept by
+	 * the save index when its meta information were queried. The thumbnail
+	 * can then be read with Graphics::loadThumbnail() on any thread.
+	 *
+	 * @param target  Name of a config manager target.
+	 * @param slot    Slot number of the save state.
+	 *
+	 * @return The thumbnail data, or nullptr if the save state is not indexed or has no thumbnail.
+	 */
+	Common::SeekableReadStream *openIndexedThumbnail(const char *target, int slot) const;
+
 	/**
 	 * Return the name of the save file for the given slot and optional target,
 	 * or a pattern for matching filenames against.
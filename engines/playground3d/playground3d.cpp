@@ -21,6 +21,7 @@
 
 #include "common/scummsys.h"
 #include "common/config-manager.h"
+#include "common/debug.h"
 #include "common/events.h"
 
 #include "graphics/renderer.h"
@@ -48,7 +49,8 @@ Playground3dEngine::Playground3dEngine(OSystem *syst)
 		_rotateAngleX(0), _rotateAngleY(0), _rotateAngleZ(0),
 		_clearColor(0.0f, 0.0f, 0.0f, 1.0f), _fade(1.0f), _fadeIn(false),
 		_rgbaTexture(nullptr), _rgbTexture(nullptr), _rgb565Texture(nullptr),
-		_rgba5551Texture(nullptr), _rgba4444Texture(nullptr) {
+		_rgba5551Texture(nullptr), _rgba4444Texture(nullptr),
+		_benchmarkFrames(0), _benchmarkMillis(0) {
 }
 
 Playground3dEngine::~Playground3dEngine() {
@@ -69,6 +71,7 @@ Common::Error Playground3dEngine::run() {
 	// 3 - fade in/out
 	// 4 - moving filled rectangle in viewport
 	// 5 - drawing RGBA pattern texture to check endian correctness
+	// 6 - grid of overlapping rotated cubes, timing the rendering
 	int testId = 1;
 
 	switch (testId) {
@@ -104,6 +107,9 @@ Common::Error Playground3dEngine::run() {
 			_rgba4444Texture = generateRgbaTexture(120, 120, pixelFormatRGB4444);
 			break;
 		}
+		case 6:
+			_clearColor = Math::Vector4d(0.5f, 0.5f, 0.5f, 1.0f);
+			break;
 		default:
 			assert(false);
 	}
@@ -170,6 +176,26 @@ void Playground3dEngine::drawAndRotateCube() {
 		_rotateAngleZ = 0;
 }
 
+void Playground3dEngine::drawCubeGrid() {
+	// Rows and columns of cubes close enough to overlap
+	const int gridSize = 8;
+	for (int y = 0; y < gridSize; y++) {
+		for (int x = 0; x < gridSize; x++) {
+			Math::Vector3d pos = Math::Vector3d(1.5f * (x - (gridSize - 1) * 0.5f), 1.2f * (y - (gridSize - 1) * 0.5f), 18.0f + (x + y) % 3);
+			_gfx->drawCube(pos, Math::Vector3d(_rotateAngleX + 10 * x, _rotateAngleY + 10 * y, _rotateAngleZ));
+		}
+	}
+	_rotateAngleX += 0.25;
+	_rotateAngleY += 0.50;
+	_rotateAngleZ += 0.10;
+	if (_rotateAngleX >= 360)
+		_rotateAngleX = 0;
+	if (_rotateAngleY >= 360)
+		_rotateAngleY = 0;
+	if (_rotateAngleZ >= 360)
+		_rotateAngleZ = 0;
+}
+
 void Playground3dEngine::drawPolyOffsetTest() {
 	Math::Vector3d pos = Math::Vector3d(0.0f, 0.0f, 6.0f);
 	_gfx->drawPolyOffsetTest(pos, Math::Vector3d(0, _rotateAngleY, 0));
@@ -202,6 +228,8 @@ void Playground3dEngine::drawRgbaTexture() {
 }
 
 void Playground3dEngine::drawFrame(int testId) {
+	const uint32 startTime = _system->getMillis();
+
 	_gfx->clear(_clearColor);
 
 	float pitch = 0.0f;
@@ -234,12 +262,24 @@ void Playground3dEngine::drawFrame(int testId) {
 			_gfx->loadTextureRGBA4444(_rgba4444Texture);
 			drawRgbaTexture();
 			break;
+		case 6:
+			drawCubeGrid();
+			break;
 		default:
 			assert(false);
 	}
 
 	_gfx->flipBuffer();
 
+	if (testId == 6) {
+		_benchmarkMillis += _system->getMillis() - startTime;
+		if (++_benchmarkFrames == kBenchmarkFrames) {
+			debug("Frame rendered in %u ms on average over %d frames", _benchmarkMillis / kBenchmarkFrames, kBenchmarkFrames);
+			_benchmarkFrames = 0;
+			_benchmarkMillis = 0;
+		}
+	}
+
 	_frameLimiter->delayBeforeSwap();
 	_system->updateScreen();
 	_frameLimiter->startFrame();
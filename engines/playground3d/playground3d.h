@@ -60,8 +60,14 @@ private:
 
 	float _rotateAngleX, _rotateAngleY, _rotateAngleZ;
 
+	/** Number of frames the rendering time is averaged over. */
+	static const int kBenchmarkFrames = 100;
+	int _benchmarkFrames;
+	uint32 _benchmarkMillis;
+
 	Graphics::Surface *generateRgbaTexture(int width, int height, Graphics::PixelFormat format);
 	void drawAndRotateCube();
+	void drawCubeGrid();
 	void drawPolyOffsetTest();
 	void dimRegionInOut();
 	void drawInViewport();
@@ -53,6 +53,7 @@
 #include "sci/video/seq_decoder.h"
 #ifdef ENABLE_SCI32
 #include "common/memstream.h"
+#include "sci/graphics/celobj32.h"
 #include "sci/graphics/frameout.h"
 #include "sci/graphics/paint32.h"
 #include "sci/graphics/palette32.h"
@@ -83,6 +84,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	// Variables
 	registerVar("sleeptime_factor",	&g_debug_sleeptime_factor);
 	registerVar("gc_interval",		&engine->_gamestate->scriptGCInterval);
+	registerVar("gc_incremental",		&engine->_gamestate->gcIncremental);
 	registerVar("simulated_key",		&g_debug_simulated_key);
 	registerVar("track_mouse_clicks",	&g_debug_track_mouse_clicks);
 	// FIXME: This actually passes an enum type instead of an integer but no
@@ -149,6 +151,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("vpi",                WRAP_METHOD(Console, cmdVisiblePlaneItemList));	// alias
 	registerCmd("saved_bits",         WRAP_METHOD(Console, cmdSavedBits));
 	registerCmd("show_saved_bits",    WRAP_METHOD(Console, cmdShowSavedBits));
+	registerCmd("scaled_cel_cache",   WRAP_METHOD(Console, cmdScaledCelCache));
 	// Segments
 	registerCmd("segment_table",		WRAP_METHOD(Console, cmdPrintSegmentTable));
 	registerCmd("segtable",			WRAP_METHOD(Console, cmdPrintSegmentTable));	// alias
@@ -162,6 +165,8 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("gc_reachable",		WRAP_METHOD(Console, cmdGCShowReachable));
 	registerCmd("gc_freeable",		WRAP_METHOD(Console, cmdGCShowFreeable));
 	registerCmd("gc_normalize",		WRAP_METHOD(Console, cmdGCNormalize));
+	registerCmd("gc_stats",			WRAP_METHOD(Console, cmdGCStats));
+	registerCmd("gc_stress",			WRAP_METHOD(Console, cmdGCStress));
 	// Music/SFX
 	registerCmd("songlib",			WRAP_METHOD(Console, cmdSongLib));
 	registerCmd("songinfo",			WRAP_METHOD(Console, cmdSongInfo));
@@ -309,6 +314,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf("---------\n");
 	debugPrintf("sleeptime_factor: Factor to multiply with wait times in kWait()\n");
 	debugPrintf("gc_interval: Number of kernel calls in between garbage collections\n");
+	debugPrintf("gc_incremental: Spreads garbage collections over several kernel calls\n");
 	debugPrintf("simulated_key: Add a key with the specified scan code to the event list\n");
 	debugPrintf("track_mouse_clicks: Toggles mouse click tracking to the console\n");
 	debugPrintf("script_abort_flag: Set to 1 to abort script execution. Set to 2 to force a replay afterwards\n");
@@ -376,6 +382,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" visible_plane_items / vpi - Shows a list of all items for a plane in the visible draw list (SCI2+)\n");
 	debugPrintf(" saved_bits - List saved bits on the hunk\n");
 	debugPrintf(" show_saved_bits - Display saved bits\n");
+	debugPrintf(" scaled_cel_cache - Shows the hit rate of the cache of scaled cels, or clears it (SCI2+)\n");
 	debugPrintf("\n");
 	debugPrintf("Segments:\n");
 	debugPrintf(" segment_table / segtable - Lists all segments\n");
@@ -388,6 +395,8 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" gc_reachable - Lists all addresses directly reachable from a given memory object\n");
 	debugPrintf(" gc_freeable - Lists all addresses freeable in a given segment\n");
 	debugPrintf(" gc_normalize - Prints the \"normal\" address of a given address\n");
+	debugPrintf(" gc_stats - Shows statistics of the garbage collections\n");
+	debugPrintf(" gc_stress - Runs incremental garbage collections repeatedly, and checks them\n");
 	debugPrintf("\n");
 	debugPrintf("Music/SFX:\n");
 	debugPrintf(" songlib - Shows the song library\n");
@@ -2314,6 +2323,28 @@ bool Console::cmdShowSavedBits(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdScaledCelCache(int argc, const char **argv) {
+#ifdef ENABLE_SCI32
+	if (!_engine->_gfxFrameout) {
+		debugPrintf("This SCI version does not have a scaled cel cache\n");
+		return true;
+	}
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "clear")) {
+		CelObj::_scaledCache->clear();
+		debugPrintf("Scaled cel cache cleared\n");
+	} else if (argc == 1) {
+		CelObj::_scaledCache->printStats(this);
+	} else {
+		debugPrintf("Shows the hit rate of the cache of scaled cels, or clears it\n");
+		debugPrintf("Usage: %s [clear]\n", argv[0]);
+	}
+#else
+	debugPrintf("SCI32 isn't included in this compiled executable\n");
+#endif
+	return true;
+}
+
 
 bool Console::cmdParseGrammar(int argc, const char **argv) {
 	debugPrintf("Parse grammar, in strict GNF:\n");
@@ -2841,6 +2872,180 @@ bool Console::cmdGCNormalize(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdGCStats(int argc, const char **argv) {
+	GCStatistics &stats = _engine->_gamestate->gcStatistics;
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "reset")) {
+		stats.reset();
+		return true;
+	}
+
+	if (argc != 1) {
+		debugPrintf("Shows statistics of the garbage collections since the game started.\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	debugPrintf("Collections: %d, of which %d incremental\n", stats.collections, stats.incrementalCollections);
+	debugPrintf("Pause: %d ms last, %d ms max, %d ms total\n", stats.lastPause, stats.maxPause, stats.totalTime);
+	debugPrintf("Objects scanned: %d last, %llu total\n", stats.lastScanned, (unsigned long long)stats.totalScanned);
+	debugPrintf("Objects freed: %d last, %llu total\n", stats.lastFreed, (unsigned long long)stats.totalFreed);
+	if (_engine->_gamestate->_segMan->getGCMarker())
+		debugPrintf("An incremental collection is running\n");
+
+	return true;
+}
+
+enum {
+	kGCStressLists = 8,
+	kGCStressInitialNodes = 32,
+	kGCStressMaxNodes = 4000,
+	kGCStressMutationsPerStep = 4
+};
+
+/**
+ * Adds a node, whose value is a new list, to the end of a list of gc_stress.
+ * Done by the kernel functions, like the scripts do.
+ */
+static void addGCStressNode(EngineState *s, reg_t list, uint16 key) {
+	const reg_t acc = s->r_acc;
+	reg_t args[2];
+	args[0] = kNewList(s, 0, nullptr);
+	args[1] = make_reg(0, key);
+	args[1] = kNewNode(s, 2, args);
+	args[0] = list;
+	kAddToEnd(s, 2, args);
+	s->r_acc = acc;
+}
+
+/**
+ * Moves a random node of a list of gc_stress to the end of another one. The
+ * node is then only referenced by the list it went to, which may have been
+ * scanned already, and is kept by the write barrier of kAddToEnd().
+ */
+static void moveGCStressNode(EngineState *s, reg_t from, reg_t to, Common::RandomSource &rng) {
+	SegManager *segMan = s->_segMan;
+	uint count = 0;
+	for (reg_t pos = segMan->lookupList(from)->first; !pos.isNull(); pos = segMan->lookupNode(pos)->succ)
+		count++;
+	if (!count)
+		return;
+
+	reg_t node = segMan->lookupList(from)->first;
+	for (uint i = rng.getRandomNumber(count - 1); i > 0; i--)
+		node = segMan->lookupNode(node)->succ;
+
+	const reg_t acc = s->r_acc;
+	reg_t args[2];
+	args[0] = from;
+	args[1] = segMan->lookupNode(node)->key;
+	kDeleteKey(s, 2, args);
+	args[0] = to;
+	args[1] = node;
+	kAddToEnd(s, 2, args);
+	s->r_acc = acc;
+}
+
+bool Console::cmdGCStress(int argc, const char **argv) {
+	if (argc > 2) {
+		debugPrintf("Runs incremental garbage collections on the current game, checking after\n");
+		debugPrintf("each one that no reachable object was freed, and that a full collection\n");
+		debugPrintf("finds nothing more to free. Between the steps of the collections, list\n");
+		debugPrintf("nodes are added and moved between lists by the kernel functions, to check\n");
+		debugPrintf("their write barriers. Restore a large saved game first.\n");
+		debugPrintf("Usage: %s [<collections>]\n", argv[0]);
+		return true;
+	}
+
+	EngineState *s = _engine->_gamestate;
+	if (s->_executionStack.empty()) {
+		debugPrintf("No game is running\n");
+		return true;
+	}
+
+	const int collections = argc == 2 ? atoi(argv[1]) : 20;
+	int failures = 0;
+
+	// The lists mutated between the steps are the values of the nodes of
+	// another list, which r_prev keeps until the end of the command
+	abort_gc(s->_segMan);
+	const reg_t prev = s->r_prev;
+	const reg_t acc = s->r_acc;
+	s->r_prev = kNewList(s, 0, nullptr);
+
+	Common::RandomSource rng("sciGCStress");
+	Common::Array<reg_t> lists;
+	uint nodes = 0;
+	for (int i = 0; i < kGCStressLists; i++) {
+		reg_t args[2];
+		args[0] = kNewList(s, 0, nullptr);
+		lists.push_back(args[0]);
+		args[1] = make_reg(0, i);
+		args[1] = kNewNode(s, 2, args);
+		args[0] = s->r_prev;
+		kAddToEnd(s, 2, args);
+
+		for (int j = 0; j < kGCStressInitialNodes; j++)
+			addGCStressNode(s, lists[i], nodes++);
+	}
+	s->r_acc = acc;
+
+	for (int i = 0; i < collections; i++) {
+		AddrSet *before = findAllActiveReferences(s);
+
+		int steps = 1;
+		int mutations = 0;
+		run_gc_step(s);
+		do {
+			for (int j = 0; j < kGCStressMutationsPerStep; j++) {
+				const reg_t from = lists[rng.getRandomNumber(lists.size() - 1)];
+				const reg_t to = lists[rng.getRandomNumber(lists.size() - 1)];
+				if (nodes < kGCStressMaxNodes && rng.getRandomBit())
+					addGCStressNode(s, to, nodes++);
+				else
+					moveGCStressNode(s, from, to, rng);
+				mutations++;
+			}
+			steps++;
+		} while (!run_gc_step(s));
+		const GCStatistics incremental = s->gcStatistics;
+
+		AddrSet *after = findAllActiveReferences(s);
+		uint lost = 0;
+		for (AddrSet::const_iterator it = before->begin(); it != before->end(); ++it) {
+			if (!after->contains(it->_key))
+				lost++;
+		}
+		delete before;
+		delete after;
+
+		debugPrintf("%d: %d steps, %d mutations, %d scanned, %d freed, %d ms pause",
+		            i, steps, mutations, incremental.lastScanned, incremental.lastFreed, incremental.lastPause);
+		if (lost) {
+			// The lists may refer to freed nodes, which cannot be mutated
+			debugPrintf(" - %d reachable freed, stopping\n", lost);
+			failures++;
+			break;
+		}
+
+		run_gc(s);
+		const uint missed = s->gcStatistics.lastFreed;
+		if (missed) {
+			debugPrintf(" - %d unreachable kept\n", missed);
+			failures++;
+		} else {
+			debugPrintf("\n");
+		}
+	}
+
+	// Let the lists go
+	s->r_prev = prev;
+	run_gc(s);
+
+	debugPrintf("%d of %d collections failed\n", failures, collections);
+	return true;
+}
+
 bool Console::cmdVMVarlist(int argc, const char **argv) {
 	EngineState *s = _engine->_gamestate;
 	const char *varnames[] = {"global", "local", "temp", "param"};
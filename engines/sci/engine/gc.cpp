@@ -20,7 +20,9 @@
  */
 
 #include "sci/engine/gc.h"
+#include "common/algorithm.h"
 #include "common/array.h"
+#include "common/system.h"
 #include "sci/graphics/ports.h"
 
 #ifdef ENABLE_SCI32
@@ -83,26 +85,50 @@ static AddrSet *normalizeAddresses(SegManager *segMan, const AddrSet &nonnormal_
 	return normal_map;
 }
 
-static void processWorkList(SegManager *segMan, WorklistManager &wm, const Common::Array<SegmentObj *> &heap) {
+/**
+ * Whether a reference is to a clone, list or node which was freed since it
+ * was marked, which an incremental collection may find.
+ */
+static bool isFreedEntry(const SegmentObj *mobj, reg_t reg) {
+	switch (mobj->getType()) {
+	case SEG_TYPE_CLONES:
+	case SEG_TYPE_LISTS:
+	case SEG_TYPE_NODES:
+		return !mobj->isValidOffset(reg.getOffset());
+	default:
+		return false;
+	}
+}
+
+/**
+ * Scans the objects of the worklist until it is empty, or maxObjects of them
+ * were scanned.
+ * @return the number of scanned objects
+ */
+static uint processWorkList(SegManager *segMan, WorklistManager &wm, const Common::Array<SegmentObj *> &heap, uint maxObjects, bool skipFreed) {
 	SegmentId stackSegment = segMan->findSegmentByType(SEG_TYPE_STACK);
-	while (!wm._worklist.empty()) {
+	uint scanned = 0;
+	while (!wm._worklist.empty() && scanned < maxObjects) {
 		reg_t reg = wm._worklist.back();
 		wm._worklist.pop_back();
 		if (reg.getSegment() != stackSegment) { // No need to repeat this one
 			debugC(kDebugLevelGC, "[GC] Checking %04x:%04x", PRINT_REG(reg));
 			if (reg.getSegment() < heap.size() && heap[reg.getSegment()]) {
+				if (skipFreed && isFreedEntry(heap[reg.getSegment()], reg))
+					continue;
+
 				// Valid heap object? Find its outgoing references!
 				wm.pushArray(heap[reg.getSegment()]->listAllOutgoingReferences(reg));
+				scanned++;
 			}
 		}
 	}
+	return scanned;
 }
 
-AddrSet *findAllActiveReferences(EngineState *s) {
+static void addRoots(EngineState *s, WorklistManager &wm) {
 	assert(!s->_executionStack.empty());
 
-	WorklistManager wm;
-
 	// Initialize registers
 	wm.push(s->r_acc);
 	wm.push(s->r_prev);
@@ -169,8 +195,17 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	}
 
 	debugC(kDebugLevelGC, "[GC] -- Finished explicitly loaded scripts, done with root set");
+}
+
+AddrSet *findAllActiveReferences(EngineState *s, uint *scanned) {
+	WorklistManager wm;
+
+	addRoots(s, wm);
 
-	processWorkList(s->_segMan, wm, heap);
+	const Common::Array<SegmentObj *> &heap = s->_segMan->getSegments();
+	const uint count = processWorkList(s->_segMan, wm, heap, 0xFFFFFFFF, false);
+	if (scanned)
+		*scanned = count;
 
 	if (g_sci->_gfxPorts)
 		g_sci->_gfxPorts->processEngineHunkList(wm);
@@ -178,20 +213,19 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	return normalizeAddresses(s->_segMan, wm._map);
 }
 
-void run_gc(EngineState *s) {
-	SegManager *segMan = s->_segMan;
-
-	// Some debug stuff
-	debugC(kDebugLevelGC, "[GC] Running...");
+/**
+ * Frees the objects which are not in activeRefs, except those of the
+ * segments in keptSegments.
+ * @return the number of freed objects
+ */
+static uint sweep(SegManager *segMan, const AddrSet &activeRefs, const Common::Array<SegmentId> &keptSegments) {
 #ifdef GC_DEBUG_CODE
 	const char *segnames[SEG_TYPE_MAX + 1];
 	int segcount[SEG_TYPE_MAX + 1];
 	memset(segnames, 0, sizeof(segnames));
 	memset(segcount, 0, sizeof(segcount));
 #endif
-
-	// Compute the set of all segments references currently in use.
-	AddrSet *activeRefs = findAllActiveReferences(s);
+	uint freed = 0;
 
 	// Iterate over all segments, and check for each whether it
 	// contains stuff that can be collected.
@@ -199,7 +233,7 @@ void run_gc(EngineState *s) {
 	for (uint seg = 1; seg < heap.size(); seg++) {
 		SegmentObj *mobj = heap[seg];
 
-		if (mobj != nullptr) {
+		if (mobj != nullptr && Common::find(keptSegments.begin(), keptSegments.end(), seg) == keptSegments.end()) {
 #ifdef GC_DEBUG_CODE
 			const SegmentType type = mobj->getType();
 			segnames[type] = segmentTypeNames[type];
@@ -210,10 +244,11 @@ void run_gc(EngineState *s) {
 			const Common::Array<reg_t> tmp = mobj->listAllDeallocatable(seg);
 			for (Common::Array<reg_t>::const_iterator it = tmp.begin(); it != tmp.end(); ++it) {
 				const reg_t addr = *it;
-				if (!activeRefs->contains(addr)) {
+				if (!activeRefs.contains(addr)) {
 					// Not found -> we can free it
 					mobj->freeAtAddress(segMan, addr);
 					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+					freed++;
 #ifdef GC_DEBUG_CODE
 					segcount[type]++;
 #endif
@@ -223,8 +258,6 @@ void run_gc(EngineState *s) {
 		}
 	}
 
-	delete activeRefs;
-
 #ifdef GC_DEBUG_CODE
 	// Output debug summary of garbage collection
 	debugC(kDebugLevelGC, "[GC] Summary:");
@@ -232,6 +265,103 @@ void run_gc(EngineState *s) {
 		if (segcount[i])
 			debugC(kDebugLevelGC, "\t%d\t* %s", segcount[i], segnames[i]);
 #endif
+
+	return freed;
+}
+
+static void addStatistics(GCStatistics &stats, uint32 pause, uint32 time, uint scanned, uint freed) {
+	stats.collections++;
+	stats.lastPause = pause;
+	stats.maxPause = MAX(stats.maxPause, pause);
+	stats.totalTime += time;
+	stats.lastScanned = scanned;
+	stats.lastFreed = freed;
+	stats.totalScanned += scanned;
+	stats.totalFreed += freed;
+}
+
+void run_gc(EngineState *s) {
+	SegManager *segMan = s->_segMan;
+	const uint32 startTime = g_system->getMillis();
+
+	// Some debug stuff
+	debugC(kDebugLevelGC, "[GC] Running...");
+
+	// A full collection makes a running incremental one useless
+	abort_gc(segMan);
+
+	// Compute the set of all segments references currently in use.
+	uint scanned;
+	AddrSet *activeRefs = findAllActiveReferences(s, &scanned);
+
+	const uint freed = sweep(segMan, *activeRefs, Common::Array<SegmentId>());
+
+	delete activeRefs;
+
+	const uint32 time = g_system->getMillis() - startTime;
+	addStatistics(s->gcStatistics, time, time, scanned, freed);
+}
+
+static void endStep(IncrementalMarker *marker, uint32 startTime) {
+	const uint32 time = g_system->getMillis() - startTime;
+	marker->_steps++;
+	marker->_longestStep = MAX(marker->_longestStep, time);
+	marker->_time += time;
+}
+
+bool run_gc_step(EngineState *s) {
+	SegManager *segMan = s->_segMan;
+	IncrementalMarker *marker = segMan->getGCMarker();
+	const uint32 startTime = g_system->getMillis();
+
+	if (!marker) {
+		debugC(kDebugLevelGC, "[GC] Starting incremental collection...");
+		marker = new IncrementalMarker();
+		addRoots(s, *marker);
+		segMan->setGCMarker(marker);
+		endStep(marker, startTime);
+		return false;
+	}
+
+	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
+	marker->_scanned += processWorkList(segMan, *marker, heap, GC_STEP_OBJECTS, true);
+	if (!marker->_worklist.empty()) {
+		endStep(marker, startTime);
+		return false;
+	}
+
+	// Whatever was reachable from the heap is marked now, thanks to the
+	// write barrier. The roots are not behind it, so they are scanned
+	// again, and what they reach is marked in this last step.
+	addRoots(s, *marker);
+	marker->_scanned += processWorkList(segMan, *marker, heap, 0xFFFFFFFF, true);
+
+	if (g_sci->_gfxPorts)
+		g_sci->_gfxPorts->processEngineHunkList(*marker);
+
+	segMan->setGCMarker(nullptr);
+
+	AddrSet *activeRefs = normalizeAddresses(segMan, marker->_map);
+	const uint freed = sweep(segMan, *activeRefs, marker->_newSegments);
+	delete activeRefs;
+
+	endStep(marker, startTime);
+	debugC(kDebugLevelGC, "[GC] Incremental collection done in %d steps", marker->_steps);
+
+	addStatistics(s->gcStatistics, marker->_longestStep, marker->_time, marker->_scanned, freed);
+	s->gcStatistics.incrementalCollections++;
+
+	delete marker;
+	return true;
+}
+
+void abort_gc(SegManager *segMan) {
+	IncrementalMarker *marker = segMan->getGCMarker();
+	if (marker) {
+		debugC(kDebugLevelGC, "[GC] Aborting incremental collection");
+		segMan->setGCMarker(nullptr);
+		delete marker;
+	}
 }
 
 } // End of namespace Sci
@@ -44,9 +44,10 @@ typedef Common::HashMap<reg_t, bool, reg_t_Hash> AddrSet;
 /**
  * Finds all used references and normalises them to their memory addresses
  * @param s The state to gather all information from
+ * @param scanned If not nullptr, set to the number of scanned objects
  * @return A hash map containing entries for all used references
  */
-AddrSet *findAllActiveReferences(EngineState *s);
+AddrSet *findAllActiveReferences(EngineState *s, uint *scanned = nullptr);
 
 /**
  * Runs garbage collection on the current system state
@@ -54,6 +55,22 @@ AddrSet *findAllActiveReferences(EngineState *s);
  */
 void run_gc(EngineState *s);
 
+/**
+ * Runs a step of an incremental garbage collection: starts a collection if
+ * none is running, else marks up to GC_STEP_OBJECTS objects, or remarks the
+ * roots and frees the unreachable objects once all others are marked.
+ * @param s The state in which we should gc
+ * @return true if the step finished the collection
+ */
+bool run_gc_step(EngineState *s);
+
+/**
+ * Stops an incremental garbage collection, if one is running, without
+ * freeing anything.
+ * @param segMan The segment manager of the collection
+ */
+void abort_gc(SegManager *segMan);
+
 struct WorklistManager {
 	Common::Array<reg_t> _worklist;
 	AddrSet _map;	// used for 2 contains() calls, inside push() and run_gc()
@@ -62,6 +79,23 @@ struct WorklistManager {
 	void pushArray(const Common::Array<reg_t> &tmp);
 };
 
+/**
+ * State of an incremental garbage collection. The objects in the map are
+ * marked, and those in the worklist still have to be scanned. References
+ * stored into the heap in between steps go through
+ * SegManager::gcWriteBarrier(), which marks them as well.
+ */
+struct IncrementalMarker : public WorklistManager {
+	/** Segments allocated since the collection started, which are kept. */
+	Common::Array<SegmentId> _newSegments;
+	uint32 _scanned;	///< Objects scanned so far
+	uint32 _steps;		///< Steps run so far
+	uint32 _longestStep;	///< Longest step so far, in ms
+	uint32 _time;		///< Time spent in all steps so far, in ms
+
+	IncrementalMarker() : _scanned(0), _steps(0), _longestStep(0), _time(0) {}
+};
+
 
 } // End of namespace Sci
 
@@ -209,6 +209,7 @@ static void addToFront(EngineState *s, reg_t listRef, reg_t nodeRef) {
 
 	newNode->pred = NULL_REG;
 	newNode->succ = list->first;
+	s->_segMan->gcWriteBarrier(newNode->succ);
 
 	// Set node to be the first and last node if it's the only node of the list
 	if (list->first.isNull())
@@ -218,6 +219,7 @@ static void addToFront(EngineState *s, reg_t listRef, reg_t nodeRef) {
 		oldNode->pred = nodeRef;
 	}
 	list->first = nodeRef;
+	s->_segMan->gcWriteBarrier(nodeRef);
 }
 
 static void addToEnd(EngineState *s, reg_t listRef, reg_t nodeRef) {
@@ -235,6 +237,7 @@ static void addToEnd(EngineState *s, reg_t listRef, reg_t nodeRef) {
 
 	newNode->pred = list->last;
 	newNode->succ = NULL_REG;
+	s->_segMan->gcWriteBarrier(newNode->pred);
 
 	// Set node to be the first and last node if it's the only node of the list
 	if (list->last.isNull())
@@ -244,6 +247,7 @@ static void addToEnd(EngineState *s, reg_t listRef, reg_t nodeRef) {
 		old_n->succ = nodeRef;
 	}
 	list->last = nodeRef;
+	s->_segMan->gcWriteBarrier(nodeRef);
 }
 
 reg_t kNextNode(EngineState *s, int argc, reg_t *argv) {
@@ -284,8 +288,10 @@ reg_t kNodeValue(EngineState *s, int argc, reg_t *argv) {
 reg_t kAddToFront(EngineState *s, int argc, reg_t *argv) {
 	addToFront(s, argv[0], argv[1]);
 
-	if (argc == 3)
+	if (argc == 3) {
 		s->_segMan->lookupNode(argv[1])->key = argv[2];
+		s->_segMan->gcWriteBarrier(argv[2]);
+	}
 
 	return s->r_acc;
 }
@@ -293,8 +299,10 @@ reg_t kAddToFront(EngineState *s, int argc, reg_t *argv) {
 reg_t kAddToEnd(EngineState *s, int argc, reg_t *argv) {
 	addToEnd(s, argv[0], argv[1]);
 
-	if (argc == 3)
+	if (argc == 3) {
 		s->_segMan->lookupNode(argv[1])->key = argv[2];
+		s->_segMan->gcWriteBarrier(argv[2]);
+	}
 
 	return s->r_acc;
 }
@@ -318,8 +326,10 @@ reg_t kAddAfter(EngineState *s, int argc, reg_t *argv) {
 		return NULL_REG;
 	}
 
-	if (argc == 4)
+	if (argc == 4) {
 		newNode->key = argv[3];
+		s->_segMan->gcWriteBarrier(argv[3]);
+	}
 
 	if (firstNode) { // We're really appending after
 		const reg_t oldNext = firstNode->succ;
@@ -327,6 +337,9 @@ reg_t kAddAfter(EngineState *s, int argc, reg_t *argv) {
 		newNode->pred = argv[1];
 		firstNode->succ = argv[2];
 		newNode->succ = oldNext;
+		s->_segMan->gcWriteBarrier(argv[1]);
+		s->_segMan->gcWriteBarrier(argv[2]);
+		s->_segMan->gcWriteBarrier(oldNext);
 
 		if (oldNext.isNull())  // Appended after last node?
 			// Set new node as last list node
@@ -360,8 +373,10 @@ reg_t kAddBefore(EngineState *s, int argc, reg_t *argv) {
 		return NULL_REG;
 	}
 
-	if (argc == 4)
+	if (argc == 4) {
 		newNode->key = argv[3];
+		s->_segMan->gcWriteBarrier(argv[3]);
+	}
 
 	if (firstNode) { // We're really appending before
 		const reg_t oldPred = firstNode->pred;
@@ -369,6 +384,9 @@ reg_t kAddBefore(EngineState *s, int argc, reg_t *argv) {
 		newNode->succ = argv[1];
 		firstNode->pred = argv[2];
 		newNode->pred = oldPred;
+		s->_segMan->gcWriteBarrier(argv[1]);
+		s->_segMan->gcWriteBarrier(argv[2]);
+		s->_segMan->gcWriteBarrier(oldPred);
 
 		if (oldPred.isNull())  // Appended before first node?
 			// Set new node as first list node
@@ -439,6 +457,8 @@ reg_t kDeleteKey(EngineState *s, int argc, reg_t *argv) {
 		s->_segMan->lookupNode(n->pred)->succ = n->succ;
 	if (!n->succ.isNull())
 		s->_segMan->lookupNode(n->succ)->pred = n->pred;
+	s->_segMan->gcWriteBarrier(n->pred);
+	s->_segMan->gcWriteBarrier(n->succ);
 
 	// Erase references to the predecessor and successor nodes, as the game
 	// scripts could reference the node itself again.
@@ -845,6 +865,8 @@ reg_t kArrayGetElement(EngineState *s, int argc, reg_t *argv) {
 reg_t kArraySetElements(EngineState *s, int argc, reg_t *argv) {
 	SciArray &array = *s->_segMan->lookupArray(argv[0]);
 	array.setElements(argv[1].toUint16(), argc - 2, argv + 2);
+	for (int i = 2; i < argc; ++i)
+		s->_segMan->gcWriteBarrier(argv[i]);
 	return argv[0];
 }
 
@@ -860,6 +882,7 @@ reg_t kArrayFree(EngineState *s, int argc, reg_t *argv) {
 reg_t kArrayFill(EngineState *s, int argc, reg_t *argv) {
 	SciArray &array = *s->_segMan->lookupArray(argv[0]);
 	array.fill(argv[1].toUint16(), argv[2].toUint16(), argv[3]);
+	s->_segMan->gcWriteBarrier(argv[3]);
 	return argv[0];
 }
 
@@ -877,6 +900,13 @@ reg_t kArrayCopy(EngineState *s, int argc, reg_t *argv) {
 		target.copy(source, sourceIndex, targetIndex, count);
 	} else {
 		target.copy(*s->_segMan->lookupArray(argv[2]), sourceIndex, targetIndex, count);
+
+		// Only the copied references need to be marked, but the count
+		// may be -1 for the whole array
+		if (s->_segMan->getGCMarker() && (target.getType() == kArrayTypeID || target.getType() == kArrayTypeInt16)) {
+			for (uint16 i = 0; i < target.size(); ++i)
+				s->_segMan->gcWriteBarrier(target.getAsID(i));
+		}
 	}
 
 	return argv[0];
@@ -75,6 +75,13 @@ enum {
 	PF_FATAL = -2
 };
 
+// Visibility of a vertex from another, as stored in AvoidPathCache
+enum {
+	VIS_UNKNOWN = 0,
+	VIS_VISIBLE = 1,
+	VIS_HIDDEN = 2
+};
+
 // Floating point struct
 struct FloatPoint {
 	FloatPoint() : x(0), y(0) {}
@@ -116,10 +123,14 @@ struct Vertex {
 	// Previous vertex in shortest path
 	Vertex *path_prev;
 
+	// Index of the vertex in the cached polygon set, -1 if not part of it
+	int baseIndex;
+
 public:
 	Vertex(const Common::Point &p) : v(p) {
 		costG = HUGE_DISTANCE;
 		path_prev = nullptr;
+		baseIndex = -1;
 	}
 };
 
@@ -241,11 +252,36 @@ public:
 
 typedef Common::List<Polygon *> PolygonList;
 
+// Bounding box of a polygon, and its vertices in the vertex index
+struct PolygonBounds {
+	Polygon *polygon;
+	int16 left, top, right, bottom;
+	int first, count;
+
+	/**
+	 * Determines whether the bounding box of a line segment, grown by
+	 * margin, overlaps the bounding box of the polygon
+	 */
+	bool overlaps(const Common::Point &a, const Common::Point &b, int margin) const {
+		return MIN(a.x, b.x) - margin <= right && MAX(a.x, b.x) + margin >= left &&
+		       MIN(a.y, b.y) - margin <= bottom && MAX(a.y, b.y) + margin >= top;
+	}
+};
+
 // Pathfinding state
 struct PathfindingState {
 	// List of all polygons
 	PolygonList polygons;
 
+	// Bounding boxes of all polygons, in list order
+	Common::Array<PolygonBounds> polygonBounds;
+
+	// Visibility cache, NULL if the polygons differ from the cached ones
+	AvoidPathCache *_cache;
+
+	// Set when polygons are removed or edges are split after caching
+	bool _polygonsChanged;
+
 	// Start and end points for pathfinding
 	Vertex *vertex_start, *vertex_end;
 
@@ -269,6 +305,8 @@ struct PathfindingState {
 		_prependPoint = nullptr;
 		_appendPoint = nullptr;
 		vertices = 0;
+		_cache = nullptr;
+		_polygonsChanged = false;
 	}
 
 	~PathfindingState() {
@@ -285,6 +323,7 @@ struct PathfindingState {
 	bool pointOnScreenBorder(const Common::Point &p);
 	bool edgeOnScreenBorder(const Common::Point &p, const Common::Point &q);
 	int findNearPoint(const Common::Point &p, Polygon *polygon, Common::Point *ret);
+	void indexPolygons();
 };
 
 static Common::Point readPoint(SegmentRef list_r, int offset) {
@@ -699,42 +738,78 @@ static int inside(const Common::Point &p, Vertex *vertex) {
 }
 
 /**
- * Returns a list of all vertices that are visible from a particular vertex.
+ * Determines whether a vertex is visible from another vertex
  * @param s				the pathfinding state
- * @param vertex_cur	the vertex
- * @return list of vertices that are visible from vert
+ * @param vertex_cur	the vertex to look from
+ * @param vertex		the vertex to look at
+ * @return true if vertex is visible from vertex_cur, false otherwise
  */
-static VertexList *visible_vertices(PathfindingState *s, Vertex *vertex_cur) {
-	VertexList *visVerts = new VertexList();
+static bool is_visible(PathfindingState *s, Vertex *vertex_cur, Vertex *vertex) {
+	// Make sure we don't intersect a polygon locally at the vertices
+	if ((inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
+		return false;
 
-	for (int i = 0; i < s->vertices; i++) {
-		Vertex *vertex = s->vertex_index[i];
+	// Edges and vertices can only obstruct the line when they are within
+	// its bounding box. The exception is a line of length zero, for
+	// which between() accepts every point on the same row.
+	const bool useBounds = (vertex_cur->v != vertex->v);
+
+	// Check for intersecting edges
+	for (uint i = 0; i < s->polygonBounds.size(); i++) {
+		const PolygonBounds &bounds = s->polygonBounds[i];
 
-		// Make sure we don't intersect a polygon locally at the vertices
-		if ((vertex == vertex_cur) || (inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
+		if (useBounds && !bounds.overlaps(vertex_cur->v, vertex->v, 0))
 			continue;
 
-		// Check for intersecting edges
-		int j;
-		for (j = 0; j < s->vertices; j++) {
+		for (int j = bounds.first; j < bounds.first + bounds.count; j++) {
 			Vertex *edge = s->vertex_index[j];
 			if (VERTEX_HAS_EDGES(edge)) {
 				if (between(vertex_cur->v, vertex->v, edge->v)) {
 					// If we hit a vertex, make sure we can pass through it without intersecting its polygon
 					if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
-						break;
+						return false;
 
 					// This edge won't properly intersect, so we continue
 					continue;
 				}
 
 				if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
-					break;
+					return false;
 			}
 		}
+	}
+
+	return true;
+}
+
+/**
+ * Returns a list of all vertices that are visible from a particular vertex.
+ * @param s				the pathfinding state
+ * @param vertex_cur	the vertex
+ * @return list of vertices that are visible from vert
+ */
+static VertexList *visible_vertices(PathfindingState *s, Vertex *vertex_cur) {
+	VertexList *visVerts = new VertexList();
+	AvoidPathCache *cache = (vertex_cur->baseIndex >= 0) ? s->_cache : nullptr;
+
+	for (int i = 0; i < s->vertices; i++) {
+		Vertex *vertex = s->vertex_index[i];
+
+		if (vertex == vertex_cur)
+			continue;
+
+		if (cache && vertex->baseIndex >= 0) {
+			// Both vertices belong to the cached polygon set, whose
+			// edges are the same as the ones of this state
+			byte &visibility = cache->visibility[vertex_cur->baseIndex * cache->vertices + vertex->baseIndex];
+			if (visibility == VIS_UNKNOWN)
+				visibility = is_visible(s, vertex_cur, vertex) ? VIS_VISIBLE : VIS_HIDDEN;
 
-		if (j == s->vertices)
+			if (visibility == VIS_VISIBLE)
+				visVerts->push_front(vertex);
+		} else if (is_visible(s, vertex_cur, vertex)) {
 			visVerts->push_front(vertex);
+		}
 	}
 
 	return visVerts;
@@ -760,6 +835,43 @@ bool PathfindingState::edgeOnScreenBorder(const Common::Point &p, const Common::
 			|| ((p.y == _height - 1) && (q.y == _height - 1)));
 }
 
+/**
+ * Rebuilds the vertex index and the bounding boxes of the polygons
+ */
+void PathfindingState::indexPolygons() {
+	int count = 0;
+	for (PolygonList::iterator it = polygons.begin(); it != polygons.end(); ++it)
+		count += (*it)->vertices.size();
+
+	free(vertex_index);
+	vertex_index = (Vertex **)malloc(sizeof(Vertex *) * MAX(count, 1));
+	polygonBounds.resize(polygons.size());
+
+	count = 0;
+	uint i = 0;
+	for (PolygonList::iterator it = polygons.begin(); it != polygons.end(); ++it, ++i) {
+		PolygonBounds &bounds = polygonBounds[i];
+		Vertex *vertex;
+
+		bounds.polygon = *it;
+		bounds.first = count;
+		bounds.left = bounds.right = (*it)->vertices.first()->v.x;
+		bounds.top = bounds.bottom = (*it)->vertices.first()->v.y;
+
+		CLIST_FOREACH(vertex, &(*it)->vertices) {
+			vertex_index[count++] = vertex;
+			bounds.left = MIN(bounds.left, vertex->v.x);
+			bounds.right = MAX(bounds.right, vertex->v.x);
+			bounds.top = MIN(bounds.top, vertex->v.y);
+			bounds.bottom = MAX(bounds.bottom, vertex->v.y);
+		}
+
+		bounds.count = count - bounds.first;
+	}
+
+	vertices = count;
+}
+
 /**
  * Searches for a nearby point that is not contained in a polygon
  * Parameters: (FloatPoint) f: The pointf to search nearby
@@ -902,8 +1014,13 @@ static int nearest_intersection(PathfindingState *s, const Common::Point &p, con
 	Polygon *ipolygon = nullptr;
 	uint32 dist = HUGE_DISTANCE;
 
-	for (PolygonList::iterator it = s->polygons.begin(); it != s->polygons.end(); ++it) {
-		polygon = *it;
+	for (uint i = 0; i < s->polygonBounds.size(); i++) {
+		// Skip polygons away from the line segment. The intersections
+		// are computed in floating point, so allow for some error.
+		if (p != q && !s->polygonBounds[i].overlaps(p, q, 1))
+			continue;
+
+		polygon = s->polygonBounds[i].polygon;
 		Vertex *vertex;
 
 		CLIST_FOREACH(vertex, &polygon->vertices) {
@@ -982,6 +1099,7 @@ static Common::Point *fixup_start_point(PathfindingState *s, const Common::Point
 			if (cont != CONT_OUTSIDE) {
 				delete *it;
 				it = s->polygons.erase(it);
+				s->_polygonsChanged = true;
 				continue;
 			}
 			break;
@@ -993,6 +1111,7 @@ static Common::Point *fixup_start_point(PathfindingState *s, const Common::Point
 			if ((cont == CONT_INSIDE) && !nearbyPolygon(start, *it)) {
 				delete *it;
 				it = s->polygons.erase(it);
+				s->_polygonsChanged = true;
 				continue;
 			}
 			// Fall through
@@ -1070,6 +1189,7 @@ static Common::Point *fixup_end_point(PathfindingState *s, const Common::Point &
 			if (cont != CONT_OUTSIDE) {
 				delete *it;
 				it = s->polygons.erase(it);
+				s->_polygonsChanged = true;
 				continue;
 			}
 			break;
@@ -1146,6 +1266,7 @@ static Vertex *merge_point(PathfindingState *s, const Common::Point &v) {
 				if (between(vertex->v, next->v, v)) {
 					// Split edge by adding vertex
 					polygon->vertices.insertAfter(vertex, v_new);
+					s->_polygonsChanged = true;
 					return v_new;
 				}
 			}
@@ -1248,6 +1369,44 @@ static void change_polygons_opt_0(PathfindingState *s) {
 	}
 }
 
+/**
+ * Looks up the polygon set in the visibility cache, resetting the cache if
+ * the polygons changed since the last call, and numbers the vertices
+ * accordingly
+ * Parameters: (EngineState *) s: The game state
+ *             (PathfindingState *) pf_s: The pathfinding state
+ */
+static void cache_polygon_set(EngineState *s, PathfindingState *pf_s) {
+	AvoidPathCache &cache = s->_avoidPathCache;
+	Common::Array<int16> polygons;
+	int count = 0;
+
+	for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it) {
+		Polygon *polygon = *it;
+		Vertex *vertex;
+
+		polygons.push_back(polygon->type);
+		polygons.push_back(polygon->vertices.size());
+
+		CLIST_FOREACH(vertex, &polygon->vertices) {
+			vertex->baseIndex = count++;
+			polygons.push_back(vertex->v.x);
+			polygons.push_back(vertex->v.y);
+		}
+	}
+
+	if (polygons != cache.polygons) {
+		debugC(kDebugLevelAvoidPath, "[avoidpath] Polygon set changed, %d vertices", count);
+
+		cache.polygons = polygons;
+		cache.vertices = count;
+		cache.visibility.clear();
+		cache.visibility.resize(count * count);
+	}
+
+	pf_s->_cache = &cache;
+}
+
 /**
  * Converts the SCI input data for pathfinding
  * Parameters: (EngineState *) s: The game state
@@ -1259,9 +1418,7 @@ static void change_polygons_opt_0(PathfindingState *s) {
  *                            NULL otherwise
  */
 static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Common::Point start, Common::Point end, int width, int height, int opt) {
-	SegManager *segMan = s->_segMan;
 	Polygon *polygon;
-	int count = 0;
 	PathfindingState *pf_s = new PathfindingState(width, height);
 
 	// Convert all polygons
@@ -1274,10 +1431,8 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 			// Happens in LB2 floppy - refer to bug #5195
 			polygon = !node->value.isNull() ? convert_polygon(s, node->value) : nullptr;
 
-			if (polygon) {
+			if (polygon)
 				pf_s->polygons.push_back(polygon);
-				count += readSelectorValue(segMan, node->value, SELECTOR(size));
-			}
 
 			node = s->_segMan->lookupNode(node->succ);
 		}
@@ -1286,6 +1441,8 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 	if (opt == 0)
 		change_polygons_opt_0(pf_s);
 
+	cache_polygon_set(s, pf_s);
+
 	Common::Point *new_start = fixup_start_point(pf_s, start);
 
 	if (!new_start) {
@@ -1316,6 +1473,7 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 		// it ASAP. This matches the behavior of SSCI.
 		if (!pf_s->_prependPoint) {
 			// Actor position is OK, find nearest obstacle.
+			pf_s->indexPolygons();
 			int err = nearest_intersection(pf_s, start, *new_end, new_start);
 
 			if (err == PF_FATAL) {
@@ -1346,21 +1504,12 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 	delete new_start;
 	delete new_end;
 
-	// Allocate and build vertex index
-	pf_s->vertex_index = (Vertex**)malloc(sizeof(Vertex *) * (count + 2));
-
-	count = 0;
-
-	for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it) {
-		polygon = *it;
-		Vertex *vertex;
-
-		CLIST_FOREACH(vertex, &polygon->vertices) {
-			pf_s->vertex_index[count++] = vertex;
-		}
-	}
+	// Build vertex index
+	pf_s->indexPolygons();
 
-	pf_s->vertices = count;
+	// The cached visibility only holds for the edges of the cached polygons
+	if (pf_s->_polygonsChanged)
+		pf_s->_cache = nullptr;
 
 	return pf_s;
 }
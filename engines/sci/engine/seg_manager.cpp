@@ -20,6 +20,7 @@
  */
 
 #include "sci/sci.h"
+#include "sci/engine/gc.h"
 #include "sci/engine/seg_manager.h"
 #include "sci/engine/state.h"
 #include "sci/engine/script.h"
@@ -31,7 +32,7 @@ namespace Sci {
 
 
 SegManager::SegManager(ResourceManager *resMan, ScriptPatcher *scriptPatcher)
-	: _resMan(resMan), _scriptPatcher(scriptPatcher) {
+	: _resMan(resMan), _scriptPatcher(scriptPatcher), _gcMarker(nullptr) {
 	_heap.push_back(0);
 
 	_clonesSegId = 0;
@@ -55,6 +56,9 @@ SegManager::~SegManager() {
 }
 
 void SegManager::resetSegMan() {
+	// A running collection knows nothing of the new heap
+	abort_gc(this);
+
 	// Free memory
 	for (uint i = 0; i < _heap.size(); i++) {
 		if (_heap[i])
@@ -125,9 +129,18 @@ SegmentObj *SegManager::allocSegment(SegmentObj *mem, SegmentId *segid) {
 	}
 	_heap[id] = mem;
 
+	// A segment which did not exist when a collection started may have
+	// been written to without being scanned, so it is not swept
+	if (_gcMarker)
+		_gcMarker->_newSegments.push_back(id);
+
 	return mem;
 }
 
+void SegManager::markReference(reg_t value) {
+	_gcMarker->push(value);
+}
+
 Script *SegManager::allocateScript(int script_nr, SegmentId *segid) {
 	// Check if the script already has an allocated segment. If it
 	// does, return that segment.
@@ -464,6 +477,7 @@ reg_t SegManager::allocateHunkEntry(const char *hunk_type, int size) {
 	h->size = size;
 	h->type = hunk_type;
 
+	gcWriteBarrier(addr);
 	return addr;
 }
 
@@ -490,6 +504,7 @@ Clone *SegManager::allocateClone(reg_t *addr) {
 	offset = table->allocEntry();
 
 	*addr = make_reg(_clonesSegId, offset);
+	gcWriteBarrier(*addr);
 	return &table->at(offset);
 }
 
@@ -504,6 +519,7 @@ List *SegManager::allocateList(reg_t *addr) {
 	offset = table->allocEntry();
 
 	*addr = make_reg(_listsSegId, offset);
+	gcWriteBarrier(*addr);
 	return &table->at(offset);
 }
 
@@ -518,6 +534,7 @@ Node *SegManager::allocateNode(reg_t *addr) {
 	offset = table->allocEntry();
 
 	*addr = make_reg(_nodesSegId, offset);
+	gcWriteBarrier(*addr);
 	return &table->at(offset);
 }
 
@@ -945,6 +962,7 @@ SciArray *SegManager::allocateArray(SciArrayType type, uint16 size, reg_t *addr)
 	offset = table->allocEntry();
 
 	*addr = make_reg(_arraysSegId, offset);
+	gcWriteBarrier(*addr);
 
 	SciArray *array = &table->at(offset);
 	array->setType(type);
@@ -1001,6 +1019,7 @@ SciBitmap *SegManager::allocateBitmap(reg_t *addr, const int16 width, const int1
 	offset = table->allocEntry();
 
 	*addr = make_reg(_bitmapSegId, offset);
+	gcWriteBarrier(*addr);
 	SciBitmap &bitmap = table->at(offset);
 
 	bitmap.create(width, height, skipColor, originX, originY, xResolution, yResolution, paletteSize, remap, gc);
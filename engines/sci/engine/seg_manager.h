@@ -44,6 +44,7 @@ enum ScriptLoadType {
 };
 
 class Script;
+struct IncrementalMarker;
 
 class SegManager : public Common::Serializable {
 	friend class Console;
@@ -462,8 +463,28 @@ public:
 
 	const Common::Array<SegmentObj *> &getSegments() const { return _heap; }
 
+	/**
+	 * Returns the state of the running incremental garbage collection, or
+	 * nullptr if there is none. See run_gc_step().
+	 */
+	IncrementalMarker *getGCMarker() const { return _gcMarker; }
+	void setGCMarker(IncrementalMarker *marker) { _gcMarker = marker; }
+
+	/**
+	 * Write barrier of the incremental garbage collector. Must be called
+	 * with every reference stored into a heap object, so that the object it
+	 * points to is marked even if the one written to was already scanned.
+	 */
+	void gcWriteBarrier(reg_t value) {
+		if (_gcMarker && value.getSegment())
+			markReference(value);
+	}
+
 private:
+	void markReference(reg_t value);
+
 	Common::Array<SegmentObj *> _heap;
+	IncrementalMarker *_gcMarker;
 	Common::Array<Class> _classTable; /**< Table of all classes */
 	/** Map script ids to segment ids. */
 	Common::HashMap<int, SegmentId> _scriptSegMap;
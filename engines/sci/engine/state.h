@@ -97,6 +97,47 @@ struct SciCallOrigin {
 	}
 };
 
+/**
+ * The polygons converted by the last kAvoidPath call, and the visibility
+ * between their vertices found so far. See kpathing.cpp.
+ */
+struct AvoidPathCache {
+	/** Type, number of vertices and vertices of every polygon. */
+	Common::Array<int16> polygons;
+	/** Total number of vertices. */
+	uint vertices;
+	/** Visibility of every vertex from every vertex, row by row. */
+	Common::Array<byte> visibility;
+
+	AvoidPathCache() : vertices(0) {}
+};
+
+/**
+ * Statistics of the garbage collections, shown by the gc_stats console
+ * command. Pauses are the longest time the scripts were stopped by one
+ * collection, which is its longest step for an incremental one.
+ */
+struct GCStatistics {
+	uint32 collections;
+	uint32 incrementalCollections;
+	uint32 lastPause;	///< In ms
+	uint32 maxPause;	///< In ms
+	uint32 totalTime;	///< In ms
+	uint32 lastScanned;
+	uint32 lastFreed;
+	uint64 totalScanned;
+	uint64 totalFreed;
+
+	GCStatistics() { reset(); }
+
+	void reset() {
+		collections = incrementalCollections = 0;
+		lastPause = maxPause = totalTime = 0;
+		lastScanned = lastFreed = 0;
+		totalScanned = totalFreed = 0;
+	}
+};
+
 struct EngineState : public Common::Serializable {
 public:
 	EngineState(SegManager *segMan);
@@ -142,6 +183,8 @@ public:
 
 	uint _chosenQfGImportItem; // Remembers the item selected in QfG import rooms
 
+	AvoidPathCache _avoidPathCache; // see kpathing.cpp / kAvoidPath
+
 	bool _cursorWorkaroundActive; // Refer to GfxCursor::setPosition()
 	int16 _cursorWorkaroundPosCount; // When the cursor is reported to be at the previously set coordinate, we won't disable the workaround unless it happened for this many times
 	Common::Point _cursorWorkaroundPoint;
@@ -194,6 +237,8 @@ public:
 	void shrinkStackToBase();
 
 	int gcCountDown; /**< Number of kernel calls until next gc */
+	bool gcIncremental; /**< Whether gcs are spread over kernel calls */
+	GCStatistics gcStatistics;
 
 	MessageState *_msgState;
 
@@ -188,6 +188,11 @@ enum {
 	GC_INTERVAL = 0x8000
 };
 
+/** Number of objects marked by each step of an incremental gc */
+enum {
+	GC_STEP_OBJECTS = 256
+};
+
 enum SciOpcodes {
 	op_bnot     = 0x00,	// 000
 	op_add      = 0x01,	// 001
@@ -20,6 +20,7 @@
  */
 
 #include "sci/resource/resource.h"
+#include "sci/console.h"
 #include "sci/engine/features.h"
 #include "sci/engine/seg_manager.h"
 #include "sci/engine/state.h"
@@ -81,9 +82,79 @@ const CelScalerTable &CelScaler::getScalerTable(const Ratio &scaleX, const Ratio
 	return _scaleTables[_activeIndex];
 }
 
+#pragma mark -
+#pragma mark ScaledCelCache
+
+ScaledCelCache::ScaledCelCache(const uint32 maxSize) :
+	_size(0),
+	_maxSize(maxSize),
+	_nextId(1),
+	_hits(0),
+	_misses(0),
+	_evictions(0) {}
+
+ScaledCelCache::~ScaledCelCache() {
+	clear();
+}
+
+const ScaledCel *ScaledCelCache::find(const ScaledCelKey &key) {
+	CelMap::iterator it = _cels.find(key);
+	if (it == _cels.end()) {
+		++_misses;
+		return nullptr;
+	}
+
+	++_hits;
+	it->_value->lastUsed = _nextId++;
+	return it->_value;
+}
+
+const ScaledCel *ScaledCelCache::insert(const ScaledCelKey &key, ScaledCel *cel) {
+	const uint32 size = cel->pixels.size();
+	while (!_cels.empty() && _size + size > _maxSize) {
+		removeLeastRecentlyUsed();
+	}
+
+	cel->lastUsed = _nextId++;
+	_cels[key] = cel;
+	_size += size;
+	return cel;
+}
+
+void ScaledCelCache::removeLeastRecentlyUsed() {
+	CelMap::iterator oldest = _cels.begin();
+	for (CelMap::iterator it = _cels.begin(); it != _cels.end(); ++it) {
+		if (it->_value->lastUsed < oldest->_value->lastUsed) {
+			oldest = it;
+		}
+	}
+
+	_size -= oldest->_value->pixels.size();
+	delete oldest->_value;
+	_cels.erase(oldest);
+	++_evictions;
+}
+
+void ScaledCelCache::clear() {
+	for (CelMap::iterator it = _cels.begin(); it != _cels.end(); ++it) {
+		delete it->_value;
+	}
+	_cels.clear();
+	_size = 0;
+	_hits = _misses = _evictions = 0;
+}
+
+void ScaledCelCache::printStats(Console *con) const {
+	const uint32 lookups = _hits + _misses;
+	con->debugPrintf("Scaled cels: %u, %u of %u KB\n", _cels.size(), _size / 1024, _maxSize / 1024);
+	con->debugPrintf("Hits: %u, misses: %u (%u%% hits), evictions: %u\n",
+		_hits, _misses, lookups ? (uint32)((uint64)_hits * 100 / lookups) : 0, _evictions);
+}
+
 #pragma mark -
 #pragma mark CelObj
 bool CelObj::_drawBlackLines = false;
+ScaledCelCache *CelObj::_scaledCache = nullptr;
 
 void CelObj::init() {
 	CelObj::deinit();
@@ -91,6 +162,7 @@ void CelObj::init() {
 	_nextCacheId = 1;
 	_scaler = new CelScaler();
 	_cache = new CelCache(100);
+	_scaledCache = new ScaledCelCache(kScaledCelCacheSize);
 }
 
 void CelObj::deinit() {
@@ -98,6 +170,8 @@ void CelObj::deinit() {
 	_scaler = nullptr;
 	delete _cache;
 	_cache = nullptr;
+	delete _scaledCache;
+	_scaledCache = nullptr;
 }
 
 #pragma mark -
@@ -311,6 +385,29 @@ int16 SCALER_Scale<FLIP, READER>::_valuesX[kCelScalerTableSize];
 template<bool FLIP, typename READER>
 int16 SCALER_Scale<FLIP, READER>::_valuesY[kCelScalerTableSize];
 
+/**
+ * Reads the pixels of a cel already scaled into the scaled cel cache.
+ */
+struct SCALER_Cached {
+	const ScaledCel &_cel;
+	const Common::Point _position;
+	const byte *_row;
+
+	SCALER_Cached(const ScaledCel &cel, const Common::Point &scaledPosition) :
+	_cel(cel),
+	_position(scaledPosition),
+	_row(nullptr) {}
+
+	inline void setTarget(const int16 x, const int16 y) {
+		assert(x >= _position.x && x < _position.x + _cel.width);
+		_row = &_cel.pixels[(y - _position.y) * _cel.width + x - _position.x];
+	}
+
+	inline byte read() {
+		return *_row++;
+	}
+};
+
 #pragma mark -
 #pragma mark CelObj - Resource readers
 
@@ -346,6 +443,16 @@ public:
 		assert(y >= 0 && y < _sourceHeight);
 		return _pixels + y * _sourceWidth;
 	}
+
+	/**
+	 * Returns whether every row of the cel can be read, which is not the case
+	 * for truncated cels.
+	 */
+	static bool canReadAllRows(const CelObj &celObj) {
+		const SciSpan<const byte> resource = celObj.getResPointer();
+		const uint32 pixelsOffset = resource.getUint32SEAt(celObj._celHeaderOffset + 24);
+		return pixelsOffset <= resource.size() && resource.size() - pixelsOffset >= (uint32)(celObj._width * celObj._height);
+	}
 };
 
 struct READER_Compressed {
@@ -432,6 +539,10 @@ public:
 
 		return _buffer;
 	}
+
+	static bool canReadAllRows(const CelObj &) {
+		return true;
+	}
 };
 
 #pragma mark -
@@ -790,6 +901,107 @@ void CelObj::render(Buffer &target, const Common::Rect &targetRect, const Common
 	}
 }
 
+template<typename MAPPER, typename READER>
+bool CelObj::renderCached(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition, const Ratio &scaleX, const Ratio &scaleY) const {
+	// The bitmaps of memory cels may change without changing their CelInfo32
+	if (_info.type != kCelTypeView && _info.type != kCelTypePic) {
+		return false;
+	}
+
+	// LarryScale scales cels to their target rect instead of following the
+	// scaler tables, see SCALER_Scale
+	if (Common::checkGameGUIOption(GAMEOPTION_LARRYSCALE, ConfMan.get("guioptions")) && ConfMan.getBool("enable_larryscale")) {
+		return false;
+	}
+
+	ScaledCelKey key;
+	key.info = _info;
+	key.scaleX = scaleX;
+	key.scaleY = scaleY;
+	key.mirrorX = _drawMirrored;
+	key.phaseX = 0;
+	key.phaseY = 0;
+
+	// With global scaling, the source pixels depend on the position of the
+	// cel modulo the numerators of the ratios, since the scaler tables repeat
+	// themselves with these periods
+	const bool useGlobalScaling = g_sci->_gfxFrameout->getScriptWidth() == kLowResX;
+	if (useGlobalScaling) {
+		if (scaledPosition.x < 0 || scaledPosition.y < 0 ||
+			scaleX.getNumerator() >= kCelScalerTableSize || scaleY.getNumerator() >= kCelScalerTableSize) {
+			return false;
+		}
+		key.phaseX = scaledPosition.x % scaleX.getNumerator();
+		key.phaseY = scaledPosition.y % scaleY.getNumerator();
+	}
+
+	const ScaledCel *cel = _scaledCache->find(key);
+	if (cel == nullptr) {
+		if (!READER::canReadAllRows(*this)) {
+			return false;
+		}
+		cel = _scaledCache->insert(key, scaleToCache<READER>(key));
+	}
+
+	if (targetRect.left < scaledPosition.x || targetRect.right > scaledPosition.x + cel->width ||
+		targetRect.top < scaledPosition.y || targetRect.bottom > scaledPosition.y + cel->height) {
+		return false;
+	}
+
+	MAPPER mapper;
+	SCALER_Cached scaler(*cel, scaledPosition);
+	if (_drawBlackLines) {
+		RENDERER<MAPPER, SCALER_Cached, true> renderer(mapper, scaler, _skipColor, _isMacSource);
+		renderer.draw(target, targetRect, scaledPosition);
+	} else {
+		RENDERER<MAPPER, SCALER_Cached, false> renderer(mapper, scaler, _skipColor, _isMacSource);
+		renderer.draw(target, targetRect, scaledPosition);
+	}
+
+	return true;
+}
+
+template<typename READER>
+ScaledCel *CelObj::scaleToCache(const ScaledCelKey &key) const {
+	// These are the source columns and rows read by SCALER_Scale, relative to
+	// the scaled position of the cel
+	const CelScalerTable &table = _scaler->getScalerTable(key.scaleX, key.scaleY);
+
+	Common::Array<int16> columns;
+	for (int x = key.phaseX; x < kCelScalerTableSize; ++x) {
+		const int column = table.valuesX[x] - table.valuesX[key.phaseX];
+		if (column >= _width) {
+			break;
+		}
+		columns.push_back(key.mirrorX ? _width - 1 - column : column);
+	}
+
+	Common::Array<int16> rows;
+	for (int y = key.phaseY; y < kCelScalerTableSize; ++y) {
+		const int row = table.valuesY[y] - table.valuesY[key.phaseY];
+		if (row >= _height) {
+			break;
+		}
+		rows.push_back(row);
+	}
+
+	ScaledCel *cel = new ScaledCel();
+	cel->width = columns.size();
+	cel->height = rows.size();
+	cel->pixels.resize(cel->width * cel->height);
+
+	READER reader(*this, _width);
+	byte *pixel = cel->pixels.data();
+	for (uint y = 0; y < rows.size(); ++y) {
+		const byte *source = reader.getRow(rows[y]);
+		for (uint x = 0; x < columns.size(); ++x) {
+			*pixel++ = source[columns[x]];
+		}
+	}
+
+	return cel;
+}
+
 void CelObj::drawHzFlip(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const {
 	render<MAPPER_NoMap, SCALER_NoScale<true, READER_Compressed> >(target, targetRect, scaledPosition);
 }
@@ -807,6 +1019,10 @@ void CelObj::drawUncompHzFlip(Buffer &target, const Common::Rect &targetRect, co
 }
 
 void CelObj::scaleDraw(Buffer &target, const Ratio &scaleX, const Ratio &scaleY, const Common::Rect &targetRect, const Common::Point &scaledPosition) const {
+	if (renderCached<MAPPER_NoMap, READER_Compressed>(target, targetRect, scaledPosition, scaleX, scaleY)) {
+		return;
+	}
+
 	if (_drawMirrored) {
 		render<MAPPER_NoMap, SCALER_Scale<true, READER_Compressed> >(target, targetRect, scaledPosition, scaleX, scaleY);
 	} else {
@@ -815,6 +1031,10 @@ void CelObj::scaleDraw(Buffer &target, const Ratio &scaleX, const Ratio &scaleY,
 }
 
 void CelObj::scaleDrawUncomp(Buffer &target, const Ratio &scaleX, const Ratio &scaleY, const Common::Rect &targetRect, const Common::Point &scaledPosition) const {
+	if (renderCached<MAPPER_NoMap, READER_Uncompressed>(target, targetRect, scaledPosition, scaleX, scaleY)) {
+		return;
+	}
+
 	if (_drawMirrored) {
 		render<MAPPER_NoMap, SCALER_Scale<true, READER_Uncompressed> >(target, targetRect, scaledPosition, scaleX, scaleY);
 	} else {
@@ -839,6 +1059,10 @@ void CelObj::drawUncompHzFlipMap(Buffer &target, const Common::Rect &targetRect,
 }
 
 void CelObj::scaleDrawMap(Buffer &target, const Ratio &scaleX, const Ratio &scaleY, const Common::Rect &targetRect, const Common::Point &scaledPosition) const {
+	if (renderCached<MAPPER_Map, READER_Compressed>(target, targetRect, scaledPosition, scaleX, scaleY)) {
+		return;
+	}
+
 	if (_drawMirrored) {
 		render<MAPPER_Map, SCALER_Scale<true, READER_Compressed> >(target, targetRect, scaledPosition, scaleX, scaleY);
 	} else {
@@ -847,6 +1071,10 @@ void CelObj::scaleDrawMap(Buffer &target, const Ratio &scaleX, const Ratio &scal
 }
 
 void CelObj::scaleDrawUncompMap(Buffer &target, const Ratio &scaleX, const Ratio &scaleY, const Common::Rect &targetRect, const Common::Point &scaledPosition) const {
+	if (renderCached<MAPPER_Map, READER_Uncompressed>(target, targetRect, scaledPosition, scaleX, scaleY)) {
+		return;
+	}
+
 	if (_drawMirrored) {
 		render<MAPPER_Map, SCALER_Scale<true, READER_Uncompressed> >(target, targetRect, scaledPosition, scaleX, scaleY);
 	} else {
@@ -886,6 +1114,10 @@ void CelObj::scaleDrawNoMD(Buffer &target, const Ratio &scaleX, const Ratio &sca
 		return;
 	}
 
+	if (renderCached<MAPPER_NoMD, READER_Compressed>(target, targetRect, scaledPosition, scaleX, scaleY)) {
+		return;
+	}
+
 	if (_drawMirrored)
 		render<MAPPER_NoMD, SCALER_Scale<true, READER_Compressed> >(target, targetRect, scaledPosition, scaleX, scaleY);
 	else
@@ -900,6 +1132,10 @@ void CelObj::scaleDrawUncompNoMD(Buffer &target, const Ratio &scaleX, const Rati
 		return;
 	}
 
+	if (renderCached<MAPPER_NoMD, READER_Uncompressed>(target, targetRect, scaledPosition, scaleX, scaleY)) {
+		return;
+	}
+
 	if (_drawMirrored) {
 		render<MAPPER_NoMD, SCALER_Scale<true, READER_Uncompressed> >(target, targetRect, scaledPosition, scaleX, scaleY);
 	} else {
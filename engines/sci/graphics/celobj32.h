@@ -22,6 +22,8 @@
 #ifndef SCI_GRAPHICS_CELOBJ32_H
 #define SCI_GRAPHICS_CELOBJ32_H
 
+#include "common/array.h"
+#include "common/hashmap.h"
 #include "common/rational.h"
 #include "common/rect.h"
 #include "sci/resource/resource.h"
@@ -105,7 +107,7 @@ struct CelInfo32 {
 
 	// This is the equivalence criteria used by CelObj::searchCache in at least
 	// SSCI SQ6. Notably, it does not check the color field.
-	inline bool operator==(const CelInfo32 &other) {
+	inline bool operator==(const CelInfo32 &other) const {
 		return (
 			type == other.type &&
 			resourceId == other.resourceId &&
@@ -115,7 +117,7 @@ struct CelInfo32 {
 		);
 	}
 
-	inline bool operator!=(const CelInfo32 &other) {
+	inline bool operator!=(const CelInfo32 &other) const {
 		return !(*this == other);
 	}
 
@@ -234,6 +236,120 @@ public:
 	const CelScalerTable &getScalerTable(const Ratio &scaleX, const Ratio &scaleY);
 };
 
+#pragma mark -
+#pragma mark ScaledCelCache
+
+enum {
+	/**
+	 * The maximum size in bytes of the bitmaps in the scaled cel cache.
+	 */
+	kScaledCelCacheSize = 8 * 1024 * 1024
+};
+
+/**
+ * The identifying information of a scaled cel bitmap.
+ */
+struct ScaledCelKey {
+	CelInfo32 info;
+	Ratio scaleX, scaleY;
+	bool mirrorX;
+
+	/**
+	 * The position of the cel in the global scaling pattern, modulo the
+	 * numerators of the ratios, or 0 in games without global scaling.
+	 *
+	 * @see SCALER_Scale
+	 */
+	int16 phaseX, phaseY;
+};
+
+struct ScaledCelKey_Hash {
+	uint operator()(const ScaledCelKey &key) const {
+		uint hash = (uint)key.info.type ^ ((uint)key.info.resourceId << 4) ^
+			((uint)(uint16)key.info.loopNo << 20) ^ ((uint)(uint16)key.info.celNo << 8);
+		hash ^= (uint)key.scaleX.getNumerator() * 31 + (uint)key.scaleY.getNumerator() * 37;
+		hash ^= ((uint)key.phaseX << 16) ^ (uint)key.phaseY ^ (key.mirrorX ? 0x80000000 : 0);
+		return hash;
+	}
+};
+
+struct ScaledCelKey_EqualTo {
+	bool operator()(const ScaledCelKey &a, const ScaledCelKey &b) const {
+		return a.info == b.info &&
+			a.scaleX == b.scaleX && a.scaleY == b.scaleY &&
+			a.mirrorX == b.mirrorX &&
+			a.phaseX == b.phaseX && a.phaseY == b.phaseY;
+	}
+};
+
+/**
+ * A cel decompressed, scaled and mirrored, at the origin of its scaled
+ * position. The pixels are those of the resource, before any skip color,
+ * remapping or Mac palette translation, so that the bitmap stays valid
+ * across palette and remap changes.
+ */
+struct ScaledCel {
+	uint16 width, height;
+	Common::Array<byte> pixels;
+
+	/**
+	 * The cache ID of the last use of the bitmap, used to identify the least
+	 * recently used bitmap in the cache for replacement.
+	 */
+	uint32 lastUsed;
+};
+
+class Console;
+
+/**
+ * A size bounded cache of the scaled cels drawn by CelObj, so that scaled
+ * cels drawn every frame are not decompressed and scaled again every time.
+ * Only cels from view and pic resources are cached, since the bitmaps of
+ * memory cels may be changed by the game scripts.
+ */
+class ScaledCelCache {
+public:
+	ScaledCelCache(const uint32 maxSize);
+	~ScaledCelCache();
+
+	/**
+	 * Returns the cached bitmap for the given key, or null if there is none.
+	 */
+	const ScaledCel *find(const ScaledCelKey &key);
+
+	/**
+	 * Puts a bitmap into the cache, replacing the least recently used ones
+	 * until the cache fits into its maximum size. The cache takes ownership
+	 * of the bitmap.
+	 */
+	const ScaledCel *insert(const ScaledCelKey &key, ScaledCel *cel);
+
+	/**
+	 * Removes all bitmaps from the cache and resets the counters.
+	 */
+	void clear();
+
+	/**
+	 * Prints the state and hit rate of the cache to the debugger console.
+	 */
+	void printStats(Console *con) const;
+
+private:
+	typedef Common::HashMap<ScaledCelKey, ScaledCel *, ScaledCelKey_Hash, ScaledCelKey_EqualTo> CelMap;
+
+	void removeLeastRecentlyUsed();
+
+	CelMap _cels;
+
+	/**
+	 * The size in bytes of the cached bitmaps, and its upper bound.
+	 */
+	uint32 _size, _maxSize;
+
+	uint32 _nextId;
+	uint32 _hits, _misses, _evictions;
+};
+
 #pragma mark -
 #pragma mark CelObj
 
@@ -265,6 +381,11 @@ protected:
 public:
 	static CelScaler *_scaler;
 
+	/**
+	 * The cache of scaled cels drawn by the scaling draw methods.
+	 */
+	static ScaledCelCache *_scaledCache;
+
 	/**
 	 * The basic identifying information for this cel. This information
 	 * effectively acts as a composite key for a cel object, and any cel object
@@ -423,6 +544,17 @@ private:
 	template<typename MAPPER, typename SCALER>
 	void render(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition, const Ratio &scaleX, const Ratio &scaleY) const;
 
+	/**
+	 * Draws the cel from its bitmap in the scaled cel cache, scaling it into
+	 * the cache first if needed. Returns false without drawing anything if
+	 * the cel cannot be drawn from the cache.
+	 */
+	template<typename MAPPER, typename READER>
+	bool renderCached(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition, const Ratio &scaleX, const Ratio &scaleY) const;
+
+	template<typename READER>
+	ScaledCel *scaleToCache(const ScaledCelKey &key) const;
+
 	void drawHzFlip(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const;
 	void drawNoFlip(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const;
 	void drawUncompNoFlip(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const;
@@ -73,6 +73,7 @@ ScummDebugger::ScummDebugger(ScummEngine *s)
 	registerCmd("matrix",    WRAP_METHOD(ScummDebugger, Cmd_PrintBoxMatrix));
 	registerCmd("camera",    WRAP_METHOD(ScummDebugger, Cmd_Camera));
 	registerCmd("room",      WRAP_METHOD(ScummDebugger, Cmd_Room));
+	registerCmd("decoderooms", WRAP_METHOD(ScummDebugger, Cmd_DecodeRooms));
 	registerCmd("objects",   WRAP_METHOD(ScummDebugger, Cmd_PrintObjects));
 	registerCmd("object",    WRAP_METHOD(ScummDebugger, Cmd_Object));
 	registerCmd("script",    WRAP_METHOD(ScummDebugger, Cmd_Script));
@@ -374,6 +375,77 @@ bool ScummDebugger::Cmd_Room(int argc, const char **argv) {
 	}
 }
 
+bool ScummDebugger::Cmd_DecodeRooms(int argc, const char **argv) {
+	if (_vm->_game.version < 4 || (_vm->_game.features & GF_16COLOR) || _vm->_game.platform == Common::kPlatformPCEngine) {
+		debugPrintf("The room backgrounds of this game use no codec ids\n");
+		return true;
+	}
+
+	const int passes = (argc > 1) ? atoi(argv[1]) : 10;
+	if (passes <= 0) {
+		debugPrintf("Usage: decoderooms [<passes>]\n");
+		return true;
+	}
+
+	Gdi::StripStats stats[256];
+	memset(stats, 0, sizeof(stats));
+	int numRooms = 0;
+
+	for (int room = 1; room < _vm->_numRooms; room++) {
+		if (_vm->_res->_types[rtRoom][room]._roomoffs == RES_INVALID_OFFSET)
+			continue;
+
+		const byte *roomptr = _vm->getResourceAddress(rtRoom, room);
+		if (!roomptr)
+			continue;
+
+		const RoomHeader *rmhd = (const RoomHeader *)_vm->findResourceData(MKTAG('R','M','H','D'), roomptr);
+		if (!rmhd)
+			continue;
+
+		int width, height;
+		if (_vm->_game.version == 8) {
+			width = READ_LE_UINT32(&(rmhd->v8.width));
+			height = READ_LE_UINT32(&(rmhd->v8.height));
+		} else if (_vm->_game.version == 7) {
+			width = READ_LE_UINT16(&(rmhd->v7.width));
+			height = READ_LE_UINT16(&(rmhd->v7.height));
+		} else {
+			width = READ_LE_UINT16(&(rmhd->old.width));
+			height = READ_LE_UINT16(&(rmhd->old.height));
+		}
+
+		// As in ScummEngine::setupRoomSubBlocks() and Gdi::drawBitmap()
+		const byte *smap_ptr;
+		if (_vm->_game.version == 8) {
+			smap_ptr = _vm->getObjectImage(roomptr, 1);
+		} else if (_vm->_game.features & GF_SMALL_HEADER) {
+			smap_ptr = _vm->findResourceData(MKTAG('I','M','0','0'), roomptr);
+		} else {
+			const byte *imagePtr = (_vm->_game.heversion >= 70) ? _vm->getResourceAddress(rtRoomImage, room) : _vm->findResource(MKTAG('R','M','I','M'), roomptr);
+			if (imagePtr)
+				imagePtr = _vm->findResource(MKTAG('I','M','0','0'), imagePtr);
+			// Newer HE games may use a BMAP instead, which is not made of strips
+			smap_ptr = imagePtr ? _vm->findResource(MKTAG('S','M','A','P'), imagePtr) : nullptr;
+		}
+		if (!smap_ptr || width < 8 || height <= 0)
+			continue;
+
+		_vm->_gdi->benchmarkStrips(smap_ptr, width / 8, height, passes, stats);
+		numRooms++;
+	}
+
+	debugPrintf("Decoded the backgrounds of %d rooms %d times\n", numRooms, passes);
+	for (int code = 0; code < 256; code++) {
+		if (!stats[code].strips)
+			continue;
+		debugPrintf("Codec %3d: %7u strips, %6u ms, %.2f us per strip\n", code, stats[code].strips, stats[code].millis,
+		            stats[code].millis * 1000.0 / stats[code].strips);
+	}
+
+	return true;
+}
+
 bool ScummDebugger::Cmd_LoadGame(int argc, const char **argv) {
 	if (argc > 1) {
 		int slot = atoi(argv[1]);
@@ -42,6 +42,7 @@ private:
 
 	// Commands
 	bool Cmd_Room(int argc, const char **argv);
+	bool Cmd_DecodeRooms(int argc, const char **argv);
 	bool Cmd_LoadGame(int argc, const char **argv);
 	bool Cmd_SaveGame(int argc, const char **argv);
 	bool Cmd_Restart(int argc, const char **argv);
@@ -22,6 +22,7 @@
 #include "common/system.h"
 #include "scumm/actor.h"
 #include "scumm/charset.h"
+#include "scumm/gfx_compose.h"
 #ifdef ENABLE_HE
 #include "scumm/he/intern_he.h"
 #endif
@@ -205,12 +206,7 @@ Gdi::Gdi(ScummEngine *vm) : _vm(vm) {
 	memset(_imgBufOffs, 0, sizeof(_imgBufOffs));
 	_numStrips = 0;
 
-	_paletteMod = 0;
 	_roomPalette = vm->_roomPalette;
-	_transparentColor = 255;
-	_decomp_shr = 0;
-	_decomp_mask = 0;
-	_vertStripNextInc = 0;
 	_zbufferDisabled = false;
 	_objectMode = false;
 	_distaff = false;
@@ -257,6 +253,7 @@ GdiHE16bit::GdiHE16bit(ScummEngine *vm) : GdiHE(vm) {
 #endif
 
 void Gdi::init() {
+	_bytesPerPixel = _vm->_bytesPerPixel;
 	_numStrips = _vm->_screenWidth / 8;
 
 	// Increase the number of screen strips by one; needed for smooth scrolling
@@ -577,26 +574,45 @@ void ScummEngine::updateDirtyScreen(VirtScreenNumber slot) {
 	if (vs->h == 0)
 		return;
 
-	int i;
-	int w = 8;
-	int start = 0;
-
-	for (i = 0; i < _gdi->_numStrips; i++) {
-		if (vs->bdirty[i]) {
-			const int top = vs->tdirty[i];
-			const int bottom = vs->bdirty[i];
+	// Neighboring dirty strips are copied as one rectangle spanning all of
+	// them, as long as that copies at most twice as many pixels as needed.
+	// Each copy costs a backend call, which is much more than a few pixels.
+	int start = -1;
+	int top = 0, bottom = 0, dirtyArea = 0;
+
+	for (int i = 0; i <= _gdi->_numStrips; i++) {
+		int stripTop = 0, stripBottom = 0;
+		if (i < _gdi->_numStrips && vs->bdirty[i]) {
+			stripTop = vs->tdirty[i];
+			stripBottom = vs->bdirty[i];
 			vs->tdirty[i] = vs->h;
 			vs->bdirty[i] = 0;
-			if (i != (_gdi->_numStrips - 1) && vs->bdirty[i + 1] == bottom && vs->tdirty[i + 1] == top) {
-				// Simple optimizations: if two or more neighboring strips
-				// form one bigger rectangle, coalesce them.
-				w += 8;
+		}
+
+		if (stripBottom <= stripTop) {
+			if (start >= 0)
+				drawStripToScreen(vs, start * 8, (i - start) * 8, top, bottom);
+			start = -1;
+			continue;
+		}
+
+		if (start >= 0) {
+			const int mergedTop = MIN(top, stripTop);
+			const int mergedBottom = MAX(bottom, stripBottom);
+			const int mergedArea = (i + 1 - start) * (mergedBottom - mergedTop);
+			if (mergedArea <= 2 * (dirtyArea + stripBottom - stripTop)) {
+				top = mergedTop;
+				bottom = mergedBottom;
+				dirtyArea += stripBottom - stripTop;
 				continue;
 			}
-			drawStripToScreen(vs, start * 8, w, top, bottom);
-			w = 8;
+			drawStripToScreen(vs, start * 8, (i - start) * 8, top, bottom);
 		}
-		start = i + 1;
+
+		start = i;
+		top = stripTop;
+		bottom = stripBottom;
+		dirtyArea = stripBottom - stripTop;
 	}
 }
 
@@ -673,7 +689,22 @@ void ScummEngine::drawStripToScreen(VirtScreen *vs, int x, int width, int top, i
 		} else
 #endif
 		// Compose the text over the game graphics
-		if (_outputPixelFormat.bytesPerPixel == 2) {
+		if (_outputPixelFormat.bytesPerPixel == 2 && vs->format.bytesPerPixel == 2 && m == 1) {
+			const byte *srcPtr = (const byte *)src;
+			const byte *textPtr = (const byte *)text;
+			byte *dstPtr = _compositeBuf;
+
+			// HE games do not draw to the text surface
+			const uint16 *palette = _game.heversion != 0 ? nullptr : _16BitPalette;
+
+			for (int h = 0; h < height; ++h) {
+				if (!_composeKernels->compose16((uint16 *)dstPtr, (const uint16 *)srcPtr, textPtr, width, palette))
+					error ("16Bit Color HE Game using old charset");
+				srcPtr += vs->pitch;
+				textPtr += _textSurface.pitch;
+				dstPtr += width * 2;
+			}
+		} else if (_outputPixelFormat.bytesPerPixel == 2) {
 			const byte *srcPtr = (const byte *)src;
 			const byte *textPtr = (byte *)_textSurface.getBasePtr(x * m, y * m);
 			byte *dstPtr = _compositeBuf;
@@ -698,35 +729,15 @@ void ScummEngine::drawStripToScreen(VirtScreen *vs, int x, int width, int top, i
 #ifdef USE_ARM_GFX_ASM
 			asmDrawStripToScreen(height, width, text, src, _compositeBuf, vs->pitch, width, _textSurface.pitch);
 #else
-			// We blit four pixels at a time, for improved performance.
-			const uint32 *src32 = (const uint32 *)src;
-			uint32 *dst32 = (uint32 *)_compositeBuf;
-
-			vsPitch >>= 2;
+			const byte *srcPtr = (const byte *)src;
+			const byte *textPtr = (const byte *)text;
+			byte *dstPtr = _compositeBuf;
 
-			const uint32 *text32 = (const uint32 *)text;
-			const int textPitch = (_textSurface.pitch - width * m) >> 2;
 			for (int h = height * m; h > 0; --h) {
-				for (int w = width * m; w > 0; w -= 4) {
-					uint32 temp = *text32++;
-
-					// Generate a byte mask for those text pixels (bytes) with
-					// value CHARSET_MASK_TRANSPARENCY. In the end, each byte
-					// in mask will be either equal to 0x00 or 0xFF.
-					// Doing it this way avoids branches and bytewise operations,
-					// at the cost of readability ;).
-					uint32 mask = temp ^ CHARSET_MASK_TRANSPARENCY_32;
-					mask = (((mask & 0x7f7f7f7f) + 0x7f7f7f7f) | mask) & 0x80808080;
-					mask = ((mask >> 7) + 0x7f7f7f7f) ^ 0x80808080;
-
-					// The following line is equivalent to this code:
-					//   *dst32++ = (*src32++ & mask) | (temp & ~mask);
-					// However, some compilers can generate somewhat better
-					// machine code for this equivalent statement:
-					*dst32++ = ((temp ^ *src32++) & mask) ^ temp;
-				}
-				src32 += vsPitch;
-				text32 += textPitch;
+				_composeKernels->composeCLUT8(dstPtr, srcPtr, textPtr, width * m);
+				srcPtr += width * m + vsPitch;
+				textPtr += _textSurface.pitch;
+				dstPtr += width * m;
 			}
 #endif
 		}
@@ -1918,8 +1929,7 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 	}
 }
 
-bool Gdi::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width, const int height,
-					int stripnr, const byte *smap_ptr) {
+const byte *Gdi::getStripPtr(const byte *smap_ptr, int stripnr) const {
 	// Do some input verification and make sure the strip/strip offset
 	// are actually valid. Normally, this should never be a problem,
 	// but if e.g. a savegame gets corrupted, we can easily get into
@@ -1947,6 +1957,13 @@ bool Gdi::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width,
 	}
 	assertRange(0, offset, smapLen-1, "screen strip");
 
+	return smap_ptr + offset;
+}
+
+bool Gdi::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width, const int height,
+					int stripnr, const byte *smap_ptr) {
+	const byte *src = getStripPtr(smap_ptr, stripnr);
+
 	// Indy4 Amiga always uses the room or verb palette map to match colors to
 	// the currently setup palette, thus we need to select it over here too.
 	// Done like the original interpreter.
@@ -1957,7 +1974,34 @@ bool Gdi::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width,
 			_roomPalette = _vm->_roomPalette;
 	}
 
-	return decompressBitmap(dstPtr, vs->pitch, smap_ptr + offset, height);
+	return decompressBitmap(dstPtr, vs->pitch, src, height);
+}
+
+void Gdi::benchmarkStrips(const byte *smap_ptr, int numStrips, int height, int passes, StripStats stats[256]) {
+	const int pitch = 8 * _vm->_bytesPerPixel;
+	Common::Array<byte> buffer(pitch * height);
+	_vertStripNextInc = height * pitch - 1 * _vm->_bytesPerPixel;
+
+	Common::Array<const byte *> strips[256];
+	for (int i = 0; i < numStrips; i++) {
+		const byte *src = getStripPtr(smap_ptr, i);
+		strips[*src].push_back(src);
+	}
+
+	// The timer only counts milliseconds, so the strips of a codec are
+	// timed together
+	for (int code = 0; code < 256; code++) {
+		if (strips[code].empty())
+			continue;
+
+		const uint32 start = g_system->getMillis();
+		for (int pass = 0; pass < passes; pass++) {
+			for (uint i = 0; i < strips[code].size(); i++)
+				decompressBitmap(buffer.data(), pitch, strips[code][i], height);
+		}
+		stats[code].millis += g_system->getMillis() - start;
+		stats[code].strips += strips[code].size() * passes;
+	}
 }
 
 bool GdiNES::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width, const int height,
@@ -3307,120 +3351,6 @@ StripTable *GdiV2::generateStripTable(const byte *src, int width, int height, St
 	return table;
 }
 
-void Gdi::drawStripEGA(byte *dst, int dstPitch, const byte *src, int height) const {
-	byte color = 0;
-	int run = 0, x = 0, y = 0, z;
-
-	while (x < 8) {
-		color = *src++;
-
-		if (color & 0x80) {
-			run = color & 0x3f;
-
-			if (color & 0x40) {
-				color = *src++;
-
-				if (run == 0) {
-					run = *src++;
-				}
-				for (z = 0; z < run; z++) {
-					*(dst + y * dstPitch + x) = (z & 1) ? _roomPalette[(color & 0xf) + _paletteMod] : _roomPalette[(color >> 4) + _paletteMod];
-
-					y++;
-					if (y >= height) {
-						y = 0;
-						x++;
-					}
-				}
-			} else {
-				if (run == 0) {
-					run = *src++;
-				}
-
-				for (z = 0; z < run; z++) {
-					*(dst + y * dstPitch + x) = *(dst + y * dstPitch + x - 1);
-
-					y++;
-					if (y >= height) {
-						y = 0;
-						x++;
-					}
-				}
-			}
-		} else {
-			run = color >> 4;
-			if (run == 0) {
-				run = *src++;
-			}
-
-			for (z = 0; z < run; z++) {
-				*(dst + y * dstPitch + x) = _roomPalette[(color & 0xf) + _paletteMod];
-
-				y++;
-				if (y >= height) {
-					y = 0;
-					x++;
-				}
-			}
-		}
-	}
-}
-
-#define READ_BIT (shift--, dataBit = data & 1, data >>= 1, dataBit)
-#define FILL_BITS(n) do {            \
-		if (shift < n) {             \
-			data |= *src++ << shift; \
-			shift += 8;              \
-		}                            \
-	} while (0)
-
-// NOTE: drawStripHE is actually very similar to drawStripComplex
-void Gdi::drawStripHE(byte *dst, int dstPitch, const byte *src, int width, int height, const bool transpCheck) const {
-	static const int delta_color[] = { -4, -3, -2, -1, 1, 2, 3, 4 };
-	uint32 dataBit, data;
-	byte color;
-	int shift;
-
-	color = *src++;
-	data = READ_LE_UINT24(src);
-	src += 3;
-	shift = 24;
-
-	int x = width;
-	while (1) {
-		if (!transpCheck || color != _transparentColor)
-			writeRoomColor(dst, color);
-		dst += _vm->_bytesPerPixel;
-		--x;
-		if (x == 0) {
-			x = width;
-			dst += dstPitch - width * _vm->_bytesPerPixel;
-			--height;
-			if (height == 0)
-				return;
-		}
-		FILL_BITS(1);
-		if (READ_BIT) {
-			FILL_BITS(1);
-			if (READ_BIT) {
-				FILL_BITS(3);
-				color += delta_color[data & 7];
-				shift -= 3;
-				data >>= 3;
-			} else {
-				FILL_BITS(_decomp_shr);
-				color = data & _decomp_mask;
-				shift -= _decomp_shr;
-				data >>= _decomp_shr;
-			}
-		}
-	}
-}
-
-#undef READ_BIT
-#undef FILL_BITS
-
-
 void Gdi::drawStrip3DO(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
 	if (height == 0)
 		return;
@@ -3457,135 +3387,6 @@ void Gdi::drawStrip3DO(byte *dst, int dstPitch, const byte *src, int height, con
 	} while (decSize > 0);
 }
 
-
-#define READ_BIT (cl--, bit = bits & 1, bits >>= 1, bit)
-#define FILL_BITS do {              \
-		if (cl <= 8) {              \
-			bits |= (*src++ << cl); \
-			cl += 8;                \
-		}                           \
-	} while (0)
-
-void Gdi::drawStripComplex(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
-	byte color = *src++;
-	uint bits = *src++;
-	byte cl = 8;
-	byte bit;
-	byte incm, reps;
-
-	do {
-		int x = 8;
-		do {
-			FILL_BITS;
-			if (!transpCheck || color != _transparentColor)
-				writeRoomColor(dst, color);
-			dst += _vm->_bytesPerPixel;
-
-		againPos:
-			if (!READ_BIT) {
-			} else if (!READ_BIT) {
-				FILL_BITS;
-				color = bits & _decomp_mask;
-				bits >>= _decomp_shr;
-				cl -= _decomp_shr;
-			} else {
-				incm = (bits & 7) - 4;
-				cl -= 3;
-				bits >>= 3;
-				if (incm) {
-					color += incm;
-				} else {
-					FILL_BITS;
-					reps = bits & 0xFF;
-					do {
-						if (!--x) {
-							x = 8;
-							dst += dstPitch - 8 * _vm->_bytesPerPixel;
-							if (!--height)
-								return;
-						}
-						if (!transpCheck || color != _transparentColor)
-							writeRoomColor(dst, color);
-						dst += _vm->_bytesPerPixel;
-					} while (--reps);
-					bits >>= 8;
-					bits |= (*src++) << (cl - 8);
-					goto againPos;
-				}
-			}
-		} while (--x);
-		dst += dstPitch - 8 * _vm->_bytesPerPixel;
-	} while (--height);
-}
-
-void Gdi::drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
-	byte color = *src++;
-	uint bits = *src++;
-	byte cl = 8;
-	byte bit;
-	int8 inc = -1;
-
-	do {
-		int x = 8;
-		do {
-			FILL_BITS;
-			if (!transpCheck || color != _transparentColor)
-				writeRoomColor(dst, color);
-			dst += _vm->_bytesPerPixel;
-			if (!READ_BIT) {
-			} else if (!READ_BIT) {
-				FILL_BITS;
-				color = bits & _decomp_mask;
-				bits >>= _decomp_shr;
-				cl -= _decomp_shr;
-				inc = -1;
-			} else if (!READ_BIT) {
-				color += inc;
-			} else {
-				inc = -inc;
-				color += inc;
-			}
-		} while (--x);
-		dst += dstPitch - 8 * _vm->_bytesPerPixel;
-	} while (--height);
-}
-
-void Gdi::drawStripBasicV(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
-	byte color = *src++;
-	uint bits = *src++;
-	byte cl = 8;
-	byte bit;
-	int8 inc = -1;
-
-	int x = 8;
-	do {
-		int h = height;
-		do {
-			FILL_BITS;
-			if (!transpCheck || color != _transparentColor)
-				writeRoomColor(dst, color);
-			dst += dstPitch;
-			if (!READ_BIT) {
-			} else if (!READ_BIT) {
-				FILL_BITS;
-				color = bits & _decomp_mask;
-				bits >>= _decomp_shr;
-				cl -= _decomp_shr;
-				inc = -1;
-			} else if (!READ_BIT) {
-				color += inc;
-			} else {
-				inc = -inc;
-				color += inc;
-			}
-		} while (--h);
-		dst -= _vertStripNextInc;
-	} while (--x);
-}
-
-#undef READ_BIT
-#undef FILL_BITS
-
 /* Ender - Zak256/Indy256 decoders */
 #define READ_BIT_256                       \
 		do {                               \
@@ -3764,15 +3565,13 @@ void Gdi::unkDecode11(byte *dst, int dstPitch, const byte *src, int height) cons
 void GdiHE16bit::writeRoomColor(byte *dst, byte color) const {
 	WRITE_UINT16(dst, READ_LE_UINT16(_vm->_hePalettes + 2048 + color * 2));
 }
-#endif
 
-void Gdi::writeRoomColor(byte *dst, byte color) const {
-	// As described in bug #2204 "FOA/Amiga: Palette problem (Regression)"
-	// the original AMIGA version of Indy4: The Fate of Atlantis allowed
-	// overflowing of the palette index. To have the same result in our code,
-	// we need to do an logical AND 0xFF here to keep the result in [0, 255].
-	*dst = _roomPalette[(color + _paletteMod) & 0xFF];
+void GdiHE16bit::writeRoomColors(byte *dst, byte color, int count) const {
+	const uint16 value = READ_LE_UINT16(_vm->_hePalettes + 2048 + color * 2);
+	for (int i = 0; i < count; i++)
+		WRITE_UINT16(dst + i * 2, value);
 }
+#endif
 
 
 #pragma mark -
@@ -24,9 +24,12 @@
 
 #include "common/system.h"
 #include "common/list.h"
+#include "common/rect.h"
 
 #include "graphics/surface.h"
 
+#include "scumm/gfx_strips.h"
+
 namespace Scumm {
 
 class ScummEngine;
@@ -204,16 +207,10 @@ struct StripTable;
 #define CHARSET_MASK_TRANSPARENCY	 0xFD
 #define CHARSET_MASK_TRANSPARENCY_32 0xFDFDFDFD
 
-class Gdi {
+class Gdi : public StripCodecs {
 protected:
 	ScummEngine *_vm;
 
-	byte _paletteMod;
-	byte *_roomPalette;
-	byte _transparentColor;
-	byte _decomp_shr, _decomp_mask;
-	uint32 _vertStripNextInc;
-
 	bool _zbufferDisabled;
 
 	/** Flag which is true when an object is being rendered, false otherwise. */
@@ -231,12 +228,6 @@ protected:
 	/* Bitmap decompressors */
 	bool decompressBitmap(byte *dst, int dstPitch, const byte *src, int numLinesToProcess);
 
-	void drawStripEGA(byte *dst, int dstPitch, const byte *src, int height) const;
-
-	void drawStripComplex(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
-	void drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
-	void drawStripBasicV(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
-
 	void drawStripRaw(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
 	void unkDecode8(byte *dst, int dstPitch, const byte *src, int height) const;
 	void unkDecode9(byte *dst, int dstPitch, const byte *src, int height) const;
@@ -244,14 +235,12 @@ protected:
 	void unkDecode11(byte *dst, int dstPitch, const byte *src, int height) const;
 	void drawStrip3DO(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
 
-	void drawStripHE(byte *dst, int dstPitch, const byte *src, int width, int height, const bool transpCheck) const;
-	virtual void writeRoomColor(byte *dst, byte color) const;
-
 	/* Mask decompressors */
 	void decompressMaskImgOr(byte *dst, const byte *src, int height) const;
 	void decompressMaskImg(byte *dst, const byte *src, int height) const;
 
 	/* Misc */
+	const byte *getStripPtr(const byte *smap_ptr, int stripnr) const;
 	int getZPlanes(const byte *smap_ptr, const byte *zplane_list[9], bool bmapImage) const;
 
 	virtual bool drawStrip(byte *dstPtr, VirtScreen *vs,
@@ -289,6 +278,18 @@ public:
 
 	void resetBackground(int top, int bottom, int strip);
 
+	/** The strips of a codec decoded by benchmarkStrips(), and the time spent. */
+	struct StripStats {
+		uint32 strips;
+		uint32 millis;
+	};
+
+	/**
+	 * Decode every strip of a room background passes times, adding them to
+	 * the stats of their codec id.
+	 */
+	void benchmarkStrips(const byte *smap_ptr, int numStrips, int height, int passes, StripStats stats[256]);
+
 	enum DrawBitmapFlags {
 		dbAllowMaskOr   = 1 << 0,
 		dbDrawMaskOnAll = 1 << 1,
@@ -460,6 +461,7 @@ public:
 class GdiHE16bit : public GdiHE {
 protected:
 	void writeRoomColor(byte *dst, byte color) const override;
+	void writeRoomColors(byte *dst, byte color, int count) const override;
 public:
 	GdiHE16bit(ScummEngine *vm);
 };
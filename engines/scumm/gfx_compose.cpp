@@ -0,0 +1,75 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/system.h"
+#include "scumm/gfx_compose.h"
+
+namespace Scumm {
+
+static void composeCLUT8(byte *dst, const byte *src, const byte *text, int width) {
+	composeCLUT8Scalar(dst, src, text, 0, width);
+}
+
+static bool compose16(uint16 *dst, const uint16 *src, const byte *text, int width, const uint16 *palette) {
+	return compose16Scalar(dst, src, text, 0, width, palette);
+}
+
+static const ComposeKernels scalarComposeKernels = {
+	composeCLUT8,
+	compose16
+};
+
+const ComposeKernels *getComposeKernels() {
+#ifdef SCUMMVM_NEON
+	if (g_system->hasFeature(OSystem::kFeatureCpuNEON))
+		return getNEONComposeKernels();
+#endif
+#ifdef SCUMMVM_SSE2
+	if (g_system->hasFeature(OSystem::kFeatureCpuSSE2))
+		return getSSE2ComposeKernels();
+#endif
+
+	return &scalarComposeKernels;
+}
+
+void copyTownsLayerRow(byte *dst, const byte *src, int width, int x, int layerWidth) {
+	// The row is copied in pieces up to the right edge of the layer
+	byte *row = dst - x;
+	for (int w = 0; w < width; ) {
+		const int n = (x < layerWidth) ? MIN(width - w, layerWidth - x) : width - w;
+		memcpy(row + x, src + w, n);
+		w += n;
+		x = (x + n == layerWidth) ? 0 : x + n;
+	}
+}
+
+void copyTownsLayerRow16(uint16 *dst, const byte *src, int width, int x, int layerWidth, const uint16 *palette) {
+	uint16 *row = dst - x;
+	for (int w = 0; w < width; ) {
+		const int n = (x < layerWidth) ? MIN(width - w, layerWidth - x) : width - w;
+		for (int i = 0; i < n; ++i)
+			row[x + i] = palette[src[w + i]];
+		w += n;
+		x = (x + n == layerWidth) ? 0 : x + n;
+	}
+}
+
+} // End of namespace Scumm
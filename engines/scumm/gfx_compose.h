@@ -0,0 +1,125 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SCUMM_GFX_COMPOSE_H
+#define SCUMM_GFX_COMPOSE_H
+
+#include "common/scummsys.h"
+#include "common/endian.h"
+#include "scumm/gfx.h"
+
+namespace Scumm {
+
+/**
+ * Compose a row of text pixels over 8 bit game pixels: the game pixel is
+ * kept where the text is transparent, the text pixel elsewhere.
+ *
+ * @param width the pixels of the row, a multiple of 4
+ */
+typedef void (*ComposeCLUT8Proc)(byte *dst, const byte *src, const byte *text, int width);
+
+/**
+ * Compose a row of text pixels over 16 bit game pixels, converting the
+ * text pixels with the palette.
+ *
+ * @param palette nullptr if the text is expected to be transparent
+ * @return false if the palette was needed but is nullptr, which leaves the
+ *         row partly drawn
+ */
+typedef bool (*Compose16Proc)(uint16 *dst, const uint16 *src, const byte *text, int width, const uint16 *palette);
+
+struct ComposeKernels {
+	ComposeCLUT8Proc composeCLUT8;
+	Compose16Proc compose16;
+};
+
+/** Return the fastest routines supported by the host CPU. */
+const ComposeKernels *getComposeKernels();
+
+/**
+ * Copy a row of 8 bit pixels to x in a row of an FM-Towns layer, which is
+ * layerWidth pixels wide, wrapping around to its left edge there.
+ *
+ * @param dst the pixel at x
+ */
+void copyTownsLayerRow(byte *dst, const byte *src, int width, int x, int layerWidth);
+
+/** Copy a row as copyTownsLayerRow() does, converting the pixels with the palette. */
+void copyTownsLayerRow16(uint16 *dst, const byte *src, int width, int x, int layerWidth, const uint16 *palette);
+
+#ifdef SCUMMVM_SSE2
+const ComposeKernels *getSSE2ComposeKernels();
+#endif
+
+#ifdef SCUMMVM_NEON
+const ComposeKernels *getNEONComposeKernels();
+#endif
+
+// This is included by the SIMD files, which are compiled for different
+// instruction sets, so avoid any inline code shared between files.
+
+/**
+ * Compose the pixels [first, width) of a row, see ComposeCLUT8Proc. The
+ * pointers must be 4 byte aligned at first.
+ */
+static inline void composeCLUT8Scalar(byte *dst, const byte *src, const byte *text, int first, int width) {
+	// We blit four pixels at a time, for improved performance.
+	const uint32 *src32 = (const uint32 *)(src + first);
+	const uint32 *text32 = (const uint32 *)(text + first);
+	uint32 *dst32 = (uint32 *)(dst + first);
+
+	for (int w = width - first; w > 0; w -= 4) {
+		uint32 temp = *text32++;
+
+		// Generate a byte mask for those text pixels (bytes) with
+		// value CHARSET_MASK_TRANSPARENCY. In the end, each byte
+		// in mask will be either equal to 0x00 or 0xFF.
+		// Doing it this way avoids branches and bytewise operations,
+		// at the cost of readability ;).
+		uint32 mask = temp ^ CHARSET_MASK_TRANSPARENCY_32;
+		mask = (((mask & 0x7f7f7f7f) + 0x7f7f7f7f) | mask) & 0x80808080;
+		mask = ((mask >> 7) + 0x7f7f7f7f) ^ 0x80808080;
+
+		// The following line is equivalent to this code:
+		//   *dst32++ = (*src32++ & mask) | (temp & ~mask);
+		// However, some compilers can generate somewhat better
+		// machine code for this equivalent statement:
+		*dst32++ = ((temp ^ *src32++) & mask) ^ temp;
+	}
+}
+
+/** Compose the pixels [first, width) of a row, see Compose16Proc. */
+static inline bool compose16Scalar(uint16 *dst, const uint16 *src, const byte *text, int first, int width, const uint16 *palette) {
+	for (int w = first; w < width; ++w) {
+		if (text[w] == CHARSET_MASK_TRANSPARENCY)
+			WRITE_UINT16(dst + w, READ_UINT16(src + w));
+		else if (!palette)
+			return false;
+		else
+			WRITE_UINT16(dst + w, palette[text[w]]);
+	}
+
+	return true;
+}
+
+} // End of namespace Scumm
+
+#endif
@@ -0,0 +1,67 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <arm_neon.h>
+
+#include "scumm/gfx_compose.h"
+
+namespace Scumm {
+
+static void composeCLUT8(byte *dst, const byte *src, const byte *text, int width) {
+	const uint8x16_t transparent = vdupq_n_u8(CHARSET_MASK_TRANSPARENCY);
+
+	int w = 0;
+	for (; w + 16 <= width; w += 16) {
+		const uint8x16_t t = vld1q_u8(text + w);
+		const uint8x16_t mask = vceqq_u8(t, transparent);
+		vst1q_u8(dst + w, vbslq_u8(mask, vld1q_u8(src + w), t));
+	}
+
+	composeCLUT8Scalar(dst, src, text, w, width);
+}
+
+static bool compose16(uint16 *dst, const uint16 *src, const byte *text, int width, const uint16 *palette) {
+	const uint8x8_t transparent = vdup_n_u8(CHARSET_MASK_TRANSPARENCY);
+
+	// Text is seldom drawn, so eight game pixels are copied at once where
+	// none of it is
+	int w = 0;
+	for (; w + 8 <= width; w += 8) {
+		const uint8x8_t mask = vceq_u8(vld1_u8(text + w), transparent);
+		if (vget_lane_u64(vreinterpret_u64_u8(mask), 0) == 0xFFFFFFFFFFFFFFFFULL)
+			vst1q_u16(dst + w, vld1q_u16(src + w));
+		else if (!compose16Scalar(dst, src, text, w, w + 8, palette))
+			return false;
+	}
+
+	return compose16Scalar(dst, src, text, w, width, palette);
+}
+
+static const ComposeKernels neonComposeKernels = {
+	composeCLUT8,
+	compose16
+};
+
+const ComposeKernels *getNEONComposeKernels() {
+	return &neonComposeKernels;
+}
+
+} // End of namespace Scumm
@@ -0,0 +1,68 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <emmintrin.h>
+
+#include "scumm/gfx_compose.h"
+
+namespace Scumm {
+
+static void composeCLUT8(byte *dst, const byte *src, const byte *text, int width) {
+	const __m128i transparent = _mm_set1_epi8((char)CHARSET_MASK_TRANSPARENCY);
+
+	int w = 0;
+	for (; w + 16 <= width; w += 16) {
+		const __m128i t = _mm_loadu_si128((const __m128i *)(text + w));
+		const __m128i s = _mm_loadu_si128((const __m128i *)(src + w));
+		const __m128i mask = _mm_cmpeq_epi8(t, transparent);
+		_mm_storeu_si128((__m128i *)(dst + w), _mm_or_si128(_mm_and_si128(mask, s), _mm_andnot_si128(mask, t)));
+	}
+
+	composeCLUT8Scalar(dst, src, text, w, width);
+}
+
+static bool compose16(uint16 *dst, const uint16 *src, const byte *text, int width, const uint16 *palette) {
+	const __m128i transparent = _mm_set1_epi8((char)CHARSET_MASK_TRANSPARENCY);
+
+	// Text is seldom drawn, so eight game pixels are copied at once where
+	// none of it is
+	int w = 0;
+	for (; w + 8 <= width; w += 8) {
+		const __m128i t = _mm_loadl_epi64((const __m128i *)(text + w));
+		if ((_mm_movemask_epi8(_mm_cmpeq_epi8(t, transparent)) & 0xFF) == 0xFF)
+			_mm_storeu_si128((__m128i *)(dst + w), _mm_loadu_si128((const __m128i *)(src + w)));
+		else if (!compose16Scalar(dst, src, text, w, w + 8, palette))
+			return false;
+	}
+
+	return compose16Scalar(dst, src, text, w, width, palette);
+}
+
+static const ComposeKernels sse2ComposeKernels = {
+	composeCLUT8,
+	compose16
+};
+
+const ComposeKernels *getSSE2ComposeKernels() {
+	return &sse2ComposeKernels;
+}
+
+} // End of namespace Scumm
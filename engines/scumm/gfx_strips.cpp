@@ -0,0 +1,418 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/endian.h"
+#include "common/util.h"
+#include "scumm/gfx_strips.h"
+
+namespace Scumm {
+
+StripCodecs::StripCodecs() {
+	_bytesPerPixel = 1;
+	_paletteMod = 0;
+	_roomPalette = nullptr;
+	_transparentColor = 255;
+	_decomp_shr = 0;
+	_decomp_mask = 0;
+	_vertStripNextInc = 0;
+}
+
+StripCodecs::~StripCodecs() {
+}
+
+void StripCodecs::drawStripEGA(byte *dst, int dstPitch, const byte *src, int height) const {
+	// The runs go down the columns, so they are drawn a column at a time,
+	// with their colors looked up once
+	int x = 0, y = 0;
+
+	while (x < 8) {
+		byte color = *src++;
+		int run;
+
+		if (color & 0x80) {
+			run = color & 0x3f;
+
+			if (color & 0x40) {
+				color = *src++;
+
+				if (run == 0) {
+					run = *src++;
+				}
+
+				// Two colors, one pixel out of two
+				const byte colors[2] = {
+					_roomPalette[(color >> 4) + _paletteMod],
+					_roomPalette[(color & 0xf) + _paletteMod]
+				};
+				int z = 0;
+				while (z < run) {
+					const int n = MIN(run - z, height - y);
+					byte *column = dst + y * dstPitch + x;
+					for (int i = 0; i < n; i++, column += dstPitch)
+						*column = colors[(z + i) & 1];
+					z += n;
+					y += n;
+					if (y == height) {
+						y = 0;
+						x++;
+					}
+				}
+			} else {
+				if (run == 0) {
+					run = *src++;
+				}
+
+				// The colors of the column on the left
+				while (run > 0) {
+					const int n = MIN(run, height - y);
+					byte *column = dst + y * dstPitch + x;
+					for (int i = 0; i < n; i++, column += dstPitch)
+						*column = column[-1];
+					run -= n;
+					y += n;
+					if (y == height) {
+						y = 0;
+						x++;
+					}
+				}
+			}
+		} else {
+			run = color >> 4;
+			if (run == 0) {
+				run = *src++;
+			}
+
+			const byte pixel = _roomPalette[(color & 0xf) + _paletteMod];
+			while (run > 0) {
+				const int n = MIN(run, height - y);
+				byte *column = dst + y * dstPitch + x;
+				for (int i = 0; i < n; i++, column += dstPitch)
+					*column = pixel;
+				run -= n;
+				y += n;
+				if (y == height) {
+					y = 0;
+					x++;
+				}
+			}
+		}
+	}
+}
+
+#define READ_BIT (shift--, dataBit = data & 1, data >>= 1, dataBit)
+#define FILL_BITS(n) do {            \
+		if (shift < n) {             \
+			data |= *src++ << shift; \
+			shift += 8;              \
+		}                            \
+	} while (0)
+
+/**
+ * The number of trailing zero bits of a byte, 8 for zero. In the Complex,
+ * Basic and HE codecs, a zero bit codes a pixel of the same color as the
+ * previous one, so this is the length of the run coded by the next bits.
+ */
+static const byte sameColorRuns[256] = {
+	8, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	6, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	7, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	6, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+};
+
+void StripCodecs::drawStripRun(byte *&dst, int &x, int width, int dstPitch, byte color, int count, const bool transpCheck) const {
+	const bool transparent = transpCheck && color == _transparentColor;
+
+	while (count > 0) {
+		const int n = MIN(count, x);
+		if (!transparent) {
+			if (n == 1)
+				writeRoomColor(dst, color);
+			else
+				writeRoomColors(dst, color, n);
+		}
+		dst += n * _bytesPerPixel;
+		count -= n;
+		x -= n;
+		if (!x) {
+			x = width;
+			dst += dstPitch - width * _bytesPerPixel;
+		}
+	}
+}
+
+void StripCodecs::drawStripColumnRun(byte *&dst, int &y, int height, int dstPitch, byte color, int count, const bool transpCheck) const {
+	const bool transparent = transpCheck && color == _transparentColor;
+
+	for (; count > 0; count--) {
+		if (!transparent)
+			writeRoomColor(dst, color);
+		dst += dstPitch;
+		if (!--y) {
+			y = height;
+			dst -= _vertStripNextInc;
+		}
+	}
+}
+
+// NOTE: drawStripHE is actually very similar to drawStripComplex
+void StripCodecs::drawStripHE(byte *dst, int dstPitch, const byte *src, int width, int height, const bool transpCheck) const {
+	static const int delta_color[] = { -4, -3, -2, -1, 1, 2, 3, 4 };
+	uint32 dataBit, data;
+	byte color;
+	int shift;
+
+	color = *src++;
+	data = READ_LE_UINT24(src);
+	src += 3;
+	shift = 24;
+
+	// The pixels are drawn a run of the same color at a time
+	int x = width;
+	int left = width * height;
+	int run = 1;
+	while (run < left) {
+		FILL_BITS(1);
+		if (!(data & 1)) {
+			const int n = MIN<int>(MIN<int>(sameColorRuns[data & 0xFF], shift), left - run);
+			run += n;
+			shift -= n;
+			data >>= n;
+			continue;
+		}
+		shift--;
+		data >>= 1;
+
+		drawStripRun(dst, x, width, dstPitch, color, run, transpCheck);
+		left -= run;
+		run = 1;
+
+		FILL_BITS(1);
+		if (READ_BIT) {
+			FILL_BITS(3);
+			color += delta_color[data & 7];
+			shift -= 3;
+			data >>= 3;
+		} else {
+			FILL_BITS(_decomp_shr);
+			color = data & _decomp_mask;
+			shift -= _decomp_shr;
+			data >>= _decomp_shr;
+		}
+	}
+
+	drawStripRun(dst, x, width, dstPitch, color, left, transpCheck);
+}
+
+#undef READ_BIT
+#undef FILL_BITS
+
+#define FILL_BITS do {              \
+		if (cl <= 8) {              \
+			bits |= (*src++ << cl); \
+			cl += 8;                \
+		}                           \
+	} while (0)
+
+void StripCodecs::drawStripComplex(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
+	byte color = *src++;
+	uint bits = *src++;
+	byte cl = 8;
+	byte incm;
+
+	// The pixels are drawn a run of the same color at a time
+	int x = 8;
+	int left = 8 * height;
+	int run = 1;
+	while (run < left) {
+		FILL_BITS;
+		const int same = sameColorRuns[bits & 0xFF];
+		if (same) {
+			const int n = MIN(same, left - run);
+			run += n;
+			bits >>= n;
+			cl -= n;
+			continue;
+		}
+
+		if (!(bits & 2)) {
+			bits >>= 2;
+			cl -= 2;
+			FILL_BITS;
+			drawStripRun(dst, x, 8, dstPitch, color, run, transpCheck);
+			left -= run;
+			run = 1;
+			color = bits & _decomp_mask;
+			bits >>= _decomp_shr;
+			cl -= _decomp_shr;
+		} else {
+			incm = ((bits >> 2) & 7) - 4;
+			bits >>= 5;
+			cl -= 5;
+			if (incm) {
+				drawStripRun(dst, x, 8, dstPitch, color, run, transpCheck);
+				left -= run;
+				run = 1;
+				color += incm;
+			} else {
+				// A repeat count, where 0 stands for 256
+				FILL_BITS;
+				const int reps = (bits & 0xFF) ? (bits & 0xFF) : 256;
+				if (run + reps >= left)
+					break;
+				run += reps;
+				bits >>= 8;
+				bits |= (*src++) << (cl - 8);
+			}
+		}
+	}
+
+	drawStripRun(dst, x, 8, dstPitch, color, left, transpCheck);
+}
+
+void StripCodecs::drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
+	byte color = *src++;
+	uint bits = *src++;
+	byte cl = 8;
+	int8 inc = -1;
+
+	// The pixels are drawn a run of the same color at a time
+	int x = 8;
+	int left = 8 * height;
+	int run = 1;
+	while (run < left) {
+		FILL_BITS;
+		const int same = sameColorRuns[bits & 0xFF];
+		if (same) {
+			const int n = MIN(same, left - run);
+			run += n;
+			bits >>= n;
+			cl -= n;
+			continue;
+		}
+
+		drawStripRun(dst, x, 8, dstPitch, color, run, transpCheck);
+		left -= run;
+		run = 1;
+
+		if (!(bits & 2)) {
+			bits >>= 2;
+			cl -= 2;
+			FILL_BITS;
+			color = bits & _decomp_mask;
+			bits >>= _decomp_shr;
+			cl -= _decomp_shr;
+			inc = -1;
+		} else if (!(bits & 4)) {
+			bits >>= 3;
+			cl -= 3;
+			color += inc;
+		} else {
+			bits >>= 3;
+			cl -= 3;
+			inc = -inc;
+			color += inc;
+		}
+	}
+
+	drawStripRun(dst, x, 8, dstPitch, color, left, transpCheck);
+}
+
+void StripCodecs::drawStripBasicV(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
+	byte color = *src++;
+	uint bits = *src++;
+	byte cl = 8;
+	int8 inc = -1;
+
+	// The pixels are drawn a run of the same color at a time, column by column
+	int y = height;
+	int left = 8 * height;
+	int run = 1;
+	while (run < left) {
+		FILL_BITS;
+		const int same = sameColorRuns[bits & 0xFF];
+		if (same) {
+			const int n = MIN(same, left - run);
+			run += n;
+			bits >>= n;
+			cl -= n;
+			continue;
+		}
+
+		drawStripColumnRun(dst, y, height, dstPitch, color, run, transpCheck);
+		left -= run;
+		run = 1;
+
+		if (!(bits & 2)) {
+			bits >>= 2;
+			cl -= 2;
+			FILL_BITS;
+			color = bits & _decomp_mask;
+			bits >>= _decomp_shr;
+			cl -= _decomp_shr;
+			inc = -1;
+		} else if (!(bits & 4)) {
+			bits >>= 3;
+			cl -= 3;
+			color += inc;
+		} else {
+			bits >>= 3;
+			cl -= 3;
+			inc = -inc;
+			color += inc;
+		}
+	}
+
+	drawStripColumnRun(dst, y, height, dstPitch, color, left, transpCheck);
+}
+
+#undef FILL_BITS
+
+void StripCodecs::writeRoomColor(byte *dst, byte color) const {
+	// As described in bug #2204 "FOA/Amiga: Palette problem (Regression)"
+	// the original AMIGA version of Indy4: The Fate of Atlantis allowed
+	// overflowing of the palette index. To have the same result in our code,
+	// we need to do an logical AND 0xFF here to keep the result in [0, 255].
+	*dst = _roomPalette[(color + _paletteMod) & 0xFF];
+}
+
+void StripCodecs::writeRoomColors(byte *dst, byte color, int count) const {
+	if (_bytesPerPixel == 1) {
+		memset(dst, _roomPalette[(color + _paletteMod) & 0xFF], count);
+		return;
+	}
+
+	for (int i = 0; i < count; i++)
+		writeRoomColor(dst + i * _bytesPerPixel, color);
+}
+
+} // End of namespace Scumm
@@ -0,0 +1,69 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SCUMM_GFX_STRIPS_H
+#define SCUMM_GFX_STRIPS_H
+
+#include "common/scummsys.h"
+
+namespace Scumm {
+
+/**
+ * The room strip codecs of Gdi which only depend on the palette and the
+ * pixel size, apart from the engine so that they can be checked alone.
+ */
+class StripCodecs {
+public:
+	StripCodecs();
+	virtual ~StripCodecs();
+
+protected:
+	byte _bytesPerPixel;
+	byte _paletteMod;
+	byte *_roomPalette;
+	byte _transparentColor;
+	byte _decomp_shr, _decomp_mask;
+	uint32 _vertStripNextInc;
+
+	void drawStripEGA(byte *dst, int dstPitch, const byte *src, int height) const;
+
+	void drawStripComplex(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
+	void drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
+	void drawStripBasicV(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
+
+	void drawStripHE(byte *dst, int dstPitch, const byte *src, int width, int height, const bool transpCheck) const;
+	virtual void writeRoomColor(byte *dst, byte color) const;
+	/** Write count pixels of a color in a row, as writeRoomColor() does. */
+	virtual void writeRoomColors(byte *dst, byte color, int count) const;
+
+	/**
+	 * Draw count pixels of a color to a strip, width pixels wide, where the
+	 * current row ends after x pixels. dst and x are moved past them.
+	 */
+	void drawStripRun(byte *&dst, int &x, int width, int dstPitch, byte color, int count, const bool transpCheck) const;
+	/** Draw count pixels of a color down the columns of a strip, see drawStripRun(). */
+	void drawStripColumnRun(byte *&dst, int &y, int height, int dstPitch, byte color, int count, const bool transpCheck) const;
+};
+
+} // End of namespace Scumm
+
+#endif
@@ -23,6 +23,7 @@
 
 #include "scumm/scumm.h"
 #include "scumm/charset.h"
+#include "scumm/gfx_compose.h"
 #include "scumm/util.h"
 #include "scumm/resource.h"
 
@@ -50,34 +51,14 @@ void ScummEngine::towns_drawStripToScreen(VirtScreen *vs, int dstX, int dstY, in
 	int sp2 = _textSurface.pitch - width * m;
 
 	if (vs->number == kMainVirtScreen || _game.id == GID_INDY3 || _game.id == GID_ZAK) {
-		if (_outputPixelFormat.bytesPerPixel == 2) {
-			for (int h = 0; h < height; ++h) {
-				uint16 *dst1tmp = dst1a;
-				int xpos = dstXScr;
-				for (int w = 0; w < width; ++w) {
-					*dst1a++ = _16BitPalette[*src1++];
-					if (++xpos == lw1) {
-						dst1a -= lw1;
-						xpos = 0;
-					}
-				}
-				src1 += sp1;
-				dst1a = dst1tmp + lw1;
-			}
-		} else {
-			for (int h = 0; h < height; ++h) {
-				uint8 *dst1tmp = dst1;
-				int xpos = dstXScr;
-				for (int w = 0; w < width; ++w) {
-					*dst1++ = *src1++;
-					if (++xpos == lw1) {
-						dst1 -= lw1;
-						xpos = 0;
-					}
-				}
-				src1 += sp1;
-				dst1 = dst1tmp + lw1;
-			}
+		for (int h = 0; h < height; ++h) {
+			if (_outputPixelFormat.bytesPerPixel == 2)
+				copyTownsLayerRow16(dst1a, src1, width, dstXScr, lw1, _16BitPalette);
+			else
+				copyTownsLayerRow(dst1, src1, width, dstXScr, lw1);
+			src1 += width + sp1;
+			dst1 += lw1;
+			dst1a += lw1;
 		}
 
 		for (int h = 0; h < height * m; ++h) {
@@ -16,7 +16,9 @@ MODULE_OBJS := \
 	dialogs.o \
 	file.o \
 	file_nes.o \
+	gfx_compose.o \
 	gfx_mac.o \
+	gfx_strips.o \
 	gfx_towns.o \
 	gfx.o \
 	he/resource_he.o \
@@ -58,6 +60,7 @@ MODULE_OBJS := \
 	players/player_v3m.o \
 	players/player_v4a.o \
 	players/player_v5m.o \
+	prefetch.o \
 	resource_v2.o \
 	resource_v3.o \
 	resource_v4.o \
@@ -133,6 +136,20 @@ MODULE_OBJS += \
 	gfxARM.o
 endif
 
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	gfx_compose_sse2.o
+
+$(MODULE)/gfx_compose_sse2.o: CXXFLAGS += -msse2
+endif
+
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	gfx_compose_neon.o
+
+$(MODULE)/gfx_compose_neon.o: CXXFLAGS += $(NEON_CXXFLAGS)
+endif
+
 ifdef ENABLE_HE
 MODULE_OBJS += \
 	he/animation_he.o \
@@ -0,0 +1,334 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "scumm/file.h"
+#include "scumm/prefetch.h"
+#include "scumm/resource.h"
+#include "scumm/scumm.h"
+
+namespace Scumm {
+
+ResourcePrefetcher *ResourcePrefetcher::create(ScummEngine *vm) {
+	if (vm->_game.version < 5 || vm->_game.heversion != 0 || (vm->_game.features & (GF_SMALL_HEADER | GF_OLD_BUNDLE)))
+		return nullptr;
+
+	// Opening the files of Steam versions requires their index
+	if (vm->_filenamePattern.genMethod == kGenDiskNumSteam || vm->_filenamePattern.genMethod == kGenRoomNumSteam)
+		return nullptr;
+
+	ResourcePrefetcher *prefetcher = new ResourcePrefetcher(vm);
+	prefetcher->_thread = new Common::Thread(threadProc, prefetcher);
+
+	if (!prefetcher->_thread->isRunning()) {
+		delete prefetcher;
+		return nullptr;
+	}
+
+	return prefetcher;
+}
+
+ResourcePrefetcher::ResourcePrefetcher(ScummEngine *vm) : _vm(vm), _thread(nullptr), _lastRoom(0), _size(0), _maxSize(0), _stop(false) {
+	_exits.resize(vm->_numRooms);
+}
+
+ResourcePrefetcher::~ResourcePrefetcher() {
+	if (_thread) {
+		_mutex.lock();
+		_stop = true;
+		_mutex.unlock();
+
+		_requestsQueued.post();
+		_thread->join();
+		delete _thread;
+	}
+
+	for (uint i = 0; i < _entries.size(); i++)
+		delete[] _entries[i].data;
+
+	for (Common::HashMap<Common::String, File *>::iterator it = _files.begin(); it != _files.end(); ++it) {
+		if (it->_value) {
+			delete it->_value->handle;
+			delete it->_value;
+		}
+	}
+}
+
+void ResourcePrefetcher::enterRoom(int room) {
+	if (room <= 0 || room >= _vm->_numRooms)
+		return;
+
+	// Remember the most recent rooms entered from the previous one
+	if (_lastRoom && _lastRoom != room) {
+		Common::Array<int> &exits = _exits[_lastRoom];
+
+		for (uint i = 0; i < exits.size(); i++) {
+			if (exits[i] == room) {
+				exits.remove_at(i);
+				break;
+			}
+		}
+
+		exits.insert_at(0, room);
+		if (exits.size() > kMaxExits)
+			exits.resize(kMaxExits);
+	}
+	_lastRoom = room;
+
+	_mutex.lock();
+	_requests.clear();
+	_maxSize = _vm->_res->getFreeHeapSize();
+	_mutex.unlock();
+
+	// The room itself is loaded already
+	queueRoom(room, false);
+
+	for (uint i = 0; i < _exits[room].size(); i++)
+		queueRoom(_exits[room][i], true);
+}
+
+byte *ResourcePrefetcher::take(ResType type, ResId idx, uint32 &size) {
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _entries.size(); i++) {
+		if (_entries[i].type == type && _entries[i].idx == idx) {
+			byte *data = _entries[i].data;
+			size = _entries[i].size;
+			_size -= size;
+			_entries.remove_at(i);
+			return data;
+		}
+	}
+
+	// It is loaded now, so do not read it again
+	for (uint i = 0; i < _requests.size(); i++) {
+		if (_requests[i].type == type && _requests[i].idx == idx) {
+			_requests.remove_at(i);
+			break;
+		}
+	}
+
+	return nullptr;
+}
+
+uint32 ResourcePrefetcher::getSize() const {
+	Common::StackLock lock(_mutex);
+	return _size;
+}
+
+void ResourcePrefetcher::expire(uint32 limit) {
+	Common::StackLock lock(_mutex);
+
+	while (!_entries.empty() && _size >= limit) {
+		delete[] _entries[0].data;
+		_size -= _entries[0].size;
+		_entries.remove_at(0);
+	}
+
+	_maxSize = MIN(_maxSize, limit);
+}
+
+void ResourcePrefetcher::queueRoom(int room, bool withRoom) {
+	if (withRoom)
+		queue(rtRoom, room);
+
+	// Costumes and scripts are mostly stored in the room which uses them
+	static const ResType types[] = { rtCostume, rtScript };
+
+	for (uint i = 0; i < ARRAYSIZE(types); i++) {
+		const ResourceManager::ResTypeData &resources = _vm->_res->_types[types[i]];
+
+		for (ResId idx = 1; idx < resources.size(); idx++) {
+			if (resources[idx]._roomno == room)
+				queue(types[i], idx);
+		}
+	}
+}
+
+void ResourcePrefetcher::queue(ResType type, ResId idx) {
+	if (_vm->_res->isResourceLoaded(type, idx) || isQueued(type, idx))
+		return;
+
+	// Same as loadResource()
+	Request request;
+	request.type = type;
+	request.idx = idx;
+	request.room = _vm->getResourceRoomNr(type, idx);
+	request.offset = _vm->getResourceRoomOffset(type, idx);
+	request.tag = _vm->_res->_types[type]._tag;
+
+	if (request.room <= 0 || request.room >= _vm->_numRooms || request.offset == RES_INVALID_OFFSET)
+		return;
+
+	request.file = getFile(request.room);
+	if (!request.file)
+		return;
+
+	_mutex.lock();
+	_requests.push_back(request);
+	_mutex.unlock();
+
+	_requestsQueued.post();
+}
+
+ResourcePrefetcher::File *ResourcePrefetcher::getFile(int room) {
+	// The files are opened here, as the search paths must only be used
+	// by the main thread
+	Common::String filename = _vm->generateFilename(room);
+
+	if (_files.contains(filename))
+		return _files[filename];
+
+	BaseScummFile *handle = new ScummFile();
+	File *file = nullptr;
+
+	if (_vm->openFile(*handle, filename, true)) {
+		// Same as openRoom()
+		handle->setEnc((_vm->_game.features & GF_USE_KEY) ? 0x69 : 0);
+
+		file = new File();
+		file->handle = handle;
+	} else {
+		delete handle;
+	}
+
+	_files[filename] = file;
+	return file;
+}
+
+bool ResourcePrefetcher::isQueued(ResType type, ResId idx) const {
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _requests.size(); i++)
+		if (_requests[i].type == type && _requests[i].idx == idx)
+			return true;
+
+	for (uint i = 0; i < _entries.size(); i++)
+		if (_entries[i].type == type && _entries[i].idx == idx)
+			return true;
+
+	return false;
+}
+
+void ResourcePrefetcher::threadProc(void *param) {
+	((ResourcePrefetcher *)param)->run();
+}
+
+void ResourcePrefetcher::run() {
+	for (;;) {
+		_requestsQueued.wait();
+
+		Request request;
+
+		{
+			Common::StackLock lock(_mutex);
+
+			if (_stop)
+				return;
+
+			// enterRoom() may have dropped it
+			if (_requests.empty())
+				continue;
+
+			request = _requests[0];
+			_requests.remove_at(0);
+		}
+
+		read(request);
+	}
+}
+
+void ResourcePrefetcher::read(const Request &request) {
+	File &file = *request.file;
+	BaseScummFile *handle = file.handle;
+
+	if (file.roomOffsets.empty())
+		readRoomOffsets(file);
+
+	const uint32 roomOffset = file.roomOffsets[request.room & 0xFF];
+	if (!roomOffset)
+		return;
+
+	// Read the resource with its header, as loadResource() does
+	const uint32 pos = roomOffset + request.offset;
+	handle->seek(pos, SEEK_SET);
+	const uint32 tag = handle->readUint32BE();
+	const uint32 size = handle->readUint32BE();
+
+	if (handle->err() || handle->eos() || tag != request.tag) {
+		handle->clearErr();
+		return;
+	}
+
+	_mutex.lock();
+	const bool fits = _size + size <= _maxSize;
+	_mutex.unlock();
+
+	if (!fits)
+		return;
+
+	byte *data = new byte[size];
+	handle->seek(pos, SEEK_SET);
+	handle->read(data, size);
+
+	if (handle->err() || handle->eos()) {
+		handle->clearErr();
+		delete[] data;
+		return;
+	}
+
+	Common::StackLock lock(_mutex);
+
+	// The heap may have filled up meanwhile
+	if (_size + size > _maxSize) {
+		delete[] data;
+		return;
+	}
+
+	Entry entry;
+	entry.type = request.type;
+	entry.idx = request.idx;
+	entry.data = data;
+	entry.size = size;
+	_entries.push_back(entry);
+	_size += size;
+}
+
+void ResourcePrefetcher::readRoomOffsets(File &file) {
+	// Same as ScummEngine::readRoomsOffsets()
+	BaseScummFile *handle = file.handle;
+	file.roomOffsets.resize(256);
+
+	handle->seek(16, SEEK_SET);
+
+	int num = handle->readByte();
+	while (num--) {
+		int room = handle->readByte();
+		file.roomOffsets[room] = handle->readUint32LE();
+	}
+
+	if (handle->err() || handle->eos()) {
+		handle->clearErr();
+		file.roomOffsets.clear();
+		file.roomOffsets.resize(256);
+	}
+}
+
+} // End of namespace Scumm
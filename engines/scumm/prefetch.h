@@ -0,0 +1,142 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SCUMM_PREFETCH_H
+#define SCUMM_PREFETCH_H
+
+#include "common/array.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/mutex.h"
+#include "common/thread.h"
+#include "scumm/scumm.h"	// for ResType
+
+namespace Scumm {
+
+class BaseScummFile;
+
+/**
+ * Reads the resources which are likely needed next on a thread, so that
+ * entering a room does not wait for the game data files.
+ *
+ * When a room is entered, the costumes and scripts stored in it are read,
+ * followed by the rooms entered from it before, along with their costumes
+ * and scripts. The data is kept until loadResource() takes it, and counts
+ * against the heap threshold of the ResourceManager, which drops it before
+ * any loaded resource.
+ *
+ * Only used for the games with the common file layout (version 5 and newer,
+ * without HE and small headers), as the others load resources in many
+ * different ways.
+ */
+class ResourcePrefetcher {
+public:
+	/**
+	 * Create a prefetcher for the given game, or return nullptr if it does
+	 * not support the game or no thread can be started.
+	 */
+	static ResourcePrefetcher *create(ScummEngine *vm);
+
+	~ResourcePrefetcher();
+
+	/**
+	 * Queue the resources likely needed after entering the given room,
+	 * dropping the ones queued for the previous room.
+	 */
+	void enterRoom(int room);
+
+	/**
+	 * Take the prefetched data of a resource, as loadResource() would read
+	 * it from the file, or return nullptr if it was not prefetched.
+	 * The caller has to delete[] it.
+	 */
+	byte *take(ResType type, ResId idx, uint32 &size);
+
+	/** Get the size of the prefetched data, in bytes. */
+	uint32 getSize() const;
+
+	/**
+	 * Drop the oldest prefetched data until its size is less than the
+	 * given limit, and prefetch no more than that.
+	 */
+	void expire(uint32 limit);
+
+private:
+	enum {
+		/** The number of rooms remembered as entered from each room. */
+		kMaxExits = 4
+	};
+
+	/** A game data file, used only by the thread once it is open. */
+	struct File {
+		BaseScummFile *handle;
+		/** The offset of each room in the file, read by the thread. */
+		Common::Array<uint32> roomOffsets;
+	};
+
+	struct Request {
+		ResType type;
+		ResId idx;
+		File *file;
+		int room;
+		uint32 offset;
+		uint32 tag;
+	};
+
+	struct Entry {
+		ResType type;
+		ResId idx;
+		byte *data;
+		uint32 size;
+	};
+
+	ResourcePrefetcher(ScummEngine *vm);
+
+	void queueRoom(int room, bool resources);
+	void queue(ResType type, ResId idx);
+	File *getFile(int room);
+	bool isQueued(ResType type, ResId idx) const;
+
+	static void threadProc(void *param);
+	void run();
+	void read(const Request &request);
+	void readRoomOffsets(File &file);
+
+	ScummEngine *_vm;
+	Common::Thread *_thread;
+	Common::Semaphore _requestsQueued;
+
+	Common::HashMap<Common::String, File *> _files;
+	Common::Array<Common::Array<int> > _exits;
+	int _lastRoom;
+
+	/** Protects the members below, which the thread uses. */
+	mutable Common::Mutex _mutex;
+	Common::Array<Request> _requests;
+	Common::Array<Entry> _entries;
+	uint32 _size;
+	uint32 _maxSize;
+	bool _stop;
+};
+
+} // End of namespace Scumm
+
+#endif
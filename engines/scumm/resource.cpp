@@ -33,6 +33,7 @@
 #include "scumm/imuse_digi/dimuse_engine.h"
 #include "scumm/he/intern_he.h"
 #include "scumm/object.h"
+#include "scumm/prefetch.h"
 #include "scumm/resource.h"
 #include "scumm/scumm.h"
 #include "scumm/scumm_v5.h"
@@ -650,7 +651,12 @@ int ScummEngine::loadResource(ResType type, ResId idx) {
 
 	_fileHandle->seek(fileOffs + _fileOffset, SEEK_SET);
 
-	if (_game.features & GF_OLD_BUNDLE) {
+	// The prefetcher reads the resource with its header, like below
+	byte *prefetched = _resourcePrefetcher ? _resourcePrefetcher->take(type, idx, size) : nullptr;
+
+	if (prefetched) {
+		debugC(DEBUG_RESOURCE, "loadResource(%s,%d): prefetched", nameOfResType(type), idx);
+	} else if (_game.features & GF_OLD_BUNDLE) {
 		if ((_game.version == 3) && !(_game.platform == Common::kPlatformAmiga) && (type == rtSound)) {
 			return readSoundResourceSmallHeader(idx);
 		} else {
@@ -696,7 +702,13 @@ int ScummEngine::loadResource(ResType type, ResId idx) {
 		size = _fileHandle->readUint32BE();
 		_fileHandle->seek(-8, SEEK_CUR);
 	}
-	_fileHandle->read(_res->createResource(type, idx, size), size);
+
+	if (prefetched) {
+		memcpy(_res->createResource(type, idx, size), prefetched, size);
+		delete[] prefetched;
+	} else {
+		_fileHandle->read(_res->createResource(type, idx, size), size);
+	}
 
 	applyWorkaroundIfNeeded(type, idx);
 
@@ -900,6 +912,10 @@ void ResourceManager::setHeapThreshold(int min, int max) {
 	_minHeapThreshold = min;
 }
 
+uint32 ResourceManager::getFreeHeapSize() const {
+	return (_allocatedSize < _maxHeapThreshold) ? _maxHeapThreshold - _allocatedSize : 0;
+}
+
 bool ResourceManager::validateResource(const char *str, ResType type, ResId idx) const {
 	if (type < rtFirst || type > rtLast || (uint)idx >= (uint)_types[type].size()) {
 		warning("%s Illegal Glob type %s (%d) num %d", str, nameOfResType(type), type, idx);
@@ -1058,6 +1074,15 @@ void ResourceManager::expireResources(uint32 size) {
 		increaseResourceCounters();
 	}
 
+	// Prefetched resources count against the heap, but are only guesses,
+	// so they are dropped first
+	if (_vm->_resourcePrefetcher && _vm->_resourcePrefetcher->getSize()) {
+		if (size + _allocatedSize + _vm->_resourcePrefetcher->getSize() < _maxHeapThreshold)
+			return;
+
+		_vm->_resourcePrefetcher->expire((size + _allocatedSize < _maxHeapThreshold) ? _maxHeapThreshold - size - _allocatedSize - 1 : 0);
+	}
+
 	if (size + _allocatedSize < _maxHeapThreshold)
 		return;
 
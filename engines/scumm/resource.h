@@ -181,6 +181,11 @@ public:
 
 	void setHeapThreshold(int min, int max);
 
+	/**
+	 * Get how many bytes may be allocated before resources are expired.
+	 */
+	uint32 getFreeHeapSize() const;
+
 	void allocResTypeData(ResType type, uint32 tag, int num, ResTypeMode mode);
 	void freeResources();
 
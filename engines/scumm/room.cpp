@@ -27,6 +27,7 @@
 #include "scumm/he/intern_he.h"
 #endif
 #include "scumm/object.h"
+#include "scumm/prefetch.h"
 #include "scumm/resource.h"
 #include "scumm/scumm_v3.h"
 #include "scumm/sound.h"
@@ -130,6 +131,9 @@ void ScummEngine::startScene(int room, Actor *a, int objectNr) {
 	if (room != 0)
 		ensureResourceLoaded(rtRoom, room);
 
+	if (_resourcePrefetcher)
+		_resourcePrefetcher->enterRoom(_roomResource);
+
 	clearRoomObjects();
 
 	if (_currentRoom == 0) {
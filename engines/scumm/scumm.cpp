@@ -40,6 +40,7 @@
 #include "scumm/dialogs.h"
 #include "scumm/file.h"
 #include "scumm/file_nes.h"
+#include "scumm/gfx_compose.h"
 #include "scumm/imuse/imuse.h"
 #include "scumm/imuse_digi/dimuse_engine.h"
 #include "scumm/smush/smush_mixer.h"
@@ -65,6 +66,7 @@
 #include "scumm/players/player_v4a.h"
 #include "scumm/players/player_v5m.h"
 #include "scumm/players/player_he.h"
+#include "scumm/prefetch.h"
 #include "scumm/resource.h"
 #include "scumm/he/resource_he.h"
 #include "scumm/he/moonbase/moonbase.h"
@@ -147,6 +149,7 @@ ScummEngine::ScummEngine(OSystem *syst, const DetectorResult &dr)
 	}
 
 	_fileHandle = nullptr;
+	_resourcePrefetcher = nullptr;
 
 	// Init all vars
 	_imuse = nullptr;
@@ -619,6 +622,7 @@ ScummEngine::ScummEngine(OSystem *syst, const DetectorResult &dr)
 		_compositeBuf = (byte *)malloc(_screenWidth * _screenHeight * sizeMult);
 	else
 		_compositeBuf = nullptr;
+	_composeKernels = getComposeKernels();
 
 	_herculesBuf = nullptr;
 	if (_renderMode == Common::kRenderHercA || _renderMode == Common::kRenderHercG) {
@@ -659,6 +663,7 @@ ScummEngine::~ScummEngine() {
 	delete _messageDialog;
 	delete _pauseDialog;
 	delete _versionDialog;
+	delete _resourcePrefetcher;
 	delete _fileHandle;
 
 	delete _sound;
@@ -1481,6 +1486,8 @@ Common::Error ScummEngine::init() {
 
 	readIndexFile();
 
+	_resourcePrefetcher = ResourcePrefetcher::create(this);
+
 	// Create the debugger now that _numVariables has been set
 	setDebugger(new ScummDebugger(this));
 
@@ -90,6 +90,7 @@ class IMuse;
 class IMuseDigital;
 class MusicEngine;
 class Player_Towns;
+class ResourcePrefetcher;
 class ScummEngine;
 class ScummDebugger;
 class Sound;
@@ -97,6 +98,7 @@ class Localizer;
 
 struct Box;
 struct BoxCoords;
+struct ComposeKernels;
 struct FindObjectInRoom;
 
 // Use g_scumm from error() ONLY
@@ -287,6 +289,7 @@ class ScummEngine : public Engine, public Common::Serializable {
 	friend class CharsetRenderer;
 	friend class CharsetRendererTownsClassic;
 	friend class ResourceManager;
+	friend class ResourcePrefetcher;
 
 public:
 	/* Put often used variables at the top.
@@ -634,6 +637,7 @@ protected:
 	/* Should be in Resource class */
 	BaseScummFile *_fileHandle;
 	uint32 _fileOffset;
+	ResourcePrefetcher *_resourcePrefetcher;
 public:
 	/** The name of the (macintosh/rescumm style) container file, if any. */
 	Common::String _containerFile;
@@ -960,6 +964,7 @@ protected:
 	// Screen rendering
 	byte *_compositeBuf;
 	byte *_herculesBuf;
+	const ComposeKernels *_composeKernels;
 
 	virtual void drawDirtyScreenParts();
 	void updateDirtyScreen(VirtScreenNumber slot);
@@ -40,6 +40,9 @@ FMVScreen::FMVScreen(Gfx::Driver *gfx, Cursor *cursor) :
 	_decoder = new Video::BinkDecoder();
 	_decoder->setDefaultHighColorFormat(Gfx::Driver::getRGBAPixelFormat());
 	_decoder->setSoundType(Audio::Mixer::kSFXSoundType);
+	// The FMVs are full screen, keep a couple of frames ready
+	_decoder->setDecodeAhead(2);
+	_decoder->setParallelDecode(true);
 
 	_texture = _gfx->createBitmap();
 	_texture->setSamplingFilter(StarkSettings->getImageSamplingFilter());
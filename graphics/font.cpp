@@ -112,20 +112,38 @@ void drawStringImpl(const Font &font, SurfaceType *dst, const StringType &str, i
 		x = x + w - width;
 	x += deltax;
 
-	typename StringType::unsigned_type last = 0;
-	for (typename StringType::const_iterator i = str.begin(), end = str.end(); i != end; ++i) {
-		const typename StringType::unsigned_type cur = *i;
+	// The characters are handed over in runs, which fonts may draw at once
+	uint32 run[64];
+	uint32 last = 0;
+	typename StringType::const_iterator i = str.begin(), end = str.end();
+	while (i != end) {
+		uint count = 0;
+		for (; i != end && count < ARRAYSIZE(run); ++i)
+			run[count++] = (typename StringType::unsigned_type)*i;
+
+		if (!font.drawChars(dst, run, count, last, x, y, leftX, rightX, color))
+			break;
+		last = run[count - 1];
+	}
+}
+
+template<class SurfaceType>
+bool drawCharsImpl(const Font &font, SurfaceType *dst, const uint32 *chars, uint count, uint32 last, int &x, int y, int leftX, int rightX, uint32 color) {
+	for (uint i = 0; i < count; ++i) {
+		const uint32 cur = chars[i];
 		x += font.getKerningOffset(last, cur);
 		last = cur;
 
 		Common::Rect charBox = font.getBoundingBox(cur);
 		if (x + charBox.right > rightX)
-			break;
+			return false;
 		if (x + charBox.right >= leftX)
 			font.drawChar(dst, cur, x, y, color);
 
 		x += font.getCharWidth(cur);
 	}
+
+	return true;
 }
 
 template<class StringType>
@@ -453,6 +471,14 @@ void Font::drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 color)
 	dst->addDirtyRect(charBox);
 }
 
+bool Font::drawChars(Surface *dst, const uint32 *chars, uint count, uint32 last, int &x, int y, int leftX, int rightX, uint32 color) const {
+	return drawCharsImpl(*this, dst, chars, count, last, x, y, leftX, rightX, color);
+}
+
+bool Font::drawChars(ManagedSurface *dst, const uint32 *chars, uint count, uint32 last, int &x, int y, int leftX, int rightX, uint32 color) const {
+	return drawCharsImpl(*this, dst, chars, count, last, x, y, leftX, rightX, color);
+}
+
 void Font::drawString(Surface *dst, const Common::String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax, bool useEllipsis) const {
 	Common::String renderStr = useEllipsis ? handleEllipsis(*this, str, w) : str;
 	drawStringImpl(*this, dst, renderStr, x, y, w, color, align, deltax);
@@ -189,6 +189,25 @@ public:
 	virtual void drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const = 0;
 	virtual void drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 color) const;
 
+	/**
+	 * Draw a run of characters, as drawString does once the string is
+	 * aligned. The characters are kerned, those whose bounding box ends
+	 * before @p leftX are skipped, and drawing stops at the first one whose
+	 * bounding box ends after @p rightX.
+	 *
+	 * The default implementation draws the characters one by one with
+	 * drawChar. Fonts may override it to draw the run at once.
+	 *
+	 * @param chars  The characters to draw.
+	 * @param count  The number of characters.
+	 * @param last   The character drawn before the run, for kerning, or 0.
+	 * @param x      The x coordinate where to draw the run, moved past it.
+	 *
+	 * @return Whether the run was drawn whole.
+	 */
+	virtual bool drawChars(Surface *dst, const uint32 *chars, uint count, uint32 last, int &x, int y, int leftX, int rightX, uint32 color) const;
+	virtual bool drawChars(ManagedSurface *dst, const uint32 *chars, uint count, uint32 last, int &x, int y, int leftX, int rightX, uint32 color) const;
+
 	/** @overload */
 
 	/**
@@ -32,6 +32,7 @@
 #include "graphics/managed_surface.h"
 
 #include "common/ustr.h"
+#include "common/debug.h"
 #include "common/file.h"
 #include "common/config-manager.h"
 #include "common/singleton.h"
@@ -106,11 +107,259 @@ private:
 	bool _initialized;
 };
 
+struct TTFGlyph {
+	Surface image;
+	int xOffset, yOffset;
+	int advance;
+	FT_UInt slot;
+};
+
+/**
+ * Glyphs rendered by all the TTF fonts, packed into large 8-bit pages.
+ *
+ * The glyphs are keyed by font and code point. The fonts loaded more than
+ * once with the same face and settings get the same id, so they share their
+ * glyphs. When the pages take the whole budget, the least recently used one
+ * is emptied, and its glyphs are rendered again when they are needed.
+ *
+ * Like the fonts, the cache is used on one thread at a time.
+ */
+class TTFGlyphCache : public Common::Singleton<TTFGlyphCache> {
+public:
+	TTFGlyphCache();
+	~TTFGlyphCache();
+
+	/**
+	 * Get the id of the fonts rendering the glyphs described.
+	 */
+	uint32 getFontId(const Common::String &description);
+
+	/**
+	 * Find a glyph. It is valid until the next call to add().
+	 */
+	const TTFGlyph *find(uint32 fontId, uint32 code);
+
+	/**
+	 * Add a rendered glyph, whose image is copied into a page. It is valid
+	 * until the next call to add().
+	 */
+	const TTFGlyph *add(uint32 fontId, uint32 code, const TTFGlyph &glyph);
+
+private:
+	enum {
+		kPageSize = 512,
+		// Upper bound in bytes of the pages, 16 pages of the default size
+		kMaxMemory = 16 * kPageSize * kPageSize
+	};
+
+	struct Key {
+		uint32 fontId;
+		uint32 code;
+
+		Key(uint32 f, uint32 c) : fontId(f), code(c) {}
+		bool operator==(const Key &key) const { return fontId == key.fontId && code == key.code; }
+	};
+
+	struct Key_Hash {
+		uint operator()(const Key &key) const { return key.fontId * 0x9E3779B1 ^ key.code; }
+	};
+
+	struct Entry {
+		TTFGlyph glyph;
+		uint page;
+	};
+
+	/** A row of glyphs of about the same height. */
+	struct Shelf {
+		int y, height;
+		int x;
+	};
+
+	struct Page {
+		Surface surface;
+		Common::Array<Shelf> shelves;
+		int freeY;
+		Common::Array<Key> keys;
+		uint32 lastUse;
+	};
+
+	typedef Common::HashMap<Key, Entry, Key_Hash> GlyphMap;
+
+	bool allocate(Page &page, int w, int h, Common::Point &pos);
+	uint addPage(int w, int h);
+	void clearPage(uint page);
+	void printStatistics(const char *event) const;
+
+	Common::HashMap<Common::String, uint32> _fontIds;
+	GlyphMap _glyphs;
+	Common::Array<Page *> _pages;
+	uint32 _memory;
+	uint32 _useCounter;
+
+	uint32 _hits, _misses, _evictions;
+};
+
+TTFGlyphCache::TTFGlyphCache() : _memory(0), _useCounter(0), _hits(0), _misses(0), _evictions(0) {
+}
+
+TTFGlyphCache::~TTFGlyphCache() {
+	printStatistics("shutdown");
+
+	for (uint i = 0; i < _pages.size(); i++) {
+		_pages[i]->surface.free();
+		delete _pages[i];
+	}
+}
+
+uint32 TTFGlyphCache::getFontId(const Common::String &description) {
+	Common::HashMap<Common::String, uint32>::const_iterator id = _fontIds.find(description);
+	if (id != _fontIds.end())
+		return id->_value;
+
+	const uint32 newId = _fontIds.size();
+	_fontIds[description] = newId;
+	return newId;
+}
+
+const TTFGlyph *TTFGlyphCache::find(uint32 fontId, uint32 code) {
+	GlyphMap::iterator entry = _glyphs.find(Key(fontId, code));
+	if (entry == _glyphs.end()) {
+		_misses++;
+		return nullptr;
+	}
+
+	_hits++;
+	_pages[entry->_value.page]->lastUse = ++_useCounter;
+	return &entry->_value.glyph;
+}
+
+const TTFGlyph *TTFGlyphCache::add(uint32 fontId, uint32 code, const TTFGlyph &glyph) {
+	const int w = glyph.image.w;
+	const int h = glyph.image.h;
+
+	// Glyphs larger than a page, from huge font sizes, get a page of their own
+	uint page = _pages.size();
+	Common::Point pos;
+	if (w <= kPageSize && h <= kPageSize) {
+		for (uint i = 0; i < _pages.size(); i++) {
+			if (_pages[i]->surface.w == kPageSize && _pages[i]->surface.h == kPageSize && allocate(*_pages[i], w, h, pos)) {
+				page = i;
+				break;
+			}
+		}
+	}
+
+	if (page == _pages.size()) {
+		page = addPage(MAX<int>(w, kPageSize), MAX<int>(h, kPageSize));
+		allocate(*_pages[page], w, h, pos);
+	}
+
+	Page &dst = *_pages[page];
+	const Key key(fontId, code);
+	Entry &entry = _glyphs[key];
+	entry.glyph = glyph;
+	entry.glyph.image = dst.surface.getSubArea(Common::Rect(pos.x, pos.y, pos.x + w, pos.y + h));
+	entry.page = page;
+	dst.keys.push_back(key);
+	dst.lastUse = ++_useCounter;
+
+	for (int y = 0; y < h; y++)
+		memcpy(entry.glyph.image.getBasePtr(0, y), glyph.image.getBasePtr(0, y), w);
+
+	return &entry.glyph;
+}
+
+bool TTFGlyphCache::allocate(Page &page, int w, int h, Common::Point &pos) {
+	// Shelves are shared by glyphs up to a third shorter than them
+	for (uint i = 0; i < page.shelves.size(); i++) {
+		Shelf &shelf = page.shelves[i];
+		if (h <= shelf.height && h * 3 >= shelf.height * 2 && shelf.x + w <= page.surface.w) {
+			pos = Common::Point(shelf.x, shelf.y);
+			shelf.x += w;
+			return true;
+		}
+	}
+
+	if (page.freeY + h > page.surface.h || w > page.surface.w)
+		return false;
+
+	Shelf shelf;
+	shelf.y = page.freeY;
+	shelf.height = h;
+	shelf.x = w;
+	page.shelves.push_back(shelf);
+	page.freeY += h;
+
+	pos = Common::Point(0, shelf.y);
+	return true;
+}
+
+uint TTFGlyphCache::addPage(int w, int h) {
+	// Empty the least recently used pages until the new one fits in the
+	// budget. A page of the default size is reused.
+	while (!_pages.empty() && _memory + w * h > kMaxMemory) {
+		uint oldest = 0;
+		for (uint i = 1; i < _pages.size(); i++) {
+			if (_pages[i]->lastUse < _pages[oldest]->lastUse)
+				oldest = i;
+		}
+
+		clearPage(oldest);
+		_evictions++;
+
+		Page *page = _pages[oldest];
+		if (page->surface.w == w && page->surface.h == h) {
+			printStatistics("page reused");
+			return oldest;
+		}
+
+		_memory -= page->surface.w * page->surface.h;
+		page->surface.free();
+		delete page;
+		_pages.remove_at(oldest);
+
+		// The pages after the removed one moved down
+		for (GlyphMap::iterator i = _glyphs.begin(); i != _glyphs.end(); ++i) {
+			if (i->_value.page > oldest)
+				i->_value.page--;
+		}
+	}
+
+	Page *page = new Page();
+	page->surface.create(w, h, PixelFormat::createFormatCLUT8());
+	page->freeY = 0;
+	page->lastUse = _useCounter;
+	_pages.push_back(page);
+	_memory += w * h;
+
+	printStatistics("page added");
+	return _pages.size() - 1;
+}
+
+void TTFGlyphCache::clearPage(uint page) {
+	Page &p = *_pages[page];
+	for (uint i = 0; i < p.keys.size(); i++)
+		_glyphs.erase(p.keys[i]);
+
+	p.keys.clear();
+	p.shelves.clear();
+	p.freeY = 0;
+}
+
+void TTFGlyphCache::printStatistics(const char *event) const {
+	const uint32 lookups = _hits + _misses;
+	debugC(1, kDebugGlobalFonts, "TTFGlyphCache: %s: %u glyphs of %u fonts in %u pages (%u KB), %u evicted, hit rate %.1f%% of %u lookups",
+	       event, _glyphs.size(), _fontIds.size(), _pages.size(), _memory / 1024, _evictions,
+	       lookups ? 100.0 * _hits / lookups : 0.0, lookups);
+}
+
 void shutdownTTF() {
+	TTFGlyphCache::destroy();
 	TTFLibrary::destroy();
 }
 
 #define g_ttf ::Graphics::TTFLibrary::instance()
+#define g_ttfGlyphs ::Graphics::TTFGlyphCache::instance()
 
 TTFLibrary::TTFLibrary() : _library(), _initialized(false) {
 	if (!FT_Init_FreeType(&_library))
@@ -161,6 +410,9 @@ public:
 	virtual void drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const;
 	virtual void drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 color) const;
 
+	virtual bool drawChars(Surface *dst, const uint32 *chars, uint count, uint32 last, int &x, int y, int leftX, int rightX, uint32 color) const;
+	virtual bool drawChars(ManagedSurface *dst, const uint32 *chars, uint count, uint32 last, int &x, int y, int leftX, int rightX, uint32 color) const;
+
 private:
 	bool _initialized;
 	FT_Face _face;
@@ -171,26 +423,27 @@ private:
 	int _width, _height;
 	int _ascent, _descent;
 
-	struct Glyph {
-		Surface image;
-		int xOffset, yOffset;
-		int advance;
-		FT_UInt slot;
-	};
+	/** Id of the glyphs of the font in the glyph cache. */
+	uint32 _fontId;
+	/** Code points of the characters, if they are mapped. */
+	Common::Array<uint32> _mapping;
 
-	bool cacheGlyph(Glyph &glyph, uint32 chr) const;
-	typedef Common::HashMap<uint32, Glyph> GlyphCache;
-	mutable GlyphCache _glyphs;
-	bool _allowLateCaching;
-	void assureCached(uint32 chr) const;
+	bool cacheGlyph(TTFGlyph &glyph, uint32 chr) const;
+	/**
+	 * Get the glyph of a character, rendering it if it is not cached. It is
+	 * valid until the next glyph is rendered.
+	 */
+	const TTFGlyph *getGlyph(uint32 chr) const;
 
 	Common::SeekableReadStream *readTTFTable(FT_ULong tag) const;
 
 	int computePointSize(int size, TTFSizeMode sizeMode) const;
 	int readPointSizeFromVDMXTable(int height) const;
 	int computePointSizeFromHeaders(int height) const;
-	void drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color,
+	void drawGlyph(Surface *dst, const TTFGlyph &glyph, int x, int y, uint32 color,
 		const uint32 *transparentColor) const;
+	bool drawChars(Surface *dst, const uint32 *chars, uint count, uint32 last, int &x, int y, int leftX, int rightX,
+		uint32 color, const uint32 *transparentColor, Common::Rect *drawnArea) const;
 
 	FT_Int32 _loadFlags;
 	FT_Render_Mode _renderMode;
@@ -202,8 +455,8 @@ private:
 
 TTFFont::TTFFont()
 	: _initialized(false), _face(), _ttfFile(0), _size(0), _width(0), _height(0), _ascent(0),
-	  _descent(0), _glyphs(), _loadFlags(FT_LOAD_TARGET_NORMAL), _renderMode(FT_RENDER_MODE_NORMAL),
-	  _hasKerning(false), _allowLateCaching(false), _fakeBold(false), _fakeItalic(false) {
+	  _descent(0), _fontId(0), _loadFlags(FT_LOAD_TARGET_NORMAL), _renderMode(FT_RENDER_MODE_NORMAL),
+	  _hasKerning(false), _fakeBold(false), _fakeItalic(false) {
 }
 
 TTFFont::~TTFFont() {
@@ -213,9 +466,6 @@ TTFFont::~TTFFont() {
 		delete[] _ttfFile;
 		_ttfFile = 0;
 
-		for (GlyphCache::iterator i = _glyphs.begin(), end = _glyphs.end(); i != end; ++i)
-			i->_value.image.free();
-
 		_initialized = false;
 	}
 }
@@ -303,7 +553,8 @@ bool TTFFont::load(uint8 *ttfFile, uint32 sizeFile, int32 faceIndex, bool bold,
 	// Check whether we have kerning support
 	_hasKerning = (FT_HAS_KERNING(_face) != 0);
 
-	if (FT_Set_Char_Size(_face, 0, computePointSize(size, sizeMode) * 64, dpi, dpi)) {
+	const int pointSize = computePointSize(size, sizeMode);
+	if (FT_Set_Char_Size(_face, 0, pointSize * 64, dpi, dpi)) {
 		g_ttf.closeFont(_face);
 
 		// Don't delete ttfFile as we return fail
@@ -367,40 +618,46 @@ bool TTFFont::load(uint8 *ttfFile, uint32 sizeFile, int32 faceIndex, bool bold,
 		_loadFlags |= FT_LOAD_NO_BITMAP;
 	}
 
+	// The fonts rendering the same glyphs share them in the glyph cache. The
+	// checksum of the head table covers the whole font file.
+	const TT_Header *head = (const TT_Header *)FT_Get_Sfnt_Table(_face, ft_sfnt_head);
+	_fontId = g_ttfGlyphs.getFontId(Common::String::format("%s/%s/%d/%u/%lx/%ld/%d/%u/%d/%d/%d/%d/%d",
+		_face->family_name ? _face->family_name : "", _face->style_name ? _face->style_name : "",
+		faceIndex, sizeFile, head ? (unsigned long)head->CheckSum_Adjust : 0UL, (long)_face->num_glyphs,
+		pointSize, dpi, (int)_loadFlags, (int)_renderMode, _fakeBold, _fakeItalic, stemDarkening));
+
+	uint numGlyphs = 0;
 	if (!mapping) {
 		// Allow loading of all unicode characters.
-		_allowLateCaching = true;
+		_mapping.clear();
 
 		// Load all ISO-8859-1 characters.
 		for (uint i = 0; i < 256; ++i) {
-			if (!cacheGlyph(_glyphs[i], i)) {
-				_glyphs.erase(i);
-			}
+			if (getGlyph(i))
+				numGlyphs++;
 		}
 	} else {
 		// We have a fixed map of characters do not load more later.
-		_allowLateCaching = false;
+		_mapping = Common::Array<uint32>(mapping, 256);
 
 		for (uint i = 0; i < 256; ++i) {
-			const uint32 unicode = mapping[i] & 0x7FFFFFFF;
 			const bool isRequired = (mapping[i] & 0x80000000) != 0;
 			// Check whether loading an important glyph fails and error out if
 			// that is the case.
-			if (!cacheGlyph(_glyphs[i], unicode)) {
-				_glyphs.erase(i);
-				if (isRequired) {
-					g_ttf.closeFont(_face);
+			if (getGlyph(i)) {
+				numGlyphs++;
+			} else if (isRequired) {
+				g_ttf.closeFont(_face);
 
-					// Don't delete ttfFile as we return fail
-					_ttfFile = 0;
+				// Don't delete ttfFile as we return fail
+				_ttfFile = 0;
 
-					return false;
-				}
+				return false;
 			}
 		}
 	}
 
-	if (_glyphs.size() == 0) {
+	if (numGlyphs == 0) {
 		g_ttf.closeFont(_face);
 
 		// Don't delete ttfFile as we return fail
@@ -549,37 +806,26 @@ int TTFFont::getMaxCharWidth() const {
 }
 
 int TTFFont::getCharWidth(uint32 chr) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end())
+	const TTFGlyph *glyph = getGlyph(chr);
+	if (!glyph)
 		return 0;
 	else
-		return glyphEntry->_value.advance;
+		return glyph->advance;
 }
 
 int TTFFont::getKerningOffset(uint32 left, uint32 right) const {
 	if (!_hasKerning)
 		return 0;
 
-	assureCached(left);
-	assureCached(right);
-
-	FT_UInt leftGlyph, rightGlyph;
-	GlyphCache::const_iterator glyphEntry;
-
-	glyphEntry = _glyphs.find(left);
-	if (glyphEntry != _glyphs.end()) {
-		leftGlyph = glyphEntry->_value.slot;
-	} else {
+	const TTFGlyph *glyph = getGlyph(left);
+	if (!glyph)
 		return 0;
-	}
+	const FT_UInt leftGlyph = glyph->slot;
 
-	glyphEntry = _glyphs.find(right);
-	if (glyphEntry != _glyphs.end()) {
-		rightGlyph = glyphEntry->_value.slot;
-	} else {
+	glyph = getGlyph(right);
+	if (!glyph)
 		return 0;
-	}
+	const FT_UInt rightGlyph = glyph->slot;
 
 	if (!leftGlyph || !rightGlyph)
 		return 0;
@@ -590,14 +836,13 @@ int TTFFont::getKerningOffset(uint32 left, uint32 right) const {
 }
 
 Common::Rect TTFFont::getBoundingBox(uint32 chr) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end()) {
+	const TTFGlyph *glyph = getGlyph(chr);
+	if (!glyph) {
 		return Common::Rect();
 	} else {
-		const int xOffset = glyphEntry->_value.xOffset;
-		const int yOffset = glyphEntry->_value.yOffset;
-		const Graphics::Surface &image = glyphEntry->_value.image;
+		const int xOffset = glyph->xOffset;
+		const int yOffset = glyph->yOffset;
+		const Graphics::Surface &image = glyph->image;
 		return Common::Rect(xOffset, yOffset, xOffset + image.w, yOffset + image.h);
 	}
 }
@@ -652,31 +897,93 @@ static void renderGlyph(uint8 *dstPos, const int dstPitch, const uint8 *srcPos,
 } // End of anonymous namespace
 
 void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const {
-	drawChar(dst, chr, x, y, color, nullptr);
+	const TTFGlyph *glyph = getGlyph(chr);
+	if (glyph)
+		drawGlyph(dst, *glyph, x, y, color, nullptr);
 }
 
 void TTFFont::drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 color) const {
+	const TTFGlyph *glyph = getGlyph(chr);
+	if (!glyph)
+		return;
+
 	if (dst->hasTransparentColor()) {
 		uint32 transColor = dst->getTransparentColor();
-		drawChar(dst->surfacePtr(), chr, x, y, color, &transColor);
+		drawGlyph(dst->surfacePtr(), *glyph, x, y, color, &transColor);
 	} else {
-		drawChar(dst->surfacePtr(), chr, x, y, color, nullptr);
+		drawGlyph(dst->surfacePtr(), *glyph, x, y, color, nullptr);
 	}
 
-	Common::Rect charBox = getBoundingBox(chr);
+	Common::Rect charBox(glyph->xOffset, glyph->yOffset, glyph->xOffset + glyph->image.w, glyph->yOffset + glyph->image.h);
 	charBox.translate(x, y);
 	dst->addDirtyRect(charBox);
 }
 
-void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
-		const uint32 *transparentColor) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end())
-		return;
+bool TTFFont::drawChars(Surface *dst, const uint32 *chars, uint count, uint32 last, int &x, int y, int leftX, int rightX, uint32 color) const {
+	return drawChars(dst, chars, count, last, x, y, leftX, rightX, color, nullptr, nullptr);
+}
+
+bool TTFFont::drawChars(ManagedSurface *dst, const uint32 *chars, uint count, uint32 last, int &x, int y, int leftX, int rightX, uint32 color) const {
+	uint32 transColor = dst->getTransparentColor();
+	Common::Rect drawnArea;
+	const bool drawnWhole = drawChars(dst->surfacePtr(), chars, count, last, x, y, leftX, rightX, color,
+		dst->hasTransparentColor() ? &transColor : nullptr, &drawnArea);
+
+	if (!drawnArea.isEmpty())
+		dst->addDirtyRect(drawnArea);
+	return drawnWhole;
+}
+
+bool TTFFont::drawChars(Surface *dst, const uint32 *chars, uint count, uint32 last, int &x, int y, int leftX, int rightX,
+		uint32 color, const uint32 *transparentColor, Common::Rect *drawnArea) const {
+	// Same as drawing the characters one by one, but every glyph is looked
+	// up once, and the area drawn is reported at once
+	FT_UInt lastSlot = 0;
+	if (_hasKerning && last) {
+		const TTFGlyph *glyph = getGlyph(last);
+		lastSlot = glyph ? glyph->slot : 0;
+	}
+
+	for (uint i = 0; i < count; ++i) {
+		// The glyph is valid until the next one is looked up
+		const TTFGlyph *glyph = getGlyph(chars[i]);
+		if (!glyph) {
+			if (x > rightX)
+				return false;
+			lastSlot = 0;
+			continue;
+		}
 
-	const Glyph &glyph = glyphEntry->_value;
+		if (lastSlot && glyph->slot) {
+			FT_Vector kerningVector;
+			FT_Get_Kerning(_face, lastSlot, glyph->slot, FT_KERNING_DEFAULT, &kerningVector);
+			x += kerningVector.x / 64;
+		}
+		lastSlot = glyph->slot;
+
+		Common::Rect charBox(glyph->xOffset, glyph->yOffset, glyph->xOffset + glyph->image.w, glyph->yOffset + glyph->image.h);
+		if (x + charBox.right > rightX)
+			return false;
+		if (x + charBox.right >= leftX) {
+			drawGlyph(dst, *glyph, x, y, color, transparentColor);
+
+			charBox.translate(x, y);
+			if (drawnArea && !charBox.isEmpty()) {
+				if (drawnArea->isEmpty())
+					*drawnArea = charBox;
+				else
+					drawnArea->extend(charBox);
+			}
+		}
+
+		x += glyph->advance;
+	}
+
+	return true;
+}
 
+void TTFFont::drawGlyph(Surface *dst, const TTFGlyph &glyph, int x, int y, uint32 color,
+		const uint32 *transparentColor) const {
 	x += glyph.xOffset;
 	y += glyph.yOffset;
 
@@ -742,7 +1049,7 @@ void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
 	}
 }
 
-bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
+bool TTFFont::cacheGlyph(TTFGlyph &glyph, uint32 chr) const {
 	FT_UInt slot = FT_Get_Char_Index(_face, chr);
 	if (!slot)
 		return false;
@@ -863,15 +1170,25 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	return true;
 }
 
-void TTFFont::assureCached(uint32 chr) const {
-	if (!chr || !_allowLateCaching || _glyphs.contains(chr)) {
-		return;
+const TTFGlyph *TTFFont::getGlyph(uint32 chr) const {
+	uint32 code = chr;
+	if (!_mapping.empty()) {
+		if (chr >= _mapping.size())
+			return nullptr;
+		code = _mapping[chr] & 0x7FFFFFFF;
 	}
 
-	Glyph newGlyph;
-	if (cacheGlyph(newGlyph, chr)) {
-		_glyphs[chr] = newGlyph;
-	}
+	const TTFGlyph *glyph = g_ttfGlyphs.find(_fontId, code);
+	if (glyph)
+		return glyph;
+
+	TTFGlyph newGlyph;
+	if (!cacheGlyph(newGlyph, code))
+		return nullptr;
+
+	glyph = g_ttfGlyphs.add(_fontId, code, newGlyph);
+	newGlyph.image.free();
+	return glyph;
 }
 
 Font *loadTTFFont(Common::SeekableReadStream &stream, int size, TTFSizeMode sizeMode, uint dpi, TTFRenderMode renderMode, const uint32 *mapping, bool stemDarkening) {
@@ -1078,6 +1395,7 @@ Font *findTTFace(const Common::Array<Common::String> &files, const Common::U32St
 
 namespace Common {
 DECLARE_SINGLETON(Graphics::TTFLibrary);
+DECLARE_SINGLETON(Graphics::TTFGlyphCache);
 } // End of namespace Common
 
 #endif
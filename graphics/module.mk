@@ -36,6 +36,7 @@ MODULE_OBJS := \
 	scaler/thumbnail_intern.o \
 	screen.o \
 	scaler/normal.o \
+	scaler/threadpool.o \
 	sjis.o \
 	surface.o \
 	svg.o \
@@ -82,7 +83,29 @@ MODULE_OBJS += \
 	tinygl/zmath.o \
 	tinygl/ztriangle.o \
 	tinygl/zblit.o \
-	tinygl/zdirtyrect.o
+	tinygl/zdirtyrect.o \
+	tinygl/ztiles.o
+
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	tinygl/zspan_sse2.o
+
+$(MODULE)/tinygl/zspan_sse2.o: CXXFLAGS += -msse2
+endif
+
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	tinygl/zspan_avx2.o
+
+$(MODULE)/tinygl/zspan_avx2.o: CXXFLAGS += -mavx2
+endif
+
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	tinygl/zspan_neon.o
+
+$(MODULE)/tinygl/zspan_neon.o: CXXFLAGS += $(NEON_CXXFLAGS)
+endif
 endif
 
 ifdef USE_ASPECT
@@ -96,6 +119,7 @@ MODULE_OBJS += \
 	scaler/sai.o \
 	scaler/pm.o \
 	scaler/downscaler.o \
+	scaler/kernels.o \
 	scaler/scale2x.o \
 	scaler/scale3x.o \
 	scaler/scalebit.o \
@@ -125,6 +149,33 @@ MODULE_OBJS += \
 	scaler/edge.o
 endif
 
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	scaler/kernels_sse2.o \
+	yuv_to_rgb_sse2.o
+
+$(MODULE)/scaler/kernels_sse2.o: CXXFLAGS += -msse2
+$(MODULE)/yuv_to_rgb_sse2.o: CXXFLAGS += -msse2
+endif
+
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	scaler/kernels_avx2.o \
+	yuv_to_rgb_avx2.o
+
+$(MODULE)/scaler/kernels_avx2.o: CXXFLAGS += -mavx2
+$(MODULE)/yuv_to_rgb_avx2.o: CXXFLAGS += -mavx2
+endif
+
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	scaler/kernels_neon.o \
+	yuv_to_rgb_neon.o
+
+$(MODULE)/scaler/kernels_neon.o: CXXFLAGS += $(NEON_CXXFLAGS)
+$(MODULE)/yuv_to_rgb_neon.o: CXXFLAGS += $(NEON_CXXFLAGS)
+endif
+
 endif
 
 # Include common rules
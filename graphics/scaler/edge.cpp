@@ -97,6 +97,8 @@
 #include "common/system.h"
 #include "graphics/scaler/intern.h"
 #include "graphics/scaler/edge.h"
+#include "graphics/scaler/kernels.h"
+#include "common/array.h"
 
 /* Randomly XORs one of 2x2 or 3x3 resized pixels in order to indicate
  * which pixels have been redrawn.  Useful for seeing which areas of
@@ -3330,8 +3332,12 @@ void EdgeScaler::antiAliasPass3x(const uint8 *src, uint8 *dst,
 	int16 *diffs;
 	int dstPitch3 = dstPitch * 3;
 	int bufferPitch3 = bufferPitch * 3;
+	const SolidMaskProc solidMask = sizeof(Pixel) == 2 ? getScalerKernels().solidMask16 : getScalerKernels().solidMask32;
+	Common::Array<uint8> solid(w);
 
 	for (y = 0; y < h; y++, sptr8 += srcPitch, dptr8 += dstPitch3, oldSrc += oldPitch, buffer += bufferPitch3) {
+		solidMask(solid.begin(), sptr8, srcPitch, w);
+
 		for (x = 0,
 		        sptr16 = (const Pixel *) sptr8,
 		        oldSptr = (const Pixel *) oldSrc,
@@ -3366,9 +3372,16 @@ void EdgeScaler::antiAliasPass3x(const uint8 *src, uint8 *dst,
 				}
 			}
 
+			/* block of solid color */
+			if (solid[x]) {
+				antiAliasGridClean3x<ColorMask>((uint8 *) dptr16, dstPitch, pixels,
+				                                    0, NULL);
+				continue;
+			}
+
 			diffs = chooseGreyscale<ColorMask>(pixels);
 
-			/* block of solid color */
+			/* block of solid color in greyscale */
 			if (!diffs) {
 				antiAliasGridClean3x<ColorMask>((uint8 *) dptr16, dstPitch, pixels,
 				                                    0, NULL);
@@ -3415,8 +3428,12 @@ void EdgeScaler::antiAliasPass2x(const uint8 *src, uint8 *dst,
 	int16 *diffs;
 	int dstPitch2 = dstPitch << 1;
 	int bufferPitch2 = bufferPitch * 2;
+	const SolidMaskProc solidMask = sizeof(Pixel) == 2 ? getScalerKernels().solidMask16 : getScalerKernels().solidMask32;
+	Common::Array<uint8> solid(w);
 
 	for (y = 0; y < h; y++, sptr8 += srcPitch, dptr8 += dstPitch2, oldSrc += oldSrcPitch, buffer += bufferPitch2) {
+		solidMask(solid.begin(), sptr8, srcPitch, w);
+
 		for (x = 0,
 		        sptr16 = (const Pixel *) sptr8,
 		        dptr16 = (Pixel *) dptr8,
@@ -3451,9 +3468,16 @@ void EdgeScaler::antiAliasPass2x(const uint8 *src, uint8 *dst,
 				}
 			}
 
+			/* block of solid color */
+			if (solid[x]) {
+				antiAliasGrid2x<ColorMask>((uint8 *) dptr16, dstPitch, pixels,
+				                              0, NULL, NULL, 0);
+				continue;
+			}
+
 			diffs = chooseGreyscale<ColorMask>(pixels);
 
-			/* block of solid color */
+			/* block of solid color in greyscale */
 			if (!diffs) {
 				antiAliasGrid2x<ColorMask>((uint8 *) dptr16, dstPitch, pixels,
 				                              0, NULL, NULL, 0);
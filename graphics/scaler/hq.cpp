@@ -21,6 +21,8 @@
 #include "graphics/scaler/hq.h"
 #include "graphics/scaler.h"
 #include "graphics/scaler/intern.h"
+#include "graphics/scaler/kernels.h"
+#include "common/array.h"
 
 // RGB-to-YUV lookup table
 extern "C" {
@@ -213,6 +215,56 @@ static inline uint32 ConvertYUV(uint32 x) {
 	return RGBtoYUV[r | g | b];
 }
 
+/**
+ * Keeps the YUV values of the rows around the current one, and classifies
+ * the pixels of the current row a whole row at a time.
+ */
+template<typename ColorMask>
+class HQPatternRows {
+	typedef typename ColorMask::PixelType Pixel;
+
+public:
+	HQPatternRows(const Pixel *p, uint32 nextlineSrc, int width) :
+		_nextlineSrc(nextlineSrc), _width(width), _yuv(3 * (width + 2)), _patterns(width),
+		_hqPatterns(getScalerKernels().hqPatterns) {
+		_above = &_yuv[0];
+		_row = &_yuv[width + 2];
+		_below = &_yuv[2 * (width + 2)];
+
+		convertRow(_above, p - nextlineSrc - 1);
+		convertRow(_row, p - 1);
+	}
+
+	/**
+	 * Return the patterns of the row starting at p, and move on to the
+	 * next row.
+	 */
+	const uint8 *next(const Pixel *p) {
+		convertRow(_below, p + _nextlineSrc - 1);
+		_hqPatterns(_patterns.begin(), _above, _row, _below, _width);
+
+		uint32 *const tmp = _above;
+		_above = _row;
+		_row = _below;
+		_below = tmp;
+
+		return _patterns.begin();
+	}
+
+private:
+	void convertRow(uint32 *yuv, const Pixel *p) const {
+		for (int x = 0; x < _width + 2; x++)
+			yuv[x] = sizeof(Pixel) == 2 ? RGBtoYUV[p[x]] : ConvertYUV<ColorMask>(p[x]);
+	}
+
+	const uint32 _nextlineSrc;
+	const int _width;
+	Common::Array<uint32> _yuv;
+	Common::Array<uint8> _patterns;
+	const HQPatternProc _hqPatterns;
+	uint32 *_above, *_row, *_below;
+};
+
 /*
  * The HQ2x high quality 2x graphics filter.
  * Original author Maxim Stepin (see http://www.hiend3d.com/hq2x.html).
@@ -241,7 +293,11 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 	//	 | w7 | w8 | w9 |
 	//	 +----+----+----+
 
+	HQPatternRows<ColorMask> rows(p, nextlineSrc, width);
+
 	while (height--) {
+		const uint8 *patterns = rows.next(p);
+
 		w1 = *(p - 1 - nextlineSrc);
 		w4 = *(p - 1);
 		w7 = *(p - 1 + nextlineSrc);
@@ -258,16 +314,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			w6 = *(p);
 			w9 = *(p + nextlineSrc);
 
-			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			const int pattern = *patterns++;
 
 			switch (pattern) {
 			case 0:
@@ -2179,7 +2226,11 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 	//	 | w7 | w8 | w9 |
 	//	 +----+----+----+
 
+	HQPatternRows<ColorMask> rows(p, nextlineSrc, width);
+
 	while (height--) {
+		const uint8 *patterns = rows.next(p);
+
 		w1 = *(p - 1 - nextlineSrc);
 		w4 = *(p - 1);
 		w7 = *(p - 1 + nextlineSrc);
@@ -2196,16 +2247,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			w6 = *(p);
 			w9 = *(p + nextlineSrc);
 
-			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			const int pattern = *patterns++;
 
 			switch (pattern) {
 			case 0:
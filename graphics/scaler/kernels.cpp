@@ -0,0 +1,70 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "graphics/scaler/kernels.h"
+#include "graphics/scaler/intern.h"
+#include "common/system.h"
+
+void hqPatternsScalar(uint8 *patterns, const uint32 *above, const uint32 *row, const uint32 *below, int width) {
+	for (int x = 0; x < width; x++) {
+		const int yuv5 = row[x + 1];
+
+		int pattern = 0;
+		if (diffYUV(yuv5, above[x]))     pattern |= 0x0001;
+		if (diffYUV(yuv5, above[x + 1])) pattern |= 0x0002;
+		if (diffYUV(yuv5, above[x + 2])) pattern |= 0x0004;
+		if (diffYUV(yuv5, row[x]))       pattern |= 0x0008;
+		if (diffYUV(yuv5, row[x + 2]))   pattern |= 0x0010;
+		if (diffYUV(yuv5, below[x]))     pattern |= 0x0020;
+		if (diffYUV(yuv5, below[x + 1])) pattern |= 0x0040;
+		if (diffYUV(yuv5, below[x + 2])) pattern |= 0x0080;
+		patterns[x] = pattern;
+	}
+}
+
+static const ScalerKernels scalarScalerKernels = {
+	hqPatternsScalar,
+	solidMaskScalar<uint16>,
+	solidMaskScalar<uint32>
+};
+
+const ScalerKernels &getScalarScalerKernels() {
+	return scalarScalerKernels;
+}
+
+const ScalerKernels &getScalerKernels() {
+	if (g_system) {
+#ifdef SCUMMVM_NEON
+		if (g_system->hasFeature(OSystem::kFeatureCpuNEON))
+			return getNEONScalerKernels();
+#endif
+#ifdef SCUMMVM_AVX2
+		if (g_system->hasFeature(OSystem::kFeatureCpuAVX2))
+			return getAVX2ScalerKernels();
+#endif
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2))
+			return getSSE2ScalerKernels();
+#endif
+	}
+
+	return scalarScalerKernels;
+}
@@ -0,0 +1,121 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_SCALER_KERNELS_H
+#define GRAPHICS_SCALER_KERNELS_H
+
+#include "common/scummsys.h"
+
+/**
+ * @defgroup graphics_scaler_kernels Scaler kernels
+ * @ingroup graphics
+ *
+ * @brief Inner loops of the software scalers which have SIMD
+ * implementations.
+ *
+ * The scalers use these to classify whole rows of source pixels before
+ * doing the per pixel work, which remains plain C++. Every implementation
+ * produces exactly the same results.
+ * @{
+ */
+
+/**
+ * Compute the HQx patterns of a row of pixels. Bit n of the pattern of a
+ * pixel is set if the YUV value of its nth neighbour (in the order top
+ * left, top, top right, left, right, bottom left, bottom, bottom right)
+ * differs noticeably from its own, see diffYUV().
+ *
+ * @param patterns Receives width patterns.
+ * @param above    YUV values of the row above, starting with the top left
+ *                 neighbour of the first pixel. Holds width + 2 values.
+ * @param row      YUV values of the row, starting with the left neighbour
+ *                 of the first pixel.
+ * @param below    YUV values of the row below.
+ * @param width    Number of pixels.
+ */
+typedef void (*HQPatternProc)(uint8 *patterns, const uint32 *above, const uint32 *row, const uint32 *below, int width);
+
+/**
+ * Find the pixels of a row whose eight neighbours all have the same value
+ * as the pixel itself.
+ *
+ * @param solid    Receives width values, non-zero for uniform pixels.
+ * @param src      First pixel of the row. The neighbours of all pixels
+ *                 must be readable.
+ * @param srcPitch Distance between two rows in bytes.
+ * @param width    Number of pixels.
+ */
+typedef void (*SolidMaskProc)(uint8 *solid, const byte *src, uint32 srcPitch, int width);
+
+struct ScalerKernels {
+	HQPatternProc hqPatterns;
+	/** Solid mask of 16 bit pixels. */
+	SolidMaskProc solidMask16;
+	/** Solid mask of 32 bit pixels. */
+	SolidMaskProc solidMask32;
+};
+
+/**
+ * Return the plain C++ kernels.
+ */
+const ScalerKernels &getScalarScalerKernels();
+
+/**
+ * Return the fastest kernels supported by the host CPU.
+ */
+const ScalerKernels &getScalerKernels();
+
+#ifdef SCUMMVM_SSE2
+const ScalerKernels &getSSE2ScalerKernels();
+#endif
+
+#ifdef SCUMMVM_AVX2
+const ScalerKernels &getAVX2ScalerKernels();
+#endif
+
+#ifdef SCUMMVM_NEON
+const ScalerKernels &getNEONScalerKernels();
+#endif
+
+/**
+ * Scalar implementations, also used by the SIMD kernels for the pixels
+ * which do not fill a whole vector.
+ */
+void hqPatternsScalar(uint8 *patterns, const uint32 *above, const uint32 *row, const uint32 *below, int width);
+
+// Static, so that every file gets a copy compiled for its instruction set
+template<typename Pixel>
+static void solidMaskScalar(uint8 *solid, const byte *src, uint32 srcPitch, int width) {
+	const Pixel *above = (const Pixel *)(src - srcPitch);
+	const Pixel *row = (const Pixel *)src;
+	const Pixel *below = (const Pixel *)(src + srcPitch);
+
+	for (int x = 0; x < width; x++) {
+		const Pixel center = row[x];
+		solid[x] = above[x - 1] == center && above[x] == center && above[x + 1] == center &&
+		           row[x - 1] == center && row[x + 1] == center &&
+		           below[x - 1] == center && below[x] == center && below[x + 1] == center;
+	}
+}
+
+/** @} */
+
+#endif
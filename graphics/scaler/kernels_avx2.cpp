@@ -0,0 +1,128 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <immintrin.h>
+
+#include "graphics/scaler/kernels.h"
+
+/**
+ * Return all ones in the lanes where the YUV values differ noticeably,
+ * see diffYUV(). The values are compared byte by byte, against a
+ * threshold of 0x30 for Y, 7 for U and 6 for V.
+ */
+static inline __m256i diffYUVVector(__m256i yuv1, __m256i yuv2) {
+	const __m256i threshold = _mm256_set1_epi32(0x00300706);
+	const __m256i diff = _mm256_or_si256(_mm256_subs_epu8(yuv1, yuv2), _mm256_subs_epu8(yuv2, yuv1));
+	const __m256i same = _mm256_cmpeq_epi32(_mm256_subs_epu8(diff, threshold), _mm256_setzero_si256());
+	return _mm256_xor_si256(same, _mm256_set1_epi32(-1));
+}
+
+static inline __m256i patternBit(__m256i yuv5, const uint32 *neighbour, int bit) {
+	return _mm256_and_si256(diffYUVVector(yuv5, _mm256_loadu_si256((const __m256i *)neighbour)), _mm256_set1_epi32(bit));
+}
+
+/** Narrow eight 32 bit lanes holding 0 to 255 or -1 to bytes. */
+static inline __m128i packLanes32(__m256i v) {
+	const __m128i v16 = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+	return _mm_packs_epi16(v16, v16);
+}
+
+static void hqPatternsAVX2(uint8 *patterns, const uint32 *above, const uint32 *row, const uint32 *below, int width) {
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		const __m256i yuv5 = _mm256_loadu_si256((const __m256i *)(row + x + 1));
+
+		__m256i pattern = patternBit(yuv5, above + x, 0x01);
+		pattern = _mm256_or_si256(pattern, patternBit(yuv5, above + x + 1, 0x02));
+		pattern = _mm256_or_si256(pattern, patternBit(yuv5, above + x + 2, 0x04));
+		pattern = _mm256_or_si256(pattern, patternBit(yuv5, row + x, 0x08));
+		pattern = _mm256_or_si256(pattern, patternBit(yuv5, row + x + 2, 0x10));
+		pattern = _mm256_or_si256(pattern, patternBit(yuv5, below + x, 0x20));
+		pattern = _mm256_or_si256(pattern, patternBit(yuv5, below + x + 1, 0x40));
+		pattern = _mm256_or_si256(pattern, patternBit(yuv5, below + x + 2, 0x80));
+
+		// The patterns do not fit signed bytes
+		const __m128i pattern16 = _mm_packs_epi32(_mm256_castsi256_si128(pattern), _mm256_extracti128_si256(pattern, 1));
+		_mm_storel_epi64((__m128i *)(patterns + x), _mm_packus_epi16(pattern16, pattern16));
+	}
+
+	hqPatternsScalar(patterns + x, above + x, row + x, below + x, width - x);
+}
+
+static inline __m256i equal16(const byte *p, __m256i center) {
+	return _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i *)p), center);
+}
+
+static void solidMask16AVX2(uint8 *solid, const byte *src, uint32 srcPitch, int width) {
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const byte *p = src + x * 2;
+		const __m256i center = _mm256_loadu_si256((const __m256i *)p);
+
+		__m256i mask = equal16(p - 2, center);
+		mask = _mm256_and_si256(mask, equal16(p + 2, center));
+		mask = _mm256_and_si256(mask, equal16(p - srcPitch - 2, center));
+		mask = _mm256_and_si256(mask, equal16(p - srcPitch, center));
+		mask = _mm256_and_si256(mask, equal16(p - srcPitch + 2, center));
+		mask = _mm256_and_si256(mask, equal16(p + srcPitch - 2, center));
+		mask = _mm256_and_si256(mask, equal16(p + srcPitch, center));
+		mask = _mm256_and_si256(mask, equal16(p + srcPitch + 2, center));
+
+		_mm_storeu_si128((__m128i *)(solid + x), _mm_packs_epi16(_mm256_castsi256_si128(mask), _mm256_extracti128_si256(mask, 1)));
+	}
+
+	solidMaskScalar<uint16>(solid + x, src + x * 2, srcPitch, width - x);
+}
+
+static inline __m256i equal32(const byte *p, __m256i center) {
+	return _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)p), center);
+}
+
+static void solidMask32AVX2(uint8 *solid, const byte *src, uint32 srcPitch, int width) {
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		const byte *p = src + x * 4;
+		const __m256i center = _mm256_loadu_si256((const __m256i *)p);
+
+		__m256i mask = equal32(p - 4, center);
+		mask = _mm256_and_si256(mask, equal32(p + 4, center));
+		mask = _mm256_and_si256(mask, equal32(p - srcPitch - 4, center));
+		mask = _mm256_and_si256(mask, equal32(p - srcPitch, center));
+		mask = _mm256_and_si256(mask, equal32(p - srcPitch + 4, center));
+		mask = _mm256_and_si256(mask, equal32(p + srcPitch - 4, center));
+		mask = _mm256_and_si256(mask, equal32(p + srcPitch, center));
+		mask = _mm256_and_si256(mask, equal32(p + srcPitch + 4, center));
+
+		_mm_storel_epi64((__m128i *)(solid + x), packLanes32(mask));
+	}
+
+	solidMaskScalar<uint32>(solid + x, src + x * 4, srcPitch, width - x);
+}
+
+static const ScalerKernels avx2ScalerKernels = {
+	hqPatternsAVX2,
+	solidMask16AVX2,
+	solidMask32AVX2
+};
+
+const ScalerKernels &getAVX2ScalerKernels() {
+	return avx2ScalerKernels;
+}
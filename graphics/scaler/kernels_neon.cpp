@@ -0,0 +1,120 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <arm_neon.h>
+
+#include "graphics/scaler/kernels.h"
+
+/**
+ * Return the bits of the lanes where the YUV values differ noticeably,
+ * see diffYUV(). The values are compared byte by byte, against a
+ * threshold of 0x30 for Y, 7 for U and 6 for V.
+ */
+static inline uint32x4_t patternBit(uint8x16_t yuv5, const uint32 *neighbour, uint32 bit) {
+	const uint8x16_t threshold = vreinterpretq_u8_u32(vdupq_n_u32(0x00300706));
+	const uint8x16_t diff = vabdq_u8(yuv5, vreinterpretq_u8_u32(vld1q_u32(neighbour)));
+	const uint32x4_t same = vceqq_u32(vreinterpretq_u32_u8(vqsubq_u8(diff, threshold)), vdupq_n_u32(0));
+	return vbicq_u32(vdupq_n_u32(bit), same);
+}
+
+static void hqPatternsNEON(uint8 *patterns, const uint32 *above, const uint32 *row, const uint32 *below, int width) {
+	int x = 0;
+	for (; x + 4 <= width; x += 4) {
+		const uint8x16_t yuv5 = vreinterpretq_u8_u32(vld1q_u32(row + x + 1));
+
+		uint32x4_t pattern = patternBit(yuv5, above + x, 0x01);
+		pattern = vorrq_u32(pattern, patternBit(yuv5, above + x + 1, 0x02));
+		pattern = vorrq_u32(pattern, patternBit(yuv5, above + x + 2, 0x04));
+		pattern = vorrq_u32(pattern, patternBit(yuv5, row + x, 0x08));
+		pattern = vorrq_u32(pattern, patternBit(yuv5, row + x + 2, 0x10));
+		pattern = vorrq_u32(pattern, patternBit(yuv5, below + x, 0x20));
+		pattern = vorrq_u32(pattern, patternBit(yuv5, below + x + 1, 0x40));
+		pattern = vorrq_u32(pattern, patternBit(yuv5, below + x + 2, 0x80));
+
+		const uint16x4_t pattern16 = vmovn_u32(pattern);
+		const uint8x8_t pattern8 = vmovn_u16(vcombine_u16(pattern16, pattern16));
+		vst1_lane_u32((uint32_t *)(void *)(patterns + x), vreinterpret_u32_u8(pattern8), 0);
+	}
+
+	hqPatternsScalar(patterns + x, above + x, row + x, below + x, width - x);
+}
+
+static inline uint16x8_t equal16(const byte *p, uint16x8_t center) {
+	return vceqq_u16(vld1q_u16((const uint16_t *)(const void *)p), center);
+}
+
+static void solidMask16NEON(uint8 *solid, const byte *src, uint32 srcPitch, int width) {
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		const byte *p = src + x * 2;
+		const uint16x8_t center = vld1q_u16((const uint16_t *)(const void *)p);
+
+		uint16x8_t mask = equal16(p - 2, center);
+		mask = vandq_u16(mask, equal16(p + 2, center));
+		mask = vandq_u16(mask, equal16(p - srcPitch - 2, center));
+		mask = vandq_u16(mask, equal16(p - srcPitch, center));
+		mask = vandq_u16(mask, equal16(p - srcPitch + 2, center));
+		mask = vandq_u16(mask, equal16(p + srcPitch - 2, center));
+		mask = vandq_u16(mask, equal16(p + srcPitch, center));
+		mask = vandq_u16(mask, equal16(p + srcPitch + 2, center));
+
+		vst1_u8(solid + x, vmovn_u16(mask));
+	}
+
+	solidMaskScalar<uint16>(solid + x, src + x * 2, srcPitch, width - x);
+}
+
+static inline uint32x4_t equal32(const byte *p, uint32x4_t center) {
+	return vceqq_u32(vld1q_u32((const uint32_t *)(const void *)p), center);
+}
+
+static void solidMask32NEON(uint8 *solid, const byte *src, uint32 srcPitch, int width) {
+	int x = 0;
+	for (; x + 4 <= width; x += 4) {
+		const byte *p = src + x * 4;
+		const uint32x4_t center = vld1q_u32((const uint32_t *)(const void *)p);
+
+		uint32x4_t mask = equal32(p - 4, center);
+		mask = vandq_u32(mask, equal32(p + 4, center));
+		mask = vandq_u32(mask, equal32(p - srcPitch - 4, center));
+		mask = vandq_u32(mask, equal32(p - srcPitch, center));
+		mask = vandq_u32(mask, equal32(p - srcPitch + 4, center));
+		mask = vandq_u32(mask, equal32(p + srcPitch - 4, center));
+		mask = vandq_u32(mask, equal32(p + srcPitch, center));
+		mask = vandq_u32(mask, equal32(p + srcPitch + 4, center));
+
+		const uint16x4_t mask16 = vmovn_u32(mask);
+		const uint8x8_t mask8 = vmovn_u16(vcombine_u16(mask16, mask16));
+		vst1_lane_u32((uint32_t *)(void *)(solid + x), vreinterpret_u32_u8(mask8), 0);
+	}
+
+	solidMaskScalar<uint32>(solid + x, src + x * 4, srcPitch, width - x);
+}
+
+static const ScalerKernels neonScalerKernels = {
+	hqPatternsNEON,
+	solidMask16NEON,
+	solidMask32NEON
+};
+
+const ScalerKernels &getNEONScalerKernels() {
+	return neonScalerKernels;
+}
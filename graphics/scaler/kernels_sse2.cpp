@@ -0,0 +1,124 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <emmintrin.h>
+
+#include "graphics/scaler/kernels.h"
+#include "common/endian.h"
+
+/**
+ * Return all ones in the lanes where the YUV values differ noticeably,
+ * see diffYUV(). The values are compared byte by byte, against a
+ * threshold of 0x30 for Y, 7 for U and 6 for V.
+ */
+static inline __m128i diffYUVVector(__m128i yuv1, __m128i yuv2) {
+	const __m128i threshold = _mm_set1_epi32(0x00300706);
+	const __m128i diff = _mm_or_si128(_mm_subs_epu8(yuv1, yuv2), _mm_subs_epu8(yuv2, yuv1));
+	const __m128i same = _mm_cmpeq_epi32(_mm_subs_epu8(diff, threshold), _mm_setzero_si128());
+	return _mm_xor_si128(same, _mm_set1_epi32(-1));
+}
+
+static inline __m128i patternBit(__m128i yuv5, const uint32 *neighbour, int bit) {
+	return _mm_and_si128(diffYUVVector(yuv5, _mm_loadu_si128((const __m128i *)neighbour)), _mm_set1_epi32(bit));
+}
+
+static void hqPatternsSSE2(uint8 *patterns, const uint32 *above, const uint32 *row, const uint32 *below, int width) {
+	int x = 0;
+	for (; x + 4 <= width; x += 4) {
+		const __m128i yuv5 = _mm_loadu_si128((const __m128i *)(row + x + 1));
+
+		__m128i pattern = patternBit(yuv5, above + x, 0x01);
+		pattern = _mm_or_si128(pattern, patternBit(yuv5, above + x + 1, 0x02));
+		pattern = _mm_or_si128(pattern, patternBit(yuv5, above + x + 2, 0x04));
+		pattern = _mm_or_si128(pattern, patternBit(yuv5, row + x, 0x08));
+		pattern = _mm_or_si128(pattern, patternBit(yuv5, row + x + 2, 0x10));
+		pattern = _mm_or_si128(pattern, patternBit(yuv5, below + x, 0x20));
+		pattern = _mm_or_si128(pattern, patternBit(yuv5, below + x + 1, 0x40));
+		pattern = _mm_or_si128(pattern, patternBit(yuv5, below + x + 2, 0x80));
+
+		pattern = _mm_packs_epi32(pattern, pattern);
+		pattern = _mm_packus_epi16(pattern, pattern);
+		WRITE_UINT32(patterns + x, _mm_cvtsi128_si32(pattern));
+	}
+
+	hqPatternsScalar(patterns + x, above + x, row + x, below + x, width - x);
+}
+
+static inline __m128i equal16(const byte *p, __m128i center) {
+	return _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)p), center);
+}
+
+static void solidMask16SSE2(uint8 *solid, const byte *src, uint32 srcPitch, int width) {
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		const byte *p = src + x * 2;
+		const __m128i center = _mm_loadu_si128((const __m128i *)p);
+
+		__m128i mask = equal16(p - 2, center);
+		mask = _mm_and_si128(mask, equal16(p + 2, center));
+		mask = _mm_and_si128(mask, equal16(p - srcPitch - 2, center));
+		mask = _mm_and_si128(mask, equal16(p - srcPitch, center));
+		mask = _mm_and_si128(mask, equal16(p - srcPitch + 2, center));
+		mask = _mm_and_si128(mask, equal16(p + srcPitch - 2, center));
+		mask = _mm_and_si128(mask, equal16(p + srcPitch, center));
+		mask = _mm_and_si128(mask, equal16(p + srcPitch + 2, center));
+
+		_mm_storel_epi64((__m128i *)(solid + x), _mm_packs_epi16(mask, mask));
+	}
+
+	solidMaskScalar<uint16>(solid + x, src + x * 2, srcPitch, width - x);
+}
+
+static inline __m128i equal32(const byte *p, __m128i center) {
+	return _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)p), center);
+}
+
+static void solidMask32SSE2(uint8 *solid, const byte *src, uint32 srcPitch, int width) {
+	int x = 0;
+	for (; x + 4 <= width; x += 4) {
+		const byte *p = src + x * 4;
+		const __m128i center = _mm_loadu_si128((const __m128i *)p);
+
+		__m128i mask = equal32(p - 4, center);
+		mask = _mm_and_si128(mask, equal32(p + 4, center));
+		mask = _mm_and_si128(mask, equal32(p - srcPitch - 4, center));
+		mask = _mm_and_si128(mask, equal32(p - srcPitch, center));
+		mask = _mm_and_si128(mask, equal32(p - srcPitch + 4, center));
+		mask = _mm_and_si128(mask, equal32(p + srcPitch - 4, center));
+		mask = _mm_and_si128(mask, equal32(p + srcPitch, center));
+		mask = _mm_and_si128(mask, equal32(p + srcPitch + 4, center));
+
+		mask = _mm_packs_epi32(mask, mask);
+		WRITE_UINT32(solid + x, _mm_cvtsi128_si32(_mm_packs_epi16(mask, mask)));
+	}
+
+	solidMaskScalar<uint32>(solid + x, src + x * 4, srcPitch, width - x);
+}
+
+static const ScalerKernels sse2ScalerKernels = {
+	hqPatternsSSE2,
+	solidMask16SSE2,
+	solidMask32SSE2
+};
+
+const ScalerKernels &getSSE2ScalerKernels() {
+	return sse2ScalerKernels;
+}
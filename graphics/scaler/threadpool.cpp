@@ -0,0 +1,116 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "graphics/scaler/threadpool.h"
+#include "graphics/scalerplugin.h"
+
+ScalerThreadPool::ScalerThreadPool(uint numThreads) : _nextBand(0), _quit(false) {
+	for (uint i = 0; i < numThreads; i++) {
+		Common::Thread *thread = new Common::Thread(threadProc, this);
+		if (!thread->isRunning()) {
+			delete thread;
+			break;
+		}
+		_threads.push_back(thread);
+	}
+}
+
+ScalerThreadPool::~ScalerThreadPool() {
+	_mutex.lock();
+	_quit = true;
+	_mutex.unlock();
+
+	for (uint i = 0; i < _threads.size(); i++)
+		_start.post();
+	for (uint i = 0; i < _threads.size(); i++)
+		delete _threads[i];
+}
+
+void ScalerThreadPool::scale(Scaler *scaler, const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+                             int width, int height, int x, int y, int minBandHeight) {
+	const int numBands = MIN<int>(_threads.size() + 1, height / MAX(minBandHeight, 1));
+	if (numBands <= 1) {
+		scaler->scale(srcPtr, srcPitch, dstPtr, dstPitch, width, height, x, y);
+		return;
+	}
+
+	_mutex.lock();
+	_job.scaler = scaler;
+	_job.srcPtr = srcPtr;
+	_job.srcPitch = srcPitch;
+	_job.dstPtr = dstPtr;
+	_job.dstPitch = dstPitch;
+	_job.width = width;
+	_job.height = height;
+	_job.x = x;
+	_job.y = y;
+	_job.factor = scaler->getFactor();
+	_job.numBands = numBands;
+	_nextBand = 0;
+	_mutex.unlock();
+
+	for (int i = 1; i < numBands; i++)
+		_start.post();
+
+	scaleBands();
+
+	// Every thread woken up takes part, even if the bands are all gone
+	// by then, so that none of them still looks at this job afterwards
+	for (int i = 1; i < numBands; i++)
+		_done.wait();
+}
+
+void ScalerThreadPool::scaleBands() {
+	for (;;) {
+		_mutex.lock();
+		const Job job = _job;
+		const int band = _nextBand < job.numBands ? _nextBand++ : -1;
+		_mutex.unlock();
+
+		if (band < 0)
+			break;
+
+		const int top = job.height * band / job.numBands;
+		const int bottom = job.height * (band + 1) / job.numBands;
+		job.scaler->scale(job.srcPtr + top * job.srcPitch, job.srcPitch,
+		                  job.dstPtr + top * job.factor * job.dstPitch, job.dstPitch,
+		                  job.width, bottom - top, job.x, job.y + top);
+	}
+}
+
+void ScalerThreadPool::threadProc(void *param) {
+	((ScalerThreadPool *)param)->run();
+}
+
+void ScalerThreadPool::run() {
+	for (;;) {
+		_start.wait();
+
+		_mutex.lock();
+		const bool quit = _quit;
+		_mutex.unlock();
+		if (quit)
+			break;
+
+		scaleBands();
+		_done.post();
+	}
+}
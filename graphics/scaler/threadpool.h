@@ -0,0 +1,95 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_SCALER_THREADPOOL_H
+#define GRAPHICS_SCALER_THREADPOOL_H
+
+#include "common/array.h"
+#include "common/mutex.h"
+#include "common/thread.h"
+
+class Scaler;
+
+/**
+ * Scales rectangles on several threads at once, by splitting them into
+ * horizontal bands.
+ *
+ * The scalers read up to extraPixels() pixels around the scaled
+ * rectangle, so every band reads the rows next to it straight from the
+ * source, and writes its own rows of the destination only. The result is
+ * the same as scaling the whole rectangle at once.
+ *
+ * Only scalers without state which changes while scaling may be used,
+ * that is, those not using the old source (see
+ * ScalerPluginObject::useOldSource()).
+ */
+class ScalerThreadPool : Common::NonCopyable {
+public:
+	/**
+	 * Start numThreads threads. Fewer, possibly none, are started if the
+	 * backend cannot create them.
+	 */
+	explicit ScalerThreadPool(uint numThreads);
+	~ScalerThreadPool();
+
+	/** Return the number of threads started. */
+	uint getNumThreads() const { return _threads.size(); }
+
+	/**
+	 * Scale like Scaler::scale(), sharing the work between the threads
+	 * of the pool and the calling thread. Returns when all bands are
+	 * done.
+	 *
+	 * @param minBandHeight Smallest number of rows worth a band of its own.
+	 */
+	void scale(Scaler *scaler, const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+	           int width, int height, int x, int y, int minBandHeight);
+
+private:
+	static void threadProc(void *param);
+	void run();
+
+	/** Scale the bands not taken yet by another thread. */
+	void scaleBands();
+
+	struct Job {
+		Scaler *scaler;
+		const uint8 *srcPtr;
+		uint32 srcPitch;
+		uint8 *dstPtr;
+		uint32 dstPitch;
+		int width, height, x, y;
+		uint factor;
+		int numBands;
+	};
+
+	Common::Mutex _mutex;
+	/** Posted once for every thread to wake up. */
+	Common::Semaphore _start;
+	/** Posted by every woken up thread when there is no band left. */
+	Common::Semaphore _done;
+	Job _job;
+	int _nextBand;
+	bool _quit;
+	Common::Array<Common::Thread *> _threads;
+};
+
+#endif
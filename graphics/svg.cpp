@@ -53,10 +53,14 @@ SVGBitmap::SVGBitmap(Common::SeekableReadStream *in) {
 	_cache = NULL;
 	_render = NULL;
 
+	_pixelformat = new Graphics::PixelFormat(getRenderFormat());
+}
+
+Graphics::PixelFormat SVGBitmap::getRenderFormat() {
 #ifdef SCUMM_BIG_ENDIAN
-	_pixelformat = new Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0);
+	return Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0);
 #else
-	_pixelformat = new Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24);
+	return Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24);
 #endif
 }
 
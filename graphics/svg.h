@@ -41,6 +41,9 @@ public:
 
 	Graphics::PixelFormat *getPixelFormat() { return _pixelformat; }
 
+	/** The format of the rendered images, the same for all of them. */
+	static Graphics::PixelFormat getRenderFormat();
+
 	void render(Graphics::ManagedSurface &target, int dw, int dh);
 
 private:
@@ -25,9 +25,13 @@
  * It also has modifications by the ResidualVM-team, which are covered under the GPLv2 (or later).
  */
 
+#include "common/config-manager.h"
+
+#include "graphics/tinygl/tinygl.h"
 #include "graphics/tinygl/zgl.h"
 #include "graphics/tinygl/zblit.h"
 #include "graphics/tinygl/zdirtyrect.h"
+#include "graphics/tinygl/ztiles.h"
 
 namespace TinyGL {
 
@@ -58,6 +62,26 @@ void createContext(int screenW, int screenH, Graphics::PixelFormat pixelFormat,
 	assert(gl_ctx == nullptr);
 	gl_ctx = new GLContext();
 	gl_ctx->init(screenW, screenH, pixelFormat, textureSize, enableStencilBuffer, dirtyRectsEnable);
+
+	if (ConfMan.hasKey("tinygl_threads"))
+		setRasterizationThreads(ConfMan.getInt("tinygl_threads"));
+}
+
+void setRasterizationThreads(uint numThreads) {
+	GLContext *c = gl_get_context();
+	assert(c);
+
+	delete c->_tileExecutor;
+	c->_tileExecutor = nullptr;
+
+	if (!numThreads)
+		return;
+
+	c->_tileExecutor = new TileExecutor(c, MIN<uint>(numThreads, TileExecutor::kMaxThreads));
+	if (!c->_tileExecutor->getNumThreads()) {
+		delete c->_tileExecutor;
+		c->_tileExecutor = nullptr;
+	}
 }
 
 void GLContext::init(int screenW, int screenH, Graphics::PixelFormat pixelFormat, int textureSize, bool enableStencilBuffer, bool dirtyRectsEnable) {
@@ -245,8 +269,9 @@ void GLContext::init(int screenW, int screenH, Graphics::PixelFormat pixelFormat
 	_drawCallAllocator[0].initialize(kDrawCallMemory);
 	_drawCallAllocator[1].initialize(kDrawCallMemory);
 	_debugRectsEnabled = false;
+	_tileExecutor = nullptr;
 
-	TinyGL::Internal::tglBlitResetScissorRect();
+	TinyGL::Internal::tglBlitResetScissorRect(this);
 }
 
 void destroyContext() {
@@ -258,6 +283,9 @@ void destroyContext() {
 }
 
 void GLContext::deinit() {
+	delete _tileExecutor;
+	_tileExecutor = nullptr;
+
 	disposeDrawCallLists();
 	disposeResources();
 
@@ -268,4 +296,112 @@ void GLContext::deinit() {
 	gl_free(vertex);
 }
 
+void GLContext::initTileWorker(const GLContext *other) {
+	// The draw state is copied from the other context before every frame,
+	// see TileExecutor::copyState(). Nothing is allocated but the framebuffer,
+	// the textures and the blit images belong to the other context.
+	_enableDirtyRectangles = false;
+	_debugRectsEnabled = false;
+	_tileExecutor = nullptr;
+	_currentAllocatorIndex = 0;
+
+	fb = new FrameBuffer(other->fb);
+	renderRect = other->renderRect;
+	_scissorRect = other->_scissorRect;
+	_textureSize = other->_textureSize;
+	viewport = other->viewport;
+
+	shared_state.lists = nullptr;
+	shared_state.texture_hash_table = nullptr;
+	current_texture = nullptr;
+	maxTextureName = 0;
+	texture_2d_enabled = 0;
+	texture_mag_filter = other->texture_mag_filter;
+	texture_min_filter = other->texture_min_filter;
+	texture_wrap_s = other->texture_wrap_s;
+	texture_wrap_t = other->texture_wrap_t;
+
+	current_op_buffer = nullptr;
+	current_op_buffer_index = 0;
+	exec_flag = 1;
+	compile_flag = 0;
+	print_flag = 0;
+
+	for (int i = 0; i < 3; i++) {
+		matrix_stack[i] = nullptr;
+		matrix_stack_ptr[i] = nullptr;
+		matrix_stack_depth_max[i] = 0;
+	}
+	matrix_mode = 0;
+	matrix_model_projection_updated = 0;
+	matrix_model_projection_no_w_transform = 0;
+	apply_texture_matrix = 0;
+
+	first_light = nullptr;
+	lighting_enabled = 0;
+	local_light_model = 0;
+	light_model_two_side = 0;
+	color_material_enabled = 0;
+	normalize_enabled = 0;
+
+	polygon_mode_front = TGL_FILL;
+	polygon_mode_back = TGL_FILL;
+	current_front_face = 0;
+	current_cull_face = TGL_BACK;
+	current_shade_model = TGL_SMOOTH;
+	cull_face_enabled = 0;
+	draw_triangle_front = nullptr;
+	draw_triangle_back = nullptr;
+
+	render_mode = TGL_RENDER;
+	select_buffer = nullptr;
+	select_size = 0;
+	select_ptr = nullptr;
+	select_hit = nullptr;
+	select_overflow = 0;
+	select_hits = 0;
+	name_stack_size = 0;
+
+	in_begin = 0;
+	begin_type = 0;
+	vertex_n = 0;
+	vertex_cnt = 0;
+	vertex_max = 0;
+	vertex = nullptr;
+	client_states = 0;
+
+	blending_enabled = false;
+	source_blending_factor = TGL_ONE;
+	destination_blending_factor = TGL_ZERO;
+	alpha_test_enabled = false;
+	alpha_test_func = TGL_ALWAYS;
+	alpha_test_ref_val = 0;
+	depth_test_enabled = false;
+	depth_func = TGL_LESS;
+	depth_write_mask = true;
+	stencil_test_enabled = false;
+	stencil_test_func = TGL_ALWAYS;
+	stencil_ref_val = 0;
+	stencil_mask = 0xff;
+	stencil_write_mask = 0xff;
+	stencil_sfail = TGL_KEEP;
+	stencil_dpfail = TGL_KEEP;
+	stencil_dppass = TGL_KEEP;
+	offset_states = 0;
+	offset_factor = 0.0f;
+	offset_units = 0.0f;
+	color_mask_red = color_mask_green = color_mask_blue = color_mask_alpha = true;
+
+	specbuf_first = nullptr;
+	specbuf_used_counter = 0;
+	specbuf_num_buffers = 0;
+	opaque = nullptr;
+	gl_resize_viewport = nullptr;
+}
+
+void GLContext::deinitTileWorker() {
+	delete fb;
+	fb = nullptr;
+}
+
 } // end of namespace TinyGL
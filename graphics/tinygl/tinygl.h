@@ -32,6 +32,11 @@ namespace TinyGL {
 void createContext(int screenW, int screenH, Graphics::PixelFormat pixelFormat,
                    int textureSize, bool enableStencilBuffer, bool dirtyRectsEnable = true);
 void destroyContext();
+/**
+ * Draw the frames on numThreads more threads, in bands of rows, or only on
+ * the calling one if 0. Only call this between frames.
+ */
+void setRasterizationThreads(uint numThreads);
 void presentBuffer();
 void presentBuffer(Common::List<Common::Rect> &dirtyAreas);
 void getSurfaceRef(Graphics::Surface &surface);
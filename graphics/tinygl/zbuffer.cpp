@@ -32,6 +32,7 @@
 
 #include "graphics/tinygl/zbuffer.h"
 #include "graphics/tinygl/zgl.h"
+#include "graphics/tinygl/zspan.h"
 
 namespace TinyGL {
 
@@ -86,24 +87,69 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &for
 	_pbufBpp = _pbufFormat.bytesPerPixel;
 	_pbufPitch = (_pbufWidth * _pbufBpp + 3) & ~3;
 
-	_pbuf.set(_pbufFormat, new byte[_pbufHeight * _pbufPitch]);
+	_pbuf.set(_pbufFormat, new byte[_pbufHeight * _pbufPitch]());
 	_zbuf = (uint *)gl_zalloc(_pbufWidth * _pbufHeight * sizeof(uint));
+	_sbuf = nullptr;
 	if (enableStencilBuffer)
 		_sbuf = (byte *)gl_zalloc(_pbufWidth * _pbufHeight * sizeof(byte));
+	_ownsBuffers = true;
+	_enableStencil = enableStencilBuffer;
 
 	_offscreenBuffer.pbuf = _pbuf.getRawBuffer();
 	_offscreenBuffer.zbuf = _zbuf;
 
+	_textureSize = 0;
+	_textureSizeMask = 0;
 	_currentTexture = nullptr;
+	_wrapS = _wrapT = TGL_REPEAT;
+	setSpanKernels(getSpanKernels());
+
+	// The draw calls executed without clipping rectangle do not reset the
+	// scissor, and the first draw calls of a frame may not set all the
+	// state, so start with the defaults of GLContext
+	_clipRectangle = Common::Rect(_pbufWidth, _pbufHeight);
+	_enableScissor = false;
+	_blendingEnabled = false;
+	_sourceBlendingFactor = TGL_ONE;
+	_destinationBlendingFactor = TGL_ZERO;
+	_alphaTestEnabled = false;
+	_alphaTestFunc = TGL_ALWAYS;
+	_alphaTestRefVal = 0;
+	_depthTestEnabled = false;
+	_depthWrite = true;
+	_depthFunc = TGL_LESS;
+	_stencilTestEnabled = false;
+	_stencilTestFunc = TGL_ALWAYS;
+	_stencilRefVal = 0;
+	_stencilMask = 0xff;
+	_stencilWriteMask = 0xff;
+	_stencilSfail = TGL_KEEP;
+	_stencilDpfail = TGL_KEEP;
+	_stencilDppass = TGL_KEEP;
+	_offsetStates = 0;
+	_offsetFactor = 0.0f;
+	_offsetUnits = 0.0f;
+}
+
+FrameBuffer::FrameBuffer(const FrameBuffer *other) {
+	shareBuffers(*other);
 }
 
 FrameBuffer::~FrameBuffer() {
+	if (!_ownsBuffers)
+		return;
+
 	_pbuf.free();
 	gl_free(_zbuf);
 	if (_sbuf)
 		gl_free(_sbuf);
 }
 
+void FrameBuffer::shareBuffers(const FrameBuffer &other) {
+	*this = other;
+	_ownsBuffers = false;
+}
+
 Buffer *FrameBuffer::genOffscreenBuffer() {
 	Buffer *buf = (Buffer *)gl_malloc(sizeof(Buffer));
 	buf->pbuf = (byte *)gl_zalloc(_pbufHeight * _pbufPitch);
@@ -37,6 +37,9 @@
 
 namespace TinyGL {
 
+struct SpanKernels;
+struct SpanParams;
+
 // Z buffer
 
 #define ZB_Z_BITS 16
@@ -102,8 +105,14 @@ struct ZBufferPoint {
 
 struct FrameBuffer {
 	FrameBuffer(int width, int height, const Graphics::PixelFormat &format, bool enableStencilBuffer);
+	// Creates a framebuffer drawing to the buffers of another one, see shareBuffers()
+	explicit FrameBuffer(const FrameBuffer *other);
 	~FrameBuffer();
 
+	// Draws to the buffers of another framebuffer from now on, starting with its state.
+	// The buffers stay owned by the other framebuffer.
+	void shareBuffers(const FrameBuffer &other);
+
 	Graphics::PixelFormat getPixelFormat() {
 		return _pbufFormat;
 	}
@@ -319,6 +328,23 @@ private:
 	template <bool kDepthWrite, bool kEnableScissor, bool kStencilEnabled, bool kDepthTestEnabled>
 	FORCEINLINE void putPixelDepth(uint *pz, byte *ps, int _a, int x, int y, uint &z, int &dzdx);
 
+	template <bool kEnableScissor>
+	FORCEINLINE void putSpanTexture(const SpanParams &spanParams, int fbOffset, const TexelBuffer *texture,
+	                                uint *pz, int x, int count, uint &z, int &t, int &s,
+	                                uint &r, uint &g, uint &b, uint &a,
+	                                int dzdx, int dsdx, int dtdx, int drdx, int dgdx, int dbdx, int dadx);
+
+	// Returns the pixels [first, last) of a span starting at x which pass the scissor test
+	template <bool kEnableScissor>
+	FORCEINLINE void scissorSpan(int x, int count, int &first, int &last) {
+		first = 0;
+		last = count;
+		if (kEnableScissor) {
+			first = MAX(first, _clipRectangle.left - x);
+			last = MIN(last, _clipRectangle.right - x);
+		}
+	}
+
 
 	template <bool kEnableAlphaTest>
 	FORCEINLINE void writePixel(int pixel, int value) {
@@ -337,6 +363,10 @@ private:
 		return !_clipRectangle.contains(x, y);
 	}
 
+	FORCEINLINE bool scissorLine(int y) {
+		return y < _clipRectangle.top || y >= _clipRectangle.bottom;
+	}
+
 public:
 
 	FORCEINLINE void writePixel(int pixel, byte aSrc, byte rSrc, byte gSrc, byte bSrc) {
@@ -569,6 +599,12 @@ public:
 		_textureSizeMask = textureSizeMask;
 	}
 
+	// Selects the SIMD routines drawing the spans of triangles, or nullptr to draw them
+	// pixel by pixel. They are only used for 32 bit pixels, see SpanParams.
+	void setSpanKernels(const SpanKernels *kernels) {
+		_spanKernels = (_pbufBpp == 4) ? kernels : nullptr;
+	}
+
 private:
 
 	/**
@@ -651,6 +687,7 @@ private:
 
 	uint *_zbuf;
 	byte *_sbuf;
+	bool _ownsBuffers;
 
 	bool _enableStencil;
 	int _textureSize;
@@ -661,6 +698,7 @@ private:
 
 	const TexelBuffer *_currentTexture;
 	uint _wrapS, _wrapT;
+	const SpanKernels *_spanKernels;
 	bool _blendingEnabled;
 	int _sourceBlendingFactor;
 	int _destinationBlendingFactor;
@@ -53,10 +53,15 @@ public:
 	bool operator!=(const DrawCall &other) const {
 		return !(*this == other);
 	}
-	virtual void execute(bool restoreState) const = 0;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const = 0;
+	// Executes the call with the given context, which is not the current one on the
+	// threads of TileExecutor.
+	virtual void execute(GLContext *c, bool restoreState) const = 0;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const = 0;
 	DrawCallType getType() const { return _type; }
 	virtual const Common::Rect getDirtyRegion() const { return _dirtyRegion; }
+	// Whether executing the call clipped to tiles of rows, on several threads, gives
+	// the same result as executing it clipped to all of them at once, see TileExecutor.
+	virtual bool canBeTiled() const { return true; }
 protected:
 	Common::Rect _dirtyRegion;
 private:
@@ -68,8 +73,8 @@ public:
 	ClearBufferDrawCall(bool clearZBuffer, int zValue, bool clearColorBuffer, int rValue, int gValue, int bValue, bool clearStencilBuffer, int stencilValue);
 	virtual ~ClearBufferDrawCall() { }
 	bool operator==(const ClearBufferDrawCall &other) const;
-	virtual void execute(bool restoreState) const;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(GLContext *c, bool restoreState) const;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const;
 
 	void *operator new(size_t size) {
 		return Internal::allocateFrame(size);
@@ -87,8 +92,9 @@ public:
 	RasterizationDrawCall();
 	virtual ~RasterizationDrawCall() { }
 	bool operator==(const RasterizationDrawCall &other) const;
-	virtual void execute(bool restoreState) const;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(GLContext *c, bool restoreState) const;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual bool canBeTiled() const;
 
 	void *operator new(size_t size) {
 		return Internal::allocateFrame(size);
@@ -146,8 +152,8 @@ private:
 
 	RasterizationState _state;
 
-	RasterizationState captureState() const;
-	void applyState(const RasterizationState &state) const;
+	RasterizationState captureState(GLContext *c) const;
+	void applyState(GLContext *c, const RasterizationState &state) const;
 };
 
 // Encapsulate a blit call: it might execute either a color buffer or z buffer blit.
@@ -163,8 +169,9 @@ public:
 	BlittingDrawCall(BlitImage *image, const BlitTransform &transform, BlittingMode blittingMode);
 	virtual ~BlittingDrawCall();
 	bool operator==(const BlittingDrawCall &other) const;
-	virtual void execute(bool restoreState) const;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(GLContext *c, bool restoreState) const;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual bool canBeTiled() const;
 
 	BlittingMode getBlittingMode() const { return _mode; }
 
@@ -199,8 +206,8 @@ private:
 		}
 	};
 
-	BlittingState captureState() const;
-	void applyState(const BlittingState &state) const;
+	BlittingState captureState(GLContext *c) const;
+	void applyState(GLContext *c, const BlittingState &state) const;
 
 	BlittingState _blitState;
 };
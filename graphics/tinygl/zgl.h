@@ -255,6 +255,7 @@ private:
 };
 
 struct GLContext;
+class TileExecutor;
 
 typedef void (*gl_draw_triangle_func)(GLContext *c, GLVertex *p0, GLVertex *p1, GLVertex *p2);
 
@@ -434,6 +435,10 @@ struct GLContext {
 	LinearAllocator _drawCallAllocator[2];
 	bool _debugRectsEnabled;
 
+	// Draw call execution
+	Common::Array<GLVertex> _drawCallVertices;
+	TileExecutor *_tileExecutor;
+
 public:
 	// The glob* functions exposed to public, however they are only for internal use.
 	// Calling them from outside of TinyGL is forbidden
@@ -485,6 +490,11 @@ public:
 
 	void init(int screenW, int screenH, Graphics::PixelFormat pixelFormat, int textureSize, bool enableStencilBuffer, bool dirtyRectsEnable = true);
 	void deinit();
+
+	// A context only executing the draw calls of another one, with the buffers of its
+	// framebuffer, see TileExecutor
+	void initTileWorker(const GLContext *other);
+	void deinitTileWorker();
 };
 
 extern GLContext *gl_ctx;
@@ -0,0 +1,199 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_TINYGL_ZSPAN_H
+#define GRAPHICS_TINYGL_ZSPAN_H
+
+#include "common/scummsys.h"
+#include "graphics/tinygl/gl.h"
+
+namespace TinyGL {
+
+/**
+ * State of the framebuffer used by the SIMD span routines. These only
+ * draw to 32 bit pixels, without stencil test, alpha test or blending.
+ */
+struct SpanParams {
+	/** Depth function of the depth test, TGL_ALWAYS when it is disabled. */
+	int depthFunc;
+	/** Whether the depth of the drawn pixels is written. */
+	bool depthWrite;
+	uint8 aShift, rShift, gShift, bShift;
+	uint8 aLoss, rLoss, gLoss, bLoss;
+};
+
+/**
+ * Values interpolated along a span at its first pixel, and their steps
+ * from one pixel to the next. The colors are in ZBufferPoint units.
+ */
+struct SpanValues {
+	uint z, r, g, b, a;
+	int dzdx, drdx, dgdx, dbdx, dadx;
+};
+
+/** Depth test count pixels, and write the depth of those which pass. */
+typedef void (*DepthSpanProc)(uint *pz, int count, uint z, int dzdx, const SpanParams &params);
+
+/** Depth test count pixels, and draw those which pass with the colors. */
+typedef void (*ColorSpanProc)(uint32 *pp, uint *pz, int count, const SpanValues &values, const SpanParams &params);
+
+/**
+ * Depth test up to kSpanMaskPixels pixels, without writing anything.
+ *
+ * @return the mask of the pixels which pass, bit i for pixel i
+ */
+typedef uint (*DepthMaskProc)(const uint *pz, int count, uint z, int dzdx, const SpanParams &params);
+
+/**
+ * Draw the pixels of a mask returned by DepthMaskProc, with the texels
+ * multiplied by the colors.
+ *
+ * @param texels the texels of the pixels in the mask, as A8R8G8B8 values
+ */
+typedef void (*TexelSpanProc)(uint32 *pp, uint *pz, int count, uint mask, const uint32 *texels, const SpanValues &values, const SpanParams &params);
+
+enum {
+	/** Most pixels given to DepthMaskProc and TexelSpanProc at once. */
+	kSpanMaskPixels = 8
+};
+
+struct SpanKernels {
+	/** Depth only triangles, as in shadow passes. */
+	DepthSpanProc depthSpan;
+	/** Flat and Gouraud shaded triangles. */
+	ColorSpanProc colorSpan;
+	/** Textured triangles, whose texels are fetched for the mask only. */
+	DepthMaskProc depthMask;
+	TexelSpanProc texelSpan;
+};
+
+/**
+ * Return the fastest span routines supported by the host CPU, or nullptr
+ * if the pixels are only drawn one by one.
+ */
+const SpanKernels *getSpanKernels();
+
+#ifdef SCUMMVM_SSE2
+const SpanKernels *getSSE2SpanKernels();
+#endif
+
+#ifdef SCUMMVM_AVX2
+const SpanKernels *getAVX2SpanKernels();
+#endif
+
+#ifdef SCUMMVM_NEON
+const SpanKernels *getNEONSpanKernels();
+#endif
+
+// This is included by the SIMD files, which are compiled for different
+// instruction sets, so avoid any inline code shared between files.
+
+/** The depth test of FrameBuffer::compareDepth(). */
+static inline bool spanDepthTest(uint zSrc, uint zDst, int depthFunc) {
+	switch (depthFunc) {
+	case TGL_LESS:
+		return zDst < zSrc;
+	case TGL_EQUAL:
+		return zDst == zSrc;
+	case TGL_LEQUAL:
+		return zDst <= zSrc;
+	case TGL_GREATER:
+		return zDst > zSrc;
+	case TGL_NOTEQUAL:
+		return zDst != zSrc;
+	case TGL_GEQUAL:
+		return zDst >= zSrc;
+	case TGL_ALWAYS:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/** Convert channels to a pixel, as PixelFormat::ARGBToColor(). */
+static inline uint32 spanPixel(uint8 a, uint8 r, uint8 g, uint8 b, const SpanParams &params) {
+	return ((a >> params.aLoss) << params.aShift) |
+	       ((r >> params.rLoss) << params.rShift) |
+	       ((g >> params.gLoss) << params.gShift) |
+	       ((b >> params.bLoss) << params.bShift);
+}
+
+/**
+ * Draw the pixels [first, count) of a span, see ColorSpanProc. Used by the
+ * SIMD routines for the pixels which do not fill a whole vector.
+ */
+static inline void drawColorSpanScalar(uint32 *pp, uint *pz, int first, int count, const SpanValues &values, const SpanParams &params) {
+	uint z = values.z + (uint)first * values.dzdx;
+	uint r = values.r + (uint)first * values.drdx;
+	uint g = values.g + (uint)first * values.dgdx;
+	uint b = values.b + (uint)first * values.dbdx;
+	uint a = values.a + (uint)first * values.dadx;
+
+	for (int i = first; i < count; i++) {
+		if (spanDepthTest(z, pz[i], params.depthFunc)) {
+			if (params.depthWrite)
+				pz[i] = z;
+			pp[i] = spanPixel(a >> 8, r >> 8, g >> 8, b >> 8, params);
+		}
+		z += values.dzdx;
+		r += values.drdx;
+		g += values.dgdx;
+		b += values.dbdx;
+		a += values.dadx;
+	}
+}
+
+/** Draw the pixels [first, count) of a span, see DepthSpanProc. */
+static inline void drawDepthSpanScalar(uint *pz, int first, int count, uint z, int dzdx, const SpanParams &params) {
+	z += (uint)first * dzdx;
+	for (int i = first; i < count; i++) {
+		if (spanDepthTest(z, pz[i], params.depthFunc) && params.depthWrite)
+			pz[i] = z;
+		z += dzdx;
+	}
+}
+
+/**
+ * Draw the pixels [first, count) of a mask, see TexelSpanProc. The texels
+ * are multiplied by the colors as in FrameBuffer::putPixelTexture().
+ */
+static inline void drawTexelSpanScalar(uint32 *pp, uint *pz, int first, int count, uint mask, const uint32 *texels, const SpanValues &values, const SpanParams &params) {
+	for (int i = first; i < count; i++) {
+		if (!(mask & (1 << i)))
+			continue;
+
+		const uint z = values.z + (uint)i * values.dzdx;
+		const uint r = (values.r + (uint)i * values.drdx) >> 8;
+		const uint g = (values.g + (uint)i * values.dgdx) >> 8;
+		const uint b = (values.b + (uint)i * values.dbdx) >> 8;
+		const uint a = (values.a + (uint)i * values.dadx) >> 8;
+		const uint32 texel = texels[i];
+
+		if (params.depthWrite)
+			pz[i] = z;
+		pp[i] = spanPixel(((texel >> 24) * a) >> 8, (((texel >> 16) & 0xFF) * r) >> 8,
+		                  (((texel >> 8) & 0xFF) * g) >> 8, ((texel & 0xFF) * b) >> 8, params);
+	}
+}
+
+} // End of namespace TinyGL
+
+#endif
@@ -0,0 +1,229 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <immintrin.h>
+
+#include "graphics/tinygl/zspan.h"
+
+namespace TinyGL {
+
+namespace {
+
+/** The shift counts of a SpanParams, ready for the shift instructions. */
+struct Shifts {
+	__m128i aLoss, rLoss, gLoss, bLoss;
+	__m128i aShift, rShift, gShift, bShift;
+
+	explicit Shifts(const SpanParams &params) {
+		aLoss = _mm_cvtsi32_si128(params.aLoss);
+		rLoss = _mm_cvtsi32_si128(params.rLoss);
+		gLoss = _mm_cvtsi32_si128(params.gLoss);
+		bLoss = _mm_cvtsi32_si128(params.bLoss);
+		aShift = _mm_cvtsi32_si128(params.aShift);
+		rShift = _mm_cvtsi32_si128(params.rShift);
+		gShift = _mm_cvtsi32_si128(params.gShift);
+		bShift = _mm_cvtsi32_si128(params.bShift);
+	}
+};
+
+} // End of anonymous namespace
+
+/** Return the values of eight pixels, starting at pixel i of a span. */
+static inline __m256i interpolate(uint value, int step, int i) {
+	const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	return _mm256_add_epi32(_mm256_set1_epi32(value + (uint)i * step), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(step)));
+}
+
+/** Return the step of the values of eight pixels. */
+static inline __m256i step8(int step) {
+	return _mm256_set1_epi32(8 * (uint)step);
+}
+
+/** Compare unsigned values, as AVX2 only compares signed ones. */
+static inline __m256i lessThan(__m256i a, __m256i b) {
+	const __m256i bias = _mm256_set1_epi32((int)0x80000000);
+	return _mm256_cmpgt_epi32(_mm256_xor_si256(b, bias), _mm256_xor_si256(a, bias));
+}
+
+/** Return the lanes passing the depth test, see spanDepthTest(). */
+static inline __m256i depthTest(__m256i zSrc, __m256i zDst, int depthFunc) {
+	const __m256i ones = _mm256_set1_epi32(-1);
+
+	switch (depthFunc) {
+	case TGL_LESS:
+		return lessThan(zDst, zSrc);
+	case TGL_EQUAL:
+		return _mm256_cmpeq_epi32(zDst, zSrc);
+	case TGL_LEQUAL:
+		return _mm256_xor_si256(lessThan(zSrc, zDst), ones);
+	case TGL_GREATER:
+		return lessThan(zSrc, zDst);
+	case TGL_NOTEQUAL:
+		return _mm256_xor_si256(_mm256_cmpeq_epi32(zDst, zSrc), ones);
+	case TGL_GEQUAL:
+		return _mm256_xor_si256(lessThan(zDst, zSrc), ones);
+	case TGL_ALWAYS:
+		return ones;
+	default:
+		return _mm256_setzero_si256();
+	}
+}
+
+static inline __m256i select(__m256i mask, __m256i a, __m256i b) {
+	return _mm256_blendv_epi8(b, a, mask);
+}
+
+/** Convert channels in [0, 255] to pixels, see spanPixel(). */
+static inline __m256i packPixels(__m256i a, __m256i r, __m256i g, __m256i b, const Shifts &shifts) {
+	return _mm256_or_si256(
+		_mm256_or_si256(_mm256_sll_epi32(_mm256_srl_epi32(a, shifts.aLoss), shifts.aShift),
+		                _mm256_sll_epi32(_mm256_srl_epi32(r, shifts.rLoss), shifts.rShift)),
+		_mm256_or_si256(_mm256_sll_epi32(_mm256_srl_epi32(g, shifts.gLoss), shifts.gShift),
+		                _mm256_sll_epi32(_mm256_srl_epi32(b, shifts.bLoss), shifts.bShift)));
+}
+
+/** Return the byte of the colors in ZBufferPoint units, as passed to writePixel(). */
+static inline __m256i colorChannel(__m256i c) {
+	return _mm256_and_si256(_mm256_srli_epi32(c, 8), _mm256_set1_epi32(0xFF));
+}
+
+/**
+ * Multiply texel channels by colors in ZBufferPoint units, keeping the low
+ * byte of the result as putPixelTexture() does. Only the low 16 bits of
+ * the products matter, which a 16 bit multiplication gives.
+ */
+template<int shift>
+static inline __m256i modulate(__m256i texels, __m256i c) {
+	const __m256i channel = _mm256_and_si256(_mm256_srli_epi32(texels, shift), _mm256_set1_epi32(0xFF));
+	return _mm256_srli_epi32(_mm256_mullo_epi16(channel, _mm256_srli_epi32(c, 8)), 8);
+}
+
+static void drawDepthSpan(uint *pz, int count, uint z, int dzdx, const SpanParams &params) {
+	// Nothing is drawn without writing the depth
+	if (!params.depthWrite)
+		return;
+
+	const __m256i zStep = step8(dzdx);
+	__m256i zSrc = interpolate(z, dzdx, 0);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256i zDst = _mm256_loadu_si256((const __m256i *)(pz + i));
+		const __m256i pass = depthTest(zSrc, zDst, params.depthFunc);
+		_mm256_storeu_si256((__m256i *)(pz + i), select(pass, zSrc, zDst));
+		zSrc = _mm256_add_epi32(zSrc, zStep);
+	}
+
+	drawDepthSpanScalar(pz, i, count, z, dzdx, params);
+}
+
+static void drawColorSpan(uint32 *pp, uint *pz, int count, const SpanValues &values, const SpanParams &params) {
+	const Shifts shifts(params);
+	const __m256i zStep = step8(values.dzdx);
+	const __m256i rStep = step8(values.drdx);
+	const __m256i gStep = step8(values.dgdx);
+	const __m256i bStep = step8(values.dbdx);
+	const __m256i aStep = step8(values.dadx);
+	__m256i z = interpolate(values.z, values.dzdx, 0);
+	__m256i r = interpolate(values.r, values.drdx, 0);
+	__m256i g = interpolate(values.g, values.dgdx, 0);
+	__m256i b = interpolate(values.b, values.dbdx, 0);
+	__m256i a = interpolate(values.a, values.dadx, 0);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256i zDst = _mm256_loadu_si256((const __m256i *)(pz + i));
+		const __m256i pass = depthTest(z, zDst, params.depthFunc);
+
+		if (_mm256_movemask_epi8(pass)) {
+			if (params.depthWrite)
+				_mm256_storeu_si256((__m256i *)(pz + i), select(pass, z, zDst));
+
+			const __m256i pixels = packPixels(colorChannel(a), colorChannel(r), colorChannel(g), colorChannel(b), shifts);
+			const __m256i dst = _mm256_loadu_si256((const __m256i *)(pp + i));
+			_mm256_storeu_si256((__m256i *)(pp + i), select(pass, pixels, dst));
+		}
+
+		z = _mm256_add_epi32(z, zStep);
+		r = _mm256_add_epi32(r, rStep);
+		g = _mm256_add_epi32(g, gStep);
+		b = _mm256_add_epi32(b, bStep);
+		a = _mm256_add_epi32(a, aStep);
+	}
+
+	drawColorSpanScalar(pp, pz, i, count, values, params);
+}
+
+static uint depthMask(const uint *pz, int count, uint z, int dzdx, const SpanParams &params) {
+	uint mask = 0;
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256i pass = depthTest(interpolate(z, dzdx, i), _mm256_loadu_si256((const __m256i *)(pz + i)), params.depthFunc);
+		mask |= _mm256_movemask_ps(_mm256_castsi256_ps(pass)) << i;
+	}
+	for (; i < count; i++) {
+		if (spanDepthTest(z + (uint)i * dzdx, pz[i], params.depthFunc))
+			mask |= 1 << i;
+	}
+
+	return mask;
+}
+
+static void drawTexelSpan(uint32 *pp, uint *pz, int count, uint mask, const uint32 *texels, const SpanValues &values, const SpanParams &params) {
+	const Shifts shifts(params);
+	const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		if (!((mask >> i) & 0xFF))
+			continue;
+
+		const __m256i pass = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(mask >> i), laneBits), laneBits);
+		if (params.depthWrite) {
+			const __m256i zDst = _mm256_loadu_si256((const __m256i *)(pz + i));
+			_mm256_storeu_si256((__m256i *)(pz + i), select(pass, interpolate(values.z, values.dzdx, i), zDst));
+		}
+
+		const __m256i src = _mm256_loadu_si256((const __m256i *)(texels + i));
+		const __m256i pixels = packPixels(modulate<24>(src, interpolate(values.a, values.dadx, i)),
+		                                  modulate<16>(src, interpolate(values.r, values.drdx, i)),
+		                                  modulate<8>(src, interpolate(values.g, values.dgdx, i)),
+		                                  modulate<0>(src, interpolate(values.b, values.dbdx, i)), shifts);
+		const __m256i dst = _mm256_loadu_si256((const __m256i *)(pp + i));
+		_mm256_storeu_si256((__m256i *)(pp + i), select(pass, pixels, dst));
+	}
+
+	drawTexelSpanScalar(pp, pz, i, count, mask, texels, values, params);
+}
+
+static const SpanKernels avx2SpanKernels = {
+	drawDepthSpan,
+	drawColorSpan,
+	depthMask,
+	drawTexelSpan
+};
+
+const SpanKernels *getAVX2SpanKernels() {
+	return &avx2SpanKernels;
+}
+
+} // End of namespace TinyGL
@@ -0,0 +1,227 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <arm_neon.h>
+
+#include "graphics/tinygl/zspan.h"
+
+namespace TinyGL {
+
+namespace {
+
+/**
+ * The shift counts of a SpanParams, ready for the shift instructions.
+ * Negative counts shift to the right.
+ */
+struct Shifts {
+	int32x4_t aLoss, rLoss, gLoss, bLoss;
+	int32x4_t aShift, rShift, gShift, bShift;
+
+	explicit Shifts(const SpanParams &params) {
+		aLoss = vdupq_n_s32(-params.aLoss);
+		rLoss = vdupq_n_s32(-params.rLoss);
+		gLoss = vdupq_n_s32(-params.gLoss);
+		bLoss = vdupq_n_s32(-params.bLoss);
+		aShift = vdupq_n_s32(params.aShift);
+		rShift = vdupq_n_s32(params.rShift);
+		gShift = vdupq_n_s32(params.gShift);
+		bShift = vdupq_n_s32(params.bShift);
+	}
+};
+
+} // End of anonymous namespace
+
+/** Return the values of four pixels, starting at pixel i of a span. */
+static inline uint32x4_t interpolate(uint value, int step, int i) {
+	static const uint32 lanes[4] = { 0, 1, 2, 3 };
+	return vmlaq_n_u32(vdupq_n_u32(value + (uint)i * step), vld1q_u32(lanes), step);
+}
+
+/** Return the step of the values of four pixels. */
+static inline uint32x4_t step4(int step) {
+	return vdupq_n_u32(4 * (uint)step);
+}
+
+/** Return the lanes passing the depth test, see spanDepthTest(). */
+static inline uint32x4_t depthTest(uint32x4_t zSrc, uint32x4_t zDst, int depthFunc) {
+	switch (depthFunc) {
+	case TGL_LESS:
+		return vcltq_u32(zDst, zSrc);
+	case TGL_EQUAL:
+		return vceqq_u32(zDst, zSrc);
+	case TGL_LEQUAL:
+		return vcleq_u32(zDst, zSrc);
+	case TGL_GREATER:
+		return vcgtq_u32(zDst, zSrc);
+	case TGL_NOTEQUAL:
+		return vmvnq_u32(vceqq_u32(zDst, zSrc));
+	case TGL_GEQUAL:
+		return vcgeq_u32(zDst, zSrc);
+	case TGL_ALWAYS:
+		return vdupq_n_u32(0xFFFFFFFF);
+	default:
+		return vdupq_n_u32(0);
+	}
+}
+
+/** Return whether any lane is set. */
+static inline bool anyLane(uint32x4_t mask) {
+	const uint32x2_t folded = vorr_u32(vget_low_u32(mask), vget_high_u32(mask));
+	return (vget_lane_u32(folded, 0) | vget_lane_u32(folded, 1)) != 0;
+}
+
+/** Convert channels in [0, 255] to pixels, see spanPixel(). */
+static inline uint32x4_t packPixels(uint32x4_t a, uint32x4_t r, uint32x4_t g, uint32x4_t b, const Shifts &shifts) {
+	return vorrq_u32(
+		vorrq_u32(vshlq_u32(vshlq_u32(a, shifts.aLoss), shifts.aShift),
+		          vshlq_u32(vshlq_u32(r, shifts.rLoss), shifts.rShift)),
+		vorrq_u32(vshlq_u32(vshlq_u32(g, shifts.gLoss), shifts.gShift),
+		          vshlq_u32(vshlq_u32(b, shifts.bLoss), shifts.bShift)));
+}
+
+/** Return the byte of the colors in ZBufferPoint units, as passed to writePixel(). */
+static inline uint32x4_t colorChannel(uint32x4_t c) {
+	return vandq_u32(vshrq_n_u32(c, 8), vdupq_n_u32(0xFF));
+}
+
+/**
+ * Multiply texel channels by colors in ZBufferPoint units, keeping the low
+ * byte of the result as putPixelTexture() does.
+ */
+template<int shift>
+static inline uint32x4_t modulate(uint32x4_t texels, uint32x4_t c) {
+	const uint32x4_t channel = vandq_u32(vshlq_u32(texels, vdupq_n_s32(-shift)), vdupq_n_u32(0xFF));
+	return vandq_u32(vshrq_n_u32(vmulq_u32(channel, vshrq_n_u32(c, 8)), 8), vdupq_n_u32(0xFF));
+}
+
+static void drawDepthSpan(uint *pz, int count, uint z, int dzdx, const SpanParams &params) {
+	// Nothing is drawn without writing the depth
+	if (!params.depthWrite)
+		return;
+
+	const uint32x4_t zStep = step4(dzdx);
+	uint32x4_t zSrc = interpolate(z, dzdx, 0);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const uint32x4_t zDst = vld1q_u32((const uint32 *)(pz + i));
+		const uint32x4_t pass = depthTest(zSrc, zDst, params.depthFunc);
+		vst1q_u32((uint32 *)(pz + i), vbslq_u32(pass, zSrc, zDst));
+		zSrc = vaddq_u32(zSrc, zStep);
+	}
+
+	drawDepthSpanScalar(pz, i, count, z, dzdx, params);
+}
+
+static void drawColorSpan(uint32 *pp, uint *pz, int count, const SpanValues &values, const SpanParams &params) {
+	const Shifts shifts(params);
+	const uint32x4_t zStep = step4(values.dzdx);
+	const uint32x4_t rStep = step4(values.drdx);
+	const uint32x4_t gStep = step4(values.dgdx);
+	const uint32x4_t bStep = step4(values.dbdx);
+	const uint32x4_t aStep = step4(values.dadx);
+	uint32x4_t z = interpolate(values.z, values.dzdx, 0);
+	uint32x4_t r = interpolate(values.r, values.drdx, 0);
+	uint32x4_t g = interpolate(values.g, values.dgdx, 0);
+	uint32x4_t b = interpolate(values.b, values.dbdx, 0);
+	uint32x4_t a = interpolate(values.a, values.dadx, 0);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const uint32x4_t zDst = vld1q_u32((const uint32 *)(pz + i));
+		const uint32x4_t pass = depthTest(z, zDst, params.depthFunc);
+
+		if (anyLane(pass)) {
+			if (params.depthWrite)
+				vst1q_u32((uint32 *)(pz + i), vbslq_u32(pass, z, zDst));
+
+			const uint32x4_t pixels = packPixels(colorChannel(a), colorChannel(r), colorChannel(g), colorChannel(b), shifts);
+			vst1q_u32(pp + i, vbslq_u32(pass, pixels, vld1q_u32(pp + i)));
+		}
+
+		z = vaddq_u32(z, zStep);
+		r = vaddq_u32(r, rStep);
+		g = vaddq_u32(g, gStep);
+		b = vaddq_u32(b, bStep);
+		a = vaddq_u32(a, aStep);
+	}
+
+	drawColorSpanScalar(pp, pz, i, count, values, params);
+}
+
+static uint depthMask(const uint *pz, int count, uint z, int dzdx, const SpanParams &params) {
+	static const uint32 laneBits[4] = { 1, 2, 4, 8 };
+	uint mask = 0;
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const uint32x4_t pass = depthTest(interpolate(z, dzdx, i), vld1q_u32((const uint32 *)(pz + i)), params.depthFunc);
+		const uint32x4_t bits = vandq_u32(pass, vld1q_u32(laneBits));
+		const uint32x2_t folded = vorr_u32(vget_low_u32(bits), vget_high_u32(bits));
+		mask |= (vget_lane_u32(folded, 0) | vget_lane_u32(folded, 1)) << i;
+	}
+	for (; i < count; i++) {
+		if (spanDepthTest(z + (uint)i * dzdx, pz[i], params.depthFunc))
+			mask |= 1 << i;
+	}
+
+	return mask;
+}
+
+static void drawTexelSpan(uint32 *pp, uint *pz, int count, uint mask, const uint32 *texels, const SpanValues &values, const SpanParams &params) {
+	static const uint32 laneBitValues[4] = { 1, 2, 4, 8 };
+	const Shifts shifts(params);
+	const uint32x4_t laneBits = vld1q_u32(laneBitValues);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		if (!((mask >> i) & 0xF))
+			continue;
+
+		const uint32x4_t pass = vtstq_u32(vdupq_n_u32(mask >> i), laneBits);
+		if (params.depthWrite) {
+			const uint32x4_t zDst = vld1q_u32((const uint32 *)(pz + i));
+			vst1q_u32((uint32 *)(pz + i), vbslq_u32(pass, interpolate(values.z, values.dzdx, i), zDst));
+		}
+
+		const uint32x4_t src = vld1q_u32(texels + i);
+		const uint32x4_t pixels = packPixels(modulate<24>(src, interpolate(values.a, values.dadx, i)),
+		                                     modulate<16>(src, interpolate(values.r, values.drdx, i)),
+		                                     modulate<8>(src, interpolate(values.g, values.dgdx, i)),
+		                                     modulate<0>(src, interpolate(values.b, values.dbdx, i)), shifts);
+		vst1q_u32(pp + i, vbslq_u32(pass, pixels, vld1q_u32(pp + i)));
+	}
+
+	drawTexelSpanScalar(pp, pz, i, count, mask, texels, values, params);
+}
+
+static const SpanKernels neonSpanKernels = {
+	drawDepthSpan,
+	drawColorSpan,
+	depthMask,
+	drawTexelSpan
+};
+
+const SpanKernels *getNEONSpanKernels() {
+	return &neonSpanKernels;
+}
+
+} // End of namespace TinyGL
@@ -0,0 +1,229 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <emmintrin.h>
+
+#include "graphics/tinygl/zspan.h"
+
+namespace TinyGL {
+
+namespace {
+
+/** The shift counts of a SpanParams, ready for the shift instructions. */
+struct Shifts {
+	__m128i aLoss, rLoss, gLoss, bLoss;
+	__m128i aShift, rShift, gShift, bShift;
+
+	explicit Shifts(const SpanParams &params) {
+		aLoss = _mm_cvtsi32_si128(params.aLoss);
+		rLoss = _mm_cvtsi32_si128(params.rLoss);
+		gLoss = _mm_cvtsi32_si128(params.gLoss);
+		bLoss = _mm_cvtsi32_si128(params.bLoss);
+		aShift = _mm_cvtsi32_si128(params.aShift);
+		rShift = _mm_cvtsi32_si128(params.rShift);
+		gShift = _mm_cvtsi32_si128(params.gShift);
+		bShift = _mm_cvtsi32_si128(params.bShift);
+	}
+};
+
+} // End of anonymous namespace
+
+/** Return the values of four pixels, starting at pixel i of a span. */
+static inline __m128i interpolate(uint value, int step, int i) {
+	const uint first = value + (uint)i * step;
+	return _mm_setr_epi32(first, first + step, first + 2 * (uint)step, first + 3 * (uint)step);
+}
+
+/** Return the step of the values of four pixels. */
+static inline __m128i step4(int step) {
+	return _mm_set1_epi32(4 * (uint)step);
+}
+
+/** Compare unsigned values, as SSE2 only compares signed ones. */
+static inline __m128i lessThan(__m128i a, __m128i b) {
+	const __m128i bias = _mm_set1_epi32((int)0x80000000);
+	return _mm_cmplt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+}
+
+/** Return the lanes passing the depth test, see spanDepthTest(). */
+static inline __m128i depthTest(__m128i zSrc, __m128i zDst, int depthFunc) {
+	const __m128i ones = _mm_set1_epi32(-1);
+
+	switch (depthFunc) {
+	case TGL_LESS:
+		return lessThan(zDst, zSrc);
+	case TGL_EQUAL:
+		return _mm_cmpeq_epi32(zDst, zSrc);
+	case TGL_LEQUAL:
+		return _mm_xor_si128(lessThan(zSrc, zDst), ones);
+	case TGL_GREATER:
+		return lessThan(zSrc, zDst);
+	case TGL_NOTEQUAL:
+		return _mm_xor_si128(_mm_cmpeq_epi32(zDst, zSrc), ones);
+	case TGL_GEQUAL:
+		return _mm_xor_si128(lessThan(zDst, zSrc), ones);
+	case TGL_ALWAYS:
+		return ones;
+	default:
+		return _mm_setzero_si128();
+	}
+}
+
+static inline __m128i select(__m128i mask, __m128i a, __m128i b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/** Convert channels in [0, 255] to pixels, see spanPixel(). */
+static inline __m128i packPixels(__m128i a, __m128i r, __m128i g, __m128i b, const Shifts &shifts) {
+	return _mm_or_si128(
+		_mm_or_si128(_mm_sll_epi32(_mm_srl_epi32(a, shifts.aLoss), shifts.aShift),
+		             _mm_sll_epi32(_mm_srl_epi32(r, shifts.rLoss), shifts.rShift)),
+		_mm_or_si128(_mm_sll_epi32(_mm_srl_epi32(g, shifts.gLoss), shifts.gShift),
+		             _mm_sll_epi32(_mm_srl_epi32(b, shifts.bLoss), shifts.bShift)));
+}
+
+/** Return the byte of the colors in ZBufferPoint units, as passed to writePixel(). */
+static inline __m128i colorChannel(__m128i c) {
+	return _mm_and_si128(_mm_srli_epi32(c, 8), _mm_set1_epi32(0xFF));
+}
+
+/**
+ * Multiply texel channels by colors in ZBufferPoint units, keeping the low
+ * byte of the result as putPixelTexture() does. Only the low 16 bits of
+ * the products matter, which a 16 bit multiplication gives.
+ */
+template<int shift>
+static inline __m128i modulate(__m128i texels, __m128i c) {
+	const __m128i channel = _mm_and_si128(_mm_srli_epi32(texels, shift), _mm_set1_epi32(0xFF));
+	return _mm_srli_epi32(_mm_mullo_epi16(channel, _mm_srli_epi32(c, 8)), 8);
+}
+
+static void drawDepthSpan(uint *pz, int count, uint z, int dzdx, const SpanParams &params) {
+	// Nothing is drawn without writing the depth
+	if (!params.depthWrite)
+		return;
+
+	const __m128i zStep = step4(dzdx);
+	__m128i zSrc = interpolate(z, dzdx, 0);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i zDst = _mm_loadu_si128((const __m128i *)(pz + i));
+		const __m128i pass = depthTest(zSrc, zDst, params.depthFunc);
+		_mm_storeu_si128((__m128i *)(pz + i), select(pass, zSrc, zDst));
+		zSrc = _mm_add_epi32(zSrc, zStep);
+	}
+
+	drawDepthSpanScalar(pz, i, count, z, dzdx, params);
+}
+
+static void drawColorSpan(uint32 *pp, uint *pz, int count, const SpanValues &values, const SpanParams &params) {
+	const Shifts shifts(params);
+	const __m128i zStep = step4(values.dzdx);
+	const __m128i rStep = step4(values.drdx);
+	const __m128i gStep = step4(values.dgdx);
+	const __m128i bStep = step4(values.dbdx);
+	const __m128i aStep = step4(values.dadx);
+	__m128i z = interpolate(values.z, values.dzdx, 0);
+	__m128i r = interpolate(values.r, values.drdx, 0);
+	__m128i g = interpolate(values.g, values.dgdx, 0);
+	__m128i b = interpolate(values.b, values.dbdx, 0);
+	__m128i a = interpolate(values.a, values.dadx, 0);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i zDst = _mm_loadu_si128((const __m128i *)(pz + i));
+		const __m128i pass = depthTest(z, zDst, params.depthFunc);
+
+		if (_mm_movemask_epi8(pass)) {
+			if (params.depthWrite)
+				_mm_storeu_si128((__m128i *)(pz + i), select(pass, z, zDst));
+
+			const __m128i pixels = packPixels(colorChannel(a), colorChannel(r), colorChannel(g), colorChannel(b), shifts);
+			const __m128i dst = _mm_loadu_si128((const __m128i *)(pp + i));
+			_mm_storeu_si128((__m128i *)(pp + i), select(pass, pixels, dst));
+		}
+
+		z = _mm_add_epi32(z, zStep);
+		r = _mm_add_epi32(r, rStep);
+		g = _mm_add_epi32(g, gStep);
+		b = _mm_add_epi32(b, bStep);
+		a = _mm_add_epi32(a, aStep);
+	}
+
+	drawColorSpanScalar(pp, pz, i, count, values, params);
+}
+
+static uint depthMask(const uint *pz, int count, uint z, int dzdx, const SpanParams &params) {
+	uint mask = 0;
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i pass = depthTest(interpolate(z, dzdx, i), _mm_loadu_si128((const __m128i *)(pz + i)), params.depthFunc);
+		mask |= _mm_movemask_ps(_mm_castsi128_ps(pass)) << i;
+	}
+	for (; i < count; i++) {
+		if (spanDepthTest(z + (uint)i * dzdx, pz[i], params.depthFunc))
+			mask |= 1 << i;
+	}
+
+	return mask;
+}
+
+static void drawTexelSpan(uint32 *pp, uint *pz, int count, uint mask, const uint32 *texels, const SpanValues &values, const SpanParams &params) {
+	const Shifts shifts(params);
+	const __m128i laneBits = _mm_setr_epi32(1, 2, 4, 8);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		if (!((mask >> i) & 0xF))
+			continue;
+
+		const __m128i pass = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(mask >> i), laneBits), laneBits);
+		if (params.depthWrite) {
+			const __m128i zDst = _mm_loadu_si128((const __m128i *)(pz + i));
+			_mm_storeu_si128((__m128i *)(pz + i), select(pass, interpolate(values.z, values.dzdx, i), zDst));
+		}
+
+		const __m128i src = _mm_loadu_si128((const __m128i *)(texels + i));
+		const __m128i pixels = packPixels(modulate<24>(src, interpolate(values.a, values.dadx, i)),
+		                                  modulate<16>(src, interpolate(values.r, values.drdx, i)),
+		                                  modulate<8>(src, interpolate(values.g, values.dgdx, i)),
+		                                  modulate<0>(src, interpolate(values.b, values.dbdx, i)), shifts);
+		const __m128i dst = _mm_loadu_si128((const __m128i *)(pp + i));
+		_mm_storeu_si128((__m128i *)(pp + i), select(pass, pixels, dst));
+	}
+
+	drawTexelSpanScalar(pp, pz, i, count, mask, texels, values, params);
+}
+
+static const SpanKernels sse2SpanKernels = {
+	drawDepthSpan,
+	drawColorSpan,
+	depthMask,
+	drawTexelSpan
+};
+
+const SpanKernels *getSSE2SpanKernels() {
+	return &sse2SpanKernels;
+}
+
+} // End of namespace TinyGL
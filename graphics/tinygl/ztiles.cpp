@@ -0,0 +1,227 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "graphics/tinygl/ztiles.h"
+#include "graphics/tinygl/zdirtyrect.h"
+#include "graphics/tinygl/zgl.h"
+
+namespace TinyGL {
+
+TileExecutor::TileExecutor(GLContext *c, uint numThreads) : _context(c), _nextTile(0), _quit(false) {
+	for (uint i = 0; i < numThreads; i++) {
+		Worker *worker = new Worker();
+		worker->executor = this;
+		worker->context = new GLContext();
+		worker->context->initTileWorker(c);
+		worker->thread = new Common::Thread(threadProc, worker);
+
+		if (!worker->thread->isRunning()) {
+			delete worker->thread;
+			worker->context->deinitTileWorker();
+			delete worker->context;
+			delete worker;
+			break;
+		}
+		_workers.push_back(worker);
+	}
+}
+
+TileExecutor::~TileExecutor() {
+	_mutex.lock();
+	_quit = true;
+	_mutex.unlock();
+
+	for (uint i = 0; i < _workers.size(); i++)
+		_start.post();
+
+	for (uint i = 0; i < _workers.size(); i++) {
+		delete _workers[i]->thread;
+		_workers[i]->context->deinitTileWorker();
+		delete _workers[i]->context;
+		delete _workers[i];
+	}
+}
+
+bool TileExecutor::canExecute(const Common::List<DrawCall *> &drawCalls) const {
+	if (_context->render_mode == TGL_SELECT)
+		return false;
+
+	for (Common::List<DrawCall *>::const_iterator it = drawCalls.begin(); it != drawCalls.end(); ++it) {
+		if (!(*it)->canBeTiled())
+			return false;
+	}
+
+	return true;
+}
+
+void TileExecutor::execute(const Common::List<DrawCall *> &drawCalls, const Common::Array<Common::Rect> &rectangles) {
+	binDrawCalls(drawCalls, rectangles);
+
+	const uint numThreads = MIN<uint>(_workers.size(), _tiles.size() - 1);
+	if (!numThreads) {
+		executeTiles(_context);
+		return;
+	}
+
+	// Any thread may wake up, so all of them get the current state
+	for (uint i = 0; i < _workers.size(); i++)
+		copyState(_workers[i]->context);
+
+	for (uint i = 0; i < numThreads; i++)
+		_start.post();
+
+	executeTiles(_context);
+
+	// Every thread woken up takes part, even if the tiles are all gone
+	// by then, so that none of them still looks at this frame afterwards
+	for (uint i = 0; i < numThreads; i++)
+		_done.wait();
+}
+
+void TileExecutor::binDrawCalls(const Common::List<DrawCall *> &drawCalls, const Common::Array<Common::Rect> &rectangles) {
+	const Common::Rect &renderRect = _context->renderRect;
+	const int height = renderRect.height();
+	const int numTiles = CLIP<int>(height / kMinTileHeight, 1, (_workers.size() + 1) * kTilesPerThread);
+
+	_tiles.resize(numTiles);
+	for (int i = 0; i < numTiles; i++) {
+		_tiles[i].rectangle = Common::Rect(renderRect.left, renderRect.top + height * i / numTiles,
+		                                   renderRect.right, renderRect.top + height * (i + 1) / numTiles);
+		// Keeps the storage for the next frame
+		_tiles[i].drawCalls.resize(0);
+	}
+
+	// The order of the calls is kept in every tile, as they overlap
+	for (Common::List<DrawCall *>::const_iterator it = drawCalls.begin(); it != drawCalls.end(); ++it) {
+		const Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+
+		for (uint i = 0; i < rectangles.size(); i++) {
+			const Common::Rect region = rectangles[i].findIntersectingRect(drawCallRegion);
+			if (region.isEmpty())
+				continue;
+
+			for (int j = 0; j < numTiles; j++) {
+				Tile &tile = _tiles[j];
+				if (tile.rectangle.top >= region.bottom)
+					break;
+				if (tile.rectangle.bottom <= region.top)
+					continue;
+
+				TileDrawCall tileDrawCall;
+				tileDrawCall.drawCall = *it;
+				tileDrawCall.clippingRectangle = rectangles[i].findIntersectingRect(tile.rectangle);
+				tile.drawCalls.push_back(tileDrawCall);
+			}
+		}
+	}
+
+	_mutex.lock();
+	_nextTile = 0;
+	_mutex.unlock();
+}
+
+void TileExecutor::copyState(GLContext *context) const {
+	const GLContext *c = _context;
+
+	// The framebuffer state is restored after every draw call, as the one of
+	// the context below, but not all of it is part of the draw call state
+	context->fb->shareBuffers(*c->fb);
+	context->renderRect = c->renderRect;
+	context->_scissorRect = c->_scissorRect;
+	context->render_mode = c->render_mode;
+	context->viewport = c->viewport;
+	context->vertex_n = c->vertex_n;
+
+	context->blending_enabled = c->blending_enabled;
+	context->source_blending_factor = c->source_blending_factor;
+	context->destination_blending_factor = c->destination_blending_factor;
+	context->alpha_test_enabled = c->alpha_test_enabled;
+	context->alpha_test_func = c->alpha_test_func;
+	context->alpha_test_ref_val = c->alpha_test_ref_val;
+	context->depth_test_enabled = c->depth_test_enabled;
+	context->depth_func = c->depth_func;
+	context->depth_write_mask = c->depth_write_mask;
+	context->stencil_test_enabled = c->stencil_test_enabled;
+	context->stencil_test_func = c->stencil_test_func;
+	context->stencil_ref_val = c->stencil_ref_val;
+	context->stencil_mask = c->stencil_mask;
+	context->stencil_write_mask = c->stencil_write_mask;
+	context->stencil_sfail = c->stencil_sfail;
+	context->stencil_dpfail = c->stencil_dpfail;
+	context->stencil_dppass = c->stencil_dppass;
+	context->offset_states = c->offset_states;
+	context->offset_factor = c->offset_factor;
+	context->offset_units = c->offset_units;
+
+	context->lighting_enabled = c->lighting_enabled;
+	context->cull_face_enabled = c->cull_face_enabled;
+	context->current_cull_face = c->current_cull_face;
+	context->begin_type = c->begin_type;
+	context->color_mask_red = c->color_mask_red;
+	context->color_mask_green = c->color_mask_green;
+	context->color_mask_blue = c->color_mask_blue;
+	context->color_mask_alpha = c->color_mask_alpha;
+	context->current_front_face = c->current_front_face;
+	context->current_shade_model = c->current_shade_model;
+	context->polygon_mode_back = c->polygon_mode_back;
+	context->polygon_mode_front = c->polygon_mode_front;
+	context->texture_2d_enabled = c->texture_2d_enabled;
+	context->current_texture = c->current_texture;
+	context->texture_wrap_s = c->texture_wrap_s;
+	context->texture_wrap_t = c->texture_wrap_t;
+}
+
+void TileExecutor::executeTiles(GLContext *context) {
+	for (;;) {
+		_mutex.lock();
+		const uint tile = _nextTile < _tiles.size() ? _nextTile++ : _tiles.size();
+		_mutex.unlock();
+
+		if (tile == _tiles.size())
+			break;
+
+		const Common::Array<TileDrawCall> &drawCalls = _tiles[tile].drawCalls;
+		for (uint i = 0; i < drawCalls.size(); i++)
+			drawCalls[i].drawCall->execute(context, drawCalls[i].clippingRectangle, true);
+	}
+}
+
+void TileExecutor::threadProc(void *param) {
+	Worker *worker = (Worker *)param;
+	worker->executor->run(worker->context);
+}
+
+void TileExecutor::run(GLContext *context) {
+	for (;;) {
+		_start.wait();
+
+		_mutex.lock();
+		const bool quit = _quit;
+		_mutex.unlock();
+		if (quit)
+			break;
+
+		executeTiles(context);
+		_done.post();
+	}
+}
+
+} // end of namespace TinyGL
@@ -0,0 +1,126 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_TINYGL_ZTILES_H
+#define GRAPHICS_TINYGL_ZTILES_H
+
+#include "common/array.h"
+#include "common/list.h"
+#include "common/mutex.h"
+#include "common/rect.h"
+#include "common/thread.h"
+
+namespace TinyGL {
+
+struct GLContext;
+class DrawCall;
+
+/**
+ * Executes the draw calls of a frame on several threads, by splitting the
+ * framebuffer into tiles of whole rows.
+ *
+ * The draw calls are binned into the tiles by their dirty regions. Every
+ * tile executes the calls overlapping it in order, clipped to the tile,
+ * through DrawCall::execute(context, clippingRectangle, true). Every thread
+ * draws with a context and a FrameBuffer of its own, which share the buffers
+ * and the state of the main context (see GLContext::initTileWorker()).
+ *
+ * No pixel belongs to two tiles, so the result is the same as executing
+ * the calls on one thread, as long as they draw the same pixels whichever
+ * rows they are clipped to (see DrawCall::canBeTiled()).
+ */
+class TileExecutor : Common::NonCopyable {
+public:
+	enum {
+		kMaxThreads = 16
+	};
+
+	/**
+	 * Start numThreads threads drawing for the given context. Fewer,
+	 * possibly none, are started if the backend cannot create them.
+	 */
+	TileExecutor(GLContext *c, uint numThreads);
+	~TileExecutor();
+
+	/** Return the number of threads started. */
+	uint getNumThreads() const { return _workers.size(); }
+
+	/** Return whether the draw calls can be executed in tiles. */
+	bool canExecute(const Common::List<DrawCall *> &drawCalls) const;
+
+	/**
+	 * Execute every draw call clipped to each of the rectangles intersecting
+	 * its dirty region, sharing the tiles between the threads and the
+	 * calling thread. Returns when all tiles are done.
+	 *
+	 * @param rectangles Rectangles to draw, which must not overlap.
+	 */
+	void execute(const Common::List<DrawCall *> &drawCalls, const Common::Array<Common::Rect> &rectangles);
+
+private:
+	enum {
+		/** Smallest number of rows worth a tile of its own. */
+		kMinTileHeight = 16,
+		/** Number of tiles per thread, to share the work evenly. */
+		kTilesPerThread = 4
+	};
+
+	struct Worker {
+		TileExecutor *executor;
+		GLContext *context;
+		Common::Thread *thread;
+	};
+
+	struct TileDrawCall {
+		const DrawCall *drawCall;
+		Common::Rect clippingRectangle;
+	};
+
+	struct Tile {
+		Common::Rect rectangle;
+		Common::Array<TileDrawCall> drawCalls;
+	};
+
+	static void threadProc(void *param);
+	void run(GLContext *context);
+
+	void binDrawCalls(const Common::List<DrawCall *> &drawCalls, const Common::Array<Common::Rect> &rectangles);
+	void copyState(GLContext *context) const;
+
+	/** Execute the tiles not taken yet by another thread, with the given context. */
+	void executeTiles(GLContext *context);
+
+	GLContext *_context;
+
+	Common::Mutex _mutex;
+	/** Posted once for every thread to wake up. */
+	Common::Semaphore _start;
+	/** Posted by every woken up thread when there is no tile left. */
+	Common::Semaphore _done;
+	Common::Array<Tile> _tiles;
+	uint _nextTile;
+	bool _quit;
+	Common::Array<Worker *> _workers;
+};
+
+} // end of namespace TinyGL
+
+#endif
@@ -26,39 +26,57 @@
  */
 
 #include "common/endian.h"
+#include "common/system.h"
 #include "graphics/tinygl/texelbuffer.h"
 #include "graphics/tinygl/zbuffer.h"
 #include "graphics/tinygl/zgl.h"
+#include "graphics/tinygl/zspan.h"
 
 namespace TinyGL {
 
 static const int NB_INTERP = 8;
 
+const SpanKernels *getSpanKernels() {
+	if (g_system) {
+#ifdef SCUMMVM_NEON
+		if (g_system->hasFeature(OSystem::kFeatureCpuNEON))
+			return getNEONSpanKernels();
+#endif
+#ifdef SCUMMVM_AVX2
+		if (g_system->hasFeature(OSystem::kFeatureCpuAVX2))
+			return getAVX2SpanKernels();
+#endif
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2))
+			return getSSE2SpanKernels();
+#endif
+	}
+
+	return nullptr;
+}
+
 template <bool kDepthWrite, bool kSmoothMode, bool kEnableAlphaTest, bool kEnableScissor, bool kEnableBlending, bool kStencilEnabled, bool kDepthTestEnabled>
 FORCEINLINE void FrameBuffer::putPixelNoTexture(int fbOffset, uint *pz, byte *ps, int _a,
 	                                        int x, int y, uint &z, uint &r, uint &g, uint &b, uint &a,
 	                                        int &dzdx, int &drdx, int &dgdx, int &dbdx, uint dadx) {
+	// The pixels not drawn still step the interpolated values
 	if (kEnableScissor && scissorPixel(x + _a, y)) {
-		return;
-	}
-	if (kStencilEnabled) {
-		bool stencilResult = stencilTest(ps[_a]);
-		if (!stencilResult) {
-			stencilOp(false, true, ps + _a);
-			return;
-		}
-	}
-	bool depthTestResult;
-	if (kDepthTestEnabled) {
-		depthTestResult = compareDepth(z, pz[_a]);
+		// not drawn
+	} else if (kStencilEnabled && !stencilTest(ps[_a])) {
+		stencilOp(false, true, ps + _a);
 	} else {
-		depthTestResult = true;
-	}
-	if (kStencilEnabled) {
-		stencilOp(true, depthTestResult, ps + _a);
-	}
-	if (depthTestResult) {
-		writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite>(fbOffset + _a, a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8), z);
+		bool depthTestResult;
+		if (kDepthTestEnabled) {
+			depthTestResult = compareDepth(z, pz[_a]);
+		} else {
+			depthTestResult = true;
+		}
+		if (kStencilEnabled) {
+			stencilOp(true, depthTestResult, ps + _a);
+		}
+		if (depthTestResult) {
+			writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite>(fbOffset + _a, a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8), z);
+		}
 	}
 	z += dzdx;
 	if (kSmoothMode) {
@@ -76,38 +94,34 @@ FORCEINLINE void FrameBuffer::putPixelTexture(int fbOffset, const TexelBuffer *t
 	                                      uint &r, uint &g, uint &b, uint &a,
 	                                      int &dzdx, int &dsdx, int &dtdx, int &drdx, int &dgdx, int &dbdx, uint dadx) {
 	if (kEnableScissor && scissorPixel(x + _a, y)) {
-		return;
-	}
-	if (kStencilEnabled) {
-		bool stencilResult = stencilTest(ps[_a]);
-		if (!stencilResult) {
-			stencilOp(false, true, ps + _a);
-			return;
-		}
-	}
-	bool depthTestResult;
-	if (kDepthTestEnabled) {
-		depthTestResult = compareDepth(z, pz[_a]);
+		// not drawn
+	} else if (kStencilEnabled && !stencilTest(ps[_a])) {
+		stencilOp(false, true, ps + _a);
 	} else {
-		depthTestResult = true;
-	}
-	if (kStencilEnabled) {
-		stencilOp(true, depthTestResult, ps + _a);
-	}
-	if (depthTestResult) {
-		uint8 c_a, c_r, c_g, c_b;
-		texture->getARGBAt(wrap_s, wrap_t, s, t, c_a, c_r, c_g, c_b);
-		if (kLightsMode) {
-			uint l_a = (a >> (ZB_POINT_ALPHA_BITS - 8));
-			uint l_r = (r >> (ZB_POINT_RED_BITS - 8));
-			uint l_g = (g >> (ZB_POINT_GREEN_BITS - 8));
-			uint l_b = (b >> (ZB_POINT_BLUE_BITS - 8));
-			c_a = (c_a * l_a) >> (ZB_POINT_ALPHA_BITS - 8);
-			c_r = (c_r * l_r) >> (ZB_POINT_RED_BITS - 8);
-			c_g = (c_g * l_g) >> (ZB_POINT_GREEN_BITS - 8);
-			c_b = (c_b * l_b) >> (ZB_POINT_BLUE_BITS - 8);
+		bool depthTestResult;
+		if (kDepthTestEnabled) {
+			depthTestResult = compareDepth(z, pz[_a]);
+		} else {
+			depthTestResult = true;
+		}
+		if (kStencilEnabled) {
+			stencilOp(true, depthTestResult, ps + _a);
+		}
+		if (depthTestResult) {
+			uint8 c_a, c_r, c_g, c_b;
+			texture->getARGBAt(wrap_s, wrap_t, s, t, c_a, c_r, c_g, c_b);
+			if (kLightsMode) {
+				uint l_a = (a >> (ZB_POINT_ALPHA_BITS - 8));
+				uint l_r = (r >> (ZB_POINT_RED_BITS - 8));
+				uint l_g = (g >> (ZB_POINT_GREEN_BITS - 8));
+				uint l_b = (b >> (ZB_POINT_BLUE_BITS - 8));
+				c_a = (c_a * l_a) >> (ZB_POINT_ALPHA_BITS - 8);
+				c_r = (c_r * l_r) >> (ZB_POINT_RED_BITS - 8);
+				c_g = (c_g * l_g) >> (ZB_POINT_GREEN_BITS - 8);
+				c_b = (c_b * l_b) >> (ZB_POINT_BLUE_BITS - 8);
+			}
+			writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite>(fbOffset + _a, c_a, c_r, c_g, c_b, z);
 		}
-		writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite>(fbOffset + _a, c_a, c_r, c_g, c_b, z);
 	}
 	z += dzdx;
 	s += dsdx;
@@ -123,30 +137,63 @@ FORCEINLINE void FrameBuffer::putPixelTexture(int fbOffset, const TexelBuffer *t
 template <bool kDepthWrite, bool kEnableScissor, bool kStencilEnabled, bool kDepthTestEnabled>
 FORCEINLINE void FrameBuffer::putPixelDepth(uint *pz, byte *ps, int _a, int x, int y, uint &z, int &dzdx) {
 	if (kEnableScissor && scissorPixel(x + _a, y)) {
-		return;
-	}
-	if (kStencilEnabled) {
-		bool stencilResult = stencilTest(ps[_a]);
-		if (!stencilResult) {
-			stencilOp(false, true, ps + _a);
-			return;
-		}
-	}
-	bool depthTestResult;
-	if (kDepthTestEnabled) {
-		depthTestResult = compareDepth(z, pz[_a]);
+		// not drawn
+	} else if (kStencilEnabled && !stencilTest(ps[_a])) {
+		stencilOp(false, true, ps + _a);
 	} else {
-		depthTestResult = true;
-	}
-	if (kStencilEnabled) {
-		stencilOp(true, depthTestResult, ps + _a);
-	}
-	if (kDepthWrite && depthTestResult) {
-		pz[_a] = z;
+		bool depthTestResult;
+		if (kDepthTestEnabled) {
+			depthTestResult = compareDepth(z, pz[_a]);
+		} else {
+			depthTestResult = true;
+		}
+		if (kStencilEnabled) {
+			stencilOp(true, depthTestResult, ps + _a);
+		}
+		if (kDepthWrite && depthTestResult) {
+			pz[_a] = z;
+		}
 	}
 	z += dzdx;
 }
 
+template <bool kEnableScissor>
+FORCEINLINE void FrameBuffer::putSpanTexture(const SpanParams &spanParams, int fbOffset, const TexelBuffer *texture,
+                                             uint *pz, int x, int count, uint &z, int &t, int &s,
+                                             uint &r, uint &g, uint &b, uint &a,
+                                             int dzdx, int dsdx, int dtdx, int drdx, int dgdx, int dbdx, int dadx) {
+	int first, last;
+	scissorSpan<kEnableScissor>(x, count, first, last);
+
+	uint mask = 0;
+	if (first < last) {
+		mask = _spanKernels->depthMask(pz, last, z, dzdx, spanParams) & ~((1 << first) - 1);
+	}
+
+	// Only the texels of the pixels passing the depth test are fetched
+	if (mask) {
+		uint32 texels[kSpanMaskPixels];
+		for (int i = first; i < last; i++) {
+			if (mask & (1 << i)) {
+				uint8 c_a, c_r, c_g, c_b;
+				texture->getARGBAt(_wrapS, _wrapT, s + (uint)i * dsdx, t + (uint)i * dtdx, c_a, c_r, c_g, c_b);
+				texels[i] = (c_a << 24) | (c_r << 16) | (c_g << 8) | c_b;
+			}
+		}
+
+		const SpanValues values = { z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx };
+		_spanKernels->texelSpan((uint32 *)_pbuf.getRawBuffer() + fbOffset, pz, last, mask, texels, values, spanParams);
+	}
+
+	z += (uint)count * dzdx;
+	s += (uint)count * dsdx;
+	t += (uint)count * dtdx;
+	r += (uint)count * drdx;
+	g += (uint)count * dgdx;
+	b += (uint)count * dbdx;
+	a += (uint)count * dadx;
+}
+
 template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kSmoothMode,
           bool kDepthWrite, bool kAlphaTestEnabled, bool kEnableScissor, bool kBlendingEnabled,
           bool kStencilEnabled, bool kDepthTestEnabled>
@@ -294,6 +341,22 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		a1 = p2->a;
 	}
 
+	// Without stencil test, alpha test or blending, the spans are drawn by the SIMD routines
+	const bool drawSpans = !kAlphaTestEnabled && !kBlendingEnabled && !kStencilEnabled && kInterpZ && _spanKernels;
+	SpanParams spanParams;
+	if (drawSpans) {
+		spanParams.depthFunc = kDepthTestEnabled ? _depthFunc : TGL_ALWAYS;
+		spanParams.depthWrite = kDepthWrite;
+		spanParams.aShift = _pbufFormat.aShift;
+		spanParams.rShift = _pbufFormat.rShift;
+		spanParams.gShift = _pbufFormat.gShift;
+		spanParams.bShift = _pbufFormat.bShift;
+		spanParams.aLoss = _pbufFormat.aLoss;
+		spanParams.rLoss = _pbufFormat.rLoss;
+		spanParams.gLoss = _pbufFormat.gLoss;
+		spanParams.bLoss = _pbufFormat.bLoss;
+	}
+
 	if (kInterpRGB && (kInterpST || kInterpSTZ)) {
 		texture = _currentTexture;
 		fdzdx = (float)dzdx;
@@ -394,8 +457,26 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 
 		// we draw all the scan line of the part
 		while (nb_lines > 0) {
+			// no pixel of the remaining lines passes the scissor test
+			if (kEnableScissor && y >= _clipRectangle.bottom)
+				return;
+
 			int x = x1;
-			if (!kInterpRGB) {
+			if (kEnableScissor && scissorLine(y)) {
+				// no pixel of the line passes the scissor test, only step the edges
+			} else if (drawSpans && !(kInterpST || kInterpSTZ)) {
+				int first, last;
+				scissorSpan<kEnableScissor>(x1, (x2 >> 16) - x1 + 1, first, last);
+				if (first < last && !kInterpRGB) {
+					_spanKernels->depthSpan(pz1 + x1 + first, last - first, z1 + (uint)first * dzdx, dzdx, spanParams);
+				} else if (first < last) {
+					const SpanValues values = {
+						z1 + (uint)first * dzdx, r1 + (uint)first * drdx, g1 + (uint)first * dgdx,
+						b1 + (uint)first * dbdx, a1 + (uint)first * dadx, dzdx, drdx, dgdx, dbdx, dadx
+					};
+					_spanKernels->colorSpan((uint32 *)_pbuf.getRawBuffer() + pp1 + x1 + first, pz1 + x1 + first, last - first, values, spanParams);
+				}
+			} else if (!kInterpRGB) {
 				int n;
 				uint *pz;
 				byte *ps = nullptr;
@@ -517,9 +598,13 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 						fz += fndzdx;
 						zinv = (float)(1.0 / fz);
 					}
-					for (int _a = 0; _a < NB_INTERP; _a++) {
-						putPixelTexture<kDepthWrite, kInterpRGB, kSmoothMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
-						               (pp, texture, _wrapS, _wrapT, pz, ps, _a, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+					if (drawSpans) {
+						putSpanTexture<kEnableScissor>(spanParams, pp, texture, pz, x, NB_INTERP, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+					} else {
+						for (int _a = 0; _a < NB_INTERP; _a++) {
+							putPixelTexture<kDepthWrite, kInterpRGB, kSmoothMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
+							               (pp, texture, _wrapS, _wrapT, pz, ps, _a, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+						}
 					}
 					pp += NB_INTERP;
 					if (kInterpZ) {
@@ -544,6 +629,10 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 					dtdx = (int)((dtzdx - tt * fdzdx) * zinv);
 				}
 
+				if (drawSpans && n >= 0) {
+					putSpanTexture<kEnableScissor>(spanParams, pp, texture, pz, x, n + 1, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+					n = -1;
+				}
 				while (n >= 0) {
 					putPixelTexture<kDepthWrite, kInterpRGB, kSmoothMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
 					               (pp, texture, _wrapS, _wrapT, pz, ps, 0, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
@@ -82,8 +82,10 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/system.h"
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_intern.h"
 
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
@@ -165,9 +167,29 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 	}
 }
 
+const YUVToRGBKernels *getYUVToRGBKernels() {
+	if (g_system) {
+#ifdef SCUMMVM_NEON
+		if (g_system->hasFeature(OSystem::kFeatureCpuNEON))
+			return getNEONYUVToRGBKernels();
+#endif
+#ifdef SCUMMVM_AVX2
+		if (g_system->hasFeature(OSystem::kFeatureCpuAVX2))
+			return getAVX2YUVToRGBKernels();
+#endif
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2))
+			return getSSE2YUVToRGBKernels();
+#endif
+	}
+
+	return nullptr;
+}
+
 YUVToRGBManager::YUVToRGBManager() {
 	_lookup = 0;
 	_alphaMode = false;
+	_kernels = getYUVToRGBKernels();
 
 	int16 *Cr_r_tab = &_colorTab[0 * 256];
 	int16 *Cr_g_tab = &_colorTab[1 * 256];
@@ -202,6 +224,63 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	return _lookup;
 }
 
+void YUVToRGBManager::convertWithKernels(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, bool alphaMode, int chromaShift, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const Graphics::PixelFormat &format = dst->format;
+
+	YUVToRGBParams params;
+	params.rShift = format.rShift;
+	params.gShift = format.gShift;
+	params.bShift = format.bShift;
+	params.aShift = format.aShift;
+	params.rLoss = format.rLoss;
+	params.gLoss = format.gLoss;
+	params.bLoss = format.bLoss;
+	params.aLoss = format.aLoss;
+	params.alpha = format.ARGBToColor(alphaMode ? 0 : 255, 0, 0, 0);
+	params.itu = (scale == kScaleITU);
+
+	// Check whether the channels can be stored byte by byte
+	params.byteOrder[0] = params.byteOrder[1] = params.byteOrder[2] = params.byteOrder[3] = 3;
+	const uint8 shifts[4] = { format.rShift, format.gShift, format.bShift, format.aShift };
+	const uint8 losses[4] = { format.rLoss, format.gLoss, format.bLoss, format.aLoss };
+	bool bytes = (format.bytesPerPixel == 4);
+	for (int i = 0; i < 4 && bytes; i++) {
+		// Missing alpha bits are zero, whatever byte they end up in
+		if (i == 3 && losses[i] == 8)
+			break;
+
+		int index = shifts[i] / 8;
+#ifdef SCUMM_BIG_ENDIAN
+		index = 3 - index;
+#endif
+		if (losses[i] != 0 || (shifts[i] % 8) != 0 || params.byteOrder[index] != 3)
+			bytes = false;
+		else
+			params.byteOrder[index] = i;
+	}
+	if (!bytes)
+		params.byteOrder[0] = -1;
+
+	YUVToRGBRowsProc convertRows;
+	if (chromaShift == 0)
+		convertRows = (format.bytesPerPixel == 2) ? _kernels->convert444To16 : _kernels->convert444To32;
+	else
+		convertRows = (format.bytesPerPixel == 2) ? _kernels->convert420To16 : _kernels->convert420To32;
+
+	byte *dstPtr = (byte *)dst->getPixels();
+
+	for (int h = 0; h < yHeight; h += 1 << chromaShift) {
+		convertRows(dstPtr, dst->pitch, ySrc, aSrc, yPitch, uSrc, vSrc, yWidth, params);
+
+		dstPtr += dst->pitch << chromaShift;
+		ySrc += yPitch << chromaShift;
+		if (aSrc)
+			aSrc += yPitch << chromaShift;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+}
+
 #define PUT_PIXEL(s, d) \
 	L = &rgbToPix[(s)]; \
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
@@ -243,6 +322,12 @@ void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
 	assert(ySrc && uSrc && vSrc);
 
+	if (_kernels) {
+		convertWithKernels(dst, scale, false, 0, ySrc, uSrc, vSrc, nullptr, yWidth, yHeight, yPitch, uvPitch);
+		return;
+	}
+
+	Common::StackLock lock(_lookupMutex);
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
 	// Use a templated function to avoid an if check on every pixel
@@ -299,6 +384,12 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert((yWidth & 1) == 0);
 	assert((yHeight & 1) == 0);
 
+	if (_kernels) {
+		convertWithKernels(dst, scale, false, 1, ySrc, uSrc, vSrc, nullptr, yWidth, yHeight, yPitch, uvPitch);
+		return;
+	}
+
+	Common::StackLock lock(_lookupMutex);
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
 	// Use a templated function to avoid an if check on every pixel
@@ -363,6 +454,12 @@ void YUVToRGBManager::convert420Alpha(Graphics::Surface *dst, YUVToRGBManager::L
 	assert((yWidth & 1) == 0);
 	assert((yHeight & 1) == 0);
 
+	if (_kernels) {
+		convertWithKernels(dst, scale, true, 1, ySrc, uSrc, vSrc, aSrc, yWidth, yHeight, yPitch, uvPitch);
+		return;
+	}
+
+	Common::StackLock lock(_lookupMutex);
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale, true);
 
 	// Use a templated function to avoid an if check on every pixel
@@ -448,6 +545,7 @@ void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert((yWidth & 3) == 0);
 	assert((yHeight & 3) == 0);
 
+	Common::StackLock lock(_lookupMutex);
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
 	// Use a templated function to avoid an if check on every pixel
@@ -38,12 +38,14 @@
 #define GRAPHICS_YUV_TO_RGB_H
 
 #include "common/scummsys.h"
+#include "common/mutex.h"
 #include "common/singleton.h"
 #include "graphics/surface.h"
 
 namespace Graphics {
 
 class YUVToRGBLookup;
+struct YUVToRGBKernels;
 
 class YUVToRGBManager : public Common::Singleton<YUVToRGBManager> {
 public:
@@ -120,16 +122,29 @@ public:
 	 */
 	void convert410(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Select the SIMD routines used by convert444(), convert420() and
+	 * convert420Alpha(). By default, the fastest routines supported by the
+	 * CPU are used. All routines give the same results.
+	 *
+	 * @param kernels the routines, or nullptr to only use lookup tables
+	 */
+	void setKernels(const YUVToRGBKernels *kernels) { _kernels = kernels; }
+
 private:
 	friend class Common::Singleton<SingletonBaseType>;
 	YUVToRGBManager();
 	~YUVToRGBManager();
 
 	const YUVToRGBLookup *getLookup(Graphics::PixelFormat format, LuminanceScale scale, bool alphaMode = false);
+	void convertWithKernels(Graphics::Surface *dst, LuminanceScale scale, bool alphaMode, int chromaShift, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
 	YUVToRGBLookup *_lookup;
+	/** Held while converting with the lookup table, which may be replaced by another thread. */
+	Common::Mutex _lookupMutex;
 	int16 _colorTab[4 * 256]; // 2048 bytes
 	bool _alphaMode;
+	const YUVToRGBKernels *_kernels;
 };
  /** @} */
 } // End of namespace Graphics
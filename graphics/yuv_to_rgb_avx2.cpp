@@ -0,0 +1,258 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <immintrin.h>
+
+#include "graphics/yuv_to_rgb_intern.h"
+
+namespace Graphics {
+
+namespace {
+
+/** The shift counts of a YUVToRGBParams, ready for the shift instructions. */
+struct Shifts {
+	__m128i rLoss, gLoss, bLoss, aLoss;
+	__m128i rShift, gShift, bShift, aShift;
+
+	explicit Shifts(const YUVToRGBParams &params) {
+		rLoss = _mm_cvtsi32_si128(params.rLoss);
+		gLoss = _mm_cvtsi32_si128(params.gLoss);
+		bLoss = _mm_cvtsi32_si128(params.bLoss);
+		aLoss = _mm_cvtsi32_si128(params.aLoss);
+		rShift = _mm_cvtsi32_si128(params.rShift);
+		gShift = _mm_cvtsi32_si128(params.gShift);
+		bShift = _mm_cvtsi32_si128(params.bShift);
+		aShift = _mm_cvtsi32_si128(params.aShift);
+	}
+};
+
+/** Red, green and blue offsets of sixteen pixels. */
+struct Chroma {
+	__m256i r, g, b;
+};
+
+} // End of anonymous namespace
+
+/** Multiply chroma values by a factor, see scaleYUVToRGBChroma(). */
+static inline __m256i scaleChroma(__m256i abs2, __m256i sign, int multiplier) {
+	const __m256i product = _mm256_mulhi_epu16(abs2, _mm256_set1_epi16((int16)multiplier));
+	return _mm256_sub_epi16(_mm256_xor_si256(product, sign), sign);
+}
+
+/** Compute the offsets of the sixteen pixels starting at x. */
+template<int chromaShift>
+static inline Chroma loadChroma(const byte *uSrc, const byte *vSrc, int x) {
+	__m128i u, v;
+	if (chromaShift == 0) {
+		u = _mm_loadu_si128((const __m128i *)(uSrc + x));
+		v = _mm_loadu_si128((const __m128i *)(vSrc + x));
+	} else {
+		// Duplicate the samples, so that there is one for each pixel
+		u = _mm_loadl_epi64((const __m128i *)(uSrc + (x >> 1)));
+		v = _mm_loadl_epi64((const __m128i *)(vSrc + (x >> 1)));
+		u = _mm_unpacklo_epi8(u, u);
+		v = _mm_unpacklo_epi8(v, v);
+	}
+
+	const __m256i cr = _mm256_sub_epi16(_mm256_cvtepu8_epi16(v), _mm256_set1_epi16(128));
+	const __m256i cb = _mm256_sub_epi16(_mm256_cvtepu8_epi16(u), _mm256_set1_epi16(128));
+	const __m256i crSign = _mm256_srai_epi16(cr, 15);
+	const __m256i cbSign = _mm256_srai_epi16(cb, 15);
+	const __m256i crAbs2 = _mm256_slli_epi16(_mm256_abs_epi16(cr), 1);
+	const __m256i cbAbs2 = _mm256_slli_epi16(_mm256_abs_epi16(cb), 1);
+
+	Chroma chroma;
+	chroma.r = scaleChroma(crAbs2, crSign, kYUVToRGBCrR);
+	chroma.g = _mm256_sub_epi16(_mm256_setzero_si256(), _mm256_add_epi16(scaleChroma(crAbs2, crSign, kYUVToRGBCrG), scaleChroma(cbAbs2, cbSign, kYUVToRGBCbG)));
+	chroma.b = scaleChroma(cbAbs2, cbSign, kYUVToRGBCbB);
+	return chroma;
+}
+
+/**
+ * Add the offsets to the luminance and scale the result to [0, 255]. For
+ * the ITU scale, 16 has already been subtracted from the luminance. The
+ * result is only clipped to [0, 255] if clip is set, pack the result with
+ * saturation otherwise.
+ */
+template<bool itu, bool clip>
+static inline __m256i channel(__m256i y, __m256i chroma) {
+	const __m256i c = _mm256_add_epi16(y, chroma);
+	if (!itu) {
+		if (!clip)
+			return c;
+		return _mm256_min_epi16(_mm256_max_epi16(c, _mm256_setzero_si256()), _mm256_set1_epi16(255));
+	}
+
+	const __m256i clipped = _mm256_min_epi16(_mm256_max_epi16(c, _mm256_setzero_si256()), _mm256_set1_epi16(219));
+	return _mm256_mulhi_epu16(_mm256_slli_epi16(clipped, 2), _mm256_set1_epi16(kYUVToRGBITUScale));
+}
+
+static inline __m256i pack16(__m256i c, __m128i loss, __m128i shift) {
+	return _mm256_sll_epi16(_mm256_srl_epi16(c, loss), shift);
+}
+
+static inline __m256i pack32(__m128i c, __m128i loss, __m128i shift) {
+	return _mm256_sll_epi32(_mm256_srl_epi32(_mm256_cvtepu16_epi32(c), loss), shift);
+}
+
+static inline __m128i low(__m256i v) {
+	return _mm256_castsi256_si128(v);
+}
+
+static inline __m128i high(__m256i v) {
+	return _mm256_extracti128_si256(v, 1);
+}
+
+/** Write sixteen 16 bit pixels. */
+template<bool itu>
+static inline void write16(byte *dst, __m256i y, const byte *aSrc, const Chroma &chroma, const Shifts &shifts, __m256i alpha) {
+	const __m256i r = channel<itu, true>(y, chroma.r);
+	const __m256i g = channel<itu, true>(y, chroma.g);
+	const __m256i b = channel<itu, true>(y, chroma.b);
+
+	__m256i pixels = _mm256_or_si256(pack16(r, shifts.rLoss, shifts.rShift), pack16(g, shifts.gLoss, shifts.gShift));
+	pixels = _mm256_or_si256(pixels, pack16(b, shifts.bLoss, shifts.bShift));
+	if (aSrc) {
+		const __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)aSrc));
+		pixels = _mm256_or_si256(pixels, pack16(a, shifts.aLoss, shifts.aShift));
+	} else {
+		pixels = _mm256_or_si256(pixels, alpha);
+	}
+	_mm256_storeu_si256((__m256i *)dst, pixels);
+}
+
+/** Write sixteen 32 bit pixels of any format. */
+template<bool itu>
+static inline void write32(byte *dst, __m256i y, const byte *aSrc, const Chroma &chroma, const Shifts &shifts, __m256i alpha) {
+	const __m256i r = channel<itu, true>(y, chroma.r);
+	const __m256i g = channel<itu, true>(y, chroma.g);
+	const __m256i b = channel<itu, true>(y, chroma.b);
+
+	__m256i lo = _mm256_or_si256(pack32(low(r), shifts.rLoss, shifts.rShift), pack32(low(g), shifts.gLoss, shifts.gShift));
+	__m256i hi = _mm256_or_si256(pack32(high(r), shifts.rLoss, shifts.rShift), pack32(high(g), shifts.gLoss, shifts.gShift));
+	lo = _mm256_or_si256(lo, pack32(low(b), shifts.bLoss, shifts.bShift));
+	hi = _mm256_or_si256(hi, pack32(high(b), shifts.bLoss, shifts.bShift));
+	if (aSrc) {
+		const __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)aSrc));
+		lo = _mm256_or_si256(lo, pack32(low(a), shifts.aLoss, shifts.aShift));
+		hi = _mm256_or_si256(hi, pack32(high(a), shifts.aLoss, shifts.aShift));
+	} else {
+		lo = _mm256_or_si256(lo, alpha);
+		hi = _mm256_or_si256(hi, alpha);
+	}
+	_mm256_storeu_si256((__m256i *)dst, lo);
+	_mm256_storeu_si256((__m256i *)(dst + 32), hi);
+}
+
+/** Write sixteen 32 bit pixels whose channels are whole bytes. */
+template<bool itu>
+static inline void writeBytes(byte *dst, __m256i y, const byte *aSrc, const Chroma &chroma, const int8 *byteOrder, __m256i alpha) {
+	// Packing works within each half, so the low eight bytes of the first
+	// half hold the first eight pixels, the ones of the second half the
+	// others. The unpacking below only uses these bytes.
+	__m256i channels[4];
+	const __m256i r = channel<itu, false>(y, chroma.r);
+	const __m256i g = channel<itu, false>(y, chroma.g);
+	const __m256i b = channel<itu, false>(y, chroma.b);
+	channels[0] = _mm256_packus_epi16(r, r);
+	channels[1] = _mm256_packus_epi16(g, g);
+	channels[2] = _mm256_packus_epi16(b, b);
+	if (aSrc) {
+		const __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)aSrc));
+		channels[3] = _mm256_packus_epi16(a, a);
+	} else {
+		channels[3] = alpha;
+	}
+
+	const __m256i b01 = _mm256_unpacklo_epi8(channels[byteOrder[0]], channels[byteOrder[1]]);
+	const __m256i b23 = _mm256_unpacklo_epi8(channels[byteOrder[2]], channels[byteOrder[3]]);
+	const __m256i lo = _mm256_unpacklo_epi16(b01, b23);
+	const __m256i hi = _mm256_unpackhi_epi16(b01, b23);
+	_mm256_storeu_si256((__m256i *)dst, _mm256_permute2x128_si256(lo, hi, 0x20));
+	_mm256_storeu_si256((__m256i *)(dst + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+template<typename PixelInt, int chromaShift, bool itu, bool bytes>
+static void convertRows(byte *dst, int dstPitch, const byte *ySrc, const byte *aSrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBParams &params) {
+	const Shifts shifts(params);
+
+	// Without alpha channel, the alpha plane is ignored
+	const byte *alphaPlane = (aSrc && params.aLoss < 8) ? aSrc : nullptr;
+	__m256i alpha;
+	if (bytes)
+		alpha = _mm256_set1_epi8((char)(params.alpha >> params.aShift));
+	else if (sizeof(PixelInt) == 2)
+		alpha = _mm256_set1_epi16((int16)params.alpha);
+	else
+		alpha = _mm256_set1_epi32(params.alpha);
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const Chroma chroma = loadChroma<chromaShift>(uSrc, vSrc, x);
+
+		for (int i = 0; i < (1 << chromaShift); i++) {
+			byte *dstRow = dst + i * dstPitch + x * sizeof(PixelInt);
+			const byte *aRow = alphaPlane ? alphaPlane + i * yPitch + x : nullptr;
+			__m256i y = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(ySrc + i * yPitch + x)));
+			if (itu)
+				y = _mm256_sub_epi16(y, _mm256_set1_epi16(16));
+
+			if (bytes)
+				writeBytes<itu>(dstRow, y, aRow, chroma, params.byteOrder, alpha);
+			else if (sizeof(PixelInt) == 2)
+				write16<itu>(dstRow, y, aRow, chroma, shifts, alpha);
+			else
+				write32<itu>(dstRow, y, aRow, chroma, shifts, alpha);
+		}
+	}
+
+	convertYUVToRGBRowsScalar<PixelInt, chromaShift>(dst, dstPitch, ySrc, aSrc, yPitch, uSrc, vSrc, x, width, params);
+}
+
+template<typename PixelInt, int chromaShift>
+static void convertRowsAVX2(byte *dst, int dstPitch, const byte *ySrc, const byte *aSrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBParams &params) {
+	const bool bytes = (sizeof(PixelInt) == 4 && params.byteOrder[0] >= 0);
+
+	if (params.itu) {
+		if (bytes)
+			convertRows<PixelInt, chromaShift, true, true>(dst, dstPitch, ySrc, aSrc, yPitch, uSrc, vSrc, width, params);
+		else
+			convertRows<PixelInt, chromaShift, true, false>(dst, dstPitch, ySrc, aSrc, yPitch, uSrc, vSrc, width, params);
+	} else {
+		if (bytes)
+			convertRows<PixelInt, chromaShift, false, true>(dst, dstPitch, ySrc, aSrc, yPitch, uSrc, vSrc, width, params);
+		else
+			convertRows<PixelInt, chromaShift, false, false>(dst, dstPitch, ySrc, aSrc, yPitch, uSrc, vSrc, width, params);
+	}
+}
+
+static const YUVToRGBKernels avx2YUVToRGBKernels = {
+	convertRowsAVX2<uint16, 0>,
+	convertRowsAVX2<uint32, 0>,
+	convertRowsAVX2<uint16, 1>,
+	convertRowsAVX2<uint32, 1>
+};
+
+const YUVToRGBKernels *getAVX2YUVToRGBKernels() {
+	return &avx2YUVToRGBKernels;
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,174 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_YUV_TO_RGB_INTERN_H
+#define GRAPHICS_YUV_TO_RGB_INTERN_H
+
+#include "common/scummsys.h"
+
+namespace Graphics {
+
+/**
+ * Destination pixel format and luminance scale of a conversion, as used
+ * by the SIMD conversion routines.
+ */
+struct YUVToRGBParams {
+	uint8 rShift, gShift, bShift, aShift;
+	uint8 rLoss, gLoss, bLoss, aLoss;
+	/** Alpha bits of every pixel, when there is no alpha plane. */
+	uint32 alpha;
+	/** Whether the luminance range is [16, 235] instead of [0, 255]. */
+	bool itu;
+	/**
+	 * For 32 bit formats whose channels are whole bytes, the channel (0 for
+	 * red, 1 for green, 2 for blue, 3 for alpha or none) stored in each byte
+	 * of a pixel in memory. Otherwise, the first entry is -1.
+	 */
+	int8 byteOrder[4];
+};
+
+/**
+ * Convert rows of YUV pixels. For 4:4:4 images this converts one row, for
+ * 4:2:0 images two rows which share the same chroma samples.
+ *
+ * @param dst      First destination pixel.
+ * @param dstPitch Pitch of the destination.
+ * @param ySrc     Luminance of the first row.
+ * @param aSrc     Alpha of the first row, or nullptr to use params.alpha.
+ * @param yPitch   Pitch of the luminance and the alpha.
+ * @param uSrc     U chroma samples of the rows.
+ * @param vSrc     V chroma samples of the rows.
+ * @param width    Number of pixels per row. Even for 4:2:0 images.
+ * @param params   The destination format.
+ */
+typedef void (*YUVToRGBRowsProc)(byte *dst, int dstPitch, const byte *ySrc, const byte *aSrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBParams &params);
+
+struct YUVToRGBKernels {
+	/** 4:4:4 images to 16 bit pixels. */
+	YUVToRGBRowsProc convert444To16;
+	/** 4:4:4 images to 32 bit pixels. */
+	YUVToRGBRowsProc convert444To32;
+	/** 4:2:0 images to 16 bit pixels. */
+	YUVToRGBRowsProc convert420To16;
+	/** 4:2:0 images to 32 bit pixels. */
+	YUVToRGBRowsProc convert420To32;
+};
+
+/**
+ * Return the fastest conversion routines supported by the host CPU, or
+ * nullptr if only the lookup tables are available.
+ */
+const YUVToRGBKernels *getYUVToRGBKernels();
+
+#ifdef SCUMMVM_SSE2
+const YUVToRGBKernels *getSSE2YUVToRGBKernels();
+#endif
+
+#ifdef SCUMMVM_AVX2
+const YUVToRGBKernels *getAVX2YUVToRGBKernels();
+#endif
+
+#ifdef SCUMMVM_NEON
+const YUVToRGBKernels *getNEONYUVToRGBKernels();
+#endif
+
+/**
+ * Fixed point multipliers which reproduce the color tables of
+ * YUVToRGBManager. The tables hold the chroma values multiplied by a
+ * factor and rounded towards zero, which for every chroma value c in
+ * [-128, 127] equals ((|c| << 1) * multiplier) >> 16, with the sign of c.
+ *
+ * The luminance scale maps x from [0, 219] to x * 255 / 219, which equals
+ * ((x << 2) * kYUVToRGBITUScale) >> 16.
+ *
+ * All multipliers are even, so that the SIMD code may use doubling
+ * multiplications of half of them.
+ */
+enum {
+	kYUVToRGBCrR = 45876, // 0.419 / 0.299
+	kYUVToRGBCrG = 23368, // 0.299 / 0.419
+	kYUVToRGBCbG = 11282, // 0.114 / 0.331
+	kYUVToRGBCbB = 58110, // 0.587 / 0.331
+	kYUVToRGBITUScale = 19078
+};
+
+// This is included by the SIMD files, which are compiled for different
+// instruction sets, so avoid any inline code shared between files.
+
+/** Multiply a chroma value by a factor, rounding towards zero. */
+static inline int scaleYUVToRGBChroma(int c, int multiplier) {
+	const int product = (((c < 0 ? -c : c) << 1) * multiplier) >> 16;
+	return c < 0 ? -product : product;
+}
+
+/**
+ * Clip a channel to [16, 235] and scale it to [0, 255], or clip it to
+ * [0, 255] for the full luminance range.
+ */
+static inline int scaleYUVToRGBChannel(int c, bool itu) {
+	if (itu) {
+		c = (c < 16) ? 16 : (c > 235) ? 235 : c;
+		return (c - 16) * 255 / 219;
+	}
+
+	return (c < 0) ? 0 : (c > 255) ? 255 : c;
+}
+
+/**
+ * Convert a single pixel, used by the SIMD routines for the pixels which
+ * do not fill a whole vector. Gives the same result as the lookup tables.
+ *
+ * @param a the alpha value, or -1 to use params.alpha
+ */
+static inline uint32 convertYUVToRGBPixel(int y, int u, int v, int a, const YUVToRGBParams &params) {
+	const int cr = v - 128, cb = u - 128;
+	const int r = scaleYUVToRGBChannel(y + scaleYUVToRGBChroma(cr, kYUVToRGBCrR), params.itu);
+	const int g = scaleYUVToRGBChannel(y - scaleYUVToRGBChroma(cr, kYUVToRGBCrG) - scaleYUVToRGBChroma(cb, kYUVToRGBCbG), params.itu);
+	const int b = scaleYUVToRGBChannel(y + scaleYUVToRGBChroma(cb, kYUVToRGBCbB), params.itu);
+
+	return ((r >> params.rLoss) << params.rShift) |
+	       ((g >> params.gLoss) << params.gShift) |
+	       ((b >> params.bLoss) << params.bShift) |
+	       (a < 0 ? params.alpha : ((a >> params.aLoss) << params.aShift));
+}
+
+/**
+ * Convert the pixels [x, width) of the rows, see YUVToRGBRowsProc.
+ *
+ * @param chromaShift 0 for 4:4:4 images, 1 for 4:2:0 images.
+ */
+template<typename PixelInt, int chromaShift>
+static void convertYUVToRGBRowsScalar(byte *dst, int dstPitch, const byte *ySrc, const byte *aSrc, int yPitch, const byte *uSrc, const byte *vSrc, int x, int width, const YUVToRGBParams &params) {
+	for (int i = 0; i < (1 << chromaShift); i++) {
+		PixelInt *dstRow = (PixelInt *)(dst + i * dstPitch);
+		const byte *yRow = ySrc + i * yPitch;
+		const byte *aRow = aSrc ? aSrc + i * yPitch : nullptr;
+
+		for (int j = x; j < width; j++) {
+			const int c = j >> chromaShift;
+			dstRow[j] = convertYUVToRGBPixel(yRow[j], uSrc[c], vSrc[c], aRow ? aRow[j] : -1, params);
+		}
+	}
+}
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,254 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <arm_neon.h>
+
+#include "graphics/yuv_to_rgb_intern.h"
+
+namespace Graphics {
+
+namespace {
+
+/**
+ * The shift counts of a YUVToRGBParams, ready for the shift instructions.
+ * Negative counts shift to the right.
+ */
+struct Shifts {
+	int16x8_t rLoss, gLoss, bLoss, aLoss;
+	int16x8_t rShift, gShift, bShift, aShift;
+
+	explicit Shifts(const YUVToRGBParams &params) {
+		rLoss = vdupq_n_s16(-params.rLoss);
+		gLoss = vdupq_n_s16(-params.gLoss);
+		bLoss = vdupq_n_s16(-params.bLoss);
+		aLoss = vdupq_n_s16(-params.aLoss);
+		rShift = vdupq_n_s16(params.rShift);
+		gShift = vdupq_n_s16(params.gShift);
+		bShift = vdupq_n_s16(params.bShift);
+		aShift = vdupq_n_s16(params.aShift);
+	}
+};
+
+/** Red, green and blue offsets of eight pixels. */
+struct Chroma {
+	int16x8_t r, g, b;
+};
+
+} // End of anonymous namespace
+
+/**
+ * Multiply chroma values by a factor, see scaleYUVToRGBChroma(). The
+ * doubling multiplication takes half of the multiplier.
+ */
+static inline int16x8_t scaleChroma(int16x8_t abs2, int16x8_t sign, int multiplier) {
+	const int16x8_t product = vqdmulhq_s16(abs2, vdupq_n_s16(multiplier / 2));
+	return vsubq_s16(veorq_s16(product, sign), sign);
+}
+
+/** Compute the offsets of eight chroma samples. */
+static inline Chroma computeChroma(uint8x8_t u, uint8x8_t v) {
+	const int16x8_t cr = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v)), vdupq_n_s16(128));
+	const int16x8_t cb = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u)), vdupq_n_s16(128));
+	const int16x8_t crSign = vshrq_n_s16(cr, 15);
+	const int16x8_t cbSign = vshrq_n_s16(cb, 15);
+	const int16x8_t crAbs2 = vshlq_n_s16(vabsq_s16(cr), 1);
+	const int16x8_t cbAbs2 = vshlq_n_s16(vabsq_s16(cb), 1);
+
+	Chroma chroma;
+	chroma.r = scaleChroma(crAbs2, crSign, kYUVToRGBCrR);
+	chroma.g = vnegq_s16(vaddq_s16(scaleChroma(crAbs2, crSign, kYUVToRGBCrG), scaleChroma(cbAbs2, cbSign, kYUVToRGBCbG)));
+	chroma.b = scaleChroma(cbAbs2, cbSign, kYUVToRGBCbB);
+	return chroma;
+}
+
+/** Compute the offsets of the sixteen pixels starting at x. */
+template<int chromaShift>
+static inline void loadChroma(Chroma chroma[2], const byte *uSrc, const byte *vSrc, int x) {
+	if (chromaShift == 0) {
+		const uint8x16_t u = vld1q_u8(uSrc + x);
+		const uint8x16_t v = vld1q_u8(vSrc + x);
+		chroma[0] = computeChroma(vget_low_u8(u), vget_low_u8(v));
+		chroma[1] = computeChroma(vget_high_u8(u), vget_high_u8(v));
+	} else {
+		// Duplicate the samples, so that there is one for each pixel
+		const uint8x8_t u = vld1_u8(uSrc + (x >> 1));
+		const uint8x8_t v = vld1_u8(vSrc + (x >> 1));
+		const uint8x8x2_t uPairs = vzip_u8(u, u);
+		const uint8x8x2_t vPairs = vzip_u8(v, v);
+		chroma[0] = computeChroma(uPairs.val[0], vPairs.val[0]);
+		chroma[1] = computeChroma(uPairs.val[1], vPairs.val[1]);
+	}
+}
+
+/**
+ * Add the offsets to the luminance and scale the result to [0, 255]. For
+ * the ITU scale, 16 has already been subtracted from the luminance. The
+ * result is only clipped to [0, 255] if clip is set, narrow the result
+ * with saturation otherwise.
+ */
+template<bool itu, bool clip>
+static inline int16x8_t channel(int16x8_t y, int16x8_t chroma) {
+	const int16x8_t c = vaddq_s16(y, chroma);
+	if (!itu) {
+		if (!clip)
+			return c;
+		return vminq_s16(vmaxq_s16(c, vdupq_n_s16(0)), vdupq_n_s16(255));
+	}
+
+	const int16x8_t clipped = vminq_s16(vmaxq_s16(c, vdupq_n_s16(0)), vdupq_n_s16(219));
+	return vqdmulhq_s16(vshlq_n_s16(clipped, 2), vdupq_n_s16(kYUVToRGBITUScale / 2));
+}
+
+static inline uint16x8_t pack16(int16x8_t c, int16x8_t loss, int16x8_t shift) {
+	return vshlq_u16(vshlq_u16(vreinterpretq_u16_s16(c), loss), shift);
+}
+
+static inline uint32x4_t pack32(uint16x4_t c, int16x8_t loss, int16x8_t shift) {
+	return vshlq_u32(vshlq_u32(vmovl_u16(c), vmovl_s16(vget_low_s16(loss))), vmovl_s16(vget_low_s16(shift)));
+}
+
+/** Write eight 16 bit pixels. */
+template<bool itu>
+static inline void write16(byte *dst, int16x8_t y, const byte *aSrc, const Chroma &chroma, const Shifts &shifts, uint32 alpha) {
+	const int16x8_t r = channel<itu, true>(y, chroma.r);
+	const int16x8_t g = channel<itu, true>(y, chroma.g);
+	const int16x8_t b = channel<itu, true>(y, chroma.b);
+
+	uint16x8_t pixels = vorrq_u16(pack16(r, shifts.rLoss, shifts.rShift), pack16(g, shifts.gLoss, shifts.gShift));
+	pixels = vorrq_u16(pixels, pack16(b, shifts.bLoss, shifts.bShift));
+	if (aSrc) {
+		const int16x8_t a = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(aSrc)));
+		pixels = vorrq_u16(pixels, pack16(a, shifts.aLoss, shifts.aShift));
+	} else {
+		pixels = vorrq_u16(pixels, vdupq_n_u16(alpha));
+	}
+	vst1q_u16((uint16_t *)(void *)dst, pixels);
+}
+
+/** Write eight 32 bit pixels of any format. */
+template<bool itu>
+static inline void write32(byte *dst, int16x8_t y, const byte *aSrc, const Chroma &chroma, const Shifts &shifts, uint32 alpha) {
+	const uint16x8_t r = vreinterpretq_u16_s16(channel<itu, true>(y, chroma.r));
+	const uint16x8_t g = vreinterpretq_u16_s16(channel<itu, true>(y, chroma.g));
+	const uint16x8_t b = vreinterpretq_u16_s16(channel<itu, true>(y, chroma.b));
+
+	uint32x4_t lo = vorrq_u32(pack32(vget_low_u16(r), shifts.rLoss, shifts.rShift), pack32(vget_low_u16(g), shifts.gLoss, shifts.gShift));
+	uint32x4_t hi = vorrq_u32(pack32(vget_high_u16(r), shifts.rLoss, shifts.rShift), pack32(vget_high_u16(g), shifts.gLoss, shifts.gShift));
+	lo = vorrq_u32(lo, pack32(vget_low_u16(b), shifts.bLoss, shifts.bShift));
+	hi = vorrq_u32(hi, pack32(vget_high_u16(b), shifts.bLoss, shifts.bShift));
+	if (aSrc) {
+		const uint16x8_t a = vmovl_u8(vld1_u8(aSrc));
+		lo = vorrq_u32(lo, pack32(vget_low_u16(a), shifts.aLoss, shifts.aShift));
+		hi = vorrq_u32(hi, pack32(vget_high_u16(a), shifts.aLoss, shifts.aShift));
+	} else {
+		lo = vorrq_u32(lo, vdupq_n_u32(alpha));
+		hi = vorrq_u32(hi, vdupq_n_u32(alpha));
+	}
+	vst1q_u32((uint32_t *)(void *)dst, lo);
+	vst1q_u32((uint32_t *)(void *)(dst + 16), hi);
+}
+
+/** Write eight 32 bit pixels whose channels are whole bytes. */
+template<bool itu>
+static inline void writeBytes(byte *dst, int16x8_t y, const byte *aSrc, const Chroma &chroma, const int8 *byteOrder, uint8x8_t alpha) {
+	uint8x8_t channels[4];
+	channels[0] = vqmovun_s16(channel<itu, false>(y, chroma.r));
+	channels[1] = vqmovun_s16(channel<itu, false>(y, chroma.g));
+	channels[2] = vqmovun_s16(channel<itu, false>(y, chroma.b));
+	channels[3] = aSrc ? vld1_u8(aSrc) : alpha;
+
+	uint8x8x4_t pixels;
+	pixels.val[0] = channels[byteOrder[0]];
+	pixels.val[1] = channels[byteOrder[1]];
+	pixels.val[2] = channels[byteOrder[2]];
+	pixels.val[3] = channels[byteOrder[3]];
+	vst4_u8(dst, pixels);
+}
+
+template<typename PixelInt, int chromaShift, bool itu, bool bytes>
+static void convertRows(byte *dst, int dstPitch, const byte *ySrc, const byte *aSrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBParams &params) {
+	const Shifts shifts(params);
+
+	// Without alpha channel, the alpha plane is ignored
+	const byte *alphaPlane = (aSrc && params.aLoss < 8) ? aSrc : nullptr;
+	const uint8x8_t alphaBytes = vdup_n_u8((uint8)(params.alpha >> params.aShift));
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		Chroma chroma[2];
+		loadChroma<chromaShift>(chroma, uSrc, vSrc, x);
+
+		for (int i = 0; i < (1 << chromaShift); i++) {
+			byte *dstRow = dst + i * dstPitch + x * sizeof(PixelInt);
+			const byte *aRow = alphaPlane ? alphaPlane + i * yPitch + x : nullptr;
+			const uint8x16_t y = vld1q_u8(ySrc + i * yPitch + x);
+			int16x8_t yLo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(y)));
+			int16x8_t yHi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(y)));
+			if (itu) {
+				yLo = vsubq_s16(yLo, vdupq_n_s16(16));
+				yHi = vsubq_s16(yHi, vdupq_n_s16(16));
+			}
+
+			if (bytes) {
+				writeBytes<itu>(dstRow, yLo, aRow, chroma[0], params.byteOrder, alphaBytes);
+				writeBytes<itu>(dstRow + 32, yHi, aRow ? aRow + 8 : nullptr, chroma[1], params.byteOrder, alphaBytes);
+			} else if (sizeof(PixelInt) == 2) {
+				write16<itu>(dstRow, yLo, aRow, chroma[0], shifts, params.alpha);
+				write16<itu>(dstRow + 16, yHi, aRow ? aRow + 8 : nullptr, chroma[1], shifts, params.alpha);
+			} else {
+				write32<itu>(dstRow, yLo, aRow, chroma[0], shifts, params.alpha);
+				write32<itu>(dstRow + 32, yHi, aRow ? aRow + 8 : nullptr, chroma[1], shifts, params.alpha);
+			}
+		}
+	}
+
+	convertYUVToRGBRowsScalar<PixelInt, chromaShift>(dst, dstPitch, ySrc, aSrc, yPitch, uSrc, vSrc, x, width, params);
+}
+
+template<typename PixelInt, int chromaShift>
+static void convertRowsNEON(byte *dst, int dstPitch, const byte *ySrc, const byte *aSrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBParams &params) {
+	const bool bytes = (sizeof(PixelInt) == 4 && params.byteOrder[0] >= 0);
+
+	if (params.itu) {
+		if (bytes)
+			convertRows<PixelInt, chromaShift, true, true>(dst, dstPitch, ySrc, aSrc, yPitch, uSrc, vSrc, width, params);
+		else
+			convertRows<PixelInt, chromaShift, true, false>(dst, dstPitch, ySrc, aSrc, yPitch, uSrc, vSrc, width, params);
+	} else {
+		if (bytes)
+			convertRows<PixelInt, chromaShift, false, true>(dst, dstPitch, ySrc, aSrc, yPitch, uSrc, vSrc, width, params);
+		else
+			convertRows<PixelInt, chromaShift, false, false>(dst, dstPitch, ySrc, aSrc, yPitch, uSrc, vSrc, width, params);
+	}
+}
+
+static const YUVToRGBKernels neonYUVToRGBKernels = {
+	convertRowsNEON<uint16, 0>,
+	convertRowsNEON<uint32, 0>,
+	convertRowsNEON<uint16, 1>,
+	convertRowsNEON<uint32, 1>
+};
+
+const YUVToRGBKernels *getNEONYUVToRGBKernels() {
+	return &neonYUVToRGBKernels;
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,266 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <emmintrin.h>
+
+#include "graphics/yuv_to_rgb_intern.h"
+
+namespace Graphics {
+
+namespace {
+
+/** The shift counts of a YUVToRGBParams, ready for the shift instructions. */
+struct Shifts {
+	__m128i rLoss, gLoss, bLoss, aLoss;
+	__m128i rShift, gShift, bShift, aShift;
+
+	explicit Shifts(const YUVToRGBParams &params) {
+		rLoss = _mm_cvtsi32_si128(params.rLoss);
+		gLoss = _mm_cvtsi32_si128(params.gLoss);
+		bLoss = _mm_cvtsi32_si128(params.bLoss);
+		aLoss = _mm_cvtsi32_si128(params.aLoss);
+		rShift = _mm_cvtsi32_si128(params.rShift);
+		gShift = _mm_cvtsi32_si128(params.gShift);
+		bShift = _mm_cvtsi32_si128(params.bShift);
+		aShift = _mm_cvtsi32_si128(params.aShift);
+	}
+};
+
+/** Red, green and blue offsets of eight pixels. */
+struct Chroma {
+	__m128i r, g, b;
+};
+
+} // End of anonymous namespace
+
+/** Multiply chroma values by a factor, see scaleYUVToRGBChroma(). */
+static inline __m128i scaleChroma(__m128i abs2, __m128i sign, int multiplier) {
+	const __m128i product = _mm_mulhi_epu16(abs2, _mm_set1_epi16((int16)multiplier));
+	return _mm_sub_epi16(_mm_xor_si128(product, sign), sign);
+}
+
+/** Compute the offsets of eight chroma samples, given as 16 bit values. */
+static inline Chroma computeChroma(__m128i u, __m128i v) {
+	const __m128i cr = _mm_sub_epi16(v, _mm_set1_epi16(128));
+	const __m128i cb = _mm_sub_epi16(u, _mm_set1_epi16(128));
+	const __m128i crSign = _mm_srai_epi16(cr, 15);
+	const __m128i cbSign = _mm_srai_epi16(cb, 15);
+	const __m128i crAbs2 = _mm_slli_epi16(_mm_max_epi16(cr, _mm_sub_epi16(_mm_setzero_si128(), cr)), 1);
+	const __m128i cbAbs2 = _mm_slli_epi16(_mm_max_epi16(cb, _mm_sub_epi16(_mm_setzero_si128(), cb)), 1);
+
+	Chroma chroma;
+	chroma.r = scaleChroma(crAbs2, crSign, kYUVToRGBCrR);
+	chroma.g = _mm_sub_epi16(_mm_setzero_si128(), _mm_add_epi16(scaleChroma(crAbs2, crSign, kYUVToRGBCrG), scaleChroma(cbAbs2, cbSign, kYUVToRGBCbG)));
+	chroma.b = scaleChroma(cbAbs2, cbSign, kYUVToRGBCbB);
+	return chroma;
+}
+
+/** Compute the offsets of the sixteen pixels starting at x. */
+template<int chromaShift>
+static inline void loadChroma(Chroma chroma[2], const byte *uSrc, const byte *vSrc, int x) {
+	const __m128i zero = _mm_setzero_si128();
+
+	if (chromaShift == 0) {
+		const __m128i u = _mm_loadu_si128((const __m128i *)(uSrc + x));
+		const __m128i v = _mm_loadu_si128((const __m128i *)(vSrc + x));
+		chroma[0] = computeChroma(_mm_unpacklo_epi8(u, zero), _mm_unpacklo_epi8(v, zero));
+		chroma[1] = computeChroma(_mm_unpackhi_epi8(u, zero), _mm_unpackhi_epi8(v, zero));
+	} else {
+		const __m128i u = _mm_loadl_epi64((const __m128i *)(uSrc + (x >> 1)));
+		const __m128i v = _mm_loadl_epi64((const __m128i *)(vSrc + (x >> 1)));
+		const Chroma c = computeChroma(_mm_unpacklo_epi8(u, zero), _mm_unpacklo_epi8(v, zero));
+		chroma[0].r = _mm_unpacklo_epi16(c.r, c.r);
+		chroma[0].g = _mm_unpacklo_epi16(c.g, c.g);
+		chroma[0].b = _mm_unpacklo_epi16(c.b, c.b);
+		chroma[1].r = _mm_unpackhi_epi16(c.r, c.r);
+		chroma[1].g = _mm_unpackhi_epi16(c.g, c.g);
+		chroma[1].b = _mm_unpackhi_epi16(c.b, c.b);
+	}
+}
+
+/**
+ * Add the offsets to the luminance and scale the result to [0, 255]. For
+ * the ITU scale, 16 has already been subtracted from the luminance. The
+ * result is only clipped to [0, 255] if clip is set, pack the result with
+ * saturation otherwise.
+ */
+template<bool itu, bool clip>
+static inline __m128i channel(__m128i y, __m128i chroma) {
+	const __m128i c = _mm_add_epi16(y, chroma);
+	if (!itu) {
+		if (!clip)
+			return c;
+		return _mm_min_epi16(_mm_max_epi16(c, _mm_setzero_si128()), _mm_set1_epi16(255));
+	}
+
+	const __m128i clipped = _mm_min_epi16(_mm_max_epi16(c, _mm_setzero_si128()), _mm_set1_epi16(219));
+	return _mm_mulhi_epu16(_mm_slli_epi16(clipped, 2), _mm_set1_epi16(kYUVToRGBITUScale));
+}
+
+static inline __m128i pack16(__m128i c, __m128i loss, __m128i shift) {
+	return _mm_sll_epi16(_mm_srl_epi16(c, loss), shift);
+}
+
+static inline __m128i pack32(__m128i c, __m128i loss, __m128i shift) {
+	return _mm_sll_epi32(_mm_srl_epi32(c, loss), shift);
+}
+
+/** Write eight 16 bit pixels. */
+template<bool itu>
+static inline void write16(byte *dst, __m128i y, const byte *aSrc, const Chroma &chroma, const Shifts &shifts, __m128i alpha) {
+	const __m128i r = channel<itu, true>(y, chroma.r);
+	const __m128i g = channel<itu, true>(y, chroma.g);
+	const __m128i b = channel<itu, true>(y, chroma.b);
+
+	__m128i pixels = _mm_or_si128(pack16(r, shifts.rLoss, shifts.rShift), pack16(g, shifts.gLoss, shifts.gShift));
+	pixels = _mm_or_si128(pixels, pack16(b, shifts.bLoss, shifts.bShift));
+	if (aSrc) {
+		const __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)aSrc), _mm_setzero_si128());
+		pixels = _mm_or_si128(pixels, pack16(a, shifts.aLoss, shifts.aShift));
+	} else {
+		pixels = _mm_or_si128(pixels, alpha);
+	}
+	_mm_storeu_si128((__m128i *)dst, pixels);
+}
+
+/** Write eight 32 bit pixels of any format. */
+template<bool itu>
+static inline void write32(byte *dst, __m128i y, const byte *aSrc, const Chroma &chroma, const Shifts &shifts, __m128i alpha) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i r = channel<itu, true>(y, chroma.r);
+	const __m128i g = channel<itu, true>(y, chroma.g);
+	const __m128i b = channel<itu, true>(y, chroma.b);
+
+	__m128i lo = _mm_or_si128(pack32(_mm_unpacklo_epi16(r, zero), shifts.rLoss, shifts.rShift),
+	                          pack32(_mm_unpacklo_epi16(g, zero), shifts.gLoss, shifts.gShift));
+	__m128i hi = _mm_or_si128(pack32(_mm_unpackhi_epi16(r, zero), shifts.rLoss, shifts.rShift),
+	                          pack32(_mm_unpackhi_epi16(g, zero), shifts.gLoss, shifts.gShift));
+	lo = _mm_or_si128(lo, pack32(_mm_unpacklo_epi16(b, zero), shifts.bLoss, shifts.bShift));
+	hi = _mm_or_si128(hi, pack32(_mm_unpackhi_epi16(b, zero), shifts.bLoss, shifts.bShift));
+	if (aSrc) {
+		const __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)aSrc), zero);
+		lo = _mm_or_si128(lo, pack32(_mm_unpacklo_epi16(a, zero), shifts.aLoss, shifts.aShift));
+		hi = _mm_or_si128(hi, pack32(_mm_unpackhi_epi16(a, zero), shifts.aLoss, shifts.aShift));
+	} else {
+		lo = _mm_or_si128(lo, alpha);
+		hi = _mm_or_si128(hi, alpha);
+	}
+	_mm_storeu_si128((__m128i *)dst, lo);
+	_mm_storeu_si128((__m128i *)(dst + 16), hi);
+}
+
+/** Write sixteen 32 bit pixels whose channels are whole bytes. */
+template<bool itu>
+static inline void writeBytes(byte *dst, __m128i yLo, __m128i yHi, const byte *aSrc, const Chroma chroma[2], const int8 *byteOrder, __m128i alpha) {
+	__m128i channels[4];
+	channels[0] = _mm_packus_epi16(channel<itu, false>(yLo, chroma[0].r), channel<itu, false>(yHi, chroma[1].r));
+	channels[1] = _mm_packus_epi16(channel<itu, false>(yLo, chroma[0].g), channel<itu, false>(yHi, chroma[1].g));
+	channels[2] = _mm_packus_epi16(channel<itu, false>(yLo, chroma[0].b), channel<itu, false>(yHi, chroma[1].b));
+	channels[3] = aSrc ? _mm_loadu_si128((const __m128i *)aSrc) : alpha;
+
+	const __m128i b0 = channels[byteOrder[0]];
+	const __m128i b1 = channels[byteOrder[1]];
+	const __m128i b2 = channels[byteOrder[2]];
+	const __m128i b3 = channels[byteOrder[3]];
+
+	const __m128i lo01 = _mm_unpacklo_epi8(b0, b1), hi01 = _mm_unpackhi_epi8(b0, b1);
+	const __m128i lo23 = _mm_unpacklo_epi8(b2, b3), hi23 = _mm_unpackhi_epi8(b2, b3);
+	_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(lo01, lo23));
+	_mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi16(lo01, lo23));
+	_mm_storeu_si128((__m128i *)(dst + 32), _mm_unpacklo_epi16(hi01, hi23));
+	_mm_storeu_si128((__m128i *)(dst + 48), _mm_unpackhi_epi16(hi01, hi23));
+}
+
+template<typename PixelInt, int chromaShift, bool itu, bool bytes>
+static void convertRows(byte *dst, int dstPitch, const byte *ySrc, const byte *aSrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBParams &params) {
+	const Shifts shifts(params);
+	const __m128i zero = _mm_setzero_si128();
+
+	// Without alpha channel, the alpha plane is ignored
+	const byte *alphaPlane = (aSrc && params.aLoss < 8) ? aSrc : nullptr;
+	__m128i alpha;
+	if (bytes)
+		alpha = _mm_set1_epi8((char)(params.alpha >> params.aShift));
+	else if (sizeof(PixelInt) == 2)
+		alpha = _mm_set1_epi16((int16)params.alpha);
+	else
+		alpha = _mm_set1_epi32(params.alpha);
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		Chroma chroma[2];
+		loadChroma<chromaShift>(chroma, uSrc, vSrc, x);
+
+		for (int i = 0; i < (1 << chromaShift); i++) {
+			byte *dstRow = dst + i * dstPitch + x * sizeof(PixelInt);
+			const byte *aRow = alphaPlane ? alphaPlane + i * yPitch + x : nullptr;
+			const __m128i y = _mm_loadu_si128((const __m128i *)(ySrc + i * yPitch + x));
+			__m128i yLo = _mm_unpacklo_epi8(y, zero);
+			__m128i yHi = _mm_unpackhi_epi8(y, zero);
+			if (itu) {
+				yLo = _mm_sub_epi16(yLo, _mm_set1_epi16(16));
+				yHi = _mm_sub_epi16(yHi, _mm_set1_epi16(16));
+			}
+
+			if (bytes) {
+				writeBytes<itu>(dstRow, yLo, yHi, aRow, chroma, params.byteOrder, alpha);
+			} else if (sizeof(PixelInt) == 2) {
+				write16<itu>(dstRow, yLo, aRow, chroma[0], shifts, alpha);
+				write16<itu>(dstRow + 16, yHi, aRow ? aRow + 8 : nullptr, chroma[1], shifts, alpha);
+			} else {
+				write32<itu>(dstRow, yLo, aRow, chroma[0], shifts, alpha);
+				write32<itu>(dstRow + 32, yHi, aRow ? aRow + 8 : nullptr, chroma[1], shifts, alpha);
+			}
+		}
+	}
+
+	convertYUVToRGBRowsScalar<PixelInt, chromaShift>(dst, dstPitch, ySrc, aSrc, yPitch, uSrc, vSrc, x, width, params);
+}
+
+template<typename PixelInt, int chromaShift>
+static void convertRowsSSE2(byte *dst, int dstPitch, const byte *ySrc, const byte *aSrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBParams &params) {
+	const bool bytes = (sizeof(PixelInt) == 4 && params.byteOrder[0] >= 0);
+
+	if (params.itu) {
+		if (bytes)
+			convertRows<PixelInt, chromaShift, true, true>(dst, dstPitch, ySrc, aSrc, yPitch, uSrc, vSrc, width, params);
+		else
+			convertRows<PixelInt, chromaShift, true, false>(dst, dstPitch, ySrc, aSrc, yPitch, uSrc, vSrc, width, params);
+	} else {
+		if (bytes)
+			convertRows<PixelInt, chromaShift, false, true>(dst, dstPitch, ySrc, aSrc, yPitch, uSrc, vSrc, width, params);
+		else
+			convertRows<PixelInt, chromaShift, false, false>(dst, dstPitch, ySrc, aSrc, yPitch, uSrc, vSrc, width, params);
+	}
+}
+
+static const YUVToRGBKernels sse2YUVToRGBKernels = {
+	convertRowsSSE2<uint16, 0>,
+	convertRowsSSE2<uint32, 0>,
+	convertRowsSSE2<uint16, 1>,
+	convertRowsSSE2<uint32, 1>
+};
+
+const YUVToRGBKernels *getSSE2YUVToRGBKernels() {
+	return &sse2YUVToRGBKernels;
+}
+
+} // End of namespace Graphics
@@ -40,6 +40,7 @@
 #include "image/bmp.h"
 #include "image/png.h"
 
+#include "gui/bitmapcache.h"
 #include "gui/widget.h"
 #include "gui/ThemeEngine.h"
 #include "gui/ThemeEval.h"
@@ -655,30 +656,57 @@ bool ThemeEngine::addBitmap(const Common::String &filename, const Common::String
 	}
 
 	if (!scalablefile.empty()) {
-		Graphics::SVGBitmap *image = nullptr;
+		const int renderWidth = width * _scaleFactor;
+		const int renderHeight = height * _scaleFactor;
+		const Graphics::PixelFormat format = Graphics::SVGBitmap::getRenderFormat();
+
 		Common::ArchiveMemberList members;
 		_themeFiles.listMatchingMembers(members, scalablefile);
 		for (Common::ArchiveMemberList::const_iterator i = members.begin(), end = members.end(); i != end; ++i) {
 			Common::SeekableReadStream *stream = (*i)->createReadStream();
 			if (stream) {
-				image = new Graphics::SVGBitmap(stream);
+				// Rasterizing is slow, so the images are kept between runs
+				const Common::String cacheKey = BitmapCacheMan.makeKey(*stream, Common::String::format("%dx%d", renderWidth, renderHeight), format);
+				surf = BitmapCacheMan.load(cacheKey, format);
+				if (!surf) {
+					Graphics::SVGBitmap *image = new Graphics::SVGBitmap(stream);
+					surf = new Graphics::ManagedSurface(renderWidth, renderHeight, format);
+					image->render(*surf, renderWidth, renderHeight);
+					delete image;
+
+					BitmapCacheMan.store(cacheKey, *surf);
+				}
 				delete stream;
 				break;
 			}
 		}
 
-		if (image) {
-			_bitmaps[filename] = new Graphics::ManagedSurface(width * _scaleFactor, height * _scaleFactor, *image->getPixelFormat());
-			image->render(*_bitmaps[filename], width * _scaleFactor, height * _scaleFactor);
-
-			delete image;
-		} else {
+		if (!surf)
 			return false;
-		}
 
+		_bitmaps[filename] = surf;
 		return true;
 	}
 
+	// Scaled bitmaps are kept between runs, by the file they are scaled from
+	Common::String cacheKey;
+	if (_scaleFactor != 1.0) {
+		Common::ArchiveMemberList members;
+		_themeFiles.listMatchingMembers(members, filename);
+		if (!members.empty()) {
+			Common::SeekableReadStream *stream = members.front()->createReadStream();
+			if (stream)
+				cacheKey = BitmapCacheMan.makeKey(*stream, Common::String::format("x%.3f", _scaleFactor), _overlayFormat);
+			delete stream;
+		}
+
+		surf = BitmapCacheMan.load(cacheKey, _overlayFormat);
+		if (surf) {
+			_bitmaps[filename] = surf;
+			return true;
+		}
+	}
+
 	const Graphics::Surface *srcSurface = nullptr;
 
 	if (filename.hasSuffix(".png")) {
@@ -732,6 +760,7 @@ bool ThemeEngine::addBitmap(const Common::String &filename, const Common::String
 		delete surf;
 
 		surf = new Graphics::ManagedSurface(tmp2);
+		BitmapCacheMan.store(cacheKey, *surf);
 	}
 	// Store the surface into our hashmap (attention, may store NULL entries!)
 	_bitmaps[filename] = surf;
@@ -771,6 +800,9 @@ void ThemeEngine::loadTheme(const Common::String &themeId) {
 		_themeOk = loadThemeXML(themeId);
 	}
 
+	// Index the images rendered for the theme at once
+	BitmapCacheMan.flush();
+
 	if (!_themeOk) {
 		warning("Failed to load theme '%s'", themeId.c_str());
 		return;
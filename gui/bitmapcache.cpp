@@ -0,0 +1,273 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/algorithm.h"
+#include "common/config-manager.h"
+#include "common/endian.h"
+#include "common/fs.h"
+#include "common/md5.h"
+#include "common/ptr.h"
+#include "common/stream.h"
+#include "common/system.h"
+#include "common/tokenizer.h"
+#include "graphics/managed_surface.h"
+
+#include "gui/bitmapcache.h"
+
+namespace Common {
+DECLARE_SINGLETON(GUI::BitmapCache);
+}
+
+namespace GUI {
+
+#define BITMAP_CACHE_DIRECTORY "gui-cache"
+#define BITMAP_CACHE_INDEX "index"
+
+enum {
+	kBitmapCacheTag = MKTAG('G', 'B', 'M', 'C'),
+	kBitmapCacheVersion = 2,
+	// Tag, version, key length, width and height, the key following
+	kBitmapCacheHeaderSize = 16,
+	// Bounds of the cache, which make for a few hundred thumbnails and
+	// theme images
+	kBitmapCacheMaxFiles = 1024,
+	kBitmapCacheMaxSize = 64 * 1024 * 1024
+};
+
+BitmapCache::BitmapCache() : _size(0), _useCounter(0), _indexChanged(false), _entriesChanged(false) {
+	// Next to the configuration file, as the detection MD5 cache
+	Common::String configFile = ConfMan.getCustomConfigFileName();
+	if (configFile.empty())
+		configFile = g_system->getDefaultConfigFileName();
+
+	Common::FSNode directory = Common::FSNode(configFile).getParent().getChild(BITMAP_CACHE_DIRECTORY);
+	if (!directory.exists())
+		directory.createDirectory();
+
+	if (directory.isDirectory()) {
+		_path = directory.getPath();
+		readIndex();
+	} else {
+		debug(2, "BitmapCache: Cannot create '%s'", directory.getPath().c_str());
+	}
+}
+
+BitmapCache::~BitmapCache() {
+	// The images loaded since the last store are the most recent ones now
+	if (_indexChanged || _entriesChanged)
+		writeIndex();
+}
+
+Common::FSNode BitmapCache::getFile(uint slot) const {
+	return Common::FSNode(_path).getChild(Common::String::format("%u.bmc", slot));
+}
+
+void BitmapCache::readIndex() {
+	Common::ScopedPtr<Common::SeekableReadStream> in(Common::FSNode(_path).getChild(BITMAP_CACHE_INDEX).createReadStream());
+	if (!in)
+		return;
+
+	// One line per image, from the least recently used one: slot, size
+	// and key. The files missing from it are reused as free slots.
+	Common::Array<bool> usedSlots(kBitmapCacheMaxFiles, false);
+	while (!in->eos() && !in->err()) {
+		const Common::String line = in->readLine();
+		Common::StringTokenizer tokenizer(line, " ");
+		const Common::String slot = tokenizer.nextToken();
+		const Common::String size = tokenizer.nextToken();
+		const Common::String key = tokenizer.nextToken();
+		if (key.empty())
+			continue;
+
+		Entry entry;
+		entry.slot = atoi(slot.c_str());
+		entry.size = atoi(size.c_str());
+		entry.lastUse = ++_useCounter;
+		if (entry.slot >= kBitmapCacheMaxFiles || usedSlots[entry.slot] || _entries.contains(key))
+			continue;
+
+		usedSlots[entry.slot] = true;
+		_entries[key] = entry;
+		_size += entry.size;
+	}
+
+	// The bounds may have been lowered since the index was written
+	while (!_entries.empty() && (_size > kBitmapCacheMaxSize || _entries.size() > kBitmapCacheMaxFiles))
+		dropOldest();
+}
+
+void BitmapCache::writeIndex() {
+	struct IndexLine {
+		const Common::String *key;
+		const Entry *entry;
+
+		bool operator<(const IndexLine &other) const { return entry->lastUse < other.entry->lastUse; }
+	};
+
+	Common::Array<IndexLine> lines;
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		IndexLine line = { &i->_key, &i->_value };
+		lines.push_back(line);
+	}
+	Common::sort(lines.begin(), lines.end());
+
+	Common::ScopedPtr<Common::SeekableWriteStream> out(Common::FSNode(_path).getChild(BITMAP_CACHE_INDEX).createWriteStream());
+	if (!out)
+		return;
+
+	for (uint i = 0; i < lines.size(); i++) {
+		const Entry &entry = *lines[i].entry;
+		out->writeString(Common::String::format("%u %u %s\n", entry.slot, entry.size, lines[i].key->c_str()));
+	}
+	out->finalize();
+	_indexChanged = false;
+	_entriesChanged = false;
+}
+
+void BitmapCache::dropOldest() {
+	EntryMap::iterator oldest = _entries.end();
+	for (EntryMap::iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		if (oldest == _entries.end() || i->_value.lastUse < oldest->_value.lastUse)
+			oldest = i;
+	}
+	if (oldest == _entries.end())
+		return;
+
+	// Emptied, so that the files hold no more than the size of the cache
+	Common::ScopedPtr<Common::SeekableWriteStream> out(getFile(oldest->_value.slot).createWriteStream());
+	if (out)
+		out->finalize();
+
+	_size -= oldest->_value.size;
+	_entries.erase(oldest);
+	_entriesChanged = true;
+}
+
+Common::String BitmapCache::makeKey(Common::SeekableReadStream &source, const Common::String &variant, const Graphics::PixelFormat &format) const {
+	if (_path.empty())
+		return Common::String();
+
+	const Common::String md5 = Common::computeStreamMD5AsString(source);
+	source.seek(0);
+	if (md5.empty())
+		return Common::String();
+
+	return Common::String::format("%s-%s-%s", md5.c_str(), variant.c_str(), format.toString().c_str());
+}
+
+Graphics::ManagedSurface *BitmapCache::load(const Common::String &key, const Graphics::PixelFormat &format) {
+	if (key.empty())
+		return nullptr;
+
+	EntryMap::iterator entry = _entries.find(key);
+	if (entry == _entries.end())
+		return nullptr;
+
+	Common::ScopedPtr<Common::SeekableReadStream> in(getFile(entry->_value.slot).createReadStream());
+	if (!in)
+		return nullptr;
+
+	const uint32 tag = in->readUint32BE();
+	const uint32 version = in->readUint32BE();
+	const uint32 keySize = in->readUint32LE();
+	const uint16 width = in->readUint16LE();
+	const uint16 height = in->readUint16LE();
+	if (in->err() || in->eos() || tag != kBitmapCacheTag || version != kBitmapCacheVersion || keySize != key.size())
+		return nullptr;
+
+	// Files cut short, e.g. by a crash while they were written, and the
+	// slots reused by another run are ignored
+	const uint32 size = width * height * format.bytesPerPixel;
+	if (in->size() != kBitmapCacheHeaderSize + keySize + size || in->readString(0, keySize) != key)
+		return nullptr;
+
+	Graphics::ManagedSurface *surf = new Graphics::ManagedSurface(width, height, format);
+	if (in->read(surf->getPixels(), size) != size) {
+		delete surf;
+		return nullptr;
+	}
+
+	entry->_value.lastUse = ++_useCounter;
+	_indexChanged = true;
+	return surf;
+}
+
+void BitmapCache::store(const Common::String &key, const Graphics::ManagedSurface &surface) {
+	if (key.empty())
+		return;
+
+	const uint32 size = kBitmapCacheHeaderSize + key.size() + surface.w * surface.h * surface.format.bytesPerPixel;
+	if (size > kBitmapCacheMaxSize)
+		return;
+
+	// Stored again, e.g. after its file was found broken
+	Entry entry;
+	EntryMap::iterator stored = _entries.find(key);
+	if (stored != _entries.end()) {
+		entry = stored->_value;
+		_size -= entry.size;
+		_entries.erase(stored);
+	} else {
+		if (_entries.size() == kBitmapCacheMaxFiles)
+			dropOldest();
+
+		Common::Array<bool> usedSlots(kBitmapCacheMaxFiles, false);
+		for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i)
+			usedSlots[i->_value.slot] = true;
+		entry.slot = Common::find(usedSlots.begin(), usedSlots.end(), false) - usedSlots.begin();
+	}
+
+	while (!_entries.empty() && _size + size > kBitmapCacheMaxSize)
+		dropOldest();
+
+	Common::ScopedPtr<Common::SeekableWriteStream> out(getFile(entry.slot).createWriteStream());
+	if (!out) {
+		_entriesChanged = true;
+		return;
+	}
+
+	out->writeUint32BE(kBitmapCacheTag);
+	out->writeUint32BE(kBitmapCacheVersion);
+	out->writeUint32LE(key.size());
+	out->writeUint16LE(surface.w);
+	out->writeUint16LE(surface.h);
+	out->writeString(key);
+	for (int y = 0; y < surface.h; y++)
+		out->write(surface.getBasePtr(0, y), surface.w * surface.format.bytesPerPixel);
+	out->finalize();
+	if (out->err()) {
+		_entriesChanged = true;
+		return;
+	}
+
+	entry.size = size;
+	entry.lastUse = ++_useCounter;
+	_entries[key] = entry;
+	_size += size;
+	_entriesChanged = true;
+}
+
+void BitmapCache::flush() {
+	if (_entriesChanged)
+		writeIndex();
+}
+
+} // End of namespace GUI
@@ -0,0 +1,129 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GUI_BITMAPCACHE_H
+#define GUI_BITMAPCACHE_H
+
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/singleton.h"
+#include "common/str.h"
+#include "graphics/pixelformat.h"
+
+namespace Common {
+class FSNode;
+class SeekableReadStream;
+}
+
+namespace Graphics {
+class ManagedSurface;
+}
+
+namespace GUI {
+
+/**
+ * Keeps the GUI images which are slow to make, such as rasterized SVGs
+ * and scaled bitmaps, on disk between runs.
+ *
+ * The images are stored by the MD5 of the file they are made from, so a
+ * changed file never gets an outdated image. Each image is a file of its
+ * own, whose pixels are read at once straight into the surface.
+ *
+ * The cache is bounded in files and in total size. As files cannot be
+ * removed, they are slots, and those of the least recently used images are
+ * reused or emptied. The slot of each image, and the order of use, are kept
+ * in an index file.
+ *
+ * The cache is only used on the GUI thread.
+ */
+class BitmapCache : public Common::Singleton<BitmapCache> {
+public:
+	BitmapCache();
+	~BitmapCache();
+
+	/**
+	 * Get the key of an image made from a source file. The stream is read
+	 * whole, then rewound.
+	 *
+	 * @param variant tells the images made from the same file apart,
+	 *                e.g. their size
+	 * @return the key, or an empty string if the cache is not available
+	 */
+	Common::String makeKey(Common::SeekableReadStream &source, const Common::String &variant, const Graphics::PixelFormat &format) const;
+
+	/**
+	 * Get a stored image.
+	 *
+	 * @return the image, or nullptr if it is not stored
+	 */
+	Graphics::ManagedSurface *load(const Common::String &key, const Graphics::PixelFormat &format);
+
+	/**
+	 * Store an image, failing silently. The least recently used images are
+	 * dropped to make room for it.
+	 */
+	void store(const Common::String &key, const Graphics::ManagedSurface &surface);
+
+	/**
+	 * Write the index if images were stored or dropped since it was last
+	 * written. Called once a batch of images is stored, rather than on
+	 * every store. Until then, the files of the new images are taken for
+	 * free slots by other runs.
+	 */
+	void flush();
+
+private:
+	struct Entry {
+		uint slot;
+		uint32 size;
+		uint32 lastUse;
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	Common::FSNode getFile(uint slot) const;
+
+	void readIndex();
+	void writeIndex();
+
+	/** Drop the least recently used image, emptying its file. */
+	void dropOldest();
+
+	/** Path of the cache directory, empty if it could not be created. */
+	Common::String _path;
+	/** The stored images, by key. */
+	EntryMap _entries;
+	/** Total size of the stored images. */
+	uint32 _size;
+	/** Incremented by every load and store, to find the least recent images. */
+	uint32 _useCounter;
+	/** Whether the order of use changed since the index was written. */
+	bool _indexChanged;
+	/** Whether images were stored or dropped since the index was written. */
+	bool _entriesChanged;
+};
+
+} // End of namespace GUI
+
+/** Shortcut for accessing the GUI bitmap cache. */
+#define BitmapCacheMan GUI::BitmapCache::instance()
+
+#endif
@@ -0,0 +1,310 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/memstream.h"
+#include "common/stream.h"
+#include "common/system.h"
+#include "graphics/managed_surface.h"
+
+#include "gui/bitmapcache.h"
+#include "gui/imageloader.h"
+
+namespace GUI {
+
+enum {
+	// Most threads decoding images. The GUI only shows a few dozens of them
+	// at once, so more threads mostly compete with the GUI thread.
+	kMaxDecodeThreads = 2,
+	// Upper bound (in milliseconds) spent decoding in poll() without threads
+	kMaxDecodeTime = 20
+};
+
+ImageLoader::ImageLoader(OpenProc open, void *openParam, uint32 cacheSize)
+	: _open(open), _openParam(openParam), _cacheSize(cacheSize), _cacheUsed(0), _useCounter(0), _passStart(0), _pass(0), _quit(false) {
+
+	const uint numThreads = CLIP<int>((int)g_system->getCPUCount() - 1, 1, kMaxDecodeThreads);
+	for (uint i = 0; i < numThreads; i++) {
+		Common::Thread *thread = new Common::Thread(threadProc, this);
+		if (!thread->isRunning()) {
+			delete thread;
+			break;
+		}
+		_threads.push_back(thread);
+	}
+}
+
+ImageLoader::~ImageLoader() {
+	_mutex.lock();
+	_quit = true;
+	_mutex.unlock();
+
+	for (uint i = 0; i < _threads.size(); i++)
+		_queuedJobs.post();
+	for (uint i = 0; i < _threads.size(); i++)
+		delete _threads[i];
+
+	// The jobs being decoded were moved to _done by the threads
+	for (uint i = 0; i < _queue.size(); i++)
+		deleteJob(_queue[i]);
+	for (uint i = 0; i < _done.size(); i++) {
+		delete _done[i]->surface;
+		deleteJob(_done[i]);
+	}
+
+	for (CacheMap::iterator i = _cache.begin(); i != _cache.end(); ++i)
+		delete i->_value.surface;
+}
+
+void ImageLoader::threadProc(void *param) {
+	((ImageLoader *)param)->run();
+}
+
+void ImageLoader::run() {
+	for (;;) {
+		_queuedJobs.wait();
+
+		Job *job;
+		{
+			Common::StackLock lock(_mutex);
+			if (_quit)
+				return;
+
+			// The job may have been dropped since it was queued
+			job = takeJobLocked();
+			if (!job)
+				continue;
+		}
+
+		decodeJob(job);
+
+		Common::StackLock lock(_mutex);
+		_done.push_back(job);
+	}
+}
+
+void ImageLoader::decodeJob(Job *job) {
+	job->keep = true;
+	job->surface = job->decode(job->data, job->size, job->params, job->keep);
+}
+
+void ImageLoader::addToCache(const Common::String &key, const Graphics::ManagedSurface *surface) {
+	CacheEntry &entry = _cache[key];
+	entry.surface = surface;
+	entry.lastUse = _useCounter;
+	if (surface)
+		_cacheUsed += surface->w * surface->h * surface->format.bytesPerPixel;
+}
+
+ImageLoader::Job *ImageLoader::takeJobLocked() {
+	if (_queue.empty())
+		return nullptr;
+
+	uint best = 0;
+	for (uint i = 1; i < _queue.size(); i++) {
+		if (_queue[i]->priority < _queue[best]->priority)
+			best = i;
+	}
+
+	Job *job = _queue[best];
+	_queue.remove_at(best);
+	return job;
+}
+
+void ImageLoader::beginRequests() {
+	_pass++;
+	_passStart = _useCounter + 1;
+}
+
+void ImageLoader::endRequests() {
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _queue.size();) {
+		Job *job = _queue[i];
+		if (job->pass == _pass) {
+			i++;
+			continue;
+		}
+
+		_jobs.erase(job->key);
+		_queue.remove_at(i);
+		deleteJob(job);
+	}
+}
+
+const Graphics::ManagedSurface *ImageLoader::request(const Common::String &name, DecodeProc decode, const Params &params, int priority, bool *queued) {
+	const Common::String key = Common::String::format("%s@%dx%d/%s", name.c_str(), params.width, params.height, params.format.toString().c_str());
+	_useCounter++;
+	if (queued)
+		*queued = false;
+
+	CacheMap::iterator cached = _cache.find(key);
+	if (cached != _cache.end()) {
+		cached->_value.lastUse = _useCounter;
+		return cached->_value.surface;
+	}
+
+	JobMap::iterator queuedJob = _jobs.find(key);
+	if (queuedJob != _jobs.end()) {
+		Job *job = queuedJob->_value;
+
+		Common::StackLock lock(_mutex);
+		if (job->pass != _pass || priority < job->priority)
+			job->priority = priority;
+		job->pass = _pass;
+		if (queued)
+			*queued = true;
+		return nullptr;
+	}
+
+	Common::SeekableReadStream *stream = _open(name, _openParam);
+	byte *data = nullptr;
+	uint32 size = 0;
+	if (stream) {
+		size = stream->size();
+		data = (byte *)malloc(size);
+		if (data && stream->read(data, size) != size) {
+			free(data);
+			data = nullptr;
+		}
+		delete stream;
+	}
+
+	if (!data) {
+		// Remember the failure, so that the file is not read again
+		addToCache(key, nullptr);
+		return nullptr;
+	}
+
+	Common::String bitmapKey;
+	if (params.bitmapCache) {
+		Common::MemoryReadStream bitmapStream(data, size);
+		bitmapKey = BitmapCacheMan.makeKey(bitmapStream, Common::String::format("%dx%d", params.width, params.height), params.format);
+		const Graphics::ManagedSurface *surface = BitmapCacheMan.load(bitmapKey, params.format);
+		if (surface) {
+			free(data);
+			addToCache(key, surface);
+			return surface;
+		}
+	}
+
+	Job *job = new Job();
+	job->key = key;
+	job->bitmapKey = bitmapKey;
+	job->data = data;
+	job->size = size;
+	job->decode = decode;
+	job->params = params;
+	job->priority = priority;
+	job->pass = _pass;
+	job->surface = nullptr;
+	job->keep = false;
+	_jobs[key] = job;
+
+	_mutex.lock();
+	_queue.push_back(job);
+	_mutex.unlock();
+
+	if (!_threads.empty())
+		_queuedJobs.post();
+	if (queued)
+		*queued = true;
+	return nullptr;
+}
+
+bool ImageLoader::poll() {
+	if (_threads.empty()) {
+		const uint32 start = g_system->getMillis();
+		while (!_queue.empty() && g_system->getMillis() - start < kMaxDecodeTime) {
+			Job *job = takeJobLocked();
+			decodeJob(job);
+			_done.push_back(job);
+		}
+	}
+
+	_mutex.lock();
+	Common::Array<Job *> done = _done;
+	_done.clear();
+	_mutex.unlock();
+
+	bool arrived = false;
+	for (uint i = 0; i < done.size(); i++) {
+		Job *job = done[i];
+		if (job->surface && job->keep && !job->bitmapKey.empty())
+			BitmapCacheMan.store(job->bitmapKey, *job->surface);
+
+		JobMap::iterator queued = _jobs.find(job->key);
+		if (queued != _jobs.end() && queued->_value == job) {
+			// Requested before it was decoded, so it counts as used
+			++_useCounter;
+			addToCache(job->key, job->surface);
+			_jobs.erase(queued);
+			arrived = true;
+		} else {
+			// Dropped by clear() while it was decoded
+			delete job->surface;
+		}
+		deleteJob(job);
+	}
+	BitmapCacheMan.flush();
+
+	// Drop the least recently used images, but none of those requested by
+	// the current pass, as they may be on screen.
+	while (_cacheUsed > _cacheSize) {
+		CacheMap::iterator oldest = _cache.end();
+		for (CacheMap::iterator i = _cache.begin(); i != _cache.end(); ++i) {
+			if (i->_value.surface && i->_value.lastUse < _passStart &&
+			    (oldest == _cache.end() || i->_value.lastUse < oldest->_value.lastUse))
+				oldest = i;
+		}
+		if (oldest == _cache.end())
+			break;
+
+		const Graphics::ManagedSurface *surface = oldest->_value.surface;
+		_cacheUsed -= surface->w * surface->h * surface->format.bytesPerPixel;
+		delete surface;
+		_cache.erase(oldest);
+	}
+
+	return arrived;
+}
+
+void ImageLoader::clear() {
+	_mutex.lock();
+	for (uint i = 0; i < _queue.size(); i++)
+		deleteJob(_queue[i]);
+	_queue.clear();
+	_mutex.unlock();
+
+	// The jobs being decoded are dropped when they are done
+	_jobs.clear();
+
+	for (CacheMap::iterator i = _cache.begin(); i != _cache.end(); ++i)
+		delete i->_value.surface;
+	_cache.clear();
+	_cacheUsed = 0;
+}
+
+void ImageLoader::deleteJob(Job *job) {
+	free(job->data);
+	delete job;
+}
+
+} // End of namespace GUI
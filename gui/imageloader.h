@@ -0,0 +1,185 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GUI_IMAGELOADER_H
+#define GUI_IMAGELOADER_H
+
+#include "common/array.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/mutex.h"
+#include "common/str.h"
+#include "common/thread.h"
+#include "graphics/pixelformat.h"
+
+namespace Common {
+class SeekableReadStream;
+}
+
+namespace Graphics {
+class ManagedSurface;
+}
+
+namespace GUI {
+
+/**
+ * Decodes images on background threads, the most wanted ones first, and
+ * keeps the decoded images in a cache of bounded size, which drops the
+ * least recently used ones.
+ *
+ * The files are read on the GUI thread when they are requested, so the
+ * threads only get their data. Without thread support, poll() decodes the
+ * requested images on the GUI thread, a few at a time.
+ *
+ * The images may be kept in the bitmap cache between runs. It is only used
+ * on the GUI thread: the images are looked up when they are requested, and
+ * stored by poll().
+ */
+class ImageLoader {
+public:
+	/** How to decode an image, copied for the thread doing it. */
+	struct Params {
+		int width;
+		int height;
+		/** Format of the decoded image. */
+		Graphics::PixelFormat format;
+		/** Whether to keep the decoded image in the bitmap cache. */
+		bool bitmapCache;
+
+		Params() : width(0), height(0), bitmapCache(false) {}
+		Params(int w, int h, const Graphics::PixelFormat &f, bool cache = false) : width(w), height(h), format(f), bitmapCache(cache) {}
+	};
+
+	/**
+	 * Decode the data of an image. This runs on any thread, so it may only
+	 * use the data and the parameters: no GUI, config or OSystem calls.
+	 *
+	 * @param keep set to false if the image is not worth keeping in the
+	 *             bitmap cache, being as quick to decode again
+	 * @return the decoded image, or nullptr if it could not be decoded
+	 */
+	typedef const Graphics::ManagedSurface *(*DecodeProc)(const byte *data, uint32 size, const Params &params, bool &keep);
+
+	/** Open a requested file, on the GUI thread. */
+	typedef Common::SeekableReadStream *(*OpenProc)(const Common::String &name, void *param);
+
+	/**
+	 * @param open      opens the requested files
+	 * @param openParam passed to open
+	 * @param cacheSize size in bytes of the decoded images kept
+	 */
+	ImageLoader(OpenProc open, void *openParam, uint32 cacheSize);
+	~ImageLoader();
+
+	/**
+	 * Start a pass of requests. The images which were queued before and
+	 * are not requested again by endRequests() are dropped from the queue,
+	 * and those requested are not dropped from the cache by the next poll().
+	 */
+	void beginRequests();
+	void endRequests();
+
+	/**
+	 * Get an image decoded with the given parameters. If it is not decoded yet, it
+	 * is queued and nullptr is returned until poll() reports it decoded.
+	 * Queued images of lower priority are decoded first.
+	 *
+	 * @param queued set to whether the image is queued, to tell it from those
+	 *               which could not be opened or decoded
+	 * @return the image, or nullptr if it is queued or could not be decoded
+	 */
+	const Graphics::ManagedSurface *request(const Common::String &name, DecodeProc decode, const Params &params, int priority, bool *queued = nullptr);
+
+	/**
+	 * Move the images decoded by the threads to the cache, and drop the
+	 * least recently requested ones when it is full. The images returned
+	 * by request() are valid until then.
+	 *
+	 * @return whether any image was decoded since the last call
+	 */
+	bool poll();
+
+	/** Drop all the queued and decoded images. */
+	void clear();
+
+private:
+	struct Job {
+		/** Only used on the GUI thread. */
+		Common::String key;
+		/** Key in the bitmap cache, empty if not kept there. Only used on the GUI thread. */
+		Common::String bitmapKey;
+		byte *data;
+		uint32 size;
+		DecodeProc decode;
+		Params params;
+		int priority;
+		uint32 pass;
+		const Graphics::ManagedSurface *surface;
+		bool keep;
+	};
+
+	struct CacheEntry {
+		const Graphics::ManagedSurface *surface;
+		uint32 lastUse;
+	};
+
+	typedef Common::HashMap<Common::String, Job *> JobMap;
+	typedef Common::HashMap<Common::String, CacheEntry> CacheMap;
+
+	static void threadProc(void *param);
+	void run();
+
+	static void decodeJob(Job *job);
+	void addToCache(const Common::String &key, const Graphics::ManagedSurface *surface);
+
+	/** Take the queued job of lowest priority, with _mutex locked. */
+	Job *takeJobLocked();
+	void deleteJob(Job *job);
+
+	OpenProc _open;
+	void *_openParam;
+	uint32 _cacheSize;
+	uint32 _cacheUsed;
+	/** Incremented by every request, to find the least recent ones. */
+	uint32 _useCounter;
+	/** _useCounter at the start of the current pass. */
+	uint32 _passStart;
+	uint32 _pass;
+
+	/** Jobs not moved to the cache yet, by key. Only used on the GUI thread. */
+	JobMap _jobs;
+	CacheMap _cache;
+
+	Common::Mutex _mutex;
+	/** Posted for every queued job. */
+	Common::Semaphore _queuedJobs;
+	bool _quit;
+	/** Jobs no thread took yet. */
+	Common::Array<Job *> _queue;
+	/** Jobs decoded by the threads. */
+	Common::Array<Job *> _done;
+
+	Common::Array<Common::Thread *> _threads;
+};
+
+} // End of namespace GUI
+
+#endif
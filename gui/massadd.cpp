@@ -19,12 +19,15 @@
  *
  */
 
+#include "engines/advancedDetector.h"
 #include "engines/metaengine.h"
 #include "common/algorithm.h"
 #include "common/config-manager.h"
 #include "common/debug.h"
+#include "common/mutex.h"
 #include "common/system.h"
 #include "common/taskbar.h"
+#include "common/thread.h"
 #include "common/translation.h"
 
 #include "gui/massadd.h"
@@ -52,10 +55,249 @@ enum {
 	kCancelCmd = 'CNCL'
 };
 
+enum {
+	// Default number of threads listing directories ahead of the scan
+	kDefaultPrefetchThreads = 4,
+	kMaxPrefetchThreads = 16,
+	// Number of directories the threads may list ahead of the scan
+	kMaxPrefetchedDirs = 64,
+	// Number of files per directory whose MD5 is computed ahead of the scan
+	kMaxPrefetchedFiles = 256
+};
+
+/**
+ * Lists directories and computes the MD5s of the files in them which the
+ * detectors look for on worker threads, ahead of the scan. On network shares, the scan is bound by the
+ * latency of these requests.
+ *
+ * The detectors are not thread safe, so the scan itself still runs on the
+ * GUI thread, one directory after the other in the same order as without
+ * the prefetcher. The results are hence the same.
+ *
+ * The threads only share paths and lists of files with the GUI thread. As
+ * Strings and FSNodes are reference counted without locking, they are
+ * copied or handed over, but never shared.
+ */
+class MassAddPrefetcher {
+public:
+	enum Result {
+		kResultPending,
+		kResultListed,
+		kResultFailed
+	};
+
+	MassAddPrefetcher(uint numThreads);
+	~MassAddPrefetcher();
+
+	bool isActive() const { return !_threads.empty(); }
+
+	/** Queue a directory whose subdirectories are not queued automatically. */
+	void queue(const Common::String &path);
+
+	/**
+	 * Get the children of a directory. If it is being listed by a thread,
+	 * kResultPending is returned. If no thread took it yet, it is listed
+	 * right away.
+	 */
+	Result fetch(const Common::FSNode &dir, Common::FSList &files);
+
+private:
+	struct Entry {
+		bool listing;
+		bool succeeded;
+		Common::FSList *files;
+
+		Entry() : listing(false), succeeded(false), files(nullptr) {}
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	static void threadProc(void *param);
+	void run();
+
+	void queueLocked(const Common::String &path);
+	void queueSubdirectories(const Common::FSList &files);
+
+	Common::Mutex _mutex;
+	/** Posted for every directory queued. */
+	Common::Semaphore _jobs;
+	/** Counts how many more directories the threads may take. */
+	Common::Semaphore _room;
+	bool _quit;
+
+	/** Paths of the queued directories. The last one is listed first. */
+	Common::StringArray _pending;
+	/** Queued, listing and listed directories, by path. */
+	EntryMap _entries;
+
+	/** Files the detectors hash, set up before the threads start. */
+	MetaEngineDetection::MD5FileMap _md5Files;
+
+	Common::Array<Common::Thread *> _threads;
+};
+
+MassAddPrefetcher::MassAddPrefetcher(uint numThreads) : _room(kMaxPrefetchedDirs), _quit(false) {
+	// Create the MD5 cache before the threads use it
+	MD5Man.clearPrefetched();
+
+	const PluginList &plugins = EngineMan.getPlugins();
+	for (PluginList::const_iterator i = plugins.begin(); i != plugins.end(); ++i)
+		(*i)->get<MetaEngineDetection>().getMD5FileNames(_md5Files);
+
+	for (uint i = 0; i < numThreads; i++) {
+		Common::Thread *thread = new Common::Thread(threadProc, this);
+		if (!thread->isRunning()) {
+			delete thread;
+			break;
+		}
+		_threads.push_back(thread);
+	}
+}
+
+MassAddPrefetcher::~MassAddPrefetcher() {
+	_mutex.lock();
+	_quit = true;
+	_mutex.unlock();
+
+	for (uint i = 0; i < _threads.size(); i++) {
+		_jobs.post();
+		_room.post();
+	}
+	for (uint i = 0; i < _threads.size(); i++)
+		delete _threads[i];
+
+	for (EntryMap::iterator i = _entries.begin(); i != _entries.end(); ++i)
+		delete i->_value.files;
+
+	MD5Man.clearPrefetched();
+}
+
+void MassAddPrefetcher::threadProc(void *param) {
+	((MassAddPrefetcher *)param)->run();
+}
+
+void MassAddPrefetcher::run() {
+	for (;;) {
+		_room.wait();
+		_jobs.wait();
+
+		Common::String path;
+		{
+			Common::StackLock lock(_mutex);
+			if (_quit)
+				return;
+
+			if (_pending.empty()) {
+				// The GUI thread took over the directory
+				_room.post();
+				continue;
+			}
+
+			path = Common::String(_pending.back().c_str());
+			_pending.pop_back();
+			_entries[path].listing = true;
+		}
+
+		Common::FSList *files = new Common::FSList();
+		const bool listed = Common::FSNode(path).getChildren(*files, Common::FSNode::kListAll);
+
+		uint prefetchedFiles = 0;
+		for (Common::FSList::const_iterator file = files->begin(); file != files->end() && prefetchedFiles < kMaxPrefetchedFiles; ++file) {
+			if (file->isDirectory())
+				continue;
+
+			MetaEngineDetection::MD5FileMap::const_iterator md5File = _md5Files.find(file->getName());
+			if (md5File != _md5Files.end()) {
+				MD5Man.prefetch(*file, md5File->_value);
+				prefetchedFiles++;
+			}
+		}
+
+		Common::StackLock lock(_mutex);
+		queueSubdirectories(*files);
+
+		Entry &entry = _entries[path];
+		entry.listing = false;
+		entry.succeeded = listed;
+		if (listed) {
+			entry.files = files;
+		} else {
+			delete files;
+			entry.files = new Common::FSList();
+		}
+	}
+}
+
+void MassAddPrefetcher::queue(const Common::String &path) {
+	Common::StackLock lock(_mutex);
+	queueLocked(path);
+}
+
+void MassAddPrefetcher::queueLocked(const Common::String &path) {
+	if (_entries.contains(path))
+		return;
+
+	_entries[Common::String(path.c_str())] = Entry();
+	_pending.push_back(Common::String(path.c_str()));
+	_jobs.post();
+}
+
+void MassAddPrefetcher::queueSubdirectories(const Common::FSList &files) {
+	for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
+		if (file->isDirectory())
+			queueLocked(file->getPath());
+	}
+}
+
+MassAddPrefetcher::Result MassAddPrefetcher::fetch(const Common::FSNode &dir, Common::FSList &files) {
+	const Common::String path = dir.getPath();
+
+	_mutex.lock();
+	EntryMap::iterator i = _entries.find(path);
+	if (i != _entries.end() && i->_value.listing) {
+		_mutex.unlock();
+		return kResultPending;
+	}
+
+	if (i != _entries.end() && i->_value.files) {
+		// Listed by a thread, take over its results
+		Common::FSList *listedFiles = i->_value.files;
+		const bool listed = i->_value.succeeded;
+		_entries.erase(i);
+		_mutex.unlock();
+
+		files = *listedFiles;
+		delete listedFiles;
+		_room.post();
+		return listed ? kResultListed : kResultFailed;
+	}
+
+	// No thread took the directory yet. Waiting for one could take long
+	// if they are busy listing directories further ahead, so do it here.
+	for (uint j = 0; j < _pending.size(); j++) {
+		if (_pending[j] == path) {
+			_pending.remove_at(j);
+			break;
+		}
+	}
+	_mutex.unlock();
+
+	if (!dir.getChildren(files, Common::FSNode::kListAll))
+		return kResultFailed;
+
+	// Keep the entry until the subdirectories are queued, so that the
+	// directory is not queued again
+	Common::StackLock lock(_mutex);
+	queueSubdirectories(files);
+	_entries.erase(path);
+	return kResultListed;
+}
+
 
 
 MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	: Dialog("MassAdd"),
+	_prefetcher(nullptr),
 	_dirsScanned(0),
 	_oldGamesCount(0),
 	_dirTotal(0),
@@ -68,6 +310,17 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	// The dir we start our scan at
 	_scanStack.push(startDir);
 
+	int numThreads = kDefaultPrefetchThreads;
+	if (ConfMan.hasKey("massadd_threads"))
+		numThreads = CLIP<int>(ConfMan.getInt("massadd_threads"), 0, kMaxPrefetchThreads);
+	if (numThreads > 0) {
+		_prefetcher = new MassAddPrefetcher(numThreads);
+		if (_prefetcher->isActive())
+			_prefetcher->queue(startDir.getPath());
+		else
+			stopPrefetcher();
+	}
+
 	// Removed for now... Why would you put a title on mass add dialog called "Mass Add Dialog"?
 	// new StaticTextWidget(this, "massadddialog_caption", "Mass Add Dialog");
 
@@ -106,6 +359,15 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	}
 }
 
+MassAddDialog::~MassAddDialog() {
+	stopPrefetcher();
+}
+
+void MassAddDialog::stopPrefetcher() {
+	delete _prefetcher;
+	_prefetcher = nullptr;
+}
+
 struct GameTargetLess {
 	bool operator()(const DetectedGame &x, const DetectedGame &y) const {
 		return x.preferredTarget.compareToIgnoreCase(y.preferredTarget) < 0;
@@ -127,6 +389,9 @@ void MassAddDialog::handleCommand(CommandSender *sender, uint32 cmd, uint32 data
 #endif
 
 	// FIXME: It's a really bad thing that we use two arbitrary constants
+	if (cmd == kOkCmd || cmd == kCancelCmd)
+		stopPrefetcher();
+
 	if (cmd == kOkCmd) {
 		// Sort the detected games. This is not strictly necessary, but nice for
 		// people who want to edit their config file by hand after a mass add.
@@ -166,10 +431,22 @@ void MassAddDialog::handleTickle() {
 
 	// Perform a breadth-first scan of the filesystem.
 	while (!_scanStack.empty() && (g_system->getMillis() - t) < kMaxScanTime) {
-		Common::FSNode dir = _scanStack.pop();
+		Common::FSNode dir = _scanStack.top();
 
 		Common::FSList files;
-		if (!dir.getChildren(files, Common::FSNode::kListAll)) {
+		bool listed;
+		if (_prefetcher) {
+			const MassAddPrefetcher::Result result = _prefetcher->fetch(dir, files);
+			// Keep the GUI responsive while a thread lists the directory
+			if (result == MassAddPrefetcher::kResultPending)
+				break;
+			listed = (result == MassAddPrefetcher::kResultListed);
+		} else {
+			listed = dir.getChildren(files, Common::FSNode::kListAll);
+		}
+
+		_scanStack.pop();
+		if (!listed) {
 			continue;
 		}
 
@@ -250,6 +527,8 @@ void MassAddDialog::handleTickle() {
 	Common::U32String buf;
 
 	if (_scanStack.empty()) {
+		stopPrefetcher();
+
 		// Enable the OK button
 		_okButton->setEnabled(true);
 
@@ -32,10 +32,12 @@
 namespace GUI {
 
 class StaticTextWidget;
+class MassAddPrefetcher;
 
 class MassAddDialog : public Dialog {
 public:
 	MassAddDialog(const Common::FSNode &startDir);
+	~MassAddDialog() override;
 
 	//void open();
 	void handleCommand(CommandSender *sender, uint32 cmd, uint32 data) override;
@@ -48,7 +50,10 @@ public:
 	}
 
 private:
+	void stopPrefetcher();
+
 	Common::Stack<Common::FSNode>  _scanStack;
+	MassAddPrefetcher *_prefetcher;
 	DetectedGames _games;
 
 	/**
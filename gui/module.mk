@@ -2,6 +2,7 @@ MODULE := gui
 
 MODULE_OBJS := \
 	about.o \
+	bitmapcache.o \
 	browser.o \
 	chooser.o \
 	console.o \
@@ -12,6 +13,7 @@ MODULE_OBJS := \
 	EventRecorder.o \
 	filebrowser-dialog.o \
 	gui-manager.o \
+	imageloader.o \
 	launcher.o \
 	massadd.o \
 	message.o \
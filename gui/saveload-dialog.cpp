@@ -32,10 +32,14 @@
 
 #include "gui/message.h"
 #include "gui/gui-manager.h"
+#include "gui/imageloader.h"
 #include "gui/ThemeEval.h"
 #include "gui/widgets/edittext.h"
 
+#include "graphics/managed_surface.h"
 #include "graphics/scaler.h"
+#include "graphics/thumbnail.h"
+#include "common/memstream.h"
 #include "common/savefile.h"
 #include "engines/engine.h"
 
@@ -778,11 +782,42 @@ enum {
 	kNewSaveCmd = 'SAVE'
 };
 
+enum {
+	// Size in bytes of the decoded thumbnails kept across page flips
+	kThumbnailCacheSize = 16 * 1024 * 1024,
+	// Priority of the thumbnails of the next and previous pages
+	kPrefetchPriority = 1000,
+	// Upper bound (in milliseconds) spent querying saves in a tickle
+	kMaxQueryTime = 20
+};
+
+static const Graphics::ManagedSurface *decodeThumbnail(const byte *data, uint32 size, const ImageLoader::Params &params, bool &keep) {
+	Common::MemoryReadStream stream(data, size);
+	Graphics::Surface *thumbnail = nullptr;
+	if (!Graphics::loadThumbnail(stream, thumbnail) || !thumbnail)
+		return nullptr;
+
+	// Scaled as PicButtonWidget::setGfx() would, from the size of the
+	// thumbnails made by the engines
+	const float scale = (float)params.width / kThumbnailWidth;
+	if (scale != 1.0f) {
+		Graphics::Surface *scaled = thumbnail->scale(thumbnail->w * scale, thumbnail->h * scale, false);
+		thumbnail->free();
+		delete thumbnail;
+		thumbnail = scaled;
+	}
+
+	thumbnail->convertToInPlace(params.format);
+	return new Graphics::ManagedSurface(thumbnail, DisposeAfterUse::YES);
+}
+
 SaveLoadChooserGrid::SaveLoadChooserGrid(const Common::U32String &title, bool saveMode)
 	: SaveLoadChooserDialog("SaveLoadChooser", saveMode), _lines(0), _columns(0), _entriesPerPage(0),
 	_curPage(0), _newSaveContainer(nullptr), _nextFreeSaveSlot(0), _buttons() {
 	_backgroundType = ThemeEngine::kDialogBackgroundSpecial;
 
+	_thumbnailLoader = new ImageLoader(openThumbnail, this, kThumbnailCacheSize);
+
 	_pageTitle = new StaticTextWidget(this, "SaveLoadChooser.Title", title);
 
 	// The list widget needs to be bound so it takes space in the layout
@@ -808,6 +843,8 @@ SaveLoadChooserGrid::~SaveLoadChooserGrid() {
 
 	removeWidget(_pageDisplay);
 	delete _pageDisplay;
+
+	delete _thumbnailLoader;
 }
 
 const Common::U32String &SaveLoadChooserGrid::getResultString() const {
@@ -868,6 +905,27 @@ void SaveLoadChooserGrid::updateSaveList() {
 	g_gui.scheduleTopDialogRedraw();
 }
 
+void SaveLoadChooserGrid::listSaves() {
+	SaveLoadChooserDialog::listSaves();
+
+	// The saves may have changed since they were last listed
+	_thumbnailLoader->clear();
+	_queriedSaves.clear();
+	_queriedSaves.resize(_saveList.size());
+}
+
+void SaveLoadChooserGrid::handleTickle() {
+	// The pages are shown at once, with placeholders for the thumbnails
+	// until they are decoded or their saves are queried
+	const bool decoded = _thumbnailLoader->poll();
+	if (querySaves() || decoded) {
+		updateSaves();
+		g_gui.scheduleTopDialogRedraw();
+	}
+
+	SaveLoadChooserDialog::handleTickle();
+}
+
 void SaveLoadChooserGrid::open() {
 	SaveLoadChooserDialog::open();
 
@@ -1049,6 +1107,7 @@ void SaveLoadChooserGrid::close() {
 
 	SaveLoadChooserDialog::close();
 	hideButtons();
+	_thumbnailLoader->clear();
 }
 
 int SaveLoadChooserGrid::runIntern() {
@@ -1108,20 +1167,66 @@ void SaveLoadChooserGrid::hideButtons() {
 	}
 }
 
+Common::SeekableReadStream *SaveLoadChooserGrid::openThumbnail(const Common::String &name, void *param) {
+	const SaveLoadChooserGrid *dialog = (const SaveLoadChooserGrid *)param;
+	return dialog->_metaEngine->openIndexedThumbnail(dialog->_target.c_str(), atoi(name.c_str()));
+}
+
+const Graphics::ManagedSurface *SaveLoadChooserGrid::requestThumbnail(uint index, int priority, bool *queued) {
+	if (_saveList[index].getLocked() || _queriedSaves[index]) {
+		if (queued)
+			*queued = false;
+		return nullptr;
+	}
+
+	const float scaleFactor = g_gui.getScaleFactor();
+	const ImageLoader::Params params(kThumbnailWidth * scaleFactor, kThumbnailHeight2 * scaleFactor, g_system->getOverlayFormat());
+	return _thumbnailLoader->request(Common::String::format("%d", _saveList[index].getSaveSlot()), decodeThumbnail, params, priority, queued);
+}
+
+bool SaveLoadChooserGrid::querySaves() {
+	const uint32 start = g_system->getMillis();
+	bool queried = false;
+
+	for (uint i = _curPage * _entriesPerPage, curNum = 0; i < _saveList.size() && curNum < _entriesPerPage; ++i, ++curNum) {
+		if (_saveList[i].getLocked() || _queriedSaves[i])
+			continue;
+
+		// The saves with an indexed thumbnail are shown as listed
+		bool queued;
+		if (requestThumbnail(i, curNum, &queued) || queued)
+			continue;
+
+		if (queried && g_system->getMillis() - start >= kMaxQueryTime)
+			break;
+
+		SaveStateDescriptor desc = _metaEngine->querySaveMetaInfos(_target.c_str(), _saveList[i].getSaveSlot());
+		if (desc.getSaveSlot() >= 0 && !desc.getDescription().empty())
+			_saveList[i] = desc;
+		_queriedSaves[i] = true;
+		queried = true;
+	}
+
+	return queried;
+}
+
 void SaveLoadChooserGrid::updateSaves() {
 	hideButtons();
+	_thumbnailLoader->beginRequests();
 
-	for (uint i = _curPage * _entriesPerPage, curNum = 0; i < _saveList.size() && curNum < _entriesPerPage; ++i, ++curNum) {
+	const uint pageStart = _curPage * _entriesPerPage;
+	for (uint i = pageStart, curNum = 0; i < _saveList.size() && curNum < _entriesPerPage; ++i, ++curNum) {
 		const uint saveSlot = _saveList[i].getSaveSlot();
 
-		SaveStateDescriptor desc =  (_saveList[i].getLocked() ? _saveList[i] : _metaEngine->querySaveMetaInfos(_target.c_str(), saveSlot));
-		if (!_saveList[i].getLocked() && desc.getSaveSlot() >= 0 && !desc.getDescription().empty())
-			_saveList[i] = desc;
+		const SaveStateDescriptor &desc = _saveList[i];
 		SlotButton &curButton = _buttons[curNum];
 		curButton.setVisible(true);
+		const Graphics::ManagedSurface *indexedThumbnail = requestThumbnail(i, curNum);
 		const Graphics::Surface *thumbnail = desc.getThumbnail();
-		if (thumbnail) {
-			curButton.button->setGfx(desc.getThumbnail());
+		if (indexedThumbnail) {
+			curButton.button->setGfx(indexedThumbnail, kPicButtonStateEnabled, false);
+		} else if (thumbnail) {
+			curButton.button->setGfx(thumbnail);
 		} else {
 			curButton.button->setGfx(kThumbnailWidth, kThumbnailHeight2, 0, 0, 0);
 		}
@@ -1165,6 +1270,18 @@ void SaveLoadChooserGrid::updateSaves() {
 		curButton.description->setEnabled(!desc.getLocked());
 	}
 
+	// The thumbnails of the next and previous pages are decoded next, so
+	// that they are ready when the page is flipped
+	for (uint curNum = 0; curNum < _entriesPerPage; ++curNum) {
+		const uint next = pageStart + _entriesPerPage + curNum;
+		if (next < _saveList.size())
+			requestThumbnail(next, kPrefetchPriority + curNum);
+		if (_curPage > 0)
+			requestThumbnail(pageStart - _entriesPerPage + curNum, kPrefetchPriority + curNum);
+	}
+
+	_thumbnailLoader->endRequests();
+
 	const uint numPages = (_entriesPerPage != 0 && !_saveList.empty()) ? ((_saveList.size() + _entriesPerPage - 1) / _entriesPerPage) : 1;
 	_pageDisplay->setLabel(Common::String::format("%u/%u", _curPage + 1, numPages));
 
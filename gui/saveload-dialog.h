@@ -170,6 +170,7 @@ private:
 #ifndef DISABLE_SAVELOADCHOOSER_GRID
 
 class EditTextWidget;
+class ImageLoader;
 
 class SavenameDialog : public Dialog {
 public:
@@ -203,10 +204,13 @@ public:
 	SaveLoadChooserType getType() const override { return kSaveLoadDialogGrid; }
 
 	void close() override;
+
+	void handleTickle() override;
 protected:
 	void handleCommand(CommandSender *sender, uint32 cmd, uint32 data) override;
 	void handleMouseWheel(int x, int y, int direction) override;
 	void updateSaveList() override;
+	void listSaves() override;
 private:
 	int runIntern() override;
 
@@ -243,6 +247,25 @@ private:
 	void destroyButtons();
 	void hideButtons();
 	void updateSaves();
+
+	/**
+	 * Decodes the thumbnails kept by the save index, which the pages show
+	 * without querying the engine.
+	 */
+	ImageLoader *_thumbnailLoader;
+	static Common::SeekableReadStream *openThumbnail(const Common::String &name, void *param);
+	const Graphics::ManagedSurface *requestThumbnail(uint index, int priority, bool *queued = nullptr);
+
+	/** Whether each entry of _saveList was replaced by its queried meta information. */
+	Common::Array<bool> _queriedSaves;
+
+	/**
+	 * Query the meta information of the saves shown which have no indexed
+	 * thumbnail, for a limited time.
+	 *
+	 * @return whether any save was queried
+	 */
+	bool querySaves();
 };
 
 #endif // !DISABLE_SAVELOADCHOOSER_GRID
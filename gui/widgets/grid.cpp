@@ -22,6 +22,7 @@
 #include "common/system.h"
 #include "common/file.h"
 #include "common/language.h"
+#include "common/memstream.h"
 #include "common/platform.h"
 #include "common/tokenizer.h"
 #include "common/translation.h"
@@ -33,6 +34,14 @@
 
 namespace GUI {
 
+enum {
+	// Size in bytes of the decoded thumbnails and icons kept
+	kImageCacheSize = 16 * 1024 * 1024,
+	// Priority of the thumbnails of the previous and next pages, after the
+	// visible ones
+	kPrefetchPriority = 1000
+};
+
 GridItemWidget::GridItemWidget(GridWidget *boss)
 	: ContainerWidget(boss, 0, 0, 0, 0), CommandSender(boss) {
 
@@ -284,28 +293,41 @@ void GridItemTray::handleMouseMoved(int x, int y, int button) {
 
 #pragma mark -
 
+static Graphics::ManagedSurface *decodePNG(Common::SeekableReadStream &stream, const Graphics::PixelFormat &format) {
+#ifdef USE_PNG
+	Image::PNGDecoder decoder;
+	if (!decoder.loadStream(stream))
+		return nullptr;
+
+	const Graphics::Surface *srcSurface = decoder.getSurface();
+	if (!srcSurface || srcSurface->format.bytesPerPixel == 1)
+		return nullptr;
+	return new Graphics::ManagedSurface(srcSurface->convertTo(format));
+#else
+	return nullptr;
+#endif
+}
+
+static Graphics::ManagedSurface *decodeSVG(Common::SeekableReadStream &stream, int renderWidth, int renderHeight) {
+	Graphics::SVGBitmap *image = new Graphics::SVGBitmap(&stream);
+	Graphics::ManagedSurface *surf = new Graphics::ManagedSurface(renderWidth, renderHeight, *image->getPixelFormat());
+	image->render(*surf, renderWidth, renderHeight);
+	delete image;
+	return surf;
+}
+
 // Load an image file by String name, provide additional render dimensions for SVG images.
 // TODO: Add BMP support, and add scaling of non-vector images.
 Graphics::ManagedSurface *loadSurfaceFromFile(const Common::String &name, int renderWidth = 0, int renderHeight = 0) {
 	Graphics::ManagedSurface *surf = nullptr;
 	if (name.hasSuffix(".png")) {
 #ifdef USE_PNG
-		const Graphics::Surface *srcSurface = nullptr;
-		Image::PNGDecoder decoder;
 		if (g_gui.getIconsSet().hasFile(name)) {
 			Common::SeekableReadStream *stream = g_gui.getIconsSet().createReadStreamForMember(name);
-			if (!decoder.loadStream(*stream)) {
-				warning("Error decoding PNG");
-				return surf;
-			}
-
-			srcSurface = decoder.getSurface();
+			surf = decodePNG(*stream, g_system->getOverlayFormat());
 			delete stream;
-			if (!srcSurface) {
+			if (!surf)
 				warning("Failed to load surface : %s", name.c_str());
-			} else if (srcSurface->format.bytesPerPixel != 1) {
-				surf = new Graphics::ManagedSurface(srcSurface->convertTo(g_system->getOverlayFormat()));
-			}
 		} else {
 			debug(5, "GridWidget: Cannot read file '%s'", name.c_str());
 		}
@@ -315,11 +337,8 @@ Graphics::ManagedSurface *loadSurfaceFromFile(const Common::String &name, int re
 	} else if (name.hasSuffix(".svg")) {
 		if (g_gui.getIconsSet().hasFile(name)) {
 			Common::SeekableReadStream *stream = g_gui.getIconsSet().createReadStreamForMember(name);
-			Graphics::SVGBitmap *image = nullptr;
-			image = new Graphics::SVGBitmap(stream);
-			surf = new Graphics::ManagedSurface(renderWidth, renderHeight, *image->getPixelFormat());
-			image->render(*surf, renderWidth, renderHeight);
-			delete image;
+			surf = decodeSVG(*stream, renderWidth, renderHeight);
+			delete stream;
 		} else {
 			debug(5, "GridWidget: Cannot read file '%s'", name.c_str());
 		}
@@ -327,6 +346,37 @@ Graphics::ManagedSurface *loadSurfaceFromFile(const Common::String &name, int re
 	return surf;
 }
 
+static Common::SeekableReadStream *openIcon(const Common::String &name, void *) {
+	if (!g_gui.getIconsSet().hasFile(name)) {
+		debug(5, "GridWidget: Cannot read file '%s'", name.c_str());
+		return nullptr;
+	}
+	return g_gui.getIconsSet().createReadStreamForMember(name);
+}
+
+// Decode the thumbnails and platform icons, scaled to fit in the size of the parameters.
+static const Graphics::ManagedSurface *decodeScaledPNG(const byte *data, uint32 size, const ImageLoader::Params &params, bool &keep) {
+	Common::MemoryReadStream stream(data, size);
+	Graphics::ManagedSurface *surf = decodePNG(stream, params.format);
+	if (!surf)
+		return nullptr;
+
+	const Graphics::ManagedSurface *scaled = scaleGfx(surf, params.width, params.height);
+	if (scaled != surf) {
+		delete surf;
+	} else {
+		// Only the scaled images are worth keeping, the others are as
+		// quick to decode again
+		keep = false;
+	}
+	return scaled;
+}
+
+static const Graphics::ManagedSurface *decodeFlagSVG(const byte *data, uint32 size, const ImageLoader::Params &params, bool &keep) {
+	Common::MemoryReadStream stream(data, size);
+	return decodeSVG(stream, params.width, params.height);
+}
+
 #pragma mark -
 
 GridWidget::GridWidget(GuiObject *boss, const Common::String &name)
@@ -345,8 +395,10 @@ GridWidget::GridWidget(GuiObject *boss, const Common::String &name)
 	_scrollWindowPaddingX = _minGridXSpacing;
 	_scrollWindowPaddingY = _minGridYSpacing;
 
-	loadPlatformIcons();
-	loadFlagIcons();
+	// The images are decoded when the grid shows them
+	_imageLoader = new ImageLoader(openIcon, nullptr, kImageCacheSize);
+	setFlags(WIDGET_WANT_TICKLE);
+	((GUI::Dialog *)_boss)->setTickleWidget(this);
 
 	_scrollBar = new ScrollBarWidget(this, _w - _scrollBarWidth, _y, _scrollBarWidth, _y + _h);
 	_scrollBar->setTarget(this);
@@ -374,42 +426,40 @@ GridWidget::GridWidget(GuiObject *boss, const Common::String &name)
 }
 
 GridWidget::~GridWidget() {
-	unloadSurfaces(_platformIcons);
-	unloadSurfaces(_languageIcons);
-	unloadSurfaces(_loadedSurfaces);
+	delete _imageLoader;
 	_gridItems.clear();
 	_dataEntryList.clear();
 	_sortedEntryList.clear();
 	_visibleEntryList.clear();
 }
 
-template<typename T>
-void GridWidget::unloadSurfaces(Common::HashMap<T, const Graphics::ManagedSurface *> &surfaces) {
-	for (typename Common::HashMap<T, const Graphics::ManagedSurface *>::iterator i = surfaces.begin(); i != surfaces.end(); ++i) {
-		delete i->_value;
-	}
-	surfaces.clear();
-}
-
 const Graphics::ManagedSurface *GridWidget::filenameToSurface(const Common::String &name) {
 	for (Common::Array<GridItemInfo *>::iterator l = _visibleEntryList.begin(); l != _visibleEntryList.end(); ++l) {
 		if ((!(*l)->isHeader) && ((*l)->thumbPath == name)) {
-			return _loadedSurfaces[name];
+			return requestThumbnail(name, 0);
 		}
 	}
 	return nullptr;
 }
 
-const Graphics::ManagedSurface *GridWidget::languageToSurface(Common::Language languageCode) {
+const Graphics::ManagedSurface *GridWidget::languageToSurface(Common::Language languageCode, int priority) {
 	if (languageCode == Common::UNK_LANG)
 		return nullptr;
-	return _languageIcons[languageCode];
+
+	const Common::String path = Common::String::format("icons/flags/%s.svg", Common::getLanguageCode(languageCode));
+	return _imageLoader->request(path, decodeFlagSVG, ImageLoader::Params(_flagIconWidth, _flagIconHeight, Graphics::SVGBitmap::getRenderFormat(), true), priority);
 }
 
-const Graphics::ManagedSurface *GridWidget::platformToSurface(Common::Platform platformCode) {
+const Graphics::ManagedSurface *GridWidget::platformToSurface(Common::Platform platformCode, int priority) {
 	if (platformCode == Common::kPlatformUnknown)
 		return nullptr;
-	return _platformIcons[platformCode];
+
+	const Common::String path = Common::String::format("icons/platforms/%s.png", Common::getPlatformCode(platformCode));
+	return _imageLoader->request(path, decodeScaledPNG, ImageLoader::Params(_platformIconWidth, _platformIconHeight, g_system->getOverlayFormat(), true), priority);
+}
+
+const Graphics::ManagedSurface *GridWidget::requestThumbnail(const Common::String &name, int priority) {
+	return _imageLoader->request(name, decodeScaledPNG, ImageLoader::Params(_thumbnailWidth, 512, g_system->getOverlayFormat(), true), priority);
 }
 
 void GridWidget::setEntryList(Common::Array<GridItemInfo> *list) {
@@ -570,53 +620,31 @@ void GridWidget::setGroupHeaderFormat(const Common::U32String &prefix, const Com
 }
 
 void GridWidget::reloadThumbnails() {
-	Graphics::ManagedSurface *surf = nullptr;
-	Common::String gameid;
-	Common::String engineid;
-
-	for (Common::Array<GridItemInfo *>::iterator iter = _visibleEntryList.begin(); iter != _visibleEntryList.end(); ++iter) {
-		GridItemInfo *entry = *iter;
-		if (!_loadedSurfaces.contains(entry->thumbPath)) {
-			surf = loadSurfaceFromFile(entry->thumbPath);
-			if (surf) {
-				const Graphics::ManagedSurface *scSurf(scaleGfx(surf, _thumbnailWidth, 512));
-				_loadedSurfaces[entry->thumbPath] = scSurf;
-				surf->free();
-				delete surf;
-			} else {
-				_loadedSurfaces[entry->thumbPath] = nullptr;
-			}
-		}
-	}
-}
+	_imageLoader->beginRequests();
 
-void GridWidget::loadFlagIcons() {
-	const Common::LanguageDescription *l = Common::g_languages;
-	for (; l->code; ++l) {
-		Common::String path = Common::String::format("icons/flags/%s.svg", l->code);
-		Graphics::ManagedSurface *gfx = loadSurfaceFromFile(path, _flagIconWidth, _flagIconHeight);
-		if (gfx) {
-			_languageIcons[l->id] = gfx;
-		} else {
-			_languageIcons[l->id] = nullptr;
-		}
+	for (uint i = 0; i < _visibleEntryList.size(); ++i) {
+		const GridItemInfo *entry = _visibleEntryList[i];
+		if (entry->isHeader)
+			continue;
+
+		// From the top left, so that the grid fills up in reading order
+		requestThumbnail(entry->thumbPath, i);
+		languageToSurface(entry->language, i);
+		platformToSurface(entry->platform, i);
 	}
-}
 
-void GridWidget::loadPlatformIcons() {
-	const Common::PlatformDescription *l = Common::g_platforms;
-	for (; l->code; ++l) {
-		Common::String path = Common::String::format("icons/platforms/%s.png", l->code);
-		Graphics::ManagedSurface *gfx = loadSurfaceFromFile(path);
-		if (gfx) {
-			const Graphics::ManagedSurface *scGfx = scaleGfx(gfx, _platformIconWidth, _platformIconHeight);
-			_platformIcons[l->id] = scGfx;
-			gfx->free();
-			delete gfx;
-		} else {
-			_platformIcons[l->id] = nullptr;
-		}
+	// Then about a page above and below, nearest first, for scrolling
+	const int pageSize = _visibleEntryList.size();
+	for (int distance = 0; distance < pageSize; ++distance) {
+		const int above = _firstVisibleItem - 1 - distance;
+		const int below = _lastVisibleItem + 1 + distance;
+		if (above >= 0 && !_sortedEntryList[above].isHeader)
+			requestThumbnail(_sortedEntryList[above].thumbPath, kPrefetchPriority + distance);
+		if (below < (int)_sortedEntryList.size() && !_sortedEntryList[below].isHeader)
+			requestThumbnail(_sortedEntryList[below].thumbPath, kPrefetchPriority + distance);
 	}
+
+	_imageLoader->endRequests();
 }
 
 void GridWidget::destroyItems() {
@@ -803,6 +831,16 @@ void GridWidget::calcEntrySizes() {
 	}
 }
 
+void GridWidget::handleTickle() {
+	if (!_imageLoader->poll())
+		return;
+
+	// Show the images decoded since the last tickle
+	for (uint k = 0; k < _gridItems.size() && k < _visibleEntryList.size(); ++k)
+		_gridItems[k]->update();
+	markAsDirty();
+}
+
 void GridWidget::reflowLayout() {
 	Widget::reflowLayout();
 	destroyItems();
@@ -815,9 +853,9 @@ void GridWidget::reflowLayout() {
 	_thumbnailHeight = g_gui.xmlEval()->getVar("Globals.GridItemThumbnail.Height");
 	_thumbnailWidth = g_gui.xmlEval()->getVar("Globals.GridItemThumbnail.Width");
 	if ((oldThumbnailHeight != _thumbnailHeight) || (oldThumbnailWidth != _thumbnailWidth)) {
-		unloadSurfaces(_loadedSurfaces);
-		reloadThumbnails();
-		loadFlagIcons();
+		// The visible entries are requested again below
+		_imageLoader->clear();
+		markGridAsInvalid();
 	}
 	_flagIconHeight = g_gui.xmlEval()->getVar("Globals.Grid.FlagIcon.Height");
 	_flagIconWidth = g_gui.xmlEval()->getVar("Globals.Grid.FlagIcon.Width");
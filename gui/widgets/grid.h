@@ -23,6 +23,7 @@
 #define GUI_WIDGETS_GRID_H
 
 #include "gui/dialog.h"
+#include "gui/imageloader.h"
 #include "gui/widgets/scrollbar.h"
 #include "common/str.h"
 
@@ -97,11 +98,8 @@ public:
 /* GridWidget */
 class GridWidget : public ContainerWidget, public CommandSender {
 protected:
-	Common::HashMap<int, const Graphics::ManagedSurface *> _platformIcons;
-	Common::HashMap<int, const Graphics::ManagedSurface *> _languageIcons;
-
-	// Images are mapped by filename -> surface.
-	Common::HashMap<Common::String, const Graphics::ManagedSurface *> _loadedSurfaces;
+	// Decodes the thumbnails and icons in the background, the visible ones first.
+	ImageLoader *_imageLoader;
 
 	Common::Array<GridItemInfo>			_dataEntryList;
 	Common::Array<GridItemInfo>			_sortedEntryList;
@@ -162,12 +160,11 @@ public:
 	GridWidget(GuiObject *boss, const Common::String &name);
 	~GridWidget();
 
-	template<typename T>
-	void unloadSurfaces(Common::HashMap<T, const Graphics::ManagedSurface *> &surfaces);
-
+	/// These return nullptr until the image is decoded, see reloadThumbnails().
 	const Graphics::ManagedSurface *filenameToSurface(const Common::String &name);
-	const Graphics::ManagedSurface *languageToSurface(Common::Language languageCode);
-	const Graphics::ManagedSurface *platformToSurface(Common::Platform platformCode);
+	const Graphics::ManagedSurface *languageToSurface(Common::Language languageCode, int priority = 0);
+	const Graphics::ManagedSurface *platformToSurface(Common::Platform platformCode, int priority = 0);
+	const Graphics::ManagedSurface *requestThumbnail(const Common::String &name, int priority);
 
 	/// Update _visibleEntries from _allEntries and returns true if reload is required.
 	bool calcVisibleEntries();
@@ -183,9 +180,9 @@ public:
 	bool groupExpanded(int groupID) { return _groupExpanded[groupID]; }
 	void toggleGroup(int groupID);
 
+	/// Queue the images of the visible entries, then those of the next
+	/// and previous pages. The items are updated as they are decoded.
 	void reloadThumbnails();
-	void loadFlagIcons();
-	void loadPlatformIcons();
 
 	void destroyItems();
 	void calcInnerHeight();
@@ -202,6 +199,7 @@ public:
 
 	void handleMouseWheel(int x, int y, int direction) override;
 	void handleCommand(CommandSender *sender, uint32 cmd, uint32 data) override;
+	void handleTickle() override;
 
 	void reflowLayout() override;
 
@@ -0,0 +1,134 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer_intern.h"
+
+#include "helper.h"
+#include "../null_osystem.h"
+
+class MixerTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_handles() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		Audio::MixerImpl mixer(22050);
+		mixer.setReady(true);
+
+		Audio::SoundHandle handle;
+		TS_ASSERT(!mixer.isSoundHandleActive(handle));
+
+		((Audio::Mixer &)mixer).playStream(Audio::Mixer::kSFXSoundType, &handle, createSineStream<int16>(22050, 1, nullptr, false, false), 42);
+
+		// The channel is visible before the audio thread picked it up
+		TS_ASSERT(mixer.isSoundHandleActive(handle));
+		TS_ASSERT(mixer.isSoundIDActive(42));
+		TS_ASSERT_EQUALS(mixer.getSoundID(handle), 42);
+		TS_ASSERT(mixer.hasActiveChannelOfType(Audio::Mixer::kSFXSoundType));
+		TS_ASSERT(!mixer.hasActiveChannelOfType(Audio::Mixer::kMusicSoundType));
+
+		// Sounds with the same id are not played twice
+		Audio::SoundHandle duplicate;
+		((Audio::Mixer &)mixer).playStream(Audio::Mixer::kSFXSoundType, &duplicate, createSineStream<int16>(22050, 1, nullptr, false, false), 42);
+		TS_ASSERT(!mixer.isSoundHandleActive(duplicate));
+
+		mixer.setChannelVolume(handle, 100);
+		mixer.setChannelBalance(handle, -20);
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 100);
+		TS_ASSERT_EQUALS(mixer.getChannelBalance(handle), -20);
+
+		int16 buffer[2 * 256];
+		TS_ASSERT_EQUALS(mixer.mixCallback((byte *)buffer, sizeof(buffer)), 256);
+
+		// Paused channels are not mixed
+		mixer.pauseHandle(handle, true);
+		TS_ASSERT_EQUALS(mixer.mixCallback((byte *)buffer, sizeof(buffer)), 0);
+		mixer.pauseHandle(handle, false);
+		TS_ASSERT_EQUALS(mixer.mixCallback((byte *)buffer, sizeof(buffer)), 256);
+
+		// The elapsed time covers everything mixed before the last call
+		TS_ASSERT(mixer.getElapsedTime(handle).totalNumberOfFrames() >= 256);
+
+		mixer.stopHandle(handle);
+		TS_ASSERT(!mixer.isSoundHandleActive(handle));
+		TS_ASSERT(!mixer.isSoundIDActive(42));
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 0);
+		TS_ASSERT_EQUALS(mixer.mixCallback((byte *)buffer, sizeof(buffer)), 0);
+#endif
+	}
+
+	void test_queueOverflow() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		Audio::MixerImpl mixer(22050);
+		mixer.setReady(true);
+
+		Audio::SoundHandle handle;
+		((Audio::Mixer &)mixer).playStream(Audio::Mixer::kSFXSoundType, &handle, createSineStream<int16>(22050, 1, nullptr, false, false));
+
+		// Without an audio thread, commands must not pile up forever
+		for (int i = 0; i < 1000; ++i)
+			mixer.setChannelVolume(handle, i & 0xFF);
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 999 & 0xFF);
+
+		mixer.pauseAll(true);
+		int16 buffer[2 * 64];
+		TS_ASSERT_EQUALS(mixer.mixCallback((byte *)buffer, sizeof(buffer)), 0);
+
+		mixer.stopAll();
+		TS_ASSERT(!mixer.isSoundHandleActive(handle));
+#endif
+	}
+
+	void test_stopAndSoundTypes() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		Audio::MixerImpl mixer(22050);
+		mixer.setReady(true);
+
+		Audio::SoundHandle first, second, permanent;
+		((Audio::Mixer &)mixer).playStream(Audio::Mixer::kSFXSoundType, &first, createSineStream<int16>(22050, 1, nullptr, false, false), 1);
+		((Audio::Mixer &)mixer).playStream(Audio::Mixer::kSFXSoundType, &second, createSineStream<int16>(22050, 1, nullptr, false, false), 2);
+		((Audio::Mixer &)mixer).playStream(Audio::Mixer::kMusicSoundType, &permanent, createSineStream<int16>(22050, 1, nullptr, false, false), 3,
+			Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::YES, true);
+
+		// Stopping applies the queued commands, including the pending inserts
+		mixer.stopID(1);
+		TS_ASSERT(!mixer.isSoundHandleActive(first));
+		TS_ASSERT(mixer.isSoundHandleActive(second));
+
+		int16 buffer[2 * 256];
+		TS_ASSERT_EQUALS(mixer.mixCallback((byte *)buffer, sizeof(buffer)), 256);
+
+		// Muted sound types are mixed silently
+		mixer.muteSoundType(Audio::Mixer::kSFXSoundType, true);
+		mixer.muteSoundType(Audio::Mixer::kMusicSoundType, true);
+		TS_ASSERT(mixer.isSoundTypeMuted(Audio::Mixer::kSFXSoundType));
+		TS_ASSERT_EQUALS(mixer.mixCallback((byte *)buffer, sizeof(buffer)), 256);
+		bool silent = true;
+		for (int i = 0; i < ARRAYSIZE(buffer); ++i)
+			silent = silent && buffer[i] == 0;
+		TS_ASSERT(silent);
+
+		mixer.muteSoundType(Audio::Mixer::kSFXSoundType, false);
+		mixer.setVolumeForSoundType(Audio::Mixer::kSFXSoundType, 1000);
+		TS_ASSERT_EQUALS(mixer.getVolumeForSoundType(Audio::Mixer::kSFXSoundType), (int)Audio::Mixer::kMaxMixerVolume);
+		TS_ASSERT_EQUALS(mixer.mixCallback((byte *)buffer, sizeof(buffer)), 256);
+		silent = true;
+		for (int i = 0; i < ARRAYSIZE(buffer); ++i)
+			silent = silent && buffer[i] == 0;
+		TS_ASSERT(!silent);
+
+		// Permanent channels survive stopAll
+		mixer.stopAll();
+		TS_ASSERT(!mixer.isSoundHandleActive(second));
+		TS_ASSERT(mixer.isSoundHandleActive(permanent));
+
+		mixer.stopHandle(permanent);
+		TS_ASSERT(!mixer.isSoundHandleActive(permanent));
+		TS_ASSERT_EQUALS(mixer.mixCallback((byte *)buffer, sizeof(buffer)), 0);
+#endif
+	}
+};
@@ -0,0 +1,158 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/rate.h"
+#include "audio/rate_mix.h"
+#include "audio/decoders/raw.h"
+
+#include "common/config-manager.h"
+#include "common/memstream.h"
+#include "common/system.h"
+
+#include "helper.h"
+#include "../helpers.h"
+#include "../null_osystem.h"
+
+static const int qualityRates[] = { 11025, 22050, 44100 };
+
+class RateTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_mixProcs() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+		const Audio::MixProcs &scalar = Audio::getScalarMixProcs();
+		const Audio::MixProcs &best = Audio::getMixProcs();
+
+		static const Audio::st_volume_t volumes[] = { 0, 1, 77, 128, 255, 256 };
+
+		for (int frames = 0; frames < 40; ++frames) {
+			for (int v = 0; v < ARRAYSIZE(volumes); ++v) {
+				const Audio::st_volume_t vol_l = volumes[v];
+				const Audio::st_volume_t vol_r = volumes[ARRAYSIZE(volumes) - 1 - v];
+
+				checkMixProc(scalar.mixMono, best.mixMono, frames, 1, vol_l, vol_r);
+				checkMixProc(scalar.mixStereo, best.mixStereo, frames, 2, vol_l, vol_r);
+				checkMixProc(scalar.mixStereoReverse, best.mixStereoReverse, frames, 2, vol_l, vol_r);
+			}
+		}
+	}
+
+	void test_firProcs() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+		const Audio::MixProcs &scalar = Audio::getScalarMixProcs();
+		const Audio::MixProcs &best = Audio::getMixProcs();
+
+		const uint taps = 16;
+		int16 *coeffs = new int16[Audio::FIR_ROWS * taps];
+		int16 input[256 + taps];
+		TestRandom rnd;
+		for (uint i = 0; i < Audio::FIR_ROWS * taps; ++i)
+			coeffs[i] = rnd.nextSample() >> 4;
+		for (uint i = 0; i < ARRAYSIZE(input); ++i)
+			input[i] = rnd.nextSample();
+
+		Audio::FirState state;
+		state.coeffs = coeffs;
+		state.taps = taps;
+		state.phases = 640;
+		state.stepInt = 0;
+		state.stepFrac = 147;
+		state.rowScale = ((uint64)Audio::FIR_ROWS << 32) / state.phases;
+		state.pos = 3;
+		state.phase = 100;
+
+		int16 expected[2 * 200];
+		int16 output[2 * 200];
+		memset(expected, 0, sizeof(expected));
+		memset(output, 0, sizeof(output));
+
+		scalar.fir(expected + 1, 2, input, state, 200);
+		best.fir(output + 1, 2, input, state, 200);
+		TS_ASSERT_EQUALS(memcmp(expected, output, sizeof(output)), 0);
+
+		delete[] coeffs;
+	}
+
+	void test_sincQuality() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		for (int i = 0; i < ARRAYSIZE(qualityRates); ++i) {
+			const int inRate = qualityRates[i];
+
+			const double linear = measureSNR(inRate, 4000);
+
+			ConfMan.set("audio_resampler", "sinc", Common::ConfigManager::kTransientDomain);
+			const double sinc = measureSNR(inRate, 4000);
+			ConfMan.removeKey("audio_resampler", Common::ConfigManager::kTransientDomain);
+
+			TS_ASSERT(sinc > linear + 20.0);
+		}
+#endif
+	}
+
+private:
+	void checkMixProc(Audio::MixProc reference, Audio::MixProc proc, int frames, int channels, Audio::st_volume_t vol_l, Audio::st_volume_t vol_r) {
+		int16 input[2 * 40];
+		int16 expected[2 * 40];
+		int16 output[2 * 40];
+
+		TestRandom rnd(frames * 31 + vol_l);
+		for (int i = 0; i < frames * channels; ++i)
+			input[i] = rnd.nextSample();
+		for (int i = 0; i < frames * 2; ++i)
+			expected[i] = output[i] = rnd.nextSample();
+
+		reference(expected, input, frames, vol_l, vol_r);
+		proc(output, input, frames, vol_l, vol_r);
+
+		TS_ASSERT_EQUALS(memcmp(expected, output, frames * 2 * sizeof(int16)), 0);
+	}
+
+	/**
+	 * Convert a sine of the given frequency to 48 kHz and compare it to the
+	 * ideal output, compensating for the latency of the converter.
+	 */
+	double measureSNR(int inRate, int frequency) {
+		const int outRate = 48000;
+		const int inFrames = inRate / 2;
+		const int outFrames = outRate / 2 - 256;
+		const double amplitude = 16000.0;
+
+		byte *sine = (byte *)malloc(inFrames * sizeof(int16));
+		for (int i = 0; i < inFrames; ++i)
+			WRITE_LE_INT16(sine + i * 2, (int16)floor(amplitude * sin(2 * M_PI * frequency * i / inRate) + 0.5));
+
+		Common::SeekableReadStream *data = new Common::MemoryReadStream(sine, inFrames * sizeof(int16), DisposeAfterUse::YES);
+		Audio::AudioStream *input = Audio::makeRawStream(data, inRate, Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, false);
+
+		int16 *output = new int16[outFrames * 2];
+		memset(output, 0, outFrames * 2 * sizeof(int16));
+		TS_ASSERT_EQUALS(converter->flow(*input, output, outFrames, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), outFrames);
+
+		// Skip the start, where the filters see the silence before the input,
+		// and try latencies of up to two input samples
+		double best = 0.0;
+		for (int delay = 0; delay <= 40; ++delay) {
+			double signal = 0.0, noise = 0.0;
+			for (int i = 256; i < outFrames; ++i) {
+				const double ideal = amplitude * sin(2 * M_PI * frequency * ((double)i / outRate - delay / (20.0 * inRate)));
+				signal += ideal * ideal;
+				noise += (output[i * 2] - ideal) * (output[i * 2] - ideal);
+			}
+			best = MAX(best, 10.0 * log10(signal / MAX(noise, 1.0)));
+		}
+
+		delete[] output;
+		delete converter;
+		delete input;
+
+		return best;
+	}
+
+};
@@ -0,0 +1,50 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/debug.h"
+#include "common/memstream.h"
+#include "common/system.h"
+#include "common/zlib.h"
+
+#include "../helpers.h"
+#include "../null_osystem.h"
+
+class GZipReadStreamBenchmarkSuite : public CxxTest::TestSuite {
+public:
+	void test_randomSeek() {
+#if defined(USE_ZLIB) && NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		const uint32 size = 4 * 1024 * 1024;
+		const int seeks = 500;
+
+		byte *contents = new byte[size];
+		TestRandom rnd;
+		for (uint32 i = 0; i < size; ++i)
+			contents[i] = 'a' + (rnd.next() >> 20);
+
+		Common::MemoryWriteStreamDynamic *data = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *compressor = Common::wrapCompressedWriteStream(data);
+		compressor->write(contents, size);
+		compressor->finalize();
+		Common::SeekableReadStream *stream = Common::wrapCompressedReadStream(new Common::MemoryReadStream(data->getData(), data->size(), DisposeAfterUse::YES));
+		delete compressor;
+
+		// Pass the whole data once, as a savegame loader would
+		byte *buffer = new byte[size];
+		stream->read(buffer, size);
+
+		const uint32 start = g_system->getMillis();
+		for (int i = 0; i < seeks; ++i) {
+			stream->seek(rnd.next() % (size - 256));
+			stream->read(buffer, 256);
+		}
+		const uint32 elapsed = MAX<uint32>(g_system->getMillis() - start, 1);
+
+		debug("GZipReadStream %u KB: %u random seeks/s", size / 1024, (uint)(seeks * 1000 / elapsed));
+
+		delete stream;
+		delete[] buffer;
+		delete[] contents;
+#endif
+	}
+};
@@ -0,0 +1,67 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/system.h"
+
+#include "../audio/helper.h"
+#include "../null_osystem.h"
+
+class RateBenchmarkSuite : public CxxTest::TestSuite
+{
+public:
+	void test_converterThroughput() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		benchmarkConverter("Copy", 48000, false);
+		benchmarkConverter("Copy", 48000, true);
+		benchmarkConverter("Simple", 96000, false);
+		benchmarkConverter("Simple", 96000, true);
+		benchmarkConverter("Linear", 11025, false);
+		benchmarkConverter("Linear", 22050, true);
+		benchmarkConverter("Linear", 44100, true);
+
+		ConfMan.set("audio_resampler", "sinc", Common::ConfigManager::kTransientDomain);
+		benchmarkConverter("Sinc", 11025, false);
+		benchmarkConverter("Sinc", 22050, true);
+		benchmarkConverter("Sinc", 44100, true);
+		ConfMan.removeKey("audio_resampler", Common::ConfigManager::kTransientDomain);
+#endif
+	}
+
+private:
+	void benchmarkConverter(const char *name, int inRate, bool stereo) {
+		const int outRate = 48000;
+		const int frames = outRate * 10;
+		const int chunk = 1024;
+
+		Audio::RewindableAudioStream *sine = createSineStream<int16>(inRate, 1, nullptr, false, stereo);
+		Audio::AudioStream *input = new Audio::LoopingAudioStream(sine, 0);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo);
+
+		int16 *buffer = new int16[chunk * 2];
+		memset(buffer, 0, chunk * 2 * sizeof(int16));
+
+		const uint32 start = g_system->getMillis();
+		int done = 0;
+		while (done < frames) {
+			const int res = converter->flow(*input, buffer, chunk, Audio::Mixer::kMaxMixerVolume / 2, Audio::Mixer::kMaxMixerVolume / 3);
+			if (res <= 0)
+				break;
+			done += res;
+		}
+		const uint32 elapsed = MAX<uint32>(g_system->getMillis() - start, 1);
+
+		debug("RateConverter %s %d->%d %s: %u samples/s", name, inRate, outRate,
+		      stereo ? "stereo" : "mono", (uint)((uint64)done * 1000 / elapsed));
+
+		delete[] buffer;
+		delete converter;
+		delete input;
+	}
+};
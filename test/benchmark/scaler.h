@@ -0,0 +1,133 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/debug.h"
+#include "common/system.h"
+#include "graphics/scalerplugin.h"
+
+#include "../helpers.h"
+#include "../null_osystem.h"
+
+#define DECLARE_SCALER_PLUGIN(ID) \
+	extern PluginObject *g_##ID##_getObject();
+
+DECLARE_SCALER_PLUGIN(NORMAL)
+#ifdef USE_SCALERS
+#ifdef USE_HQ_SCALERS
+DECLARE_SCALER_PLUGIN(HQ)
+#endif
+#ifdef USE_EDGE_SCALERS
+DECLARE_SCALER_PLUGIN(EDGE)
+#endif
+DECLARE_SCALER_PLUGIN(ADVMAME)
+DECLARE_SCALER_PLUGIN(SAI)
+DECLARE_SCALER_PLUGIN(SUPERSAI)
+DECLARE_SCALER_PLUGIN(SUPEREAGLE)
+DECLARE_SCALER_PLUGIN(PM)
+DECLARE_SCALER_PLUGIN(DOTMATRIX)
+DECLARE_SCALER_PLUGIN(TV)
+#endif
+
+class ScalerBenchmarkSuite : public CxxTest::TestSuite {
+	TestRandom _rnd;
+
+	void createPlugins(Common::Array<PluginObject *> &plugins) {
+#define ADD_SCALER_PLUGIN(ID) \
+		plugins.push_back(g_##ID##_getObject());
+
+		ADD_SCALER_PLUGIN(NORMAL)
+#ifdef USE_SCALERS
+#ifdef USE_HQ_SCALERS
+		ADD_SCALER_PLUGIN(HQ)
+#endif
+#ifdef USE_EDGE_SCALERS
+		ADD_SCALER_PLUGIN(EDGE)
+#endif
+		ADD_SCALER_PLUGIN(ADVMAME)
+		ADD_SCALER_PLUGIN(SAI)
+		ADD_SCALER_PLUGIN(SUPERSAI)
+		ADD_SCALER_PLUGIN(SUPEREAGLE)
+		ADD_SCALER_PLUGIN(PM)
+		ADD_SCALER_PLUGIN(DOTMATRIX)
+		ADD_SCALER_PLUGIN(TV)
+#endif
+#undef ADD_SCALER_PLUGIN
+	}
+
+	/** Fill a surface with flat areas, gradients and noise, like a game screen. */
+	void fillScreen(byte *pixels, uint pitch, int width, int height, const Graphics::PixelFormat &format) {
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				uint32 color;
+				if (y < height / 2)
+					color = format.RGBToColor(x * 255 / width, 0x40, y * 255 / height);
+				else if (x < width / 2)
+					color = format.RGBToColor(((x / 16) & 1) ? 0xFF : 0, 0x80, 0x20);
+				else
+					color = format.RGBToColor(_rnd.next() & 0xFF, _rnd.next() & 0xFF, _rnd.next() & 0xFF);
+
+				if (format.bytesPerPixel == 2)
+					*(uint16 *)(pixels + y * pitch + x * 2) = color;
+				else
+					*(uint32 *)(pixels + y * pitch + x * 4) = color;
+			}
+		}
+	}
+
+	void benchmarkScaler(const ScalerPluginObject &plugin, uint factor, const Graphics::PixelFormat &format) {
+		const int width = 320;
+		const int height = 200;
+		const uint32 duration = 100;
+		const int padding = plugin.extraPixels();
+
+		const uint srcPitch = (width + padding * 2) * format.bytesPerPixel;
+		const uint dstPitch = width * factor * format.bytesPerPixel;
+		byte *src = new byte[srcPitch * (height + padding * 2)];
+		byte *dst = new byte[dstPitch * height * factor];
+		fillScreen(src, srcPitch, width + padding * 2, height + padding * 2, format);
+
+		Scaler *scaler = plugin.createInstance(format);
+		scaler->setFactor(factor);
+
+		const byte *srcStart = src + padding * srcPitch + padding * format.bytesPerPixel;
+		const uint32 start = g_system->getMillis();
+		uint32 elapsed;
+		int frames = 0;
+		do {
+			scaler->scale(srcStart, srcPitch, dst, dstPitch, width, height, 0, 0);
+			frames++;
+			elapsed = g_system->getMillis() - start;
+		} while (elapsed < duration);
+
+		debug("Scaler %s %ux %d bpp: %.1f Mpixels/s", plugin.getName(), factor, format.bytesPerPixel * 8,
+		      (double)width * height * frames / elapsed / 1000.0);
+
+		delete scaler;
+		delete[] dst;
+		delete[] src;
+	}
+
+public:
+	void test_scalers() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+
+		Common::Array<PluginObject *> plugins;
+		createPlugins(plugins);
+
+		for (uint i = 0; i < plugins.size(); i++) {
+			const ScalerPluginObject &plugin = *(const ScalerPluginObject *)plugins[i];
+			const Common::Array<uint> &factors = plugin.getFactors();
+			for (uint j = 0; j < factors.size(); j++) {
+				for (uint k = 0; k < ARRAYSIZE(formats); k++)
+					benchmarkScaler(plugin, factors[j], formats[k]);
+			}
+			delete plugins[i];
+		}
+#endif
+	}
+};
@@ -0,0 +1,69 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/debug.h"
+#include "common/system.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_intern.h"
+
+#include "../helpers.h"
+#include "../null_osystem.h"
+
+class YUVToRGBBenchmarkSuite : public CxxTest::TestSuite {
+	void benchmark(const char *name, int width, int height, const Graphics::PixelFormat &format) {
+		const uint32 duration = 100;
+
+		Common::Array<byte> y, u, v;
+		y.resize(width * height);
+		u.resize(width * height / 4);
+		v.resize(width * height / 4);
+		TestRandom rnd;
+		for (uint i = 0; i < y.size(); i++)
+			y[i] = rnd.next() >> 16;
+		for (uint i = 0; i < u.size(); i++) {
+			u[i] = i & 0xFF;
+			v[i] = (i * 97 + 13) & 0xFF;
+		}
+
+		Graphics::Surface surface;
+		surface.create(width, height, format);
+
+		const uint32 start = g_system->getMillis();
+		uint32 elapsed;
+		int frames = 0;
+		do {
+			YUVToRGBMan.convert420(&surface, Graphics::YUVToRGBManager::kScaleITU, y.begin(), u.begin(), v.begin(), width, height, width, width / 2);
+			frames++;
+			elapsed = g_system->getMillis() - start;
+		} while (elapsed < duration);
+
+		debug("YUV420 to RGB %s %dx%d %d bpp: %.1f frames/s", name, width, height, format.bytesPerPixel * 8,
+		      frames * 1000.0 / elapsed);
+
+		surface.free();
+	}
+
+public:
+	void test_convert420() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		const int sizes[][2] = { { 320, 240 }, { 640, 480 }, { 1280, 720 } };
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+
+		for (uint i = 0; i < ARRAYSIZE(sizes); i++) {
+			for (uint j = 0; j < ARRAYSIZE(formats); j++) {
+				YUVToRGBMan.setKernels(nullptr);
+				benchmark("tables", sizes[i][0], sizes[i][1], formats[j]);
+				YUVToRGBMan.setKernels(Graphics::getYUVToRGBKernels());
+				if (Graphics::getYUVToRGBKernels())
+					benchmark("SIMD", sizes[i][0], sizes[i][1], formats[j]);
+			}
+		}
+#endif
+	}
+};
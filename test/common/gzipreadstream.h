@@ -0,0 +1,76 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/system.h"
+#include "common/zlib.h"
+
+#include "../helpers.h"
+#include "../null_osystem.h"
+
+class GZipReadStreamTestSuite : public CxxTest::TestSuite {
+public:
+	void test_randomSeek() {
+#if defined(USE_ZLIB)
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+		const uint32 size = 4 * 1024 * 1024;
+		const int seeks = 500;
+
+		byte *contents = new byte[size];
+		TestRandom rnd;
+		for (uint32 i = 0; i < size; ++i)
+			contents[i] = 'a' + (rnd.next() >> 20);
+
+		Common::SeekableReadStream *stream = createGZipStream(contents, size);
+		TS_ASSERT_EQUALS(stream->size(), size);
+
+		// Pass the whole data once, as a savegame loader would
+		byte *buffer = new byte[size];
+		TS_ASSERT_EQUALS(stream->read(buffer, size), size);
+		TS_ASSERT_EQUALS(memcmp(buffer, contents, size), 0);
+
+		for (int i = 0; i < seeks; ++i) {
+			const uint32 offset = rnd.next() % (size - 256);
+
+			TS_ASSERT(stream->seek(offset));
+			TS_ASSERT_EQUALS(stream->pos(), offset);
+			TS_ASSERT_EQUALS(stream->read(buffer, 256), 256u);
+			TS_ASSERT_EQUALS(memcmp(buffer, contents + offset, 256), 0);
+		}
+
+		TS_ASSERT(stream->seek(-10, SEEK_END));
+		TS_ASSERT_EQUALS(stream->read(buffer, 20), 10u);
+		TS_ASSERT(stream->eos());
+		TS_ASSERT_EQUALS(memcmp(buffer, contents + size - 10, 10), 0);
+
+		TS_ASSERT(stream->seek(0));
+		TS_ASSERT(!stream->eos());
+		TS_ASSERT_EQUALS(stream->readByte(), contents[0]);
+
+		// Seeking past the end fails and leaves the stream at its end
+		TS_ASSERT(!stream->seek(size + 100));
+		TS_ASSERT_EQUALS(stream->pos(), size);
+		TS_ASSERT_EQUALS(stream->read(buffer, 1), 0u);
+		TS_ASSERT(stream->eos());
+		TS_ASSERT(!stream->err());
+
+		delete stream;
+		delete[] buffer;
+		delete[] contents;
+#endif
+	}
+
+private:
+	Common::SeekableReadStream *createGZipStream(const byte *contents, uint32 size) {
+		Common::MemoryWriteStreamDynamic *data = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *compressor = Common::wrapCompressedWriteStream(data);
+		compressor->write(contents, size);
+		compressor->finalize();
+
+		Common::SeekableReadStream *compressed = new Common::MemoryReadStream(data->getData(), data->size(), DisposeAfterUse::YES);
+		delete compressor;
+
+		return Common::wrapCompressedReadStream(compressed);
+	}
+};
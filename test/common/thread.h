@@ -0,0 +1,96 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/mutex.h"
+#include "common/system.h"
+#include "common/thread.h"
+
+#include "../null_osystem.h"
+
+struct ThreadTestState {
+	Common::Mutex mutex;
+	Common::Semaphore items;
+	Common::Semaphore done;
+	int produced;
+	int consumed;
+	int sum;
+
+	ThreadTestState() : produced(0), consumed(0), sum(0) {}
+};
+
+static void threadTestConsumer(void *param) {
+	ThreadTestState *state = (ThreadTestState *)param;
+
+	for (;;) {
+		state->items.wait();
+
+		Common::StackLock lock(state->mutex);
+		if (state->consumed == state->produced) {
+			// Posted without an item, time to stop
+			break;
+		}
+		state->sum += ++state->consumed;
+	}
+	state->done.post();
+}
+
+class ThreadTestSuite : public CxxTest::TestSuite {
+public:
+	void test_semaphoreWithoutThreads() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+		Common::Semaphore semaphore(1);
+		semaphore.wait();
+		semaphore.post();
+		semaphore.post();
+		semaphore.wait();
+		semaphore.wait();
+	}
+
+	void test_producerConsumer() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+		const int numThreads = 4;
+		const int numItems = 10000;
+
+		ThreadTestState state;
+		Common::Thread *threads[numThreads];
+		int started = 0;
+		for (int i = 0; i < numThreads; ++i) {
+			threads[i] = new Common::Thread(threadTestConsumer, &state);
+			if (threads[i]->isRunning())
+				started++;
+		}
+
+		// Without thread support, there is nothing to test
+		if (!started) {
+			for (int i = 0; i < numThreads; ++i)
+				delete threads[i];
+			return;
+		}
+		TS_ASSERT_EQUALS(started, numThreads);
+
+		for (int i = 0; i < numItems; ++i) {
+			state.mutex.lock();
+			state.produced++;
+			state.mutex.unlock();
+			state.items.post();
+		}
+
+		// Wake up every consumer once more, so that they stop
+		for (int i = 0; i < numThreads; ++i)
+			state.items.post();
+		for (int i = 0; i < numThreads; ++i)
+			state.done.wait();
+
+		for (int i = 0; i < numThreads; ++i) {
+			threads[i]->join();
+			TS_ASSERT(!threads[i]->isRunning());
+			delete threads[i];
+		}
+
+		TS_ASSERT_EQUALS(state.consumed, numItems);
+		TS_ASSERT_EQUALS(state.sum, numItems * (numItems + 1) / 2);
+	}
+};
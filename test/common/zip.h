@@ -0,0 +1,201 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/crc.h"
+#include "common/memstream.h"
+#include "common/unzip.h"
+#include "common/zlib.h"
+
+#include "../helpers.h"
+
+class ZipTestSuite : public CxxTest::TestSuite {
+public:
+	void test_members() {
+#if defined(USE_ZLIB)
+		const uint32 size = 3 * 1024 * 1024 + 123;
+		byte *contents = createContents(size);
+
+		Common::Archive *archive = Common::makeZipArchive(createZip(contents, size));
+		TS_ASSERT(archive);
+		if (!archive) {
+			delete[] contents;
+			return;
+		}
+
+		Common::SeekableReadStream *stored = archive->createReadStreamForMember("stored.txt");
+		Common::SeekableReadStream *deflated = archive->createReadStreamForMember("deflated.txt");
+		TS_ASSERT(!archive->createReadStreamForMember("missing.txt"));
+
+		// The members outlive the archive
+		delete archive;
+
+		TS_ASSERT(stored && deflated);
+		if (stored && deflated) {
+			TS_ASSERT_EQUALS(stored->size(), 1000);
+			TS_ASSERT_EQUALS(deflated->size(), size);
+
+			// Read everything sequentially
+			byte *buffer = new byte[size];
+			TS_ASSERT_EQUALS(deflated->read(buffer, size), size);
+			TS_ASSERT_EQUALS(memcmp(buffer, contents, size), 0);
+			TS_ASSERT(!deflated->eos());
+			TS_ASSERT_EQUALS(deflated->read(buffer, 1), 0u);
+			TS_ASSERT(deflated->eos());
+			TS_ASSERT(!deflated->err());
+
+			// Seek around, interleaved with reads from the other member
+			static const uint32 offsets[] = { 2500000, 100, 1048576, 1048575, 3000000, 0, size - 10 };
+			for (uint i = 0; i < ARRAYSIZE(offsets); ++i) {
+				const uint32 length = MIN<uint32>(1000, size - offsets[i]);
+
+				TS_ASSERT(deflated->seek(offsets[i]));
+				TS_ASSERT_EQUALS(deflated->pos(), offsets[i]);
+
+				TS_ASSERT(stored->seek(i * 10));
+				TS_ASSERT_EQUALS(stored->read(buffer, 10), 10u);
+				TS_ASSERT_EQUALS(memcmp(buffer, contents + i * 10, 10), 0);
+
+				TS_ASSERT_EQUALS(deflated->read(buffer, length), length);
+				TS_ASSERT_EQUALS(memcmp(buffer, contents + offsets[i], length), 0);
+			}
+
+			TS_ASSERT(deflated->seek(-5, SEEK_END));
+			TS_ASSERT_EQUALS(deflated->read(buffer, 10), 5u);
+			TS_ASSERT_EQUALS(memcmp(buffer, contents + size - 5, 5), 0);
+			TS_ASSERT(!deflated->seek(size + 1));
+
+			delete[] buffer;
+		}
+
+		delete stored;
+		delete deflated;
+		delete[] contents;
+#endif
+	}
+
+	void test_crc() {
+#if defined(USE_ZLIB)
+		const uint32 size = 5000;
+		byte *contents = createContents(size);
+
+		Common::Archive *archive = Common::makeZipArchive(createZip(contents, size, true));
+		TS_ASSERT(archive);
+		if (!archive) {
+			delete[] contents;
+			return;
+		}
+
+		Common::SeekableReadStream *stored = archive->createReadStreamForMember("stored.txt");
+		Common::SeekableReadStream *deflated = archive->createReadStreamForMember("deflated.txt");
+		delete archive;
+
+		TS_ASSERT(stored && deflated);
+		if (stored && deflated) {
+			byte buffer[size];
+
+			// The mismatch only shows once the member has been read through
+			TS_ASSERT_EQUALS(stored->read(buffer, 999), 999u);
+			TS_ASSERT(!stored->err());
+			TS_ASSERT(stored->seek(500));
+			TS_ASSERT_EQUALS(stored->read(buffer, 500), 500u);
+			TS_ASSERT(stored->err());
+
+			TS_ASSERT_EQUALS(deflated->read(buffer, size), size);
+			TS_ASSERT(!deflated->err());
+		}
+
+		delete stored;
+		delete deflated;
+		delete[] contents;
+#endif
+	}
+
+private:
+	byte *createContents(uint32 size) {
+		byte *contents = new byte[size];
+		TestRandom rnd;
+		for (uint32 i = 0; i < size; ++i)
+			contents[i] = 'a' + (rnd.next() >> 20);
+		return contents;
+	}
+
+	/**
+	 * Build a ZIP file with the first 1000 bytes of contents as a stored
+	 * member and all of contents as a deflated member. With badStoredCrc,
+	 * the checksum of the stored member is wrong.
+	 */
+	Common::SeekableReadStream *createZip(const byte *contents, uint32 size, bool badStoredCrc = false) {
+		Common::CRC32 crc;
+		const uint32 storedCrc = crc.crcSlow(contents, 1000) ^ (badStoredCrc ? 1 : 0);
+		const uint32 deflatedCrc = crc.crcSlow(contents, size);
+
+		// Take the raw deflate data out of a gzip stream, skipping the
+		// 10 byte header and the 8 byte trailer
+		Common::MemoryWriteStreamDynamic *gzip = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *compressor = Common::wrapCompressedWriteStream(gzip);
+		compressor->write(contents, size);
+		compressor->finalize();
+		byte *gzipData = gzip->getData();
+		const uint32 deflatedSize = gzip->size() - 18;
+
+		Common::MemoryWriteStreamDynamic zip(DisposeAfterUse::NO);
+		writeLocalHeader(zip, "stored.txt", 0, storedCrc, 1000, 1000);
+		zip.write(contents, 1000);
+		const uint32 deflatedOffset = zip.pos();
+		writeLocalHeader(zip, "deflated.txt", 8, deflatedCrc, deflatedSize, size);
+		zip.write(gzipData + 10, deflatedSize);
+
+		delete compressor;
+		free(gzipData);
+
+		const uint32 centralDirOffset = zip.pos();
+		writeCentralHeader(zip, "stored.txt", 0, storedCrc, 1000, 1000, 0);
+		writeCentralHeader(zip, "deflated.txt", 8, deflatedCrc, deflatedSize, size, deflatedOffset);
+		const uint32 centralDirSize = zip.pos() - centralDirOffset;
+
+		zip.writeUint32LE(0x06054b50);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(2);
+		zip.writeUint16LE(2);
+		zip.writeUint32LE(centralDirSize);
+		zip.writeUint32LE(centralDirOffset);
+		zip.writeUint16LE(0);
+
+		return new Common::MemoryReadStream(zip.getData(), zip.size(), DisposeAfterUse::YES);
+	}
+
+	void writeLocalHeader(Common::WriteStream &zip, const char *name, uint16 method, uint32 crc, uint32 compressedSize, uint32 size) {
+		zip.writeUint32LE(0x04034b50);
+		zip.writeUint16LE(20);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(method);
+		zip.writeUint32LE(0);
+		zip.writeUint32LE(crc);
+		zip.writeUint32LE(compressedSize);
+		zip.writeUint32LE(size);
+		zip.writeUint16LE(strlen(name));
+		zip.writeUint16LE(0);
+		zip.write(name, strlen(name));
+	}
+
+	void writeCentralHeader(Common::WriteStream &zip, const char *name, uint16 method, uint32 crc, uint32 compressedSize, uint32 size, uint32 offset) {
+		zip.writeUint32LE(0x02014b50);
+		zip.writeUint16LE(20);
+		zip.writeUint16LE(20);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(method);
+		zip.writeUint32LE(0);
+		zip.writeUint32LE(crc);
+		zip.writeUint32LE(compressedSize);
+		zip.writeUint32LE(size);
+		zip.writeUint16LE(strlen(name));
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(0);
+		zip.writeUint32LE(0);
+		zip.writeUint32LE(offset);
+		zip.write(name, strlen(name));
+	}
+};
@@ -0,0 +1,135 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/system.h"
+#include "engines/scumm/gfx_compose.h"
+
+#include "../../helpers.h"
+#include "../../null_osystem.h"
+
+class ScummComposeTestSuite : public CxxTest::TestSuite {
+	enum {
+		kNumRows = 500,
+		kMaxWidth = 328
+	};
+
+	TestRandom _rnd;
+
+	/** Text pixels, mostly transparent, with some letters and whole lines of them. */
+	void randomText(Common::Array<byte> &text, int width, int opaqueChance) {
+		text.resize(width);
+		for (int i = 0; i < width; i++) {
+			const bool opaque = opaqueChance && (int)(_rnd.next() % 100) < opaqueChance;
+			text[i] = opaque ? _rnd.next() & 0xFF : CHARSET_MASK_TRANSPARENCY;
+		}
+	}
+
+	void checkCLUT8(const char *name, const Scumm::ComposeKernels *kernels) {
+		for (int i = 0; i < kNumRows; i++) {
+			const int width = 4 * (_rnd.next() % (kMaxWidth / 4 + 1));
+			Common::Array<byte> src(width + 4), text, dst(width + 4);
+			for (int j = 0; j < width; j++)
+				src[j] = _rnd.next() & 0xFF;
+			randomText(text, width, (i % 3) * 30);
+			text.resize(width + 4);
+
+			for (int j = 0; j < width + 4; j++)
+				dst[j] = _rnd.next() & 0xFF;
+			Common::Array<byte> expected = dst;
+			for (int j = 0; j < width; j++)
+				expected[j] = (text[j] == CHARSET_MASK_TRANSPARENCY) ? src[j] : text[j];
+
+			kernels->composeCLUT8(&dst[0], &src[0], &text[0], width);
+			TSM_ASSERT(name, dst == expected);
+		}
+	}
+
+	void check16(const char *name, const Scumm::ComposeKernels *kernels) {
+		Common::Array<uint16> palette(256);
+		for (uint i = 0; i < palette.size(); i++)
+			palette[i] = _rnd.next() & 0xFFFF;
+
+		for (int i = 0; i < kNumRows; i++) {
+			const int width = 1 + _rnd.next() % kMaxWidth;
+			Common::Array<uint16> src(width), dst(width + 1);
+			Common::Array<byte> text;
+			for (int j = 0; j < width; j++)
+				src[j] = _rnd.next() & 0xFFFF;
+			randomText(text, width, (i % 3) * 5);
+
+			for (int j = 0; j < width + 1; j++)
+				dst[j] = _rnd.next() & 0xFFFF;
+			Common::Array<uint16> expected = dst;
+			bool opaque = false;
+			for (int j = 0; j < width; j++) {
+				opaque |= text[j] != CHARSET_MASK_TRANSPARENCY;
+				expected[j] = (text[j] == CHARSET_MASK_TRANSPARENCY) ? src[j] : palette[text[j]];
+			}
+
+			TSM_ASSERT(name, kernels->compose16(&dst[0], &src[0], &text[0], width, &palette[0]));
+			TSM_ASSERT(name, dst == expected);
+
+			// Without palette, only rows without text can be composed
+			TSM_ASSERT_EQUALS(name, kernels->compose16(&dst[0], &src[0], &text[0], width, nullptr), !opaque);
+		}
+	}
+
+	void checkKernels(const char *name, const Scumm::ComposeKernels *kernels) {
+		_rnd.setSeed(1234);
+		checkCLUT8(name, kernels);
+		check16(name, kernels);
+	}
+
+public:
+	void test_compose() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		checkKernels("host", Scumm::getComposeKernels());
+		// There are no AVX2 compose kernels
+		CHECK_SSE2_KERNELS(checkKernels, Scumm::getSSE2ComposeKernels);
+		CHECK_NEON_KERNELS(checkKernels, Scumm::getNEONComposeKernels);
+#endif
+	}
+
+	void test_townsLayerRow() {
+		_rnd.setSeed(4321);
+		Common::Array<uint16> palette(256);
+		for (uint i = 0; i < palette.size(); i++)
+			palette[i] = _rnd.next() & 0xFFFF;
+
+		for (int i = 0; i < kNumRows; i++) {
+			const int layerWidth = 8 + _rnd.next() % 640;
+			const int width = 1 + _rnd.next() % layerWidth;
+			// Start near the right edge, so that most rows wrap around,
+			// and now and then past it, where the rows do not
+			const int x = (i % 10) ? _rnd.next() % layerWidth : layerWidth + _rnd.next() % 16;
+
+			Common::Array<byte> src(width);
+			for (int j = 0; j < width; j++)
+				src[j] = _rnd.next() & 0xFF;
+
+			// As the layer row was written pixel by pixel before
+			const int layerSize = MAX(layerWidth, x + width);
+			Common::Array<byte> row(layerSize), expected;
+			Common::Array<uint16> row16(layerSize), expected16;
+			for (int j = 0; j < layerSize; j++) {
+				row[j] = _rnd.next() & 0xFF;
+				row16[j] = _rnd.next() & 0xFFFF;
+			}
+			expected = row;
+			expected16 = row16;
+			for (int j = 0, pos = x; j < width; j++) {
+				expected[pos] = src[j];
+				expected16[pos] = palette[src[j]];
+				if (++pos == layerWidth)
+					pos = 0;
+			}
+
+			Scumm::copyTownsLayerRow(&row[x], &src[0], width, x, layerWidth);
+			Scumm::copyTownsLayerRow16(&row16[x], &src[0], width, x, layerWidth, &palette[0]);
+			TS_ASSERT(row == expected);
+			TS_ASSERT(row16 == expected16);
+		}
+	}
+};
@@ -0,0 +1,479 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/endian.h"
+#include "engines/scumm/gfx_strips.h"
+
+#include "../../helpers.h"
+
+/**
+ * The strip codecs as they were before they drew runs of pixels, to check
+ * the current ones against.
+ */
+class ReferenceStripCodecs {
+public:
+	byte _bytesPerPixel;
+	byte _paletteMod;
+	byte *_roomPalette;
+	byte _transparentColor;
+	byte _decomp_shr, _decomp_mask;
+	uint32 _vertStripNextInc;
+	const uint16 *_palette16;
+
+	void drawStripEGA(byte *dst, int dstPitch, const byte *src, int height) const;
+	void drawStripComplex(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
+	void drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
+	void drawStripBasicV(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
+	void drawStripHE(byte *dst, int dstPitch, const byte *src, int width, int height, const bool transpCheck) const;
+
+	void writeRoomColor(byte *dst, byte color) const {
+		if (_bytesPerPixel == 2)
+			WRITE_UINT16(dst, _palette16[color]);
+		else
+			*dst = _roomPalette[(color + _paletteMod) & 0xFF];
+	}
+};
+
+void ReferenceStripCodecs::drawStripEGA(byte *dst, int dstPitch, const byte *src, int height) const {
+	byte color = 0;
+	int run = 0, x = 0, y = 0, z;
+
+	while (x < 8) {
+		color = *src++;
+
+		if (color & 0x80) {
+			run = color & 0x3f;
+
+			if (color & 0x40) {
+				color = *src++;
+
+				if (run == 0) {
+					run = *src++;
+				}
+				for (z = 0; z < run; z++) {
+					*(dst + y * dstPitch + x) = (z & 1) ? _roomPalette[(color & 0xf) + _paletteMod] : _roomPalette[(color >> 4) + _paletteMod];
+
+					y++;
+					if (y >= height) {
+						y = 0;
+						x++;
+					}
+				}
+			} else {
+				if (run == 0) {
+					run = *src++;
+				}
+
+				for (z = 0; z < run; z++) {
+					*(dst + y * dstPitch + x) = *(dst + y * dstPitch + x - 1);
+
+					y++;
+					if (y >= height) {
+						y = 0;
+						x++;
+					}
+				}
+			}
+		} else {
+			run = color >> 4;
+			if (run == 0) {
+				run = *src++;
+			}
+
+			for (z = 0; z < run; z++) {
+				*(dst + y * dstPitch + x) = _roomPalette[(color & 0xf) + _paletteMod];
+
+				y++;
+				if (y >= height) {
+					y = 0;
+					x++;
+				}
+			}
+		}
+	}
+}
+
+#define READ_BIT (shift--, dataBit = data & 1, data >>= 1, dataBit)
+#define FILL_BITS(n) do {            \
+		if (shift < n) {             \
+			data |= *src++ << shift; \
+			shift += 8;              \
+		}                            \
+	} while (0)
+
+// NOTE: drawStripHE is actually very similar to drawStripComplex
+void ReferenceStripCodecs::drawStripHE(byte *dst, int dstPitch, const byte *src, int width, int height, const bool transpCheck) const {
+	static const int delta_color[] = { -4, -3, -2, -1, 1, 2, 3, 4 };
+	uint32 dataBit, data;
+	byte color;
+	int shift;
+
+	color = *src++;
+	data = READ_LE_UINT24(src);
+	src += 3;
+	shift = 24;
+
+	int x = width;
+	while (1) {
+		if (!transpCheck || color != _transparentColor)
+			writeRoomColor(dst, color);
+		dst += _bytesPerPixel;
+		--x;
+		if (x == 0) {
+			x = width;
+			dst += dstPitch - width * _bytesPerPixel;
+			--height;
+			if (height == 0)
+				return;
+		}
+		FILL_BITS(1);
+		if (READ_BIT) {
+			FILL_BITS(1);
+			if (READ_BIT) {
+				FILL_BITS(3);
+				color += delta_color[data & 7];
+				shift -= 3;
+				data >>= 3;
+			} else {
+				FILL_BITS(_decomp_shr);
+				color = data & _decomp_mask;
+				shift -= _decomp_shr;
+				data >>= _decomp_shr;
+			}
+		}
+	}
+}
+
+#undef READ_BIT
+#undef FILL_BITS
+
+#define READ_BIT (cl--, bit = bits & 1, bits >>= 1, bit)
+#define FILL_BITS do {              \
+		if (cl <= 8) {              \
+			bits |= (*src++ << cl); \
+			cl += 8;                \
+		}                           \
+	} while (0)
+
+void ReferenceStripCodecs::drawStripComplex(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
+	byte color = *src++;
+	uint bits = *src++;
+	byte cl = 8;
+	byte bit;
+	byte incm, reps;
+
+	do {
+		int x = 8;
+		do {
+			FILL_BITS;
+			if (!transpCheck || color != _transparentColor)
+				writeRoomColor(dst, color);
+			dst += _bytesPerPixel;
+
+		againPos:
+			if (!READ_BIT) {
+			} else if (!READ_BIT) {
+				FILL_BITS;
+				color = bits & _decomp_mask;
+				bits >>= _decomp_shr;
+				cl -= _decomp_shr;
+			} else {
+				incm = (bits & 7) - 4;
+				cl -= 3;
+				bits >>= 3;
+				if (incm) {
+					color += incm;
+				} else {
+					FILL_BITS;
+					reps = bits & 0xFF;
+					do {
+						if (!--x) {
+							x = 8;
+							dst += dstPitch - 8 * _bytesPerPixel;
+							if (!--height)
+								return;
+						}
+						if (!transpCheck || color != _transparentColor)
+							writeRoomColor(dst, color);
+						dst += _bytesPerPixel;
+					} while (--reps);
+					bits >>= 8;
+					bits |= (*src++) << (cl - 8);
+					goto againPos;
+				}
+			}
+		} while (--x);
+		dst += dstPitch - 8 * _bytesPerPixel;
+	} while (--height);
+}
+
+void ReferenceStripCodecs::drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
+	byte color = *src++;
+	uint bits = *src++;
+	byte cl = 8;
+	byte bit;
+	int8 inc = -1;
+
+	do {
+		int x = 8;
+		do {
+			FILL_BITS;
+			if (!transpCheck || color != _transparentColor)
+				writeRoomColor(dst, color);
+			dst += _bytesPerPixel;
+			if (!READ_BIT) {
+			} else if (!READ_BIT) {
+				FILL_BITS;
+				color = bits & _decomp_mask;
+				bits >>= _decomp_shr;
+				cl -= _decomp_shr;
+				inc = -1;
+			} else if (!READ_BIT) {
+				color += inc;
+			} else {
+				inc = -inc;
+				color += inc;
+			}
+		} while (--x);
+		dst += dstPitch - 8 * _bytesPerPixel;
+	} while (--height);
+}
+
+void ReferenceStripCodecs::drawStripBasicV(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
+	byte color = *src++;
+	uint bits = *src++;
+	byte cl = 8;
+	byte bit;
+	int8 inc = -1;
+
+	int x = 8;
+	do {
+		int h = height;
+		do {
+			FILL_BITS;
+			if (!transpCheck || color != _transparentColor)
+				writeRoomColor(dst, color);
+			dst += dstPitch;
+			if (!READ_BIT) {
+			} else if (!READ_BIT) {
+				FILL_BITS;
+				color = bits & _decomp_mask;
+				bits >>= _decomp_shr;
+				cl -= _decomp_shr;
+				inc = -1;
+			} else if (!READ_BIT) {
+				color += inc;
+			} else {
+				inc = -inc;
+				color += inc;
+			}
+		} while (--h);
+		dst -= _vertStripNextInc;
+	} while (--x);
+}
+
+#undef READ_BIT
+#undef FILL_BITS
+
+/** The current codecs, with the pixels written as GdiHE16bit does for 16 bit pixels. */
+class TestStripCodecs : public Scumm::StripCodecs {
+public:
+	const uint16 *_palette16;
+
+	void setState(const ReferenceStripCodecs &state) {
+		_bytesPerPixel = state._bytesPerPixel;
+		_paletteMod = state._paletteMod;
+		_roomPalette = state._roomPalette;
+		_transparentColor = state._transparentColor;
+		_decomp_shr = state._decomp_shr;
+		_decomp_mask = state._decomp_mask;
+		_vertStripNextInc = state._vertStripNextInc;
+		_palette16 = state._palette16;
+	}
+
+	using Scumm::StripCodecs::drawStripEGA;
+	using Scumm::StripCodecs::drawStripComplex;
+	using Scumm::StripCodecs::drawStripBasicH;
+	using Scumm::StripCodecs::drawStripBasicV;
+	using Scumm::StripCodecs::drawStripHE;
+
+protected:
+	void writeRoomColor(byte *dst, byte color) const override {
+		if (_bytesPerPixel == 2)
+			WRITE_UINT16(dst, _palette16[color]);
+		else
+			Scumm::StripCodecs::writeRoomColor(dst, color);
+	}
+
+	void writeRoomColors(byte *dst, byte color, int count) const override {
+		if (_bytesPerPixel == 2) {
+			for (int i = 0; i < count; i++)
+				WRITE_UINT16(dst + i * 2, _palette16[color]);
+		} else {
+			Scumm::StripCodecs::writeRoomColors(dst, color, count);
+		}
+	}
+};
+
+class ScummStripsTestSuite : public CxxTest::TestSuite {
+	enum {
+		kNumStreams = 300,
+		// Room for the columns drawn past the strip by the last EGA run
+		kEGAPitch = 1 + 8 + 256 + 8
+	};
+
+	enum Codec {
+		kCodecEGA,
+		kCodecComplex,
+		kCodecBasicH,
+		kCodecBasicV,
+		kCodecHE
+	};
+
+	TestRandom _rnd;
+	byte _roomPalette[256 + 16];
+	uint16 _palette16[256];
+
+	/**
+	 * Random bits, with many zero bytes for the runs of the same color,
+	 * and long ones now and then.
+	 */
+	void randomBits(Common::Array<byte> &data, uint size) {
+		data.resize(size);
+		for (uint i = 0; i < size; ) {
+			const uint kind = _rnd.next() % 8;
+			uint n = (kind == 0) ? 1 + _rnd.next() % 40 : 1;
+			for (; n > 0 && i < size; n--, i++)
+				data[i] = (kind < 3) ? 0 : _rnd.next() & 0xFF;
+		}
+	}
+
+	/** EGA runs which cover the strip, with some past its end. */
+	void randomEGARuns(Common::Array<byte> &data, int height) {
+		data.clear();
+		for (int pixels = 0; pixels < 8 * height + 16; ) {
+			const uint kind = _rnd.next() % 3;
+			int run = 1 + _rnd.next() % ((_rnd.next() % 4) ? 15 : 255);
+			const byte color = _rnd.next() & 0xFF;
+
+			if (kind == 0 && run < 16) {
+				data.push_back((run << 4) | (color & 0xF));
+			} else if (kind == 0) {
+				data.push_back(color & 0xF);
+				data.push_back(run);
+			} else {
+				const byte flags = (kind == 1) ? 0xC0 : 0x80;
+				data.push_back(flags | ((run < 64) ? run : 0));
+				if (kind == 1)
+					data.push_back(color);
+				if (run >= 64)
+					data.push_back(run);
+			}
+			pixels += run;
+		}
+	}
+
+	void check(Codec codec, int bytesPerPixel, bool transpCheck) {
+		for (int i = 0; i < kNumStreams; i++) {
+			ReferenceStripCodecs reference;
+			reference._bytesPerPixel = bytesPerPixel;
+			reference._paletteMod = (i % 3) ? 0 : _rnd.next() & 0xFF;
+			reference._roomPalette = _roomPalette;
+			reference._decomp_shr = 4 + _rnd.next() % 5;
+			reference._decomp_mask = 0xFF >> (8 - reference._decomp_shr);
+			reference._transparentColor = _rnd.next() & reference._decomp_mask;
+			reference._palette16 = _palette16;
+
+			const int height = 1 + _rnd.next() % ((i % 4) ? 16 : 200);
+			const int width = (codec == kCodecHE) ? 1 + _rnd.next() % 24 : 8;
+			int pitch = (width + _rnd.next() % 8) * bytesPerPixel;
+			int offset = 0;
+
+			Common::Array<byte> src;
+			if (codec == kCodecEGA) {
+				pitch = kEGAPitch;
+				// The first column may copy the pixels on its left
+				offset = 1;
+				randomEGARuns(src, height);
+			} else {
+				// Even a pixel per bit leaves the streams some bits to spare
+				randomBits(src, 4 + width * height * 2 + 64);
+			}
+			reference._vertStripNextInc = height * pitch - 1 * bytesPerPixel;
+
+			TestStripCodecs codecs;
+			codecs.setState(reference);
+
+			Common::Array<byte> expected(pitch * height), actual;
+			for (uint j = 0; j < expected.size(); j++)
+				expected[j] = _rnd.next() & 0xFF;
+			actual = expected;
+
+			switch (codec) {
+			case kCodecEGA:
+				reference.drawStripEGA(&expected[offset], pitch, &src[0], height);
+				codecs.drawStripEGA(&actual[offset], pitch, &src[0], height);
+				break;
+			case kCodecComplex:
+				reference.drawStripComplex(&expected[0], pitch, &src[0], height, transpCheck);
+				codecs.drawStripComplex(&actual[0], pitch, &src[0], height, transpCheck);
+				break;
+			case kCodecBasicH:
+				reference.drawStripBasicH(&expected[0], pitch, &src[0], height, transpCheck);
+				codecs.drawStripBasicH(&actual[0], pitch, &src[0], height, transpCheck);
+				break;
+			case kCodecBasicV:
+				reference.drawStripBasicV(&expected[0], pitch, &src[0], height, transpCheck);
+				codecs.drawStripBasicV(&actual[0], pitch, &src[0], height, transpCheck);
+				break;
+			case kCodecHE:
+				reference.drawStripHE(&expected[0], pitch, &src[0], width, height, transpCheck);
+				codecs.drawStripHE(&actual[0], pitch, &src[0], width, height, transpCheck);
+				break;
+			}
+
+			TS_ASSERT(expected == actual);
+		}
+	}
+
+public:
+	void setUp() {
+		_rnd.setSeed(1234);
+		for (int i = 0; i < ARRAYSIZE(_roomPalette); i++)
+			_roomPalette[i] = _rnd.next() & 0xFF;
+		for (int i = 0; i < ARRAYSIZE(_palette16); i++)
+			_palette16[i] = _rnd.next() & 0xFFFF;
+	}
+
+	void test_ega() {
+		check(kCodecEGA, 1, false);
+	}
+
+	void test_complex() {
+		for (int bytesPerPixel = 1; bytesPerPixel <= 2; bytesPerPixel++) {
+			check(kCodecComplex, bytesPerPixel, false);
+			check(kCodecComplex, bytesPerPixel, true);
+		}
+	}
+
+	void test_basicH() {
+		for (int bytesPerPixel = 1; bytesPerPixel <= 2; bytesPerPixel++) {
+			check(kCodecBasicH, bytesPerPixel, false);
+			check(kCodecBasicH, bytesPerPixel, true);
+		}
+	}
+
+	void test_basicV() {
+		for (int bytesPerPixel = 1; bytesPerPixel <= 2; bytesPerPixel++) {
+			check(kCodecBasicV, bytesPerPixel, false);
+			check(kCodecBasicV, bytesPerPixel, true);
+		}
+	}
+
+	void test_he() {
+		for (int bytesPerPixel = 1; bytesPerPixel <= 2; bytesPerPixel++) {
+			check(kCodecHE, bytesPerPixel, false);
+			check(kCodecHE, bytesPerPixel, true);
+		}
+	}
+};
@@ -0,0 +1,196 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/system.h"
+#include "graphics/scalerplugin.h"
+#include "graphics/scaler/kernels.h"
+#include "graphics/scaler/threadpool.h"
+
+#include "../helpers.h"
+#include "../null_osystem.h"
+
+#define DECLARE_SCALER_PLUGIN(ID) \
+	extern PluginObject *g_##ID##_getObject();
+
+DECLARE_SCALER_PLUGIN(NORMAL)
+#ifdef USE_SCALERS
+#ifdef USE_HQ_SCALERS
+DECLARE_SCALER_PLUGIN(HQ)
+#endif
+#ifdef USE_EDGE_SCALERS
+DECLARE_SCALER_PLUGIN(EDGE)
+#endif
+DECLARE_SCALER_PLUGIN(ADVMAME)
+DECLARE_SCALER_PLUGIN(SAI)
+DECLARE_SCALER_PLUGIN(SUPERSAI)
+DECLARE_SCALER_PLUGIN(SUPEREAGLE)
+DECLARE_SCALER_PLUGIN(PM)
+DECLARE_SCALER_PLUGIN(DOTMATRIX)
+DECLARE_SCALER_PLUGIN(TV)
+#endif
+
+static const Graphics::PixelFormat kFormats[] = {
+	Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+	Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+};
+
+class ScalerTestSuite : public CxxTest::TestSuite {
+	TestRandom _rnd;
+
+	void createPlugins(Common::Array<PluginObject *> &plugins) {
+#define ADD_SCALER_PLUGIN(ID) \
+		plugins.push_back(g_##ID##_getObject());
+
+		ADD_SCALER_PLUGIN(NORMAL)
+#ifdef USE_SCALERS
+#ifdef USE_HQ_SCALERS
+		ADD_SCALER_PLUGIN(HQ)
+#endif
+#ifdef USE_EDGE_SCALERS
+		ADD_SCALER_PLUGIN(EDGE)
+#endif
+		ADD_SCALER_PLUGIN(ADVMAME)
+		ADD_SCALER_PLUGIN(SAI)
+		ADD_SCALER_PLUGIN(SUPERSAI)
+		ADD_SCALER_PLUGIN(SUPEREAGLE)
+		ADD_SCALER_PLUGIN(PM)
+		ADD_SCALER_PLUGIN(DOTMATRIX)
+		ADD_SCALER_PLUGIN(TV)
+#endif
+#undef ADD_SCALER_PLUGIN
+	}
+
+	/** A YUV value close to base, so that all thresholds of diffYUV() get hit. */
+	uint32 randomYUV(uint32 base) {
+		uint32 yuv = 0;
+		for (int shift = 0; shift < 24; shift += 8) {
+			const int component = (int)((base >> shift) & 0xFF) + (int)(_rnd.next() % 0x70) - 0x38;
+			yuv |= (uint32)CLIP(component, 0, 255) << shift;
+		}
+		return yuv;
+	}
+
+	void checkKernels(const char *name, const ScalerKernels &kernels) {
+		const ScalerKernels &scalar = getScalarScalerKernels();
+		const int maxWidth = 67;
+
+		uint32 rows[3][maxWidth + 2];
+		uint8 expected[maxWidth], actual[maxWidth];
+		for (int width = 1; width <= maxWidth; width += 3) {
+			const uint32 base = _rnd.next() & 0xFFFFFF;
+			for (int i = 0; i < 3; i++)
+				for (int x = 0; x < width + 2; x++)
+					rows[i][x] = randomYUV(base);
+
+			scalar.hqPatterns(expected, rows[0], rows[1], rows[2], width);
+			kernels.hqPatterns(actual, rows[0], rows[1], rows[2], width);
+			for (int x = 0; x < width; x++)
+				TSM_ASSERT_EQUALS(name, actual[x], expected[x]);
+		}
+
+		uint16 pixels16[3][maxWidth + 2];
+		uint32 pixels32[3][maxWidth + 2];
+		for (int width = 1; width <= maxWidth; width += 3) {
+			// Mostly uniform pixels with a few odd ones
+			for (int i = 0; i < 3; i++) {
+				for (int x = 0; x < width + 2; x++) {
+					const uint32 value = (_rnd.next() % 8) ? 0x1234 : _rnd.next();
+					pixels16[i][x] = value;
+					pixels32[i][x] = (_rnd.next() % 8) ? value : value | 0x10000;
+				}
+			}
+
+			scalar.solidMask16(expected, (const byte *)&pixels16[1][1], sizeof(pixels16[0]), width);
+			kernels.solidMask16(actual, (const byte *)&pixels16[1][1], sizeof(pixels16[0]), width);
+			for (int x = 0; x < width; x++)
+				TSM_ASSERT_EQUALS(name, actual[x] != 0, expected[x] != 0);
+
+			scalar.solidMask32(expected, (const byte *)&pixels32[1][1], sizeof(pixels32[0]), width);
+			kernels.solidMask32(actual, (const byte *)&pixels32[1][1], sizeof(pixels32[0]), width);
+			for (int x = 0; x < width; x++)
+				TSM_ASSERT_EQUALS(name, actual[x] != 0, expected[x] != 0);
+		}
+	}
+
+	/** Fill a surface with flat areas, gradients and noise, like a game screen. */
+	void fillScreen(byte *pixels, uint pitch, int width, int height, const Graphics::PixelFormat &format) {
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				uint32 color;
+				if (y < height / 2)
+					color = format.RGBToColor(x * 255 / width, 0x40, y * 255 / height);
+				else if (x < width / 2)
+					color = format.RGBToColor(((x / 16) & 1) ? 0xFF : 0, 0x80, 0x20);
+				else
+					color = format.RGBToColor(_rnd.next() & 0xFF, _rnd.next() & 0xFF, _rnd.next() & 0xFF);
+
+				if (format.bytesPerPixel == 2)
+					*(uint16 *)(pixels + y * pitch + x * 2) = color;
+				else
+					*(uint32 *)(pixels + y * pitch + x * 4) = color;
+			}
+		}
+	}
+
+	void checkThreadPool(ScalerThreadPool &pool, const ScalerPluginObject &plugin, uint factor, const Graphics::PixelFormat &format) {
+		// An odd size, so that the bands differ in height
+		const int width = 97;
+		const int height = 61;
+		const int padding = plugin.extraPixels();
+
+		const uint srcPitch = (width + padding * 2) * format.bytesPerPixel;
+		const uint dstPitch = width * factor * format.bytesPerPixel;
+		const uint dstSize = dstPitch * height * factor;
+		byte *src = new byte[srcPitch * (height + padding * 2)];
+		byte *expected = new byte[dstSize];
+		byte *actual = new byte[dstSize];
+		fillScreen(src, srcPitch, width + padding * 2, height + padding * 2, format);
+		memset(expected, 0, dstSize);
+		memset(actual, 0, dstSize);
+
+		Scaler *scaler = plugin.createInstance(format);
+		scaler->setFactor(factor);
+
+		const byte *srcStart = src + padding * srcPitch + padding * format.bytesPerPixel;
+		scaler->scale(srcStart, srcPitch, expected, dstPitch, width, height, 3, 5);
+		pool.scale(scaler, srcStart, srcPitch, actual, dstPitch, width, height, 3, 5, 4);
+		TSM_ASSERT(plugin.getName(), !memcmp(actual, expected, dstSize));
+
+		delete scaler;
+		delete[] actual;
+		delete[] expected;
+		delete[] src;
+	}
+
+public:
+	void test_threadPool() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+		ScalerThreadPool pool(3);
+
+		Common::Array<PluginObject *> plugins;
+		createPlugins(plugins);
+
+		for (uint i = 0; i < plugins.size(); i++) {
+			const ScalerPluginObject &plugin = *(const ScalerPluginObject *)plugins[i];
+			if (!plugin.useOldSource()) {
+				const Common::Array<uint> &factors = plugin.getFactors();
+				for (uint j = 0; j < factors.size(); j++) {
+					for (uint k = 0; k < ARRAYSIZE(kFormats); k++)
+						checkThreadPool(pool, plugin, factors[j], kFormats[k]);
+				}
+			}
+			delete plugins[i];
+		}
+	}
+
+	void test_kernels() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+		checkKernels("scalar", getScalarScalerKernels());
+		checkKernels("default", getScalerKernels());
+		CHECK_SIMD_KERNELS(checkKernels, get, ScalerKernels);
+	}
+
+};
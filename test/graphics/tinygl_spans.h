@@ -0,0 +1,150 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/system.h"
+#include "graphics/tinygl/tinygl.h"
+#include "graphics/tinygl/zgl.h"
+#include "graphics/tinygl/zspan.h"
+
+#include "../helpers.h"
+#include "../null_osystem.h"
+
+static const TGLenum kSpanDepthFuncs[] = {
+	TGL_LESS, TGL_LEQUAL, TGL_GREATER, TGL_GEQUAL, TGL_EQUAL, TGL_NOTEQUAL, TGL_ALWAYS, TGL_NEVER
+};
+
+class TinyGLSpansTestSuite : public CxxTest::TestSuite {
+	enum {
+		kWidth = 123,
+		kHeight = 77,
+		kTextureSize = 16,
+		kNumTriangles = 12,
+		kNumFrames = 3
+	};
+
+	TestRandom _rnd;
+
+	float nextCoordinate() {
+		return (float)(_rnd.next() % 2001) / 1000.0f - 1.0f;
+	}
+
+	struct Frame {
+		Common::Array<uint32> pixels;
+		Common::Array<uint> depths;
+	};
+
+	/**
+	 * Draw random overlapping triangles, smooth, flat and textured, with
+	 * a depth only pass first. The triangle moved changes between frames,
+	 * so that only its region is drawn again with dirty rectangles.
+	 */
+	void drawScene(uint32 seed, float clearGray, TGLenum depthFunc, TGLuint texture, int moved) {
+		_rnd.setSeed(seed);
+
+		tglClearColor(clearGray, clearGray, clearGray, 1.0f);
+		tglClearDepth(0.5f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+		tglEnable(TGL_DEPTH_TEST);
+
+		for (int i = 0; i < kNumTriangles; i++) {
+			const int kind = i % 4;
+			tglDepthFunc(kind == 0 ? TGL_LESS : depthFunc);
+			tglDepthMask((i % 5) ? TGL_TRUE : TGL_FALSE);
+			tglColorMask(kind != 0, kind != 0, kind != 0, kind != 0);
+			tglShadeModel(kind == 2 ? TGL_FLAT : TGL_SMOOTH);
+			if (kind == 3) {
+				tglEnable(TGL_TEXTURE_2D);
+				tglBindTexture(TGL_TEXTURE_2D, texture);
+			} else {
+				tglDisable(TGL_TEXTURE_2D);
+			}
+
+			const float offset = (i == moved) ? 0.3f : 0.0f;
+			tglBegin(TGL_TRIANGLES);
+			for (int j = 0; j < 3; j++) {
+				tglColor4ub(_rnd.next() & 0xFF, _rnd.next() & 0xFF, _rnd.next() & 0xFF, _rnd.next() & 0xFF);
+				tglTexCoord2f(nextCoordinate() * 2.0f, nextCoordinate() * 2.0f);
+				tglVertex3f(nextCoordinate() + offset, nextCoordinate(), nextCoordinate());
+			}
+			tglEnd();
+		}
+
+		tglColorMask(TGL_TRUE, TGL_TRUE, TGL_TRUE, TGL_TRUE);
+		tglDepthMask(TGL_TRUE);
+		tglDisable(TGL_TEXTURE_2D);
+		TinyGL::presentBuffer();
+	}
+
+	TGLuint createTexture() {
+		Common::Array<byte> texels(kTextureSize * kTextureSize * 4);
+		for (uint i = 0; i < texels.size(); i++)
+			texels[i] = _rnd.next() & 0xFF;
+
+		TGLuint texture;
+		tglGenTextures(1, &texture);
+		tglBindTexture(TGL_TEXTURE_2D, texture);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, TGL_NEAREST);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, TGL_NEAREST);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_WRAP_S, TGL_REPEAT);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_WRAP_T, TGL_REPEAT);
+		tglTexImage2D(TGL_TEXTURE_2D, 0, TGL_RGBA, kTextureSize, kTextureSize, 0, TGL_RGBA, TGL_UNSIGNED_BYTE, &texels[0]);
+		return texture;
+	}
+
+	/**
+	 * Render a first frame with another clear color, so that the next one
+	 * is drawn whole, then a frame with one triangle moved.
+	 */
+	void render(Common::Array<Frame> &frames, const TinyGL::SpanKernels *kernels, bool dirtyRects, TGLenum depthFunc, uint32 seed) {
+		TinyGL::createContext(kWidth, kHeight, Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24), 256, false, dirtyRects);
+		TinyGL::FrameBuffer *fb = TinyGL::gl_get_context()->fb;
+		fb->setSpanKernels(kernels);
+
+		_rnd.setSeed(seed);
+		const TGLuint texture = createTexture();
+
+		static const float kClearGrays[kNumFrames] = { 0.25f, 0.0f, 0.0f };
+		static const int kMoved[kNumFrames] = { -1, -1, 5 };
+		frames.resize(kNumFrames);
+		for (int i = 0; i < kNumFrames; i++) {
+			drawScene(seed, kClearGrays[i], depthFunc, texture, kMoved[i]);
+
+			const uint32 *pixels = (const uint32 *)fb->getPixelBuffer();
+			frames[i].pixels = Common::Array<uint32>(pixels, kWidth * kHeight);
+			frames[i].depths = Common::Array<uint>(fb->getZBuffer(), kWidth * kHeight);
+		}
+
+		tglDeleteTextures(1, &texture);
+		TinyGL::destroyContext();
+	}
+
+	void checkKernels(const char *name, const TinyGL::SpanKernels *kernels) {
+		for (int dirtyRects = 0; dirtyRects < 2; dirtyRects++) {
+			for (int i = 0; i < ARRAYSIZE(kSpanDepthFuncs); i++) {
+				const uint32 seed = 4321 + i;
+				Common::Array<Frame> expected, actual;
+				render(expected, nullptr, dirtyRects, kSpanDepthFuncs[i], seed);
+				render(actual, kernels, dirtyRects, kSpanDepthFuncs[i], seed);
+
+				for (int j = 0; j < kNumFrames; j++) {
+					TSM_ASSERT(name, expected[j].pixels == actual[j].pixels);
+					TSM_ASSERT(name, expected[j].depths == actual[j].depths);
+				}
+			}
+		}
+	}
+
+public:
+	void test_span_kernels() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		CHECK_SIMD_KERNELS(checkKernels, TinyGL::get, SpanKernels);
+#endif
+	}
+};
@@ -0,0 +1,157 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/system.h"
+#include "graphics/surface.h"
+#include "graphics/tinygl/tinygl.h"
+#include "graphics/tinygl/zgl.h"
+
+#include "../null_osystem.h"
+
+class TinyGLTilesTestSuite : public CxxTest::TestSuite {
+	enum {
+		kWidth = 160,
+		kHeight = 131,
+		kNumFrames = 4,
+		kGridSize = 8
+	};
+
+	struct Frame {
+		Common::Array<uint32> pixels;
+		Common::Array<uint> depths;
+	};
+
+	static void drawCube(float x, float y, float z, float angleX, float angleY, float angleZ) {
+		static const float kVertices[6][4][3] = {
+			{ { -1, -1,  1 }, {  1, -1,  1 }, {  1,  1,  1 }, { -1,  1,  1 } },
+			{ {  1, -1, -1 }, { -1, -1, -1 }, { -1,  1, -1 }, {  1,  1, -1 } },
+			{ {  1, -1,  1 }, {  1, -1, -1 }, {  1,  1, -1 }, {  1,  1,  1 } },
+			{ { -1, -1, -1 }, { -1, -1,  1 }, { -1,  1,  1 }, { -1,  1, -1 } },
+			{ { -1,  1,  1 }, {  1,  1,  1 }, {  1,  1, -1 }, { -1,  1, -1 } },
+			{ { -1, -1, -1 }, {  1, -1, -1 }, {  1, -1,  1 }, { -1, -1,  1 } }
+		};
+
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+		tglTranslatef(x, y, -z);
+		tglRotatef(angleX, 1.0f, 0.0f, 0.0f);
+		tglRotatef(angleY, 0.0f, 1.0f, 0.0f);
+		tglRotatef(angleZ, 0.0f, 0.0f, 1.0f);
+		tglScalef(0.5f, 0.5f, 0.5f);
+
+		for (int i = 0; i < 6; i++) {
+			tglBegin(TGL_TRIANGLE_FAN);
+			for (int j = 0; j < 4; j++) {
+				// Smooth shading across the face
+				tglColor3f((i & 1) ? 1.0f : 0.2f * j, (i & 2) ? 1.0f : 0.3f * j, (i & 4) ? 1.0f : 0.1f * j);
+				tglVertex3f(kVertices[i][j][0], kVertices[i][j][1], kVertices[i][j][2]);
+			}
+			tglEnd();
+		}
+	}
+
+	/**
+	 * Draw the cube grid of playground3d test 6, a half transparent overlay
+	 * and a tinted blit crossing several bands.
+	 */
+	static void drawScene(int frame, TinyGL::BlitImage *image) {
+		tglClearColor(0.5f, 0.5f, 0.5f, 1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglFrustum(-1.0f, 1.0f, -0.8f, 0.8f, 1.0f, 100.0f);
+		tglEnable(TGL_DEPTH_TEST);
+		tglDepthMask(TGL_TRUE);
+
+		for (int y = 0; y < kGridSize; y++) {
+			for (int x = 0; x < kGridSize; x++) {
+				drawCube(1.5f * (x - (kGridSize - 1) * 0.5f), 1.2f * (y - (kGridSize - 1) * 0.5f), 6.0f + (x + y) % 3,
+				         10.0f * frame + 10 * x, 20.0f * frame + 10 * y, 4.0f * frame);
+			}
+		}
+
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+		tglEnable(TGL_BLEND);
+		tglBlendFunc(TGL_ONE, TGL_ONE_MINUS_SRC_ALPHA);
+		tglDisable(TGL_DEPTH_TEST);
+		tglDepthMask(TGL_FALSE);
+
+		tglColor4f(0.0f, 0.0f, 0.0f, 0.4f);
+		tglBegin(TGL_TRIANGLE_STRIP);
+		tglVertex3f(-0.9f, 0.7f, 0.0f);
+		tglVertex3f(0.2f, 0.9f, 0.0f);
+		tglVertex3f(-0.6f, -0.8f, 0.0f);
+		tglVertex3f(0.4f, -0.5f, 0.0f);
+		tglEnd();
+
+		tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+		TinyGL::BlitTransform transform(20 + 7 * frame, 10);
+		transform.tint(0.8f, 1.0f, 0.5f, 0.7f);
+		tglBlit(image, transform);
+
+		tglDisable(TGL_BLEND);
+		TinyGL::presentBuffer();
+	}
+
+	static TinyGL::BlitImage *createImage() {
+		Graphics::Surface surface;
+		surface.create(40, 100, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+		for (int y = 0; y < surface.h; y++) {
+			for (int x = 0; x < surface.w; x++) {
+				// Transparent holes, for the RLE blit
+				const byte alpha = ((x / 8 + y / 8) & 1) ? 0 : 200;
+				*(uint32 *)surface.getBasePtr(x, y) = surface.format.ARGBToColor(alpha, x * 6, y * 2, 255 - x * 3);
+			}
+		}
+
+		TinyGL::BlitImage *image = tglGenBlitImage();
+		tglUploadBlitImage(image, surface, 0, false);
+		surface.free();
+		return image;
+	}
+
+	static void render(Common::Array<Frame> &frames, bool dirtyRects, uint numThreads) {
+		TinyGL::createContext(kWidth, kHeight, Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24), 256, false, dirtyRects);
+		TinyGL::setRasterizationThreads(numThreads);
+		TinyGL::FrameBuffer *fb = TinyGL::gl_get_context()->fb;
+		TinyGL::BlitImage *image = createImage();
+
+		frames.resize(kNumFrames);
+		for (int i = 0; i < kNumFrames; i++) {
+			drawScene(i, image);
+
+			const uint32 *pixels = (const uint32 *)fb->getPixelBuffer();
+			frames[i].pixels = Common::Array<uint32>(pixels, kWidth * kHeight);
+			frames[i].depths = Common::Array<uint>(fb->getZBuffer(), kWidth * kHeight);
+		}
+
+		tglDeleteBlitImage(image);
+		TinyGL::destroyContext();
+	}
+
+public:
+	void test_tiled_matches_serial() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		for (int dirtyRects = 0; dirtyRects < 2; dirtyRects++) {
+			Common::Array<Frame> expected;
+			render(expected, dirtyRects, 0);
+
+			for (uint numThreads = 1; numThreads <= 3; numThreads++) {
+				Common::Array<Frame> actual;
+				render(actual, dirtyRects, numThreads);
+
+				for (int i = 0; i < kNumFrames; i++) {
+					TS_ASSERT(expected[i].pixels == actual[i].pixels);
+					TS_ASSERT(expected[i].depths == actual[i].depths);
+				}
+			}
+		}
+#endif
+	}
+};
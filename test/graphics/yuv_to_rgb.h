@@ -0,0 +1,128 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/system.h"
+#include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_intern.h"
+
+#include "../helpers.h"
+#include "../null_osystem.h"
+
+static const Graphics::PixelFormat kYUVFormats[] = {
+	Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+	Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15),
+	Graphics::PixelFormat(2, 4, 4, 4, 4, 12, 8, 4, 0),
+	Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+	Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24),
+	Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0)
+};
+
+static const Graphics::YUVToRGBManager::LuminanceScale kYUVScales[] = {
+	Graphics::YUVToRGBManager::kScaleFull,
+	Graphics::YUVToRGBManager::kScaleITU
+};
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite {
+	TestRandom _rnd;
+
+	enum Layout {
+		kLayout444,
+		kLayout420,
+		kLayout420Alpha
+	};
+
+	/**
+	 * YUV planes with some padding. The first luminance values cover the
+	 * whole range, to check the clipping, the others are random. The
+	 * chroma planes hold every value, if they are large enough.
+	 */
+	struct Planes {
+		Common::Array<byte> y, u, v, a;
+		int width, height, yPitch, uvPitch;
+	};
+
+	void fillPlanes(Planes &planes, int width, int height, int chromaShift) {
+		planes.width = width;
+		planes.height = height;
+		planes.yPitch = width + 5;
+		planes.uvPitch = (width >> chromaShift) + 3;
+
+		const int chromaHeight = height >> chromaShift;
+		planes.y.resize(planes.yPitch * height);
+		planes.a.resize(planes.yPitch * height);
+		planes.u.resize(planes.uvPitch * chromaHeight);
+		planes.v.resize(planes.uvPitch * chromaHeight);
+
+		for (uint i = 0; i < planes.y.size(); i++) {
+			planes.y[i] = (i < 256) ? i : (_rnd.next() & 0xFF);
+			planes.a[i] = _rnd.next() & 0xFF;
+		}
+		const int chromaWidth = width >> chromaShift;
+		for (int y = 0; y < chromaHeight; y++) {
+			for (int x = 0; x < chromaWidth; x++) {
+				const int i = y * chromaWidth + x;
+				planes.u[y * planes.uvPitch + x] = i & 0xFF;
+				planes.v[y * planes.uvPitch + x] = (i * 97 + 13) & 0xFF;
+			}
+		}
+	}
+
+	void convert(Graphics::Surface &surface, const Planes &planes, Graphics::YUVToRGBManager::LuminanceScale scale, Layout layout) {
+		switch (layout) {
+		case kLayout444:
+			YUVToRGBMan.convert444(&surface, scale, planes.y.begin(), planes.u.begin(), planes.v.begin(), planes.width, planes.height, planes.yPitch, planes.uvPitch);
+			break;
+		case kLayout420:
+			YUVToRGBMan.convert420(&surface, scale, planes.y.begin(), planes.u.begin(), planes.v.begin(), planes.width, planes.height, planes.yPitch, planes.uvPitch);
+			break;
+		case kLayout420Alpha:
+			YUVToRGBMan.convert420Alpha(&surface, scale, planes.y.begin(), planes.u.begin(), planes.v.begin(), planes.a.begin(), planes.width, planes.height, planes.yPitch, planes.uvPitch);
+			break;
+		}
+	}
+
+	void checkKernels(const char *name, const Graphics::YUVToRGBKernels *kernels) {
+		const Layout layouts[] = { kLayout444, kLayout420, kLayout420Alpha };
+
+		for (uint i = 0; i < ARRAYSIZE(layouts); i++) {
+			// Odd sizes leave pixels for the scalar code, where allowed
+			const int width = (layouts[i] == kLayout444) ? 77 : 130;
+			const int height = (layouts[i] == kLayout444) ? 5 : 10;
+			Planes planes;
+			fillPlanes(planes, width, height, (layouts[i] == kLayout444) ? 0 : 1);
+
+			for (uint j = 0; j < ARRAYSIZE(kYUVFormats); j++) {
+				for (uint k = 0; k < ARRAYSIZE(kYUVScales); k++) {
+					Graphics::Surface expected, actual;
+					expected.create(width, height, kYUVFormats[j]);
+					actual.create(width, height, kYUVFormats[j]);
+
+					YUVToRGBMan.setKernels(nullptr);
+					convert(expected, planes, kYUVScales[k], layouts[i]);
+					YUVToRGBMan.setKernels(kernels);
+					convert(actual, planes, kYUVScales[k], layouts[i]);
+
+					for (int y = 0; y < height; y++)
+						TSM_ASSERT_SAME_DATA(name, actual.getBasePtr(0, y), expected.getBasePtr(0, y), width * kYUVFormats[j].bytesPerPixel);
+
+					expected.free();
+					actual.free();
+				}
+			}
+		}
+	}
+
+public:
+	void setUp() {
+		_rnd.setSeed(1);
+	}
+
+	void test_kernels() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+		CHECK_SIMD_KERNELS(checkKernels, Graphics::get, YUVToRGBKernels);
+		YUVToRGBMan.setKernels(Graphics::getYUVToRGBKernels());
+	}
+
+};
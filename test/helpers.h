@@ -0,0 +1,70 @@
+#ifndef TEST_HELPERS_H
+#define TEST_HELPERS_H
+
+#include "common/scummsys.h"
+#include "common/system.h"
+
+/**
+ * Reproducible random numbers for the test data. Unlike Common::RandomSource,
+ * it does not need g_system, and the same seed always gives the same data.
+ */
+class TestRandom {
+public:
+	TestRandom(uint32 seed = 1) : _seed(seed) {}
+
+	void setSeed(uint32 seed) { _seed = seed; }
+
+	/** @return 24 random bits, the upper ones of a linear congruential generator */
+	uint32 next() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	/** @return a random 16-bit sample */
+	int16 nextSample() { return (int16)(next() >> 8); }
+
+private:
+	uint32 _seed;
+};
+
+/**
+ * Call check(name, kernels) on every set of SIMD kernels which is built in
+ * and supported by the CPU. The kernels of an instruction set are returned
+ * by prefix<name>suffix(), e.g. CHECK_SIMD_KERNELS(checkKernels,
+ * Graphics::get, SpanKernels) checks Graphics::getSSE2SpanKernels().
+ */
+#define CHECK_SIMD_KERNELS(check, prefix, suffix) \
+	do { \
+		CHECK_SSE2_KERNELS(check, prefix##SSE2##suffix); \
+		CHECK_AVX2_KERNELS(check, prefix##AVX2##suffix); \
+		CHECK_NEON_KERNELS(check, prefix##NEON##suffix); \
+	} while (0)
+
+/** Call check("SSE2", getter()) if SSE2 kernels are built in and supported. */
+#ifdef SCUMMVM_SSE2
+#define CHECK_SSE2_KERNELS(check, getter) \
+	if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) \
+		check("SSE2", getter())
+#else
+#define CHECK_SSE2_KERNELS(check, getter)
+#endif
+
+/** Call check("AVX2", getter()) if AVX2 kernels are built in and supported. */
+#ifdef SCUMMVM_AVX2
+#define CHECK_AVX2_KERNELS(check, getter) \
+	if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) \
+		check("AVX2", getter())
+#else
+#define CHECK_AVX2_KERNELS(check, getter)
+#endif
+
+/** Call check("NEON", getter()) if NEON kernels are built in and supported. */
+#ifdef SCUMMVM_NEON
+#define CHECK_NEON_KERNELS(check, getter) \
+	if (g_system->hasFeature(OSystem::kFeatureCpuNEON)) \
+		check("NEON", getter())
+#else
+#define CHECK_NEON_KERNELS(check, getter)
+#endif
+
+#endif
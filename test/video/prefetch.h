@@ -0,0 +1,178 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/rect.h"
+#include "video/video_decoder.h"
+#include "graphics/surface.h"
+
+#include "../null_osystem.h"
+
+/**
+ * A video whose frames are filled with their number, read packet by packet
+ * as a real decoder would.
+ */
+class PrefetchTestDecoder : public Video::VideoDecoder {
+public:
+	PrefetchTestDecoder(bool prefetchable = true) : _prefetchable(prefetchable), _track(nullptr) {}
+	~PrefetchTestDecoder() override { close(); }
+
+	bool loadStream(Common::SeekableReadStream *stream) override { return false; }
+
+	void load(int frameCount) {
+		close();
+		_track = new PrefetchTestTrack(frameCount);
+		addTrack(_track);
+	}
+
+	void close() override {
+		VideoDecoder::close();
+		_track = nullptr;
+	}
+
+protected:
+	void readNextPacket() override {
+		if (!_track->endOfTrack())
+			_track->_packet = _track->getCurFrame() + 1;
+	}
+
+	bool canPrefetch() const override { return _prefetchable; }
+
+private:
+	class PrefetchTestTrack : public FixedRateVideoTrack {
+	public:
+		PrefetchTestTrack(int frameCount) : _packet(-1), _frameCount(frameCount), _curFrame(-1) {
+			_surface.create(8, 4, Graphics::PixelFormat::createFormatCLUT8());
+			memset(_palette, 0, sizeof(_palette));
+		}
+		~PrefetchTestTrack() override { _surface.free(); }
+
+		bool isSeekable() const override { return true; }
+		bool seek(const Audio::Timestamp &time) override {
+			_curFrame = getFrameAtTime(time) - 1;
+			_packet = -1;
+			return true;
+		}
+
+		uint16 getWidth() const override { return _surface.w; }
+		uint16 getHeight() const override { return _surface.h; }
+		Graphics::PixelFormat getPixelFormat() const override { return _surface.format; }
+		int getCurFrame() const override { return _curFrame; }
+		int getFrameCount() const override { return _frameCount; }
+
+		const Graphics::Surface *decodeNextFrame() override {
+			// Decoding a frame other than the packet read last would
+			// mean the stream and the track got out of step
+			if (_packet != _curFrame + 1)
+				return nullptr;
+
+			_curFrame = _packet;
+			_packet = -1;
+			_surface.fillRect(Common::Rect(_surface.w, _surface.h), _curFrame & 0xFF);
+			_palette[0] = _curFrame & 0xFF;
+			return &_surface;
+		}
+
+		const byte *getPalette() const override { return _palette; }
+		bool hasDirtyPalette() const override { return _curFrame % 10 == 0; }
+
+		int _packet;
+
+	protected:
+		Common::Rational getFrameRate() const override { return 25; }
+
+	private:
+		int _frameCount;
+		int _curFrame;
+		Graphics::Surface _surface;
+		byte _palette[3 * 256];
+	};
+
+	bool _prefetchable;
+	PrefetchTestTrack *_track;
+};
+
+class VideoPrefetchTestSuite : public CxxTest::TestSuite {
+public:
+	void test_prefetchMatchesSerial() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		PrefetchTestDecoder decoder;
+		decoder.setPrefetchFrames(3);
+		decoder.load(30);
+		checkFrames(decoder, 0, 30);
+
+		TS_ASSERT(decoder.endOfVideo());
+		TS_ASSERT(!decoder.decodeNextFrame());
+
+		if (decoder.getPrefetchFrames()) {
+			// Thread support is available
+			TS_ASSERT_EQUALS(decoder.getPrefetchStats().decodedFrames, 30u);
+		}
+#endif
+	}
+
+	void test_seekRewindClose() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		PrefetchTestDecoder decoder;
+		decoder.setPrefetchFrames(4);
+		decoder.load(50);
+		checkFrames(decoder, 0, 5);
+
+		// The frames decoded ahead are dropped
+		TS_ASSERT(decoder.seekToFrame(20));
+		checkFrames(decoder, 20, 5);
+
+		TS_ASSERT(decoder.rewind());
+		checkFrames(decoder, 0, 12);
+
+		TS_ASSERT(decoder.seekToFrame(45));
+		checkFrames(decoder, 45, 5);
+		TS_ASSERT(decoder.endOfVideo());
+
+		TS_ASSERT(decoder.rewind());
+		checkFrames(decoder, 0, 2);
+
+		// Close while the thread waits for a free frame
+		decoder.close();
+		TS_ASSERT(!decoder.isVideoLoaded());
+
+		decoder.load(10);
+		checkFrames(decoder, 0, 10);
+#endif
+	}
+
+	void test_notPrefetchable() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		PrefetchTestDecoder decoder(false);
+		decoder.setPrefetchFrames(3);
+		decoder.load(10);
+		checkFrames(decoder, 0, 10);
+
+		TS_ASSERT_EQUALS(decoder.getPrefetchStats().decodedFrames, 0u);
+#endif
+	}
+
+private:
+	void checkFrames(PrefetchTestDecoder &decoder, int first, int count) {
+		for (int i = first; i < first + count; i++) {
+			const Graphics::Surface *frame = decoder.decodeNextFrame();
+
+			TS_ASSERT(frame);
+			if (!frame)
+				return;
+
+			TS_ASSERT_EQUALS(decoder.getCurFrame(), i);
+			TS_ASSERT_EQUALS(*(const byte *)frame->getBasePtr(0, 0), i & 0xFF);
+			TS_ASSERT_EQUALS(*(const byte *)frame->getBasePtr(frame->w - 1, frame->h - 1), i & 0xFF);
+
+			if (i % 10 == 0) {
+				TS_ASSERT(decoder.hasDirtyPalette());
+				TS_ASSERT_EQUALS(decoder.getPalette()[0], i & 0xFF);
+			}
+		}
+	}
+};
@@ -102,6 +102,8 @@ protected:
 	bool seekIntern(const Audio::Timestamp &time);
 	bool supportsAudioTrackSwitching() const { return true; }
 	AudioTrack *getAudioTrack(int index);
+	// The transparency track is decoded by decodeNextTransparency(), after the frame
+	bool canPrefetch() const { return !_transparencyTrack.track; }
 
 	/**
 	 * Define a track to be used by this class.
@@ -29,6 +29,7 @@
 #include "common/util.h"
 #include "common/textconsole.h"
 #include "common/math.h"
+#include "common/memstream.h"
 #include "common/stream.h"
 #include "common/substream.h"
 #include "common/file.h"
@@ -38,6 +39,7 @@
 #include "common/rdft.h"
 #include "common/dct.h"
 #include "common/system.h"
+#include "common/thread.h"
 
 #include "graphics/yuv_to_rgb.h"
 #include "graphics/surface.h"
@@ -62,6 +64,8 @@ namespace Video {
 
 BinkDecoder::BinkDecoder() {
 	_bink = 0;
+	_decodeAheadFrames = 0;
+	_parallelDecode = false;
 }
 
 BinkDecoder::~BinkDecoder() {
@@ -159,46 +163,64 @@ void BinkDecoder::readNextPacket() {
 	if (videoTrack->endOfTrack())
 		return;
 
-	VideoFrame &frame = _frames[videoTrack->getCurFrame() + 1];
+	if ((_decodeAheadFrames || _parallelDecode) && !videoTrack->isDecodingAhead()) {
+		if (!videoTrack->startDecodeAhead(this, _decodeAheadFrames, _parallelDecode)) {
+			// No threads, decode every frame when needed
+			_decodeAheadFrames = 0;
+			_parallelDecode = false;
+		}
+	}
 
-	if (!_bink->seek(frame.offset))
-		error("Bad bink seek");
+	VideoFrame &frame = _frames[videoTrack->getCurFrame() + 1];
 
 	uint32 frameSize = frame.size;
 
-	for (uint32 i = 0; i < _audioTracks.size(); i++) {
-		AudioInfo &audio = _audioTracks[i];
+	{
+		// The threads decoding ahead read the next video packets meanwhile
+		Common::StackLock lock(_streamMutex);
 
-		uint32 audioPacketLength = _bink->readUint32LE();
+		if (!_bink->seek(frame.offset))
+			error("Bad bink seek");
 
-		frameSize -= 4;
+		for (uint32 i = 0; i < _audioTracks.size(); i++) {
+			AudioInfo &audio = _audioTracks[i];
 
-		if (frameSize < audioPacketLength)
-			error("Audio packet too big for the frame");
+			uint32 audioPacketLength = _bink->readUint32LE();
 
-		if (audioPacketLength >= 4) {
-			// Get our track - audio index plus one as the first track is video
-			BinkAudioTrack *audioTrack = (BinkAudioTrack *)getTrack(i + 1);
-			uint32 audioPacketStart = _bink->pos();
-			uint32 audioPacketEnd   = _bink->pos() + audioPacketLength;
+			frameSize -= 4;
 
-			//                  Number of samples in bytes
-			audio.sampleCount = _bink->readUint32LE() / (2 * audio.channels);
+			if (frameSize < audioPacketLength)
+				error("Audio packet too big for the frame");
 
-			audio.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
-					audioPacketStart + 4, audioPacketEnd), DisposeAfterUse::YES);
+			if (audioPacketLength >= 4) {
+				// Get our track - audio index plus one as the first track is video
+				BinkAudioTrack *audioTrack = (BinkAudioTrack *)getTrack(i + 1);
+				uint32 audioPacketStart = _bink->pos();
+				uint32 audioPacketEnd   = _bink->pos() + audioPacketLength;
 
-			audioTrack->decodePacket();
+				//                  Number of samples in bytes
+				audio.sampleCount = _bink->readUint32LE() / (2 * audio.channels);
 
-			delete audio.bits;
-			audio.bits = 0;
+				audio.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
+						audioPacketStart + 4, audioPacketEnd), DisposeAfterUse::YES);
 
-			_bink->seek(audioPacketEnd);
+				audioTrack->decodePacket();
 
-			frameSize -= audioPacketLength;
+				delete audio.bits;
+				audio.bits = 0;
+
+				_bink->seek(audioPacketEnd);
+
+				frameSize -= audioPacketLength;
+			}
 		}
 	}
 
+	if (videoTrack->isDecodingAhead()) {
+		videoTrack->showNextFrame();
+		return;
+	}
+
 	uint32 videoPacketStart = _bink->pos();
 	uint32 videoPacketEnd   = _bink->pos() + frameSize;
 
@@ -211,6 +233,36 @@ void BinkDecoder::readNextPacket() {
 	frame.bits = 0;
 }
 
+void BinkDecoder::readVideoPacket(uint32 frameIdx, Common::Array<byte> &packet) {
+	Common::StackLock lock(_streamMutex);
+
+	VideoFrame &frame = _frames[frameIdx];
+
+	if (!_bink->seek(frame.offset))
+		error("Bad bink seek");
+
+	uint32 frameSize = frame.size;
+
+	for (uint32 i = 0; i < _audioTracks.size(); i++) {
+		uint32 audioPacketLength = _bink->readUint32LE();
+
+		frameSize -= 4;
+
+		if (frameSize < audioPacketLength)
+			error("Audio packet too big for the frame");
+
+		if (audioPacketLength >= 4) {
+			_bink->skip(audioPacketLength);
+
+			frameSize -= audioPacketLength;
+		}
+	}
+
+	packet.resize(frameSize);
+	if (_bink->read(packet.begin(), frameSize) != frameSize)
+		error("Bad bink read");
+}
+
 VideoDecoder::AudioTrack *BinkDecoder::getAudioTrack(int index) {
 	// Bink audio track indexes are relative to the first audio track
 	Track *track = getTrack(index + 1);
@@ -248,24 +300,31 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 	for (int i = 0; i < 16; i++)
 		_huffman[i] = 0;
 
-	for (int i = 0; i < kSourceMAX; i++) {
-		_bundles[i].countLength = 0;
+	for (int t = 0; t < kAheadThreadsMax; t++) {
+		for (int i = 0; i < kSourceMAX; i++) {
+			_bundles[t][i].countLength = 0;
 
-		_bundles[i].huffman.index = 0;
-		for (int j = 0; j < 16; j++)
-			_bundles[i].huffman.symbols[j] = j;
+			_bundles[t][i].huffman.index = 0;
+			for (int j = 0; j < 16; j++)
+				_bundles[t][i].huffman.symbols[j] = j;
 
-		_bundles[i].data     = 0;
-		_bundles[i].dataEnd  = 0;
-		_bundles[i].curDec   = 0;
-		_bundles[i].curPtr   = 0;
+			_bundles[t][i].data     = 0;
+			_bundles[t][i].dataEnd  = 0;
+			_bundles[t][i].curDec   = 0;
+			_bundles[t][i].curPtr   = 0;
+		}
 	}
 
-	for (int i = 0; i < 16; i++) {
-		_colHighHuffman[i].index = 0;
-		for (int j = 0; j < 16; j++)
-			_colHighHuffman[i].symbols[j] = j;
-	}
+	_decoder = 0;
+	for (int i = 0; i < kAheadThreadsMax; i++)
+		_aheadThreads[i] = 0;
+	_aheadFrames = 0;
+	_aheadFrameCount = 0;
+	_aheadThreadCount = 0;
+	_aheadFirst = 0;
+	_aheadNext = 0;
+	_aheadShown = -1;
+	_aheadStop = false;
 
 	// Make the surface even-sized:
 	_surfaceHeight = height;
@@ -305,17 +364,21 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 	memset(_curPlanes[3], 255, _yBlockWidth  * 8 * _yBlockHeight  * 8);
 	memset(_oldPlanes[3], 255, _yBlockWidth  * 8 * _yBlockHeight  * 8);
 
-	initBundles();
+	// The bundles of the second thread are only needed to decode in parallel
+	initBundles(_bundles[0]);
 	initHuffman();
 }
 
 BinkDecoder::BinkVideoTrack::~BinkVideoTrack() {
+	stopDecodeAhead();
+
 	for (int i = 0; i < 4; i++) {
 		delete[] _curPlanes[i]; _curPlanes[i] = 0;
 		delete[] _oldPlanes[i]; _oldPlanes[i] = 0;
 	}
 
-	deinitBundles();
+	for (int i = 0; i < kAheadThreadsMax; i++)
+		deinitBundles(_bundles[i]);
 
 	for (int i = 0; i < 16; i++) {
 		delete _huffman[i];
@@ -355,6 +418,9 @@ Common::Rational BinkDecoder::getFrameRate() {
 bool BinkDecoder::seekIntern(const Audio::Timestamp &time) {
 	BinkVideoTrack *videoTrack = (BinkVideoTrack *)getTrack(0);
 
+	// The frames decoded ahead follow the old position
+	videoTrack->stopDecodeAhead();
+
 	uint32 frame = videoTrack->getFrameAtTime(time);
 
 	// Track down the keyframe
@@ -448,6 +514,8 @@ bool BinkDecoder::BinkVideoTrack::rewind() {
 		return false;
 	}
 
+	stopDecodeAhead();
+
 	_curFrame = -1;
 
 	// Re-initialize the video with solid green
@@ -463,49 +531,260 @@ bool BinkDecoder::BinkVideoTrack::rewind() {
 	return true;
 }
 
+const Graphics::Surface *BinkDecoder::BinkVideoTrack::decodeNextFrame() {
+	if (_aheadFrames && _aheadShown >= 0)
+		return &_aheadFrames[_aheadShown % _aheadFrameCount].surface;
+
+	return &_surface;
+}
+
+bool BinkDecoder::BinkVideoTrack::startDecodeAhead(BinkDecoder *decoder, uint frames, bool parallel) {
+	assert(!_aheadFrames);
+
+	const int threadCount = parallel ? 2 : 1;
+
+	// The frame shown, and at least one being decoded by each thread
+	_aheadFrameCount = MAX<uint>(frames, threadCount) + 1;
+	_aheadFrames = new AheadFrame[_aheadFrameCount];
+
+	const uint32 ySize  = _yBlockWidth  * 8 * _yBlockHeight  * 8;
+	const uint32 uvSize = _uvBlockWidth * 8 * _uvBlockHeight * 8;
+
+	for (uint i = 0; i < _aheadFrameCount; i++) {
+		AheadFrame &frame = _aheadFrames[i];
+
+		frame.surface.create(_surfaceWidth, _surfaceHeight, _surface.format);
+		frame.surface.w = _surface.w;
+		frame.surface.h = _surface.h;
+
+		frame.planes[0] = new byte[ySize]();
+		frame.planes[1] = new byte[uvSize]();
+		frame.planes[2] = new byte[uvSize]();
+		frame.planes[3] = _hasAlpha ? new byte[ySize] : 0;
+
+		frame.free = new Common::Semaphore(1);
+		for (int j = 0; j < 4; j++)
+			frame.planeDone[j] = new Common::Semaphore(0);
+		frame.ready = new Common::Semaphore(0);
+	}
+
+	if (parallel && !_bundles[1][0].data)
+		initBundles(_bundles[1]);
+
+	// Create the converter before the threads share it
+	Graphics::YUVToRGBManager::instance();
+
+	_decoder = decoder;
+	_aheadThreadCount = 0;
+	_aheadFirst = _curFrame + 1;
+	_aheadNext = 0;
+	_aheadShown = -1;
+	_aheadStop = false;
+
+	for (int i = 0; i < threadCount; i++) {
+		_aheadThreads[i] = new Common::Thread(decodeAheadProc, this);
+		if (!_aheadThreads[i]->isRunning()) {
+			delete _aheadThreads[i];
+			_aheadThreads[i] = 0;
+			break;
+		}
+	}
+
+	if (!_aheadThreads[0]) {
+		freeAheadFrames();
+		return false;
+	}
+
+	return true;
+}
+
+void BinkDecoder::BinkVideoTrack::stopDecodeAhead() {
+	if (!_aheadFrames)
+		return;
+
+	_aheadMutex.lock();
+	_aheadStop = true;
+	_aheadMutex.unlock();
+
+	// Wake up the threads waiting for a free slot in the ring. The others
+	// finish their frame first.
+	for (uint i = 0; i < _aheadFrameCount; i++)
+		_aheadFrames[i].free->post();
+
+	for (int i = 0; i < kAheadThreadsMax; i++) {
+		delete _aheadThreads[i];
+		_aheadThreads[i] = 0;
+	}
+
+	freeAheadFrames();
+}
+
+void BinkDecoder::BinkVideoTrack::freeAheadFrames() {
+	for (uint i = 0; i < _aheadFrameCount; i++) {
+		AheadFrame &frame = _aheadFrames[i];
+
+		frame.surface.free();
+
+		for (int j = 0; j < 4; j++) {
+			delete[] frame.planes[j];
+			delete frame.planeDone[j];
+		}
+		delete frame.free;
+		delete frame.ready;
+	}
+
+	delete[] _aheadFrames;
+	_aheadFrames = 0;
+	_aheadFrameCount = 0;
+}
+
+void BinkDecoder::BinkVideoTrack::showNextFrame() {
+	const int index = _aheadShown + 1;
+	assert(_aheadFirst + index == _curFrame + 1);
+
+	AheadFrame &frame = _aheadFrames[index % _aheadFrameCount];
+	frame.ready->wait();
+
+	// The frame shown before is not needed to decode the next ones anymore
+	if (_aheadShown >= 0)
+		_aheadFrames[_aheadShown % _aheadFrameCount].free->post();
+
+	_aheadShown = index;
+	_curFrame++;
+}
+
+void BinkDecoder::BinkVideoTrack::decodeAheadProc(void *param) {
+	((BinkVideoTrack *)param)->decodeAhead();
+}
+
+void BinkDecoder::BinkVideoTrack::decodeAhead() {
+	_aheadMutex.lock();
+	Bundle *bundles = _bundles[_aheadThreadCount++];
+	_aheadMutex.unlock();
+
+	for (;;) {
+		_aheadMutex.lock();
+		const int index = _aheadNext;
+		const bool done = _aheadStop || (_aheadFirst + index >= _frameCount);
+		if (!done)
+			_aheadNext++;
+		_aheadMutex.unlock();
+
+		if (done)
+			return;
+
+		AheadFrame &frame = _aheadFrames[index % _aheadFrameCount];
+		AheadFrame *prevFrame = (index > 0) ? &_aheadFrames[(index - 1) % _aheadFrameCount] : 0;
+
+		frame.free->wait();
+
+		_aheadMutex.lock();
+		const bool stop = _aheadStop;
+		_aheadMutex.unlock();
+
+		if (stop) {
+			// Do not keep the thread decoding the next frame waiting
+			for (int i = 0; i < 4; i++)
+				frame.planeDone[i]->post();
+			return;
+		}
+
+		_decoder->readVideoPacket(_aheadFirst + index, frame.packet);
+
+		VideoFrame video;
+		video.bits = new Common::BitStream32LELSB(new Common::MemoryReadStream(frame.packet.begin(),
+				frame.packet.size()), DisposeAfterUse::YES);
+
+		// The first frame refers to the last one decoded beforehand
+		decodePlanes(video, bundles, frame.planes, prevFrame ? prevFrame->planes : _oldPlanes,
+		             prevFrame ? prevFrame->planeDone : 0, frame.planeDone);
+
+		convertPlanes(frame.surface, frame.planes);
+
+		frame.ready->post();
+	}
+}
+
 void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 	assert(frame.bits);
 
+	decodePlanes(frame, _bundles[0], _curPlanes, _oldPlanes, 0, 0);
+
+	convertPlanes(_surface, _curPlanes);
+
+	// And swap the planes with the reference planes
+	for (int i = 0; i < 4; i++)
+		SWAP(_curPlanes[i], _oldPlanes[i]);
+
+	_curFrame++;
+}
+
+void BinkDecoder::BinkVideoTrack::decodePlanes(VideoFrame &video, Bundle *bundles, byte **curPlanes, byte **oldPlanes,
+                                               Common::Semaphore **waitPlanes, Common::Semaphore **donePlanes) {
+	// Every plane of the previous frame is waited for, and every plane of
+	// this one posted, exactly once, even those missing from the packet
+	bool planeDone[4] = { false, false, false, false };
+
 	if (_hasAlpha) {
 		if (_id == kBIKiID)
-			frame.bits->skip(32);
+			video.bits->skip(32);
+
+		if (waitPlanes)
+			waitPlanes[3]->wait();
+
+		decodePlane(video, bundles, curPlanes, oldPlanes, 3, false);
 
-		decodePlane(frame, 3, false);
+		planeDone[3] = true;
+		if (donePlanes)
+			donePlanes[3]->post();
 	}
 
 	if (_id == kBIKiID)
-		frame.bits->skip(32);
+		video.bits->skip(32);
 
 	for (int i = 0; i < 3; i++) {
 		int planeIdx = ((i == 0) || !_swapPlanes) ? i : (i ^ 3);
 
-		decodePlane(frame, planeIdx, i != 0);
+		if (waitPlanes)
+			waitPlanes[planeIdx]->wait();
 
-		if (frame.bits->pos() >= frame.bits->size())
+		decodePlane(video, bundles, curPlanes, oldPlanes, planeIdx, i != 0);
+
+		planeDone[planeIdx] = true;
+		if (donePlanes)
+			donePlanes[planeIdx]->post();
+
+		if (video.bits->pos() >= video.bits->size())
 			break;
 	}
 
+	for (int i = 0; i < 4; i++) {
+		if (planeDone[i])
+			continue;
+
+		if (waitPlanes)
+			waitPlanes[i]->wait();
+		if (donePlanes)
+			donePlanes[i]->post();
+	}
+}
+
+void BinkDecoder::BinkVideoTrack::convertPlanes(Graphics::Surface &surface, byte **planes) {
 	// Convert the YUV data we have to our format
 	// The width used here is the surface-width, and not the video-width
 	// to allow for odd-sized videos.
 	if (_hasAlpha) {
-		assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2] && _curPlanes[3]);
-		YUVToRGBMan.convert420Alpha(&_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2], _curPlanes[3],
+		assert(planes[0] && planes[1] && planes[2] && planes[3]);
+		YUVToRGBMan.convert420Alpha(&surface, Graphics::YUVToRGBManager::kScaleITU, planes[0], planes[1], planes[2], planes[3],
 				_surfaceWidth, _surfaceHeight, _yBlockWidth * 8, _uvBlockWidth * 8);
 	} else {
-		assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2]);
-		YUVToRGBMan.convert420(&_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2],
+		assert(planes[0] && planes[1] && planes[2]);
+		YUVToRGBMan.convert420(&surface, Graphics::YUVToRGBManager::kScaleITU, planes[0], planes[1], planes[2],
 				_surfaceWidth, _surfaceHeight, _yBlockWidth * 8, _uvBlockWidth * 8);
 	}
-
-	// And swap the planes with the reference planes
-	for (int i = 0; i < 4; i++)
-		SWAP(_curPlanes[i], _oldPlanes[i]);
-
-	_curFrame++;
 }
 
-void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, bool isChroma) {
+void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, Bundle *bundles, byte **curPlanes, byte **oldPlanes, int planeIdx, bool isChroma) {
 	uint32 blockWidth  = isChroma ? _uvBlockWidth  : _yBlockWidth;
 	uint32 blockHeight = isChroma ? _uvBlockHeight : _yBlockHeight;
 	uint32 width       = blockWidth  * 8;
@@ -514,11 +793,12 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 	DecodeContext ctx;
 
 	ctx.video     = &video;
+	ctx.bundles   = bundles;
 	ctx.planeIdx  = planeIdx;
-	ctx.destStart = _curPlanes[planeIdx];
-	ctx.destEnd   = _curPlanes[planeIdx] + width * height;
-	ctx.prevStart = _oldPlanes[planeIdx];
-	ctx.prevEnd   = _oldPlanes[planeIdx] + width * height;
+	ctx.destStart = curPlanes[planeIdx];
+	ctx.destEnd   = curPlanes[planeIdx] + width * height;
+	ctx.prevStart = oldPlanes[planeIdx];
+	ctx.prevEnd   = oldPlanes[planeIdx] + width * height;
 	ctx.pitch     = width;
 
 	for (int i = 0; i < 64; i++) {
@@ -531,27 +811,27 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 	}
 
 	for (int i = 0; i < kSourceMAX; i++) {
-		_bundles[i].countLength = _bundles[i].countLengths[isChroma ? 1 : 0];
+		bundles[i].countLength = bundles[i].countLengths[isChroma ? 1 : 0];
 
-		readBundle(video, (Source) i);
+		readBundle(ctx, (Source) i);
 	}
 
 	for (ctx.blockY = 0; ctx.blockY < blockHeight; ctx.blockY++) {
-		readBlockTypes  (video, _bundles[kSourceBlockTypes]);
-		readBlockTypes  (video, _bundles[kSourceSubBlockTypes]);
-		readColors      (video, _bundles[kSourceColors]);
-		readPatterns    (video, _bundles[kSourcePattern]);
-		readMotionValues(video, _bundles[kSourceXOff]);
-		readMotionValues(video, _bundles[kSourceYOff]);
-		readDCS         (video, _bundles[kSourceIntraDC], kDCStartBits, false);
-		readDCS         (video, _bundles[kSourceInterDC], kDCStartBits, true);
-		readRuns        (video, _bundles[kSourceRun]);
+		readBlockTypes  (video, bundles[kSourceBlockTypes]);
+		readBlockTypes  (video, bundles[kSourceSubBlockTypes]);
+		readColors      (ctx,   bundles[kSourceColors]);
+		readPatterns    (video, bundles[kSourcePattern]);
+		readMotionValues(video, bundles[kSourceXOff]);
+		readMotionValues(video, bundles[kSourceYOff]);
+		readDCS         (video, bundles[kSourceIntraDC], kDCStartBits, false);
+		readDCS         (video, bundles[kSourceInterDC], kDCStartBits, true);
+		readRuns        (video, bundles[kSourceRun]);
 
 		ctx.dest = ctx.destStart + 8 * ctx.blockY * ctx.pitch;
 		ctx.prev = ctx.prevStart + 8 * ctx.blockY * ctx.pitch;
 
 		for (ctx.blockX = 0; ctx.blockX < blockWidth; ctx.blockX++, ctx.dest += 8, ctx.prev += 8) {
-			BlockType blockType = (BlockType) getBundleValue(kSourceBlockTypes);
+			BlockType blockType = (BlockType) getBundleValue(ctx, kSourceBlockTypes);
 
 			// 16x16 block type on odd line means part of the already decoded block, so skip it
 			if ((ctx.blockY & 1) && (blockType == kBlockScaled)) {
@@ -605,19 +885,19 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 
 }
 
-void BinkDecoder::BinkVideoTrack::readBundle(VideoFrame &video, Source source) {
+void BinkDecoder::BinkVideoTrack::readBundle(DecodeContext &ctx, Source source) {
 	if (source == kSourceColors) {
 		for (int i = 0; i < 16; i++)
-			readHuffman(video, _colHighHuffman[i]);
+			readHuffman(*ctx.video, ctx.colHighHuffman[i]);
 
-		_colLastVal = 0;
+		ctx.colLastVal = 0;
 	}
 
 	if ((source != kSourceIntraDC) && (source != kSourceInterDC))
-		readHuffman(video, _bundles[source].huffman);
+		readHuffman(*ctx.video, ctx.bundles[source].huffman);
 
-	_bundles[source].curDec = _bundles[source].data;
-	_bundles[source].curPtr = _bundles[source].data;
+	ctx.bundles[source].curDec = ctx.bundles[source].data;
+	ctx.bundles[source].curPtr = ctx.bundles[source].data;
 }
 
 void BinkDecoder::BinkVideoTrack::readHuffman(VideoFrame &video, Huffman &huffman) {
@@ -694,14 +974,14 @@ void BinkDecoder::BinkVideoTrack::mergeHuffmanSymbols(VideoFrame &video, byte *d
 		*dst++ = *src2++;
 }
 
-void BinkDecoder::BinkVideoTrack::initBundles() {
+void BinkDecoder::BinkVideoTrack::initBundles(Bundle *bundles) {
 	uint32 bw     = (_surface.w + 7) >> 3;
 	uint32 bh     = (_surface.h + 7) >> 3;
 	uint32 blocks = bw * bh;
 
 	for (int i = 0; i < kSourceMAX; i++) {
-		_bundles[i].data    = new byte[blocks * 64];
-		_bundles[i].dataEnd = _bundles[i].data + blocks * 64;
+		bundles[i].data    = new byte[blocks * 64];
+		bundles[i].dataEnd = bundles[i].data + blocks * 64;
 	}
 
 	uint32 cbw[2] = { (uint32)((_surface.w + 7) >> 3), (uint32)((_surface.w  + 15) >> 4) };
@@ -711,21 +991,23 @@ void BinkDecoder::BinkVideoTrack::initBundles() {
 	for (int i = 0; i < 2; i++) {
 		int width = MAX<uint32>(cw[i], 8);
 
-		_bundles[kSourceBlockTypes   ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourceSubBlockTypes].countLengths[i] = Common::intLog2(((width + 7) >> 4) + 511) + 1;
-		_bundles[kSourceColors       ].countLengths[i] = Common::intLog2((cbw[i])     * 64  + 511) + 1;
-		_bundles[kSourceIntraDC      ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourceInterDC      ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourceXOff         ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourceYOff         ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourcePattern      ].countLengths[i] = Common::intLog2((cbw[i]      << 3) + 511) + 1;
-		_bundles[kSourceRun          ].countLengths[i] = Common::intLog2((cbw[i])     * 48  + 511) + 1;
+		bundles[kSourceBlockTypes   ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+		bundles[kSourceSubBlockTypes].countLengths[i] = Common::intLog2(((width + 7) >> 4) + 511) + 1;
+		bundles[kSourceColors       ].countLengths[i] = Common::intLog2((cbw[i])     * 64  + 511) + 1;
+		bundles[kSourceIntraDC      ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+		bundles[kSourceInterDC      ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+		bundles[kSourceXOff         ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+		bundles[kSourceYOff         ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+		bundles[kSourcePattern      ].countLengths[i] = Common::intLog2((cbw[i]      << 3) + 511) + 1;
+		bundles[kSourceRun          ].countLengths[i] = Common::intLog2((cbw[i])     * 48  + 511) + 1;
 	}
 }
 
-void BinkDecoder::BinkVideoTrack::deinitBundles() {
-	for (int i = 0; i < kSourceMAX; i++)
-		delete[] _bundles[i].data;
+void BinkDecoder::BinkVideoTrack::deinitBundles(Bundle *bundles) {
+	for (int i = 0; i < kSourceMAX; i++) {
+		delete[] bundles[i].data;
+		bundles[i].data = 0;
+	}
 }
 
 void BinkDecoder::BinkVideoTrack::initHuffman() {
@@ -737,16 +1019,18 @@ byte BinkDecoder::BinkVideoTrack::getHuffmanSymbol(VideoFrame &video, Huffman &h
 	return huffman.symbols[_huffman[huffman.index]->getSymbol(*video.bits)];
 }
 
-int32 BinkDecoder::BinkVideoTrack::getBundleValue(Source source) {
+int32 BinkDecoder::BinkVideoTrack::getBundleValue(DecodeContext &ctx, Source source) {
+	Bundle &bundle = ctx.bundles[source];
+
 	if ((source < kSourceXOff) || (source == kSourceRun))
-		return *_bundles[source].curPtr++;
+		return *bundle.curPtr++;
 
 	if ((source == kSourceXOff) || (source == kSourceYOff))
-		return (int8) *_bundles[source].curPtr++;
+		return (int8) *bundle.curPtr++;
 
-	int16 ret = *((int16 *) _bundles[source].curPtr);
+	int16 ret = *((int16 *) bundle.curPtr);
 
-	_bundles[source].curPtr += 2;
+	bundle.curPtr += 2;
 
 	return ret;
 }
@@ -783,7 +1067,7 @@ void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
 
 	int i = 0;
 	do {
-		int run = getBundleValue(kSourceRun) + 1;
+		int run = getBundleValue(ctx, kSourceRun) + 1;
 
 		i += run;
 		if (i > 64)
@@ -791,7 +1075,7 @@ void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
 
 		if (ctx.video->bits->getBit()) {
 
-			byte v = getBundleValue(kSourceColors);
+			byte v = getBundleValue(ctx, kSourceColors);
 			for (int j = 0; j < run; j++, scan++)
 				ctx.dest[ctx.coordScaledMap1[*scan]] =
 				ctx.dest[ctx.coordScaledMap2[*scan]] =
@@ -803,7 +1087,7 @@ void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
 				ctx.dest[ctx.coordScaledMap1[*scan]] =
 				ctx.dest[ctx.coordScaledMap2[*scan]] =
 				ctx.dest[ctx.coordScaledMap3[*scan]] =
-				ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(kSourceColors);
+				ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(ctx, kSourceColors);
 
 	} while (i < 63);
 
@@ -811,14 +1095,14 @@ void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
 		ctx.dest[ctx.coordScaledMap1[*scan]] =
 		ctx.dest[ctx.coordScaledMap2[*scan]] =
 		ctx.dest[ctx.coordScaledMap3[*scan]] =
-		ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(kSourceColors);
+		ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(ctx, kSourceColors);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledIntra(DecodeContext &ctx) {
 	int32 block[64];
 	memset(block, 0, 64 * sizeof(int32));
 
-	block[0] = getBundleValue(kSourceIntraDC);
+	block[0] = getBundleValue(ctx, kSourceIntraDC);
 
 	readDCTCoeffs(*ctx.video, block, true);
 
@@ -836,7 +1120,7 @@ void BinkDecoder::BinkVideoTrack::blockScaledIntra(DecodeContext &ctx) {
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledFill(DecodeContext &ctx) {
-	byte v = getBundleValue(kSourceColors);
+	byte v = getBundleValue(ctx, kSourceColors);
 
 	byte *dest = ctx.dest;
 	for (int i = 0; i < 16; i++, dest += ctx.pitch)
@@ -847,12 +1131,12 @@ void BinkDecoder::BinkVideoTrack::blockScaledPattern(DecodeContext &ctx) {
 	byte col[2];
 
 	for (int i = 0; i < 2; i++)
-		col[i] = getBundleValue(kSourceColors);
+		col[i] = getBundleValue(ctx, kSourceColors);
 
 	byte *dest1 = ctx.dest;
 	byte *dest2 = ctx.dest + ctx.pitch;
 	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16) {
-		byte v = getBundleValue(kSourcePattern);
+		byte v = getBundleValue(ctx, kSourcePattern);
 
 		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2, v >>= 1)
 			dest1[0] = dest1[1] = dest2[0] = dest2[1] = col[v & 1];
@@ -865,17 +1149,17 @@ void BinkDecoder::BinkVideoTrack::blockScaledRaw(DecodeContext &ctx) {
 	byte *dest1 = ctx.dest;
 	byte *dest2 = ctx.dest + ctx.pitch;
 	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16) {
-		memcpy(row, _bundles[kSourceColors].curPtr, 8);
+		memcpy(row, ctx.bundles[kSourceColors].curPtr, 8);
 
 		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
 			dest1[0] = dest1[1] = dest2[0] = dest2[1] = row[i];
 
-		_bundles[kSourceColors].curPtr += 8;
+		ctx.bundles[kSourceColors].curPtr += 8;
 	}
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaled(DecodeContext &ctx) {
-	BlockType blockType = (BlockType) getBundleValue(kSourceSubBlockTypes);
+	BlockType blockType = (BlockType) getBundleValue(ctx, kSourceSubBlockTypes);
 
 	switch (blockType) {
 	case kBlockRun:
@@ -903,8 +1187,8 @@ void BinkDecoder::BinkVideoTrack::blockScaled(DecodeContext &ctx) {
 }
 
 void BinkDecoder::BinkVideoTrack::blockMotion(DecodeContext &ctx) {
-	int8 xOff = getBundleValue(kSourceXOff);
-	int8 yOff = getBundleValue(kSourceYOff);
+	int8 xOff = getBundleValue(ctx, kSourceXOff);
+	int8 yOff = getBundleValue(ctx, kSourceYOff);
 
 	byte *dest = ctx.dest;
 	byte *prev = ctx.prev + yOff * ((int32) ctx.pitch) + xOff;
@@ -920,7 +1204,7 @@ void BinkDecoder::BinkVideoTrack::blockRun(DecodeContext &ctx) {
 
 	int i = 0;
 	do {
-		int run = getBundleValue(kSourceRun) + 1;
+		int run = getBundleValue(ctx, kSourceRun) + 1;
 
 		i += run;
 		if (i > 64)
@@ -928,18 +1212,18 @@ void BinkDecoder::BinkVideoTrack::blockRun(DecodeContext &ctx) {
 
 		if (ctx.video->bits->getBit()) {
 
-			byte v = getBundleValue(kSourceColors);
+			byte v = getBundleValue(ctx, kSourceColors);
 			for (int j = 0; j < run; j++)
 				ctx.dest[ctx.coordMap[*scan++]] = v;
 
 		} else
 			for (int j = 0; j < run; j++)
-				ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(kSourceColors);
+				ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(ctx, kSourceColors);
 
 	} while (i < 63);
 
 	if (i == 63)
-		ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(kSourceColors);
+		ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(ctx, kSourceColors);
 }
 
 void BinkDecoder::BinkVideoTrack::blockResidue(DecodeContext &ctx) {
@@ -963,7 +1247,7 @@ void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
 	int32 block[64];
 	memset(block, 0, 64 * sizeof(int32));
 
-	block[0] = getBundleValue(kSourceIntraDC);
+	block[0] = getBundleValue(ctx, kSourceIntraDC);
 
 	readDCTCoeffs(*ctx.video, block, true);
 
@@ -971,7 +1255,7 @@ void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
 }
 
 void BinkDecoder::BinkVideoTrack::blockFill(DecodeContext &ctx) {
-	byte v = getBundleValue(kSourceColors);
+	byte v = getBundleValue(ctx, kSourceColors);
 
 	byte *dest = ctx.dest;
 	for (int i = 0; i < 8; i++, dest += ctx.pitch)
@@ -984,7 +1268,7 @@ void BinkDecoder::BinkVideoTrack::blockInter(DecodeContext &ctx) {
 	int32 block[64];
 	memset(block, 0, 64 * sizeof(int32));
 
-	block[0] = getBundleValue(kSourceInterDC);
+	block[0] = getBundleValue(ctx, kSourceInterDC);
 
 	readDCTCoeffs(*ctx.video, block, false);
 
@@ -995,11 +1279,11 @@ void BinkDecoder::BinkVideoTrack::blockPattern(DecodeContext &ctx) {
 	byte col[2];
 
 	for (int i = 0; i < 2; i++)
-		col[i] = getBundleValue(kSourceColors);
+		col[i] = getBundleValue(ctx, kSourceColors);
 
 	byte *dest = ctx.dest;
 	for (int i = 0; i < 8; i++, dest += ctx.pitch - 8) {
-		byte v = getBundleValue(kSourcePattern);
+		byte v = getBundleValue(ctx, kSourcePattern);
 
 		for (int j = 0; j < 8; j++, v >>= 1)
 			*dest++ = col[v & 1];
@@ -1008,11 +1292,11 @@ void BinkDecoder::BinkVideoTrack::blockPattern(DecodeContext &ctx) {
 
 void BinkDecoder::BinkVideoTrack::blockRaw(DecodeContext &ctx) {
 	byte *dest = ctx.dest;
-	byte *data = _bundles[kSourceColors].curPtr;
+	byte *data = ctx.bundles[kSourceColors].curPtr;
 	for (int i = 0; i < 8; i++, dest += ctx.pitch, data += 8)
 		memcpy(dest, data, 8);
 
-	_bundles[kSourceColors].curPtr += 64;
+	ctx.bundles[kSourceColors].curPtr += 64;
 }
 
 void BinkDecoder::BinkVideoTrack::readRuns(VideoFrame &video, Bundle &bundle) {
@@ -1127,7 +1411,9 @@ void BinkDecoder::BinkVideoTrack::readPatterns(VideoFrame &video, Bundle &bundle
 }
 
 
-void BinkDecoder::BinkVideoTrack::readColors(VideoFrame &video, Bundle &bundle) {
+void BinkDecoder::BinkVideoTrack::readColors(DecodeContext &ctx, Bundle &bundle) {
+	VideoFrame &video = *ctx.video;
+
 	uint32 n = readBundleCount(video, bundle);
 	if (n == 0)
 		return;
@@ -1137,11 +1423,11 @@ void BinkDecoder::BinkVideoTrack::readColors(VideoFrame &video, Bundle &bundle)
 		error("Too many color values");
 
 	if (video.bits->getBit()) {
-		_colLastVal = getHuffmanSymbol(video, _colHighHuffman[_colLastVal]);
+		ctx.colLastVal = getHuffmanSymbol(video, ctx.colHighHuffman[ctx.colLastVal]);
 
 		byte v;
 		v = getHuffmanSymbol(video, bundle.huffman);
-		v = (_colLastVal << 4) | v;
+		v = (ctx.colLastVal << 4) | v;
 
 		if (_id != kBIKiID) {
 			int sign = ((int8) v) >> 7;
@@ -1156,11 +1442,11 @@ void BinkDecoder::BinkVideoTrack::readColors(VideoFrame &video, Bundle &bundle)
 	}
 
 	while (bundle.curDec < decEnd) {
-		_colLastVal = getHuffmanSymbol(video, _colHighHuffman[_colLastVal]);
+		ctx.colLastVal = getHuffmanSymbol(video, ctx.colHighHuffman[ctx.colLastVal]);
 
 		byte v;
 		v = getHuffmanSymbol(video, bundle.huffman);
-		v = (_colLastVal << 4) | v;
+		v = (ctx.colLastVal << 4) | v;
 
 		if (_id != kBIKiID) {
 			int sign = ((int8) v) >> 7;
@@ -32,6 +32,7 @@
 
 #include "common/array.h"
 #include "common/bitstream.h"
+#include "common/mutex.h"
 #include "common/rational.h"
 
 #include "video/video_decoder.h"
@@ -50,6 +51,9 @@ class Huffman;
 
 class RDFT;
 class DCT;
+
+class Thread;
+class Semaphore;
 }
 
 namespace Graphics {
@@ -74,6 +78,29 @@ public:
 
 	Common::Rational getFrameRate();
 
+	/**
+	 * Decode the frames following the one shown on a background thread,
+	 * while the current one is presented.
+	 *
+	 * Turning this off takes effect at the next seek or rewind.
+	 *
+	 * @param frames The number of frames to decode ahead, 0 to decode
+	 *               every frame when it is needed.
+	 */
+	void setDecodeAhead(uint frames) { _decodeAheadFrames = frames; }
+
+	/**
+	 * Decode the planes of consecutive frames at the same time, on two
+	 * threads.
+	 *
+	 * The planes of a frame are stored one after another in the same
+	 * bitstream, so each frame is decoded by one thread. But a plane only
+	 * refers to the same plane of the previous frame, so the next frame
+	 * starts as soon as its first plane is available. This implies
+	 * decoding at least two frames ahead, see setDecodeAhead().
+	 */
+	void setParallelDecode(bool parallel) { _parallelDecode = parallel; }
+
 protected:
 	void readNextPacket();
 	bool supportsAudioTrackSwitching() const { return true; }
@@ -153,7 +180,7 @@ private:
 		Graphics::PixelFormat getPixelFormat() const override { return _surface.format; }
 		int getCurFrame() const override { return _curFrame; }
 		int getFrameCount() const override { return _frameCount; }
-		const Graphics::Surface *decodeNextFrame() override { return &_surface; }
+		const Graphics::Surface *decodeNextFrame() override;
 		bool isSeekable() const  override{ return true; }
 		bool seek(const Audio::Timestamp &time) override { return true; }
 		bool rewind() override;
@@ -162,32 +189,24 @@ private:
 		/** Decode a video packet. */
 		void decodePacket(VideoFrame &frame);
 
+		/**
+		 * Start decoding the frames after the current one on background
+		 * threads. Returns false if the backend cannot create threads.
+		 *
+		 * @param frames   Number of frames to decode ahead.
+		 * @param parallel Whether to use two threads, see BinkDecoder::setParallelDecode().
+		 */
+		bool startDecodeAhead(BinkDecoder *decoder, uint frames, bool parallel);
+		/** Stop the background threads, dropping the frames decoded ahead. */
+		void stopDecodeAhead();
+		bool isDecodingAhead() const { return _aheadFrames != nullptr; }
+		/** Make the next frame decoded ahead the current one, waiting for it if needed. */
+		void showNextFrame();
+
 		Common::Rational getFrameRate() const override { return _frameRate; }
 
 	private:
-		/** A decoder state. */
-		struct DecodeContext {
-			VideoFrame *video;
-
-			uint32 planeIdx;
-
-			uint32 blockX;
-			uint32 blockY;
-
-			byte *dest;
-			byte *prev;
-
-			byte *destStart, *destEnd;
-			byte *prevStart, *prevEnd;
-
-			uint32 pitch;
-
-			int coordMap[64];
-			int coordScaledMap1[64];
-			int coordScaledMap2[64];
-			int coordScaledMap3[64];
-			int coordScaledMap4[64];
-		};
+		static const int kAheadThreadsMax = 2;
 
 		/** IDs for different data types used in Bink video codec. */
 		enum Source {
@@ -238,6 +257,38 @@ private:
 			byte *curPtr; ///< Pointer to the data that wasn't yet read.
 		};
 
+		/** A decoder state. */
+		struct DecodeContext {
+			VideoFrame *video;
+
+			/** The bundles of the decoding thread. */
+			Bundle *bundles;
+
+			/** Huffman codebooks to use for decoding high nibbles in color data types. */
+			Huffman colHighHuffman[16];
+			/** Value of the last decoded high nibble in color data types. */
+			int colLastVal;
+
+			uint32 planeIdx;
+
+			uint32 blockX;
+			uint32 blockY;
+
+			byte *dest;
+			byte *prev;
+
+			byte *destStart, *destEnd;
+			byte *prevStart, *prevEnd;
+
+			uint32 pitch;
+
+			int coordMap[64];
+			int coordScaledMap1[64];
+			int coordScaledMap2[64];
+			int coordScaledMap3[64];
+			int coordScaledMap4[64];
+		};
+
 		int _curFrame;
 		int _frameCount;
 
@@ -252,15 +303,11 @@ private:
 
 		Common::Rational _frameRate;
 
-		Bundle _bundles[kSourceMAX]; ///< Bundles for decoding all data types.
+		/** Bundles for decoding all data types, for each decoding thread. */
+		Bundle _bundles[kAheadThreadsMax][kSourceMAX];
 
 		Common::Huffman<Common::BitStream32LELSB> *_huffman[16]; ///< The 16 Huffman codebooks used in Bink decoding.
 
-		/** Huffman codebooks to use for decoding high nibbles in color data types. */
-		Huffman _colHighHuffman[16];
-		/** Value of the last decoded high nibble in color data types. */
-		int _colLastVal;
-
 		uint32 _yBlockWidth;   ///< Width of the Y plane in blocks
 		uint32 _yBlockHeight;  ///< Height of the Y plane in blocks
 		uint32 _uvBlockWidth;  ///< Width of the U and V planes in blocks
@@ -269,19 +316,55 @@ private:
 		byte *_curPlanes[4]; ///< The 4 color planes, YUVA, current frame.
 		byte *_oldPlanes[4]; ///< The 4 color planes, YUVA, last frame.
 
+		/** A frame decoded ahead of the one shown. */
+		struct AheadFrame {
+			Graphics::Surface surface;
+			byte *planes[4];                 ///< The 4 color planes, YUVA.
+			Common::Array<byte> packet;      ///< The video packet.
+			Common::Semaphore *free;         ///< Posted once the frame decoded before in this slot is not needed anymore.
+			Common::Semaphore *planeDone[4]; ///< Posted once each plane is decoded, for the next frame.
+			Common::Semaphore *ready;        ///< Posted once the surface is converted.
+		};
+
+		BinkDecoder *_decoder;
+		Common::Thread *_aheadThreads[kAheadThreadsMax];
+		AheadFrame *_aheadFrames; ///< Ring of frames decoded ahead, or nullptr.
+		uint _aheadFrameCount;    ///< Size of the ring.
+		Common::Mutex _aheadMutex;
+		int _aheadThreadCount;    ///< The number of threads which took their bundles.
+		int _aheadFirst;          ///< Number of the first frame decoded ahead.
+		int _aheadNext;           ///< Index of the next frame to decode, from the first.
+		int _aheadShown;          ///< Index of the frame shown, -1 for none yet.
+		bool _aheadStop;
+
+		static void decodeAheadProc(void *param);
+		/** Decode the frames until stopped, on a background thread. */
+		void decodeAhead();
+		void freeAheadFrames();
+
 		/** Initialize the bundles. */
-		void initBundles();
+		void initBundles(Bundle *bundles);
 		/** Deinitialize the bundles. */
-		void deinitBundles();
+		void deinitBundles(Bundle *bundles);
 
 		/** Initialize the Huffman decoders. */
 		void initHuffman();
 
+		/**
+		 * Decode the planes of a video packet.
+		 *
+		 * @param waitPlanes Semaphores to wait for before decoding each plane, or nullptr.
+		 * @param donePlanes Semaphores to post once each plane is decoded, or nullptr.
+		 */
+		void decodePlanes(VideoFrame &video, Bundle *bundles, byte **curPlanes, byte **oldPlanes,
+		                  Common::Semaphore **waitPlanes, Common::Semaphore **donePlanes);
 		/** Decode a plane. */
-		void decodePlane(VideoFrame &video, int planeIdx, bool isChroma);
+		void decodePlane(VideoFrame &video, Bundle *bundles, byte **curPlanes, byte **oldPlanes, int planeIdx, bool isChroma);
+		/** Convert the YUV planes of a frame to our format. */
+		void convertPlanes(Graphics::Surface &surface, byte **planes);
 
 		/** Read/Initialize a bundle for decoding a plane. */
-		void readBundle(VideoFrame &video, Source source);
+		void readBundle(DecodeContext &ctx, Source source);
 
 		/** Read the symbols for a Huffman code. */
 		void readHuffman(VideoFrame &video, Huffman &huffman);
@@ -292,7 +375,7 @@ private:
 		byte getHuffmanSymbol(VideoFrame &video, Huffman &huffman);
 
 		/** Get a direct value out of a bundle. */
-		int32 getBundleValue(Source source);
+		int32 getBundleValue(DecodeContext &ctx, Source source);
 		/** Read a count value out of a bundle. */
 		uint32 readBundleCount(VideoFrame &video, Bundle &bundle);
 
@@ -319,7 +402,7 @@ private:
 		void readMotionValues(VideoFrame &video, Bundle &bundle);
 		void readBlockTypes  (VideoFrame &video, Bundle &bundle);
 		void readPatterns    (VideoFrame &video, Bundle &bundle);
-		void readColors      (VideoFrame &video, Bundle &bundle);
+		void readColors      (DecodeContext &ctx, Bundle &bundle);
 		void readDCS         (VideoFrame &video, Bundle &bundle, int startBits, bool hasSign);
 		void readDCTCoeffs   (VideoFrame &video, int32 *block, bool isIntra);
 		void readResidue     (VideoFrame &video, int16 *block, int masksCount);
@@ -369,7 +452,15 @@ private:
 	Common::Array<AudioInfo> _audioTracks; ///< All audio tracks.
 	Common::Array<VideoFrame> _frames;      ///< All video frames.
 
+	/** Locks _bink, as the video packets may be read while decoding ahead. */
+	Common::Mutex _streamMutex;
+	uint _decodeAheadFrames;
+	bool _parallelDecode;
+
 	void initAudioTrack(AudioInfo &audio);
+
+	/** Read the video packet of a frame, skipping the audio packets. */
+	void readVideoPacket(uint32 frame, Common::Array<byte> &packet);
 };
 
 } // End of namespace Video
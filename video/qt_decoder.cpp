@@ -89,7 +89,11 @@ const Graphics::Surface *QuickTimeDecoder::decodeNextFrame() {
 
 	// Update audio buffers too
 	// (needs to be done after we find the next track)
-	updateAudioBuffer();
+	{
+		// The prefetch thread may be reading the file meanwhile
+		Common::StackLock lock(_prefetchMutex);
+		updateAudioBuffer();
+	}
 
 	// We have to initialize the scaled surface
 	if (frame && (_scaleFactorX != 1 || _scaleFactorY != 1)) {
@@ -27,11 +27,25 @@
 #include "common/rational.h"
 #include "common/file.h"
 #include "common/system.h"
+#include "common/thread.h"
 
 #include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Video {
 
+/** A frame decoded by the prefetch thread. */
+struct VideoDecoder::PrefetchedFrame {
+	Graphics::Surface surface;
+	bool hasSurface;
+	byte palette[256 * 3];
+	bool dirtyPalette;
+	PrefetchState state;
+
+	PrefetchedFrame() : hasSurface(false), dirtyPalette(false) {}
+	~PrefetchedFrame() { surface.free(); }
+};
+
 VideoDecoder::VideoDecoder() {
 	_startTime = 0;
 	_dirtyPalette = false;
@@ -49,6 +63,17 @@ VideoDecoder::VideoDecoder() {
 	_mainAudioTrack = 0;
 	_canSetDither = true;
 
+	_prefetchFrames = 0;
+	_prefetchedFrames = 0;
+	_prefetchThread = 0;
+	_prefetchFree = 0;
+	_prefetchReady = 0;
+	_prefetchStop = false;
+	_prefetchNext = 0;
+	_prefetchShown = -1;
+	_prefetchFinished = false;
+	memset(&_prefetchStats, 0, sizeof(_prefetchStats));
+
 	// Find the best format for output
 	_defaultHighColorFormat = g_system->getScreenFormat();
 
@@ -56,7 +81,16 @@ VideoDecoder::VideoDecoder() {
 		_defaultHighColorFormat = Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0);
 }
 
+VideoDecoder::~VideoDecoder() {
+	// Subclasses are expected to close() the video, which already stops
+	// the prefetch thread while their tracks are still alive.
+	stopPrefetch();
+	freePrefetchedFrames();
+}
+
 void VideoDecoder::close() {
+	stopPrefetch();
+
 	if (isPlaying())
 		stop();
 
@@ -97,6 +131,8 @@ bool VideoDecoder::needsUpdate() const {
 }
 
 void VideoDecoder::pauseVideo(bool pause) {
+	Common::StackLock lock(_prefetchMutex);
+
 	if (pause) {
 		_pauseLevel++;
 
@@ -128,6 +164,8 @@ void VideoDecoder::resetPauseStartTime() {
 }
 
 void VideoDecoder::setVolume(byte volume) {
+	Common::StackLock lock(_prefetchMutex);
+
 	_audioVolume = volume;
 
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -136,6 +174,8 @@ void VideoDecoder::setVolume(byte volume) {
 }
 
 void VideoDecoder::setBalance(int8 balance) {
+	Common::StackLock lock(_prefetchMutex);
+
 	_audioBalance = balance;
 
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -148,6 +188,8 @@ Audio::Mixer::SoundType VideoDecoder::getSoundType() const {
 }
 
 void VideoDecoder::setSoundType(Audio::Mixer::SoundType soundType) {
+	Common::StackLock lock(_prefetchMutex);
+
 	_soundType = soundType;
 
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -187,6 +229,21 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	_needsUpdate = false;
 	_canSetDither = false;
 
+	if (startPrefetch())
+		return nextPrefetchedFrame();
+
+	const byte *palette = 0;
+	const Graphics::Surface *frame = decodeFrameIntern(palette);
+
+	if (palette) {
+		_palette = palette;
+		_dirtyPalette = true;
+	}
+
+	return frame;
+}
+
+const Graphics::Surface *VideoDecoder::decodeFrameIntern(const byte *&palette) {
 	readNextPacket();
 
 	// If we have no next video track at this point, there shouldn't be
@@ -196,10 +253,8 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 
 	const Graphics::Surface *frame = _nextVideoTrack->decodeNextFrame();
 
-	if (_nextVideoTrack->hasDirtyPalette()) {
-		_palette = _nextVideoTrack->getPalette();
-		_dirtyPalette = true;
-	}
+	if (_nextVideoTrack->hasDirtyPalette())
+		palette = _nextVideoTrack->getPalette();
 
 	// Look for the next video track here for the next decode.
 	findNextVideoTrack();
@@ -215,6 +270,16 @@ bool VideoDecoder::setReverse(bool reverse) {
 	// Attempt to make sure all the tracks are in the requested direction
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
+			if (_prefetchThread) {
+				// Go back to the shown frame, reverse playback is not
+				// prefetched
+				PrefetchState state = _prefetchState;
+				stopPrefetch();
+
+				if (state.hasNextVideoTrack && isSeekable())
+					seekIntern(Audio::Timestamp(state.nextFrameStartTime, 1000));
+			}
+
 			if (!((VideoTrack *)*it)->setReverse(reverse))
 				return false;
 
@@ -232,6 +297,9 @@ const byte *VideoDecoder::getPalette() {
 }
 
 int VideoDecoder::getCurFrame() const {
+	if (_prefetchThread)
+		return _prefetchState.curFrame;
+
 	int32 frame = -1;
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -273,13 +341,16 @@ uint32 VideoDecoder::getTime() const {
 }
 
 uint32 VideoDecoder::getTimeToNextFrame() const {
-	if (endOfVideo() || _needsUpdate || !_nextVideoTrack)
+	// While prefetching, the next video track is ahead of the shown frame
+	bool hasNextVideoTrack = _prefetchThread ? _prefetchState.hasNextVideoTrack : _nextVideoTrack != 0;
+
+	if (endOfVideo() || _needsUpdate || !hasNextVideoTrack)
 		return 0;
 
 	uint32 currentTime = getTime();
-	uint32 nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+	uint32 nextFrameStartTime = _prefetchThread ? _prefetchState.nextFrameStartTime : _nextVideoTrack->getNextFrameStartTime();
 
-	if (_nextVideoTrack->isReversed()) {
+	if (_prefetchThread ? _prefetchState.reversed : _nextVideoTrack->isReversed()) {
 		// For reversed videos, we need to handle the time difference the opposite way.
 		if (nextFrameStartTime >= currentTime)
 			return 0;
@@ -295,6 +366,18 @@ uint32 VideoDecoder::getTimeToNextFrame() const {
 }
 
 bool VideoDecoder::endOfVideo() const {
+	if (_prefetchThread) {
+		// The video tracks are already ahead of the shown frame
+		if (!videoEndReached(_prefetchState))
+			return false;
+
+		for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
+			if ((*it)->getTrackType() != Track::kTrackTypeVideo && !(*it)->endOfTrack())
+				return false;
+
+		return true;
+	}
+
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		const Track *track = *it;
 
@@ -322,6 +405,8 @@ bool VideoDecoder::rewind() {
 	if (!isRewindable())
 		return false;
 
+	stopPrefetch();
+
 	// Stop all tracks so they can be rewound
 	if (isPlaying())
 		stopAudio();
@@ -356,6 +441,8 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	if (!isSeekable())
 		return false;
 
+	stopPrefetch();
+
 	// Stop all tracks so they can be seeked
 	if (isPlaying())
 		stopAudio();
@@ -422,6 +509,8 @@ void VideoDecoder::stop() {
 	if (!isPlaying())
 		return;
 
+	Common::StackLock lock(_prefetchMutex);
+
 	// Stop audio here so we don't have it affect getTime()
 	stopAudio();
 
@@ -470,6 +559,8 @@ void VideoDecoder::setRate(const Common::Rational &rate) {
 			return;
 	}
 
+	Common::StackLock lock(_prefetchMutex);
+
 	if (_playbackRate != 0)
 		_lastTimeChange = getTime();
 
@@ -759,6 +850,7 @@ bool VideoDecoder::addStreamFileTrack(const Common::String &baseName) {
 	if (!isVideoLoaded())
 		return false;
 
+	Common::StackLock lock(_prefetchMutex);
 	StreamFileAudioTrack *track = new StreamFileAudioTrack(getSoundType());
 
 	bool result = track->loadFromFile(baseName);
@@ -783,6 +875,8 @@ bool VideoDecoder::setAudioTrack(int index) {
 	if (_mainAudioTrack == audioTrack)
 		return true;
 
+	Common::StackLock lock(_prefetchMutex);
+
 	_mainAudioTrack->setMute(true);
 	audioTrack->setMute(false);
 	_mainAudioTrack = audioTrack;
@@ -800,6 +894,7 @@ uint VideoDecoder::getAudioTrackCount() const {
 }
 
 void VideoDecoder::setEndTime(const Audio::Timestamp &endTime) {
+	Common::StackLock lock(_prefetchMutex);
 	Audio::Timestamp startTime = 0;
 
 	if (isPlaying()) {
@@ -917,6 +1012,8 @@ bool VideoDecoder::hasFramesLeft() const {
 	// This is similar to endOfVideo(), except it doesn't take Audio into account (and returns true if not the end of the video)
 	// This is only used for needsUpdate() atm so that setEndTime() works properly
 	// And unlike endOfVideoTracks(), this takes into account _endTime
+	if (_prefetchThread)
+		return !videoEndReached(_prefetchState);
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() != Track::kTrackTypeVideo)
 			continue;
@@ -957,4 +1054,214 @@ void VideoDecoder::eraseTrack(Track *track) {
 	}
 }
 
+void VideoDecoder::setPrefetchFrames(uint frames) {
+	if (frames == _prefetchFrames)
+		return;
+
+	stopPrefetch();
+	freePrefetchedFrames();
+	_prefetchFrames = frames;
+
+	Common::StackLock lock(_prefetchStatsMutex);
+	memset(&_prefetchStats, 0, sizeof(_prefetchStats));
+	_prefetchStats.maxQueuedFrames = frames;
+}
+
+VideoDecoder::PrefetchStats VideoDecoder::getPrefetchStats() const {
+	Common::StackLock lock(_prefetchStatsMutex);
+	return _prefetchStats;
+}
+
+void VideoDecoder::savePrefetchState(PrefetchState &state) const {
+	state.curFrame = -1;
+	state.hasNextVideoTrack = false;
+	state.nextFrameStartTime = 0;
+	state.reversed = false;
+
+	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if ((*it)->getTrackType() != Track::kTrackTypeVideo)
+			continue;
+
+		const VideoTrack *track = (const VideoTrack *)*it;
+		state.curFrame += track->getCurFrame() + 1;
+
+		// Same as findNextVideoTrack()
+		if (!track->endOfTrack() && (!state.hasNextVideoTrack || track->getNextFrameStartTime() < state.nextFrameStartTime)) {
+			state.hasNextVideoTrack = true;
+			state.nextFrameStartTime = track->getNextFrameStartTime();
+			state.reversed = track->isReversed();
+		}
+	}
+}
+
+bool VideoDecoder::videoEndReached(const PrefetchState &state) const {
+	// Every video track ended, or the earliest next frame is past the end time
+	return !state.hasNextVideoTrack || (isPlaying() && _endTimeSet && state.nextFrameStartTime >= (uint)_endTime.msecs());
+}
+
+bool VideoDecoder::startPrefetch() {
+	if (_prefetchThread)
+		return true;
+
+	if (!_prefetchFrames || !canPrefetch())
+		return false;
+
+	PrefetchState state;
+	savePrefetchState(state);
+
+	// Reverse playback may seek before every frame, so it is decoded when
+	// asked for, as is anything after the end of the video
+	if (!state.hasNextVideoTrack || state.reversed)
+		return false;
+
+	if (!_prefetchedFrames)
+		_prefetchedFrames = new PrefetchedFrame[_prefetchFrames + 1];
+
+	_prefetchState = state;
+	_prefetchStop = false;
+	_prefetchNext = 0;
+	_prefetchShown = -1;
+	_prefetchFinished = false;
+
+	// One frame more than prefetched, since the caller may still use the
+	// frame returned last
+	_prefetchFree = new Common::Semaphore(_prefetchFrames + 1);
+	_prefetchReady = new Common::Semaphore();
+	_prefetchThread = new Common::Thread(prefetchProc, this);
+
+	if (!_prefetchThread->isRunning()) {
+		// Without thread support, decode the frames when asked for
+		stopPrefetch();
+		freePrefetchedFrames();
+		_prefetchFrames = 0;
+		return false;
+	}
+
+	return true;
+}
+
+void VideoDecoder::stopPrefetch() {
+	if (!_prefetchThread)
+		return;
+
+	_prefetchMutex.lock();
+	_prefetchStop = true;
+	_prefetchMutex.unlock();
+
+	// Wake up the thread, in case all frames are in use
+	_prefetchFree->post();
+	_prefetchThread->join();
+
+	delete _prefetchThread;
+	delete _prefetchFree;
+	delete _prefetchReady;
+	_prefetchThread = 0;
+	_prefetchFree = 0;
+	_prefetchReady = 0;
+
+	// The surfaces are kept, the last one may still be in use
+	Common::StackLock lock(_prefetchStatsMutex);
+	_prefetchStats.queuedFrames = 0;
+}
+
+void VideoDecoder::freePrefetchedFrames() {
+	delete[] _prefetchedFrames;
+	_prefetchedFrames = 0;
+}
+
+const Graphics::Surface *VideoDecoder::nextPrefetchedFrame() {
+	// There is nothing left to decode
+	if (_prefetchFinished)
+		return 0;
+
+	_prefetchStatsMutex.lock();
+	if (!_prefetchStats.queuedFrames && _prefetchShown >= 0)
+		_prefetchStats.underruns++;
+	_prefetchStatsMutex.unlock();
+
+	_prefetchReady->wait();
+
+	// The frame returned last is not used anymore
+	if (_prefetchShown >= 0)
+		_prefetchFree->post();
+
+	_prefetchShown = (_prefetchShown + 1) % (_prefetchFrames + 1);
+	const PrefetchedFrame &frame = _prefetchedFrames[_prefetchShown];
+
+	_prefetchStatsMutex.lock();
+	_prefetchStats.queuedFrames--;
+	_prefetchStatsMutex.unlock();
+
+	_prefetchState = frame.state;
+	_prefetchFinished = !frame.state.hasNextVideoTrack;
+
+	if (frame.dirtyPalette) {
+		memcpy(_prefetchPalette, frame.palette, sizeof(_prefetchPalette));
+		_palette = _prefetchPalette;
+		_dirtyPalette = true;
+	}
+
+	return frame.hasSurface ? &frame.surface : 0;
+}
+
+void VideoDecoder::prefetchProc(void *param) {
+	((VideoDecoder *)param)->prefetch();
+}
+
+void VideoDecoder::prefetch() {
+	for (;;) {
+		_prefetchFree->wait();
+
+		PrefetchedFrame &frame = _prefetchedFrames[_prefetchNext];
+		_prefetchNext = (_prefetchNext + 1) % (_prefetchFrames + 1);
+
+		uint32 decodeTime;
+
+		{
+			Common::StackLock lock(_prefetchMutex);
+
+			if (_prefetchStop)
+				return;
+
+			uint32 startTime = g_system->getMillis();
+			const byte *palette = 0;
+			const Graphics::Surface *surface = decodeFrameIntern(palette);
+
+			frame.hasSurface = surface != 0;
+
+			if (surface) {
+				if (frame.surface.w != surface->w || frame.surface.h != surface->h || frame.surface.format != surface->format) {
+					frame.surface.free();
+					frame.surface.create(surface->w, surface->h, surface->format);
+				}
+
+				frame.surface.copyRectToSurface(surface->getPixels(), surface->pitch, 0, 0, surface->w, surface->h);
+			}
+
+			frame.dirtyPalette = palette != 0;
+
+			if (palette)
+				memcpy(frame.palette, palette, sizeof(frame.palette));
+
+			savePrefetchState(frame.state);
+			decodeTime = g_system->getMillis() - startTime;
+		}
+
+		bool finished = !frame.state.hasNextVideoTrack;
+
+		_prefetchStatsMutex.lock();
+		_prefetchStats.queuedFrames++;
+		_prefetchStats.decodedFrames++;
+		_prefetchStats.lastDecodeTime = decodeTime;
+		_prefetchStats.maxDecodeTime = MAX(_prefetchStats.maxDecodeTime, decodeTime);
+		_prefetchStats.totalDecodeTime += decodeTime;
+		_prefetchStatsMutex.unlock();
+
+		_prefetchReady->post();
+
+		if (finished)
+			return;
+	}
+}
+
 } // End of namespace Video
@@ -25,6 +25,7 @@
 #include "audio/mixer.h"
 #include "audio/timestamp.h"	// TODO: Move this to common/ ?
 #include "common/array.h"
+#include "common/mutex.h"
 #include "common/path.h"
 #include "common/rational.h"
 #include "common/str.h"
@@ -38,6 +39,8 @@ class SeekableAudioStream;
 
 namespace Common {
 class SeekableReadStream;
+class Semaphore;
+class Thread;
 }
 
 namespace Graphics {
@@ -52,7 +55,7 @@ namespace Video {
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -396,6 +399,58 @@ public:
 	 */
 	bool setDitheringPalette(const byte *palette);
 
+	/////////////////////////////////////////
+	// Frame Prefetching
+	/////////////////////////////////////////
+
+	/**
+	 * Statistics of the frame prefetching.
+	 *
+	 * @see setPrefetchFrames()
+	 */
+	struct PrefetchStats {
+		uint queuedFrames;       ///< Frames decoded ahead, which were not shown yet
+		uint maxQueuedFrames;    ///< Capacity of the queue
+		uint32 decodedFrames;    ///< Frames decoded by the prefetch thread
+		uint32 underruns;        ///< How often decodeNextFrame() had to wait for a frame
+		uint32 lastDecodeTime;   ///< Time spent decoding the last frame, in ms
+		uint32 maxDecodeTime;    ///< Longest time spent decoding a frame, in ms
+		uint32 totalDecodeTime;  ///< Time spent decoding all frames, in ms
+	};
+
+	/**
+	 * Decode frames ahead on a separate thread.
+	 *
+	 * By default, decodeNextFrame() decodes the frame before it returns, so
+	 * any frame which takes longer to decode than it is shown causes a
+	 * hitch. With prefetching, a thread decodes up to the given number of
+	 * frames ahead into copies owned by the VideoDecoder, and
+	 * decodeNextFrame() only returns the next one. Seeking, rewinding and
+	 * closing drop the frames decoded ahead. Reverse playback is always
+	 * decoded when asked for.
+	 *
+	 * Without thread support, or for decoders which cannot decode ahead
+	 * (see canPrefetch()), the frames are decoded as usual.
+	 *
+	 * Frames decoded ahead are dropped when this is changed during
+	 * playback, so it should be called before the first decodeNextFrame().
+	 *
+	 * @param frames The number of frames to decode ahead, 0 to disable
+	 */
+	void setPrefetchFrames(uint frames);
+
+	/**
+	 * Get the number of frames to decode ahead.
+	 *
+	 * @see setPrefetchFrames()
+	 */
+	uint getPrefetchFrames() const { return _prefetchFrames; }
+
+	/**
+	 * Get the statistics of the frame prefetching since it was enabled.
+	 */
+	PrefetchStats getPrefetchStats() const;
+
 	/////////////////////////////////////////
 	// Audio Control
 	/////////////////////////////////////////
@@ -936,6 +991,29 @@ protected:
 	 */
 	virtual AudioTrack *getAudioTrack(int index) { return 0; }
 
+	/**
+	 * Whether the frames can be decoded ahead.
+	 *
+	 * A subclass whose decodeNextFrame() reads or decodes more than the
+	 * next frame of its tracks, like an extra track decoded separately,
+	 * must return false, since the prefetch thread is already ahead of
+	 * the shown frame meanwhile.
+	 *
+	 * @see setPrefetchFrames()
+	 */
+	virtual bool canPrefetch() const { return true; }
+
+	/**
+	 * Held by the prefetch thread while it decodes a frame.
+	 *
+	 * A subclass which reads its streams or changes its tracks outside of
+	 * readNextPacket(), the tracks and the virtual functions which stop the
+	 * prefetching must lock it.
+	 *
+	 * @see setPrefetchFrames()
+	 */
+	Common::Mutex _prefetchMutex;
+
 private:
 	// Tracks owned by this VideoDecoder
 	TrackList _tracks;
@@ -978,6 +1056,42 @@ private:
 	Audio::Mixer::SoundType _soundType;
 
 	AudioTrack *_mainAudioTrack;
+
+	// Frame prefetching
+	struct PrefetchedFrame;
+
+	/** The state of the video tracks after decoding a frame. */
+	struct PrefetchState {
+		int curFrame;
+		bool hasNextVideoTrack;
+		uint32 nextFrameStartTime;
+		bool reversed;
+	};
+
+	const Graphics::Surface *decodeFrameIntern(const byte *&palette);
+	void savePrefetchState(PrefetchState &state) const;
+	bool videoEndReached(const PrefetchState &state) const;
+	bool startPrefetch();
+	void stopPrefetch();
+	void freePrefetchedFrames();
+	const Graphics::Surface *nextPrefetchedFrame();
+	static void prefetchProc(void *param);
+	void prefetch();
+
+	uint _prefetchFrames;
+	PrefetchedFrame *_prefetchedFrames;
+	Common::Thread *_prefetchThread;
+	Common::Semaphore *_prefetchFree;
+	Common::Semaphore *_prefetchReady;
+	bool _prefetchStop;
+	uint _prefetchNext;
+	int _prefetchShown;
+	bool _prefetchFinished;
+	PrefetchState _prefetchState;
+	byte _prefetchPalette[256 * 3];
+
+	mutable Common::Mutex _prefetchStatsMutex;
+	PrefetchStats _prefetchStats;
 };
 
 } // End of namespace Video